@@ -0,0 +1,169 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_ATOMICCOUNTER_H
+#define OPENDDS_DCPS_ATOMICCOUNTER_H
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+# pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+#include "dds/Versioned_Namespace.h"
+
+#include "ace/config-lite.h"
+
+#if defined ACE_HAS_CPP11
+#  define OPENDDS_ATOMIC_COUNTER_STD
+#  include <atomic>
+#elif defined __GNUC__ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#  define OPENDDS_ATOMIC_COUNTER_GCC
+#elif defined _MSC_VER
+#  define OPENDDS_ATOMIC_COUNTER_MSVC
+#  include <intrin.h>
+#else
+#  include "ace/Guard_T.h"
+#  include "ace/Synch_Traits.h"
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class AtomicCounter
+ *
+ * @brief Reference count updated with the processor's atomic instructions.
+ *
+ * increment() doesn't order other memory accesses, the caller already holds
+ * a reference so the object can't go away.  decrement() makes the writes
+ * done while holding a reference visible to the thread that takes the count
+ * to 0 and deletes the object.  Compilers without atomic builtins fall back
+ * on a mutex.
+ */
+class AtomicCounter {
+public:
+  explicit AtomicCounter(long value = 0)
+    : value_(value)
+  {}
+
+  void increment()
+  {
+#if defined OPENDDS_ATOMIC_COUNTER_STD
+    value_.fetch_add(1, std::memory_order_relaxed);
+#elif defined OPENDDS_ATOMIC_COUNTER_GCC
+    __atomic_fetch_add(&value_, 1, __ATOMIC_RELAXED);
+#elif defined OPENDDS_ATOMIC_COUNTER_MSVC
+    _InterlockedIncrement(&value_);
+#else
+    ACE_GUARD(ACE_SYNCH_MUTEX, guard, lock_);
+    ++value_;
+#endif
+  }
+
+  /// Returns the new value.
+  long decrement()
+  {
+#if defined OPENDDS_ATOMIC_COUNTER_STD
+    const long value = value_.fetch_sub(1, std::memory_order_release) - 1;
+    if (value == 0) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return value;
+#elif defined OPENDDS_ATOMIC_COUNTER_GCC
+    const long value = __atomic_sub_fetch(&value_, 1, __ATOMIC_RELEASE);
+    if (value == 0) {
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }
+    return value;
+#elif defined OPENDDS_ATOMIC_COUNTER_MSVC
+    return _InterlockedDecrement(&value_);
+#else
+    ACE_GUARD_RETURN(ACE_SYNCH_MUTEX, guard, lock_, -1);
+    return --value_;
+#endif
+  }
+
+  /// Increments the counter unless it's 0.  Returns false if it was 0.
+  bool increment_if_nonzero()
+  {
+#if defined OPENDDS_ATOMIC_COUNTER_STD
+    long value = value_.load(std::memory_order_relaxed);
+    while (value != 0) {
+      if (value_.compare_exchange_weak(value, value + 1,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+#elif defined OPENDDS_ATOMIC_COUNTER_GCC
+    long value = __atomic_load_n(&value_, __ATOMIC_RELAXED);
+    while (value != 0) {
+      if (__atomic_compare_exchange_n(&value_, &value, value + 1, true,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return true;
+      }
+    }
+    return false;
+#elif defined OPENDDS_ATOMIC_COUNTER_MSVC
+    long value = value_;
+    while (value != 0) {
+      const long prev = _InterlockedCompareExchange(&value_, value + 1, value);
+      if (prev == value) {
+        return true;
+      }
+      value = prev;
+    }
+    return false;
+#else
+    ACE_GUARD_RETURN(ACE_SYNCH_MUTEX, guard, lock_, false);
+    if (value_ == 0) {
+      return false;
+    }
+    ++value_;
+    return true;
+#endif
+  }
+
+  long value() const
+  {
+#if defined OPENDDS_ATOMIC_COUNTER_STD
+    return value_.load(std::memory_order_acquire);
+#elif defined OPENDDS_ATOMIC_COUNTER_GCC
+    return __atomic_load_n(&value_, __ATOMIC_ACQUIRE);
+#elif defined OPENDDS_ATOMIC_COUNTER_MSVC
+    // MSVC gives volatile reads acquire semantics.
+    return value_;
+#else
+    ACE_GUARD_RETURN(ACE_SYNCH_MUTEX, guard, lock_, -1);
+    return value_;
+#endif
+  }
+
+private:
+  AtomicCounter(const AtomicCounter&);
+  AtomicCounter& operator=(const AtomicCounter&);
+
+#if defined OPENDDS_ATOMIC_COUNTER_STD
+  std::atomic<long> value_;
+#elif defined OPENDDS_ATOMIC_COUNTER_GCC
+  long value_;
+#elif defined OPENDDS_ATOMIC_COUNTER_MSVC
+  volatile long value_;
+#else
+  mutable ACE_SYNCH_MUTEX lock_;
+  long value_;
+#endif
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_ATOMICCOUNTER_H */
@@ -0,0 +1,136 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "AtomicDataBlock.h"
+
+#include "ace/Malloc_Base.h"
+#include "ace/OS_Memory.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+namespace {
+
+AtomicDataBlock*
+create(size_t size,
+       ACE_Message_Block::ACE_Message_Type msg_type,
+       ACE_Allocator* allocator_strategy,
+       ACE_Message_Block::Message_Flags flags,
+       ACE_Allocator* data_block_allocator)
+{
+  if (!data_block_allocator) {
+    data_block_allocator = ACE_Allocator::instance();
+  }
+
+  AtomicDataBlock* db = 0;
+  ACE_NEW_MALLOC_RETURN(db,
+                        static_cast<AtomicDataBlock*>(
+                          data_block_allocator->malloc(sizeof(AtomicDataBlock))),
+                        AtomicDataBlock(size, msg_type, allocator_strategy,
+                                        flags, data_block_allocator),
+                        0);
+
+  // The data block is constructed even if its buffer couldn't be allocated.
+  if (db->size() < size) {
+    db->~AtomicDataBlock();
+    data_block_allocator->free(db);
+    return 0;
+  }
+  return db;
+}
+
+}
+
+AtomicDataBlock::AtomicDataBlock(size_t size,
+                                 ACE_Message_Block::ACE_Message_Type msg_type,
+                                 ACE_Allocator* allocator_strategy,
+                                 ACE_Message_Block::Message_Flags flags,
+                                 ACE_Allocator* data_block_allocator)
+  : ACE_Data_Block(size, msg_type, 0, allocator_strategy, 0 /*locking_strategy*/,
+                   flags, data_block_allocator)
+  , ref_count_(1)
+{
+}
+
+ACE_Data_Block*
+AtomicDataBlock::duplicate()
+{
+  ref_count_.increment();
+  return this;
+}
+
+ACE_Data_Block*
+AtomicDataBlock::release_i()
+{
+  // The caller frees the block when this returns 0.
+  return ref_count_.decrement() ? this : 0;
+}
+
+ACE_Data_Block*
+AtomicDataBlock::clone_nocopy(ACE_Message_Block::Message_Flags mask,
+                              size_t max_size) const
+{
+  // The clone has its own buffer, so it always deletes it.
+  const ACE_Message_Block::Message_Flags clear =
+    mask | ACE_Message_Block::DONT_DELETE;
+  return create(max_size ? max_size : capacity(), msg_type(),
+                allocator_strategy(), flags() & ~clear, data_block_allocator());
+}
+
+AtomicDataBlock*
+AtomicDataBlock::make(size_t size,
+                      ACE_Allocator* allocator_strategy,
+                      ACE_Allocator* data_block_allocator)
+{
+  return create(size, ACE_Message_Block::MB_DATA, allocator_strategy, 0,
+                data_block_allocator);
+}
+
+ACE_Message_Block*
+AtomicDataBlock::make_message_block(size_t size,
+                                    ACE_Message_Block* cont,
+                                    ACE_Allocator* allocator_strategy,
+                                    ACE_Allocator* data_block_allocator,
+                                    ACE_Allocator* message_block_allocator)
+{
+  ACE_Message_Block* mb = 0;
+  ACE_Data_Block* const db = make(size, allocator_strategy, data_block_allocator);
+
+  if (db) {
+    if (message_block_allocator) {
+      ACE_NEW_MALLOC_NORETURN(mb,
+                              static_cast<ACE_Message_Block*>(
+                                message_block_allocator->malloc(sizeof(ACE_Message_Block))),
+                              ACE_Message_Block(db, 0, message_block_allocator));
+    } else {
+      ACE_NEW_NORETURN(mb, ACE_Message_Block(db, 0, 0));
+    }
+
+    if (!mb) {
+      db->release();
+    }
+  }
+
+  if (!mb) {
+    if (cont) {
+      cont->release();
+    }
+    return 0;
+  }
+
+  mb->cont(cont);
+  return mb;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
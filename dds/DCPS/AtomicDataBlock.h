@@ -0,0 +1,88 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_ATOMICDATABLOCK_H
+#define OPENDDS_DCPS_ATOMICDATABLOCK_H
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+# pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+#include "dcps_export.h"
+#include "AtomicCounter.h"
+
+#include "ace/Message_Block.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class AtomicDataBlock
+ *
+ * @brief ACE_Data_Block whose reference count is an AtomicCounter instead
+ *        of an int guarded by a locking strategy.
+ *
+ * A sample's data block is duplicated and released by every DataLink it
+ * is sent on and by the send buffers that retain it, from the threads of
+ * those links.  With an AtomicDataBlock none of them take a lock for it.
+ * The block has no locking strategy, so ACE_Message_Block::release()
+ * doesn't lock either.  ACE_Data_Block::reference_count() isn't kept up
+ * to date, use ref_count().
+ *
+ * The block must be allocated with its @a data_block_allocator, which
+ * frees it when the count gets to 0; make_message_block() does that.
+ */
+class OpenDDS_Dcps_Export AtomicDataBlock : public ACE_Data_Block {
+public:
+  AtomicDataBlock(size_t size,
+                  ACE_Message_Block::ACE_Message_Type msg_type,
+                  ACE_Allocator* allocator_strategy,
+                  ACE_Message_Block::Message_Flags flags,
+                  ACE_Allocator* data_block_allocator);
+
+  virtual ACE_Data_Block* duplicate();
+
+  /// Clones are AtomicDataBlocks as well.
+  virtual ACE_Data_Block* clone_nocopy(ACE_Message_Block::Message_Flags mask = 0,
+                                       size_t max_size = 0) const;
+
+  long ref_count() const { return ref_count_.value(); }
+
+  /// Returns an AtomicDataBlock of @a size bytes allocated from
+  /// @a data_block_allocator (the ACE default allocator if 0), or 0 if
+  /// it or its buffer can't be allocated.
+  static AtomicDataBlock* make(size_t size,
+                               ACE_Allocator* allocator_strategy = 0,
+                               ACE_Allocator* data_block_allocator = 0);
+
+  /// Returns an MB_DATA message block of @a size bytes followed by
+  /// @a cont, for an AtomicDataBlock from make().  @a cont is released if
+  /// the message block can't be allocated.
+  static ACE_Message_Block* make_message_block(size_t size,
+                                               ACE_Message_Block* cont = 0,
+                                               ACE_Allocator* allocator_strategy = 0,
+                                               ACE_Allocator* data_block_allocator = 0,
+                                               ACE_Allocator* message_block_allocator = 0);
+
+protected:
+  virtual ACE_Data_Block* release_i();
+
+private:
+  AtomicDataBlock(const AtomicDataBlock&);
+  AtomicDataBlock& operator=(const AtomicDataBlock&);
+
+  AtomicCounter ref_count_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_ATOMICDATABLOCK_H */
@@ -16,6 +16,7 @@
 #include "DataSampleElement.h"
 #include "WriteDataContainer.h"
 #include "DataWriterImpl.h"
+#include "AtomicDataBlock.h"
 #include "Time_Helper.h"
 #include "debug.h"
 #include "SafetyProfileStreams.h"
@@ -73,7 +74,9 @@ public:
                   list_difference_type index,
                   ACE_Allocator * allocator,
                   const OPENDDS_VECTOR(OPENDDS_STRING) & path,
-                  const ACE_CString & data_dir)
+                  const ACE_CString & data_dir,
+                  OpenDDS::DCPS::DurabilityLog * log,
+                  ACE_UINT32 log_id)
   : sample_list_(sample_list)
   , index_(index)
   , allocator_(allocator)
@@ -81,6 +84,8 @@ public:
   , timer_ids_(0)
   , path_(path)
   , data_dir_(data_dir)
+  , log_(log)
+  , log_id_(log_id)
   {
   }
 
@@ -103,6 +108,10 @@ public:
                  data_queue_type);
     queue = 0;
 
+    if (this->log_ && this->log_id_) {
+      this->log_->remove(this->log_id_);
+    }
+
     try {
       cleanup_directory(path_, this->data_dir_);
 
@@ -160,6 +169,80 @@ private:
   OPENDDS_VECTOR(OPENDDS_STRING) path_;
 
   ACE_CString data_dir_;
+
+  /// Log holding the samples if they weren't stored in path_.
+  OpenDDS::DCPS::DurabilityLog * const log_;
+  ACE_UINT32 const log_id_;
+};
+
+/**
+ * @class Log_Loader
+ *
+ * @brief Creates the in-memory data structures for the streams read
+ *        from the DurabilityLog, as if insert() had been called once
+ *        for each of them.
+ */
+class Log_Loader : public OpenDDS::DCPS::DurabilityLog::Loader {
+public:
+
+  typedef OpenDDS::DCPS::DataDurabilityCache cache_type;
+  typedef OpenDDS::DCPS::DurabilityQueue<cache_type::sample_data_type>
+  data_queue_type;
+
+  Log_Loader(cache_type::sample_map_type & samples,
+             ACE_Allocator * allocator)
+  : samples_(samples)
+  , allocator_(allocator)
+  , queue_(0)
+  {
+  }
+
+  virtual void stream(ACE_UINT32 id, DDS::DomainId_t domain_id,
+                      const char * topic_name, const char * type_name) {
+    cache_type::key_type key(domain_id, topic_name, type_name, allocator_);
+    cache_type::sample_list_type * sample_list = 0;
+    queue_ = 0;
+
+    if (samples_.find(key, sample_list, allocator_) != 0) {
+      ACE_NEW_MALLOC(sample_list,
+                     static_cast<cache_type::sample_list_type *>(
+                       allocator_->malloc(sizeof(cache_type::sample_list_type))),
+                     cache_type::sample_list_type(0,
+                                                  static_cast<data_queue_type *>(0),
+                                                  allocator_));
+      if (samples_.bind(key, sample_list, allocator_) != 0) return;
+    }
+
+    ACE_NEW_MALLOC(queue_,
+                   static_cast<data_queue_type *>(
+                     allocator_->malloc(sizeof(data_queue_type))),
+                   data_queue_type(allocator_));
+
+    size_t const old_len = sample_list->size();
+    sample_list->size(old_len + 1);
+    (*sample_list)[old_len] = queue_;
+    queue_->log_id_ = id;
+  }
+
+  virtual void sample(ACE_UINT32 id, const DDS::Time_t & timestamp,
+                      const char * data, size_t length) {
+    // The samples of a stream follow the call to stream() for it.
+    if (queue_ == 0 || queue_->log_id_ != id) return;
+
+    // sample_data_type copies the data, no need to copy it here.
+    ACE_Message_Block mb(data, length);
+    mb.wr_ptr(length);
+    queue_->enqueue_tail(cache_type::sample_data_type(timestamp, mb,
+                                                      allocator_));
+  }
+
+private:
+
+  cache_type::sample_map_type & samples_;
+  ACE_Allocator * const allocator_;
+
+  /// Queue of the stream being read.
+  data_queue_type * queue_;
 };
 
 } // namespace
@@ -285,6 +368,7 @@ OpenDDS::DCPS::DataDurabilityCache::DataDurabilityCache(
   DDS::DurabilityQosPolicyKind kind)
   : allocator_(new ACE_New_Allocator)
   , kind_(kind)
+  , sync_samples_(0)
   , samples_(0)
   , cleanup_timer_ids_()
   , lock_()
@@ -295,10 +379,14 @@ OpenDDS::DCPS::DataDurabilityCache::DataDurabilityCache(
 
 OpenDDS::DCPS::DataDurabilityCache::DataDurabilityCache(
   DDS::DurabilityQosPolicyKind kind,
-  ACE_CString & data_dir)
+  ACE_CString & data_dir,
+  size_t sync_samples,
+  ACE_Time_Value const & sync_interval)
   : allocator_(new ACE_New_Allocator)
   , kind_(kind)
   , data_dir_(data_dir)
+  , sync_samples_(sync_samples)
+  , sync_interval_(sync_interval)
   , samples_(0)
   , cleanup_timer_ids_()
   , lock_()
@@ -416,6 +504,23 @@ void OpenDDS::DCPS::DataDurabilityCache::init()
         }
       }
     }
+
+    // Data written since the log was added is in the log, it's also used
+    // for new data.  FileSystemStorage is only used if the log can't be.
+    this->log_.reset(new DurabilityLog(this->data_dir_, this->sync_samples_,
+                                       this->sync_interval_));
+    Log_Loader loader(*this->samples_, allocator);
+
+    if (!this->log_->open(loader)) {
+      if (DCPS_debug_level) {
+        ACE_ERROR((LM_WARNING,
+                   ACE_TEXT("(%P|%t) DataDurabilityCache::init ")
+                   ACE_TEXT("couldn't open log for PERSISTENT data in %C, ")
+                   ACE_TEXT("using a file per sample\n"),
+                   this->data_dir_.c_str()));
+      }
+      this->log_.reset();
+    }
   }
 
   this->reactor_ = TheServiceParticipant->timer();
@@ -531,12 +636,17 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
   using OpenDDS::FileSystemStorage::File;
   Directory::Ptr dir;
   OPENDDS_VECTOR(OPENDDS_STRING) path;
+  ACE_UINT32 log_id = 0;
   {
     ACE_Allocator * const allocator = this->allocator_.get();
 
     ACE_GUARD_RETURN(ACE_SYNCH_MUTEX, guard, this->lock_, false);
 
-    if (this->kind_ == DDS::PERSISTENT_DURABILITY_QOS) {
+    if (this->kind_ == DDS::PERSISTENT_DURABILITY_QOS && this->log_) {
+      // Like the directory below, a stream per datawriter.
+      log_id = this->log_->add_stream(domain_id, topic_name, type_name);
+
+    } else if (this->kind_ == DDS::PERSISTENT_DURABILITY_QOS) {
       try {
         dir = Directory::create(this->data_dir_.c_str());
 
@@ -611,6 +721,8 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
       samples->fs_path_ = path;
     }
 
+    samples->log_id_ = log_id;
+
     for (SendStateDataSampleList::iterator i(element); i != the_end; ++i) {
       DataSampleElement& elem = *i;
 
@@ -631,7 +743,21 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
       if (samples->enqueue_tail(sample) != 0)
         return false;
 
-      if (!dir.is_nil()) {
+      if (log_id) {
+        DDS::Time_t timestamp;
+        const char * data;
+        size_t len;
+        sample.get_sample(data, len, timestamp);
+
+        if (!this->log_->append(log_id, timestamp, data, len)
+            && DCPS_debug_level > 0) {
+          ACE_ERROR((LM_ERROR,
+                     ACE_TEXT("(%P|%t) DataDurabilityCache::insert ")
+                     ACE_TEXT("couldn't write sample for PERSISTENT ")
+                     ACE_TEXT("data to the log\n")));
+        }
+
+      } else if (!dir.is_nil()) {
         try {
           File::Ptr f = dir->create_next_file();
           std::ofstream os;
@@ -682,7 +808,9 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
                           slot - &(*sample_list)[0],
                           this->allocator_.get(),
                           path,
-                          this->data_dir_);
+                          this->data_dir_,
+                          this->log_.get(),
+                          log_id);
     ACE_Event_Handler_var safe_cleanup(cleanup);   // Transfer ownership
     long const tid =
       this->reactor_->schedule_timer(cleanup,
@@ -696,6 +824,10 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
                    DurabilityQueue<sample_data_type>);
       *slot = 0;
 
+      if (log_id) {
+        this->log_->remove(log_id);
+      }
+
       return false;
 
     } else {
@@ -712,6 +844,12 @@ OpenDDS::DCPS::DataDurabilityCache::insert(
   return true;
 }
 
+bool
+OpenDDS::DCPS::DataDurabilityCache::flush()
+{
+  return !this->log_ || this->log_->flush();
+}
+
 bool
 OpenDDS::DCPS::DataDurabilityCache::get_data(
   DDS::DomainId_t domain_id,
@@ -760,12 +898,9 @@ OpenDDS::DCPS::DataDurabilityCache::get_data(
   // Don't use the cached allocator for the registered sample message
   // block.
   Message_Block_Ptr registration_sample(
-    new ACE_Message_Block(marshaled_sample_length,
-                          ACE_Message_Block::MB_DATA,
-                          0, //cont
-                          0, //data
-                          0, //alloc_strategy
-                          data_writer->get_db_lock()));
+    AtomicDataBlock::make_message_block(marshaled_sample_length));
+  if (!registration_sample)
+    return false;
 
   ACE_OS::memcpy(registration_sample->wr_ptr(),
                  marshaled_sample,
@@ -808,25 +943,14 @@ OpenDDS::DCPS::DataDurabilityCache::get_data(
 
       data->get_sample(sample, sample_length, source_timestamp);
 
-      ACE_Message_Block * tmp_mb = 0;
-      ACE_NEW_MALLOC_RETURN(tmp_mb,
-                            static_cast<ACE_Message_Block*>(
-                              mb_allocator->malloc(
-                                sizeof(ACE_Message_Block))),
-                            ACE_Message_Block(
-                              sample_length,
-                              ACE_Message_Block::MB_DATA,
-                              0, // cont
-                              0, // data
-                              0, // allocator_strategy
-                              data_writer->get_db_lock(), // data block locking_strategy
-                              ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-                              ACE_Time_Value::zero,
-                              ACE_Time_Value::max_time,
-                              db_allocator,
-                              mb_allocator),
-                            false);
-      Message_Block_Ptr mb(tmp_mb);
+      Message_Block_Ptr mb(
+        AtomicDataBlock::make_message_block(sample_length,
+                                            0, // cont
+                                            0, // allocator_strategy
+                                            db_allocator,
+                                            mb_allocator));
+      if (!mb)
+        return false;
 
       ACE_OS::memcpy(mb->wr_ptr(),
                      sample,
@@ -849,6 +973,11 @@ OpenDDS::DCPS::DataDurabilityCache::get_data(
      */
     q->reset();
 
+    if (this->log_ && q->log_id_) {
+      this->log_->remove(q->log_id_);
+      q->log_id_ = 0;
+    }
+
     try {
       cleanup_directory(q->fs_path_, this->data_dir_);
 
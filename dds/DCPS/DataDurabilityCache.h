@@ -18,6 +18,7 @@
 
 #include "dds/DCPS/DurabilityArray.h"
 #include "dds/DCPS/DurabilityQueue.h"
+#include "dds/DCPS/DurabilityLog.h"
 #include "dds/DCPS/FileSystemStorage.h"
 #include "dds/DCPS/PoolAllocator.h"
 #include "dds/DCPS/unique_ptr.h"
@@ -189,8 +190,12 @@ public:
 
   DataDurabilityCache(DDS::DurabilityQosPolicyKind kind);
 
+  /// For @c PERSISTENT data, see DurabilityLog for @a sync_samples and
+  /// @a sync_interval.
   DataDurabilityCache(DDS::DurabilityQosPolicyKind kind,
-                      ACE_CString & data_dir);
+                      ACE_CString & data_dir,
+                      size_t sync_samples = 0,
+                      ACE_Time_Value const & sync_interval = ACE_Time_Value::zero);
 
   ~DataDurabilityCache();
 
@@ -213,6 +218,11 @@ public:
                 ACE_Allocator * db_allocator,
                 DDS::LifespanQosPolicy const & /* lifespan */);
 
+  /// Write the @c PERSISTENT samples that are waiting to be written,
+  /// and sync them to storage.  Returns false if any of them couldn't be
+  /// written.
+  bool flush();
+
 private:
 
   // Prevent copying.
@@ -230,6 +240,14 @@ private:
 
   ACE_CString data_dir_;
 
+  /// When the DurabilityLog syncs the samples written to it.
+  size_t sync_samples_;
+  ACE_Time_Value sync_interval_;
+
+  /// Log of the @c PERSISTENT samples.  Not set when the log can't be
+  /// used, then the samples are stored using FileSystemStorage.
+  unique_ptr<DurabilityLog> log_;
+
   /// Map of all data samples.
   sample_map_type * samples_;
 
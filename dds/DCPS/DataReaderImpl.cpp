@@ -1204,7 +1204,7 @@ DataReaderImpl::enable()
 
   if (DCPS_debug_level >= 2)
     ACE_DEBUG((LM_DEBUG,"(%P|%t) DataReaderImpl::enable"
-        " Cached_Allocator_With_Overflow %x with %d chunks\n",
+        " Slab_Allocator %x with %d chunks\n",
         rd_allocator_.get(), n_chunks_));
 
   if ((qos_.liveliness.lease_duration.sec !=
@@ -1999,6 +1999,7 @@ DataReaderImpl::release_instance(DDS::InstanceHandle_t handle)
   {
     ACE_GUARD(ACE_Recursive_Thread_Mutex, instance_guard, instances_lock_);
     instances_.erase(handle);
+    instance_index_.unbind(handle);
   }
 
   this->release_instance_i(handle);
@@ -2423,19 +2424,17 @@ DataReaderImpl::prepare_to_delete()
 SubscriptionInstance_rch
 DataReaderImpl::get_handle_instance(DDS::InstanceHandle_t handle)
 {
-  ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, instance_guard, this->instances_lock_, SubscriptionInstance_rch());
-
-  SubscriptionInstanceMapType::iterator iter = instances_.find(handle);
-  if (iter == instances_.end()) {
+  SubscriptionInstance_rch instance;
+  if (!instance_index_.find(handle, instance)) {
     ACE_DEBUG((LM_WARNING,
         ACE_TEXT("(%P|%t) WARNING: ")
         ACE_TEXT("DataReaderImpl::get_handle_instance: ")
         ACE_TEXT("lookup for 0x%x failed\n"),
         handle));
     return SubscriptionInstance_rch();
-  } // if (0 != instances_.find(handle, instance))
+  }
 
-  return iter->second;
+  return instance;
 }
 
 DDS::InstanceHandle_t
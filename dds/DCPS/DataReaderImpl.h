@@ -22,7 +22,8 @@
 #include "DisjointSequence.h"
 #include "SubscriptionInstance.h"
 #include "InstanceState.h"
-#include "Cached_Allocator_With_Overflow_T.h"
+#include "Slab_Allocator.h"
+#include "InstanceHandleIndex_T.h"
 #include "ZeroCopyInfoSeq_T.h"
 #include "Stats_T.h"
 #include "OwnershipManager.h"
@@ -72,7 +73,7 @@ class Monitor;
 class DataReaderImpl;
 class FilterEvaluator;
 
-typedef Cached_Allocator_With_Overflow<OpenDDS::DCPS::ReceivedDataElementMemoryBlock, ACE_Null_Mutex>
+typedef Slab_Allocator<OpenDDS::DCPS::ReceivedDataElementMemoryBlock>
 ReceivedDataAllocator;
 
 enum MarshalingType {
@@ -602,6 +603,11 @@ protected:
   /// @TODO: remove the recursive nature of the instances_lock if not needed.
   mutable ACE_Recursive_Thread_Mutex instances_lock_;
 
+  /// Hash index of instances_ used by get_handle_instance(), so that
+  /// looking up an instance doesn't take instances_lock_ or contend with
+  /// lookups of other instances.  Updated along with instances_.
+  InstanceHandleIndex<SubscriptionInstance_rch> instance_index_;
+
   /// Check if the received data sample or instance should
   /// be filtered.
   /**
@@ -6,6 +6,7 @@
 #include "dds/DCPS/BuiltInTopicUtils.h"
 #include "dds/DCPS/Util.h"
 #include "dds/DCPS/TypeSupportImpl.h"
+#include "dds/DCPS/KeyHashIndex_T.h"
 #include "dds/DCPS/Watchdog.h"
 #include "dcps_export.h"
 #include "dds/DCPS/GuidConverter.h"
@@ -13,6 +14,8 @@
 #include "ace/Bound_Ptr.h"
 #include "ace/Time_Value.h"
 
+#include <algorithm>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -39,6 +42,8 @@ namespace OpenDDS {
 
     typedef OPENDDS_MAP_CMP_T(MessageType, DDS::InstanceHandle_t,
                               typename TraitsType::LessThanType) InstanceMap;
+    typedef KeyHashIndex<InstanceMap, typename TraitsType::HashType,
+                         typename TraitsType::LessThanType> KeyIndex;
 
     class SharedInstanceMap
       : public RcObject
@@ -69,12 +74,13 @@ namespace OpenDDS {
       ACE_New_Allocator* allocator_;
     };
 
-    typedef OpenDDS::DCPS::Cached_Allocator_With_Overflow<MessageTypeMemoryBlock, ACE_Null_Mutex>  DataAllocator;
+    typedef OpenDDS::DCPS::Slab_Allocator<MessageTypeMemoryBlock>  DataAllocator;
 
     typedef typename TraitsType::DataReaderType Interface;
 
     DataReaderImpl_T (void)
     : filter_delayed_handler_(make_rch<FilterDelayedHandler>(ref(*this)))
+    , key_index_(instance_map_)
     {
     }
 
@@ -100,7 +106,7 @@ namespace OpenDDS {
         ACE_DEBUG((LM_DEBUG,
                    ACE_TEXT("(%P|%t) %CDataReaderImpl::")
                    ACE_TEXT("enable_specific-data")
-                   ACE_TEXT(" Cached_Allocator_With_Overflow ")
+                   ACE_TEXT(" Slab_Allocator ")
                    ACE_TEXT("%x with %d chunks\n"),
                    TraitsType::type_name(),
                    data_allocator().get(),
@@ -694,7 +700,7 @@ namespace OpenDDS {
 
   virtual DDS::InstanceHandle_t lookup_instance (const MessageType & instance_data)
   {
-    typename InstanceMap::const_iterator const it = instance_map_.find(instance_data);
+    typename InstanceMap::const_iterator const it = key_index_.find(instance_data);
 
     if (it == instance_map_.end())
       {
@@ -735,8 +741,15 @@ namespace OpenDDS {
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, guard, sample_lock_, false);
     ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex, instance_guard, this->instances_lock_, false);
 
-    const bool filter_has_non_key_fields =
-      evaluator.has_non_key_fields(getMetaStruct<MessageType>());
+    const MetaStruct& meta = getMetaStruct<MessageType>();
+    const bool filter_has_non_key_fields = evaluator.has_non_key_fields(meta);
+
+    // The filter is evaluated for runs of samples at a time, see
+    // FilterEvaluator::eval_batch().
+    const size_t batch_size = 256;
+    const void* batch[batch_size];
+    unsigned char selected[batch_size];
+    size_t count = 0;
 
     for (SubscriptionInstanceMapType::iterator iter = instances_.begin(),
            end = instances_.end(); iter != end; ++iter) {
@@ -754,14 +767,23 @@ namespace OpenDDS {
             if (!item->valid_data_ && filter_has_non_key_fields) {
               continue;
             }
-            if (evaluator.eval(*static_cast< MessageType* >(item->registered_data_), params)) {
-              return true;
+            batch[count++] = item->registered_data_;
+            if (count == batch_size) {
+              evaluator.eval_batch(batch, count, meta, params, selected);
+              if (std::find(selected, selected + count, 1) != selected + count) {
+                return true;
+              }
+              count = 0;
             }
           }
         }
       }
     }
 
+    if (count) {
+      evaluator.eval_batch(batch, count, meta, params, selected);
+      return std::find(selected, selected + count, 1) != selected + count;
+    }
     return false;
   }
 
@@ -977,7 +999,7 @@ namespace OpenDDS {
     }
 
     DDS::InstanceHandle_t handle(DDS::HANDLE_NIL);
-    typename InstanceMap::const_iterator const it = instance_map_.find(data);
+    typename InstanceMap::const_iterator const it = key_index_.find(data);
     if (it != instance_map_.end()) {
       handle = it->second;
     }
@@ -1115,6 +1137,7 @@ protected:
           {
             typename InstanceMap::iterator curIt = it;
             ++ it;
+            key_index_.erase (curIt);
             instance_map_.erase (curIt);
           }
         else
@@ -1629,7 +1652,7 @@ void store_instance_data(
   //!!! caller should already have the sample_lock_
   //We will unlock it before calling into listeners
 
-  typename InstanceMap::const_iterator const it = instance_map_.find(*instance_data);
+  typename InstanceMap::const_iterator const it = key_index_.find(*instance_data);
 
   if ((is_dispose_msg || is_unregister_msg) && it == instance_map_.end())
   {
@@ -1720,6 +1743,7 @@ void store_instance_data(
                     ACE_TEXT("insert handle failed. \n"), TraitsType::type_name()));
         return;
       }
+      instance_index_.bind(handle, instance);
     }
 
 #ifndef OPENDDS_NO_OWNERSHIP_KIND_EXCLUSIVE
@@ -1772,6 +1796,7 @@ void store_instance_data(
                   ACE_TEXT("insert %C failed. \n"), TraitsType::type_name(), TraitsType::type_name()));
       return;
     }
+    key_index_.insert(bpair.first);
   }
   else
   {
@@ -2382,6 +2407,7 @@ unique_ptr<DataAllocator>& data_allocator() { return filter_delayed_handler_->da
 RcHandle<FilterDelayedHandler> filter_delayed_handler_;
 
 InstanceMap  instance_map_;
+KeyIndex key_index_;
 };
 
 template <typename MessageType>
@@ -7,6 +7,7 @@
 
 #include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
 #include "DataWriterImpl.h"
+#include "AtomicDataBlock.h"
 #include "FeatureDisabledQosCheck.h"
 #include "DomainParticipantImpl.h"
 #include "PublisherImpl.h"
@@ -62,7 +63,6 @@ DataWriterImpl::DataWriterImpl()
     n_chunks_(TheServiceParticipant->n_chunks()),
     association_chunk_multiplier_(TheServiceParticipant->association_chunk_multiplier()),
     qos_(TheServiceParticipant->initial_DataWriterQos()),
-    db_lock_pool_(new DataBlockLockPool((unsigned long)TheServiceParticipant->n_chunks())),
     topic_id_(GUID_UNKNOWN),
     topic_servant_(0),
     listener_mask_(DEFAULT_STATUS_MASK),
@@ -216,11 +216,20 @@ DataWriterImpl::add_association(const RepoId& yourId,
 
   {
     ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
-    reader_info_.insert(std::make_pair(reader.readerId,
-                                       ReaderInfo(reader.filterClassName,
-                                                  TheServiceParticipant->publisher_content_filter() ? reader.filterExpression : "",
-                                                  reader.exprParams, participant_servant_,
-                                                  reader.readerQos.durability.kind > DDS::VOLATILE_DURABILITY_QOS)));
+    const RepoIdToReaderInfoMap::iterator iter =
+      reader_info_.insert(std::make_pair(reader.readerId,
+                                         ReaderInfo(reader.filterClassName,
+                                                    TheServiceParticipant->publisher_content_filter() ? reader.filterExpression : "",
+                                                    reader.exprParams, participant_servant_,
+                                                    reader.readerQos.durability.kind > DDS::VOLATILE_DURABILITY_QOS))).first;
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+    if (!iter->second.eval_.is_nil()) {
+      filter_index_.insert(reader.readerId, iter->second.eval_,
+                           iter->second.expression_params_);
+    }
+#else
+    ACE_UNUSED_ARG(iter);
+#endif
   }
 
   if (DCPS_debug_level > 4) {
@@ -566,9 +575,7 @@ DataWriterImpl::association_complete_i(const RepoId& remote_id)
 
       size_t size = 0, padding = 0;
       gen_find_size(remote_id, size, padding);
-      Message_Block_Ptr data(
-        new ACE_Message_Block(size, ACE_Message_Block::MB_DATA, 0, 0, 0,
-                              get_db_lock()));
+      Message_Block_Ptr data(AtomicDataBlock::make_message_block(size));
       Serializer ser(data.get());
       ser << remote_id;
 
@@ -657,6 +664,9 @@ DataWriterImpl::remove_associations(const ReaderIdSeq & readers,
       }
 
       ACE_GUARD(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_);
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+      filter_index_.remove(readers[i]);
+#endif
       reader_info_.erase(readers[i]);
       //else reader is already removed which indicates remove_association()
       //is called multiple times.
@@ -841,6 +851,9 @@ DataWriterImpl::update_subscription_params(const RepoId& readerId,
 
   if (iter != reader_info_.end()) {
     iter->second.expression_params_ = params;
+    if (!iter->second.eval_.is_nil()) {
+      filter_index_.insert(readerId, iter->second.eval_, params);
+    }
 
   } else if (DCPS_debug_level > 4 &&
              TheServiceParticipant->publisher_content_filter()) {
@@ -1345,26 +1358,26 @@ DataWriterImpl::enable()
 
   // +1 because we might allocate one before releasing another
   // TBD - see if this +1 can be removed.
-  mb_allocator_.reset(new MessageBlockAllocator(n_chunks_ * association_chunk_multiplier_));
-  db_allocator_.reset(new DataBlockAllocator(n_chunks_+1));
-  header_allocator_.reset(new DataSampleHeaderAllocator(n_chunks_+1));
+  mb_allocator_.reset(new WriterMessageBlockAllocator(n_chunks_ * association_chunk_multiplier_));
+  db_allocator_.reset(new WriterDataBlockAllocator(n_chunks_+1));
+  header_allocator_.reset(new WriterSampleHeaderAllocator(n_chunks_+1));
 
   if (DCPS_debug_level >= 2) {
     ACE_DEBUG((LM_DEBUG,
                "(%P|%t) DataWriterImpl::enable-mb"
-               " Cached_Allocator_With_Overflow %x with %d chunks\n",
+               " Slab_Allocator %x with %d chunks\n",
                mb_allocator_.get(),
                n_chunks_));
 
     ACE_DEBUG((LM_DEBUG,
                "(%P|%t) DataWriterImpl::enable-db"
-               " Cached_Allocator_With_Overflow %x with %d chunks\n",
+               " Slab_Allocator %x with %d chunks\n",
                db_allocator_.get(),
                n_chunks_));
 
     ACE_DEBUG((LM_DEBUG,
                "(%P|%t) DataWriterImpl::enable-header"
-               " Cached_Allocator_With_Overflow %x with %d chunks\n",
+               " Slab_Allocator %x with %d chunks\n",
                header_allocator_.get(),
                n_chunks_));
   }
@@ -1720,7 +1733,7 @@ DataWriterImpl::unregister_instances(const DDS::Time_t& source_timestamp)
       this->data_container_->instances_.begin();
 
     while (it != this->data_container_->instances_.end()) {
-      if (!it->second->unregistered_) {
+      if (!it->second->unregistered_.value()) {
         const DDS::InstanceHandle_t handle = it->first;
         ++it; // avoid mangling the iterator
         this->unregister_instance_i(handle, source_timestamp);
@@ -1739,11 +1752,6 @@ DataWriterImpl::write(Message_Block_Ptr data,
 {
   DBG_ENTRY_LVL("DataWriterImpl","write",6);
 
-  ACE_GUARD_RETURN (ACE_Recursive_Thread_Mutex,
-                    guard,
-                    get_lock (),
-                    DDS::RETCODE_ERROR);
-
   // take ownership of sequence allocated in FooDWImpl::write_w_timestamp()
   GUIDSeq_var filter_out_var(filter_out);
 
@@ -1754,8 +1762,35 @@ DataWriterImpl::write(Message_Block_Ptr data,
                      DDS::RETCODE_NOT_ENABLED);
   }
 
+  RcHandle<PublisherImpl> publisher = this->publisher_servant_.lock();
+  if (!publisher) {
+    return DDS::RETCODE_ERROR;
+  }
+
+  // Build the sample's message before taking the lock, concurrent writers
+  // only need to be serialized for the sequence number and the sample lists.
+  DataSampleHeader header_data;
+  Message_Block_Ptr message;
+  DDS::ReturnCode_t ret = create_sample_data_message(move(data),
+                                                     header_data,
+                                                     message,
+                                                     source_timestamp,
+                                                     (filter_out != 0),
+                                                     *publisher);
+
+  if (ret != DDS::RETCODE_OK) {
+    return ret;
+  }
+
+  const ACE_Time_Value now = ACE_OS::gettimeofday();
+
+  ACE_GUARD_RETURN (ACE_Recursive_Thread_Mutex,
+                    guard,
+                    get_lock (),
+                    DDS::RETCODE_ERROR);
+
   DataSampleElement* element = 0;
-  DDS::ReturnCode_t ret = this->data_container_->obtain_buffer(element, handle);
+  ret = this->data_container_->obtain_buffer(element, handle);
 
   if (ret == DDS::RETCODE_TIMEOUT) {
     return ret; // silent for timeout
@@ -1769,18 +1804,9 @@ DataWriterImpl::write(Message_Block_Ptr data,
                      ret);
   }
 
-  Message_Block_Ptr temp;
-  ret = create_sample_data_message(move(data),
-                                   handle,
-                                   element->get_header(),
-                                   temp,
-                                   source_timestamp,
-                                   (filter_out != 0));
-  element->set_sample(move(temp));
-
-  if (ret != DDS::RETCODE_OK) {
-    return ret;
-  }
+  stamp_sample_data_message(header_data, *message);
+  element->get_header() = header_data;
+  element->set_sample(move(message));
 
   element->set_filter_out(filter_out_var._retn()); // ownership passed to element
 
@@ -1793,7 +1819,7 @@ DataWriterImpl::write(Message_Block_Ptr data,
                       ACE_TEXT("enqueue failed.\n")),
                      ret);
   }
-  this->last_liveliness_activity_time_ = ACE_OS::gettimeofday();
+  this->last_liveliness_activity_time_ = now;
 
   track_sequence_number(filter_out);
 
@@ -1804,8 +1830,7 @@ DataWriterImpl::write(Message_Block_Ptr data,
 
   ACE_UINT64 transaction_id = this->get_unsent_data(list);
 
-  RcHandle<PublisherImpl> publisher = this->publisher_servant_.lock();
-  if (!publisher || publisher->is_suspended()) {
+  if (publisher->is_suspended()) {
     if (min_suspended_transaction_id_ == 0) {
       //provides transaction id for lower bound of suspended transactions
       //or transaction id for single suspended write transaction
@@ -1957,6 +1982,26 @@ DataWriterImpl::get_publication_id()
   return publication_id_;
 }
 
+void
+DataWriterImpl::allocator_stats(AllocatorStatsList& stats) const
+{
+  add_allocator_stats(stats, "mb_allocator", mb_allocator_.get());
+  add_allocator_stats(stats, "db_allocator", db_allocator_.get());
+  add_allocator_stats(stats, "header_allocator", header_allocator_.get());
+}
+
+void
+DataWriterImpl::add_allocator_stats(AllocatorStatsList& stats, const char* name,
+                                    const Dynamic_Slab_Allocator* allocator)
+{
+  if (allocator) {
+    const AllocatorStats allocator_stats = {
+      name, allocator->slabs(), allocator->overflows(), allocator->high_water()
+    };
+    stats.push_back(allocator_stats);
+  }
+}
+
 RepoId
 DataWriterImpl::get_dp_id()
 {
@@ -2018,23 +2063,16 @@ DataWriterImpl::create_control_message(MessageId message_id,
     header_data.key_fields_only_ = true;
   }
 
-  ACE_Message_Block* message = 0;
-  ACE_NEW_MALLOC_RETURN(message,
-                        static_cast<ACE_Message_Block*>(
-                          mb_allocator_->malloc(sizeof(ACE_Message_Block))),
-                        ACE_Message_Block(
-                          DataSampleHeader::max_marshaled_size(),
-                          ACE_Message_Block::MB_DATA,
-                          header_data.message_length_ ? data.release() : 0, //cont
-                          0, //data
-                          0, //allocator_strategy
-                          get_db_lock(), //locking_strategy
-                          ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-                          ACE_Time_Value::zero,
-                          ACE_Time_Value::max_time,
-                          db_allocator_.get(),
-                          mb_allocator_.get()),
-                        0);
+  ACE_Message_Block* const message =
+    AtomicDataBlock::make_message_block(
+      DataSampleHeader::max_marshaled_size(),
+      header_data.message_length_ ? data.release() : 0, //cont
+      0, //allocator_strategy
+      db_allocator_.get(),
+      mb_allocator_.get());
+  if (!message) {
+    return 0;
+  }
 
   *message << header_data;
 
@@ -2061,51 +2099,24 @@ DataWriterImpl::create_control_message(MessageId message_id,
 
 DDS::ReturnCode_t
 DataWriterImpl::create_sample_data_message(Message_Block_Ptr data,
-                                           DDS::InstanceHandle_t instance_handle,
                                            DataSampleHeader& header_data,
                                            Message_Block_Ptr& message,
                                            const DDS::Time_t& source_timestamp,
-                                           bool content_filter)
+                                           bool content_filter,
+                                           const PublisherImpl& publisher)
 {
-  PublicationInstance_rch instance =
-    data_container_->get_handle_instance(instance_handle);
-
-  if (0 == instance) {
-    ACE_ERROR_RETURN((LM_ERROR,
-                      ACE_TEXT("(%P|%t) DataWriterImpl::create_sample_data_message ")
-                      ACE_TEXT("failed to find instance for handle %d\n"),
-                      instance_handle),
-                     DDS::RETCODE_ERROR);
-  }
-
   header_data.message_id_ = SAMPLE_DATA;
   header_data.byte_order_ =
     this->swap_bytes() ? !ACE_CDR_BYTE_ORDER : ACE_CDR_BYTE_ORDER;
-  header_data.coherent_change_ = this->coherent_;
-
-  RcHandle<PublisherImpl> publisher = this->publisher_servant_.lock();
-
-  if (!publisher)
-    return DDS::RETCODE_ERROR;
 
 #ifndef OPENDDS_NO_OBJECT_MODEL_PROFILE
   header_data.group_coherent_ =
-    publisher->qos_.presentation.access_scope
+    publisher.qos_.presentation.access_scope
     == DDS::GROUP_PRESENTATION_QOS;
 #endif
   header_data.content_filter_ = content_filter;
   header_data.cdr_encapsulation_ = this->cdr_encapsulation();
   header_data.message_length_ = static_cast<ACE_UINT32>(data->total_length());
-  header_data.sequence_repair_ = need_sequence_repair();
-
-  if (this->sequence_number_ == SequenceNumber::SEQUENCENUMBER_UNKNOWN()) {
-    this->sequence_number_ = SequenceNumber();
-
-  } else {
-    ++this->sequence_number_;
-  }
-
-  header_data.sequence_ = this->sequence_number_;
   header_data.source_timestamp_sec_ = source_timestamp.sec;
   header_data.source_timestamp_nanosec_ = source_timestamp.nanosec;
 
@@ -2117,36 +2128,47 @@ DataWriterImpl::create_sample_data_message(Message_Block_Ptr data,
   }
 
   header_data.publication_id_ = publication_id_;
-  header_data.publisher_id_ = publisher->publisher_id_;
+  header_data.publisher_id_ = publisher.publisher_id_;
   size_t max_marshaled_size = header_data.max_marshaled_size();
 
-  ACE_Message_Block* tmp_message;
-  ACE_NEW_MALLOC_RETURN(tmp_message,
-                        static_cast<ACE_Message_Block*>(
-                          mb_allocator_->malloc(sizeof(ACE_Message_Block))),
-                        ACE_Message_Block(max_marshaled_size,
-                                          ACE_Message_Block::MB_DATA,
-                                          data.release(), //cont
-                                          0, //data
-                                          header_allocator_.get(), //alloc_strategy
-                                          get_db_lock(), //locking_strategy
-                                          ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-                                          ACE_Time_Value::zero,
-                                          ACE_Time_Value::max_time,
-                                          db_allocator_.get(),
-                                          mb_allocator_.get()),
-                        DDS::RETCODE_ERROR);
+  ACE_Message_Block* const tmp_message =
+    AtomicDataBlock::make_message_block(max_marshaled_size,
+                                        data.release(), //cont
+                                        header_allocator_.get(), //alloc_strategy
+                                        db_allocator_.get(),
+                                        mb_allocator_.get());
+  if (!tmp_message) {
+    return DDS::RETCODE_ERROR;
+  }
   message.reset(tmp_message);
-  *message << header_data;
+  return DDS::RETCODE_OK;
+}
+
+void
+DataWriterImpl::stamp_sample_data_message(DataSampleHeader& header_data,
+                                          ACE_Message_Block& message)
+{
+  header_data.coherent_change_ = this->coherent_;
+  header_data.sequence_repair_ = need_sequence_repair();
+
+  if (this->sequence_number_ == SequenceNumber::SEQUENCENUMBER_UNKNOWN()) {
+    this->sequence_number_ = SequenceNumber();
+
+  } else {
+    ++this->sequence_number_;
+  }
+
+  header_data.sequence_ = this->sequence_number_;
+
+  message << header_data;
   if (DCPS_debug_level >= 4) {
     const GuidConverter converter(publication_id_);
     ACE_DEBUG((LM_DEBUG,
-               ACE_TEXT("(%P|%t) DataWriterImpl::create_sample_data_message: ")
+               ACE_TEXT("(%P|%t) DataWriterImpl::stamp_sample_data_message: ")
                ACE_TEXT("from publication %C sending data sample: %C .\n"),
                OPENDDS_STRING(converter).c_str(),
                to_string(header_data).c_str()));
   }
-  return DDS::RETCODE_OK;
 }
 
 void
@@ -2273,12 +2295,7 @@ DataWriterImpl::end_coherent_changes(const GroupCoherentSamples& group_samples)
 
   size_t max_marshaled_size = end_msg.max_marshaled_size();
 
-  Message_Block_Ptr data( new ACE_Message_Block(max_marshaled_size,
-                                  ACE_Message_Block::MB_DATA,
-                                  0, //cont
-                                  0, //data
-                                  0, //alloc_strategy
-                                  get_db_lock()));
+  Message_Block_Ptr data(AtomicDataBlock::make_message_block(max_marshaled_size));
 
   Serializer serializer(
     data.get(),
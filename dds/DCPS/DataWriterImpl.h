@@ -14,7 +14,6 @@
 #include "dds/DCPS/transport/framework/TransportSendListener.h"
 #include "dds/DCPS/transport/framework/TransportClient.h"
 #include "dds/DCPS/MessageTracker.h"
-#include "dds/DCPS/DataBlockLockPool.h"
 #include "dds/DCPS/PoolAllocator.h"
 #include "WriteDataContainer.h"
 #include "Definitions.h"
@@ -26,9 +25,11 @@
 #include "RcEventHandler.h"
 #include "unique_ptr.h"
 #include "Message_Block_Ptr.h"
+#include "Slab_Allocator.h"
 
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
 #include "FilterEvaluator.h"
+#include "FilterIndex.h"
 #endif
 
 #include "ace/Event_Handler.h"
@@ -412,14 +413,25 @@ public:
    * needed. e.g. message id, length of whole message...
    * The fast allocator is used to allocate the message block,
    * data block and header.
+   * The header is not marshaled until stamp_sample_data_message()
+   * has filled in the sequence number, so this may be called
+   * without holding the lock.
    */
   DDS::ReturnCode_t
   create_sample_data_message(Message_Block_Ptr data,
-                             DDS::InstanceHandle_t instance_handle,
                              DataSampleHeader& header_data,
                              Message_Block_Ptr& message,
                              const DDS::Time_t& source_timestamp,
-                             bool content_filter);
+                             bool content_filter,
+                             const PublisherImpl& publisher);
+
+  /**
+   * Assign the next sequence number to a header made by
+   * create_sample_data_message() and marshal it into @a message.
+   * The lock returned by get_lock() must be held.
+   */
+  void stamp_sample_data_message(DataSampleHeader& header_data,
+                                 ACE_Message_Block& message);
 
 #ifndef OPENDDS_NO_PERSISTENCE_PROFILE
   /// Make sent data available beyond the lifetime of this
@@ -453,19 +465,36 @@ public:
    */
   void wait_control_pending();
 
-  DataBlockLockPool::DataBlockLock* get_db_lock() {
-    return db_lock_pool_->get_lock();
-  }
-
  /**
   *  Attempt to locate an existing instance for the given handle.
   */
  PublicationInstance_rch get_handle_instance(
    DDS::InstanceHandle_t handle);
 
+  /// Counters of one of the chunk allocators of the writer.
+  struct AllocatorStats {
+    const char* name_;
+    size_t slabs_;
+    size_t overflows_;
+    size_t high_water_;
+  };
+  typedef OPENDDS_VECTOR(AllocatorStats) AllocatorStatsList;
+
+  /// Appends the counters of the allocators sized by DCPSChunks, for the
+  /// monitor library.
+  virtual void allocator_stats(AllocatorStatsList& stats) const;
 
 protected:
 
+  /// The chunk allocators of the writer grow by slabs, the other users
+  /// of MessageBlockAllocator and friends keep a fixed number of chunks.
+  typedef Slab_Allocator<ACE_Message_Block> WriterMessageBlockAllocator;
+  typedef Slab_Allocator<AtomicDataBlock> WriterDataBlockAllocator;
+  typedef Slab_Allocator<DataSampleHeader> WriterSampleHeaderAllocator;
+
+  static void add_allocator_stats(AllocatorStatsList& stats, const char* name,
+                                  const Dynamic_Slab_Allocator* allocator);
+
   DDS::ReturnCode_t wait_for_specific_ack(const AckToken& token);
 
   void prepare_to_delete();
@@ -511,6 +540,12 @@ protected:
   typedef OPENDDS_MAP_CMP(RepoId, ReaderInfo, GUID_tKeyLessThan) RepoIdToReaderInfoMap;
   RepoIdToReaderInfoMap reader_info_;
 
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+  /// The filters of the readers in reader_info_ that have one, also
+  /// protected by reader_info_lock_.
+  FilterIndex filter_index_;
+#endif
+
   struct AckCustomization {
     GUIDSeq customized_;
     AckToken& token_;
@@ -569,9 +604,6 @@ private:
   friend class ::DDS_TEST; // allows tests to get at privates
 
 
-  // Data block local pool for this data writer.
-  unique_ptr<DataBlockLockPool>  db_lock_pool_;
-
   /// The name of associated topic.
   CORBA::String_var               topic_name_;
   /// The associated topic repository id.
@@ -634,11 +666,11 @@ private:
   // PublicationReconnectingStatus       publication_reconnecting_status_;
 
   /// The message block allocator.
-  unique_ptr<MessageBlockAllocator>     mb_allocator_;
+  unique_ptr<WriterMessageBlockAllocator> mb_allocator_;
   /// The data block allocator.
-  unique_ptr<DataBlockAllocator>        db_allocator_;
+  unique_ptr<WriterDataBlockAllocator>    db_allocator_;
   /// The header data allocator.
-  unique_ptr<DataSampleHeaderAllocator> header_allocator_;
+  unique_ptr<WriterSampleHeaderAllocator> header_allocator_;
 
   /// The orb's reactor to be used to register the liveliness
   /// timer.
@@ -6,8 +6,11 @@
 #include "dds/DCPS/DataReaderImpl.h"
 #include "dds/DCPS/Util.h"
 #include "dds/DCPS/TypeSupportImpl.h"
+#include "dds/DCPS/KeyHashIndex_T.h"
 #include "dcps_export.h"
 
+#include "ace/RW_Thread_Mutex.h"
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -33,14 +36,19 @@ namespace OpenDDS {
 
     typedef OPENDDS_MAP_CMP_T(MessageType, DDS::InstanceHandle_t,
                               typename TraitsType::LessThanType) InstanceMap;
-    typedef ::OpenDDS::DCPS::Dynamic_Cached_Allocator_With_Overflow<ACE_Thread_Mutex>  DataAllocator;
+    typedef KeyHashIndex<InstanceMap, typename TraitsType::HashType,
+                         typename TraitsType::LessThanType> KeyIndex;
+    typedef OPENDDS_MAP(DDS::InstanceHandle_t, PublicationInstance_rch)
+      HandleInstanceMap;
+    typedef ::OpenDDS::DCPS::Dynamic_Slab_Allocator DataAllocator;
 
     enum {
       cdr_header_size = 4
     };
 
     DataWriterImpl_T (void)
-      : marshaled_size_ (0)
+      : key_index_ (instance_map_)
+      , marshaled_size_ (0)
       , key_marshaled_size_ (0)
     {
       MessageType data;
@@ -197,17 +205,9 @@ namespace OpenDDS {
 #ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
       if (TheServiceParticipant->publisher_content_filter()) {
         ACE_GUARD_RETURN(ACE_Thread_Mutex, reader_info_guard, this->reader_info_lock_, DDS::RETCODE_ERROR);
-        for (RepoIdToReaderInfoMap::iterator iter = reader_info_.begin(),
-               end = reader_info_.end(); iter != end; ++iter) {
-          const ReaderInfo& ri = iter->second;
-          if (!ri.eval_.is_nil()) {
-            if (!filter_out.ptr()) {
-              filter_out = new OpenDDS::DCPS::GUIDSeq;
-            }
-            if (!ri.eval_->eval(instance_data, ri.expression_params_)) {
-              push_back(filter_out.inout(), iter->first);
-            }
-          }
+        if (!filter_index_.empty()) {
+          filter_out = new OpenDDS::DCPS::GUIDSeq;
+          filter_index_.filter_out(instance_data, filter_out.inout());
         }
       }
 #endif
@@ -258,10 +258,10 @@ namespace OpenDDS {
       MessageType & key_holder,
       DDS::InstanceHandle_t handle)
     {
-      ACE_GUARD_RETURN (ACE_Recursive_Thread_Mutex,
-                        guard,
-                        get_lock (),
-                        DDS::RETCODE_ERROR);
+      ACE_READ_GUARD_RETURN (ACE_RW_Thread_Mutex,
+                             guard,
+                             instance_map_lock_,
+                             DDS::RETCODE_ERROR);
 
       typename InstanceMap::iterator const the_end = instance_map_.end ();
       for (typename InstanceMap::iterator it = instance_map_.begin ();
@@ -281,12 +281,12 @@ namespace OpenDDS {
   virtual DDS::InstanceHandle_t lookup_instance (
       const MessageType & instance_data)
     {
-      ACE_GUARD_RETURN (ACE_Recursive_Thread_Mutex,
-                        guard,
-                        get_lock (),
-                        DDS::RETCODE_ERROR);
+      ACE_READ_GUARD_RETURN (ACE_RW_Thread_Mutex,
+                             guard,
+                             instance_map_lock_,
+                             DDS::HANDLE_NIL);
 
-      typename InstanceMap::const_iterator const it = instance_map_.find(instance_data);
+      typename InstanceMap::const_iterator const it = key_index_.find(instance_data);
 
       if (it == instance_map_.end())
         {
@@ -312,7 +312,7 @@ namespace OpenDDS {
             ACE_DEBUG((LM_DEBUG,
                        ACE_TEXT("(%P|%t) %CDataWriterImpl::")
                        ACE_TEXT("enable_specific-data")
-                       ACE_TEXT(" Dynamic_Cached_Allocator_With_Overflow %x ")
+                       ACE_TEXT(" Dynamic_Slab_Allocator %x ")
                        ACE_TEXT("with %d chunks\n"),
                        TraitsType::type_name(),
                        data_allocator_.get(),
@@ -327,16 +327,16 @@ namespace OpenDDS {
         }
 
       mb_allocator_.reset(
-        new ::OpenDDS::DCPS::MessageBlockAllocator (
-                                                    n_chunks_ * association_chunk_multiplier_));
-      db_allocator_.reset(new ::OpenDDS::DCPS::DataBlockAllocator (n_chunks_));
+        new WriterMessageBlockAllocator (
+                                         n_chunks_ * association_chunk_multiplier_));
+      db_allocator_.reset(new WriterDataBlockAllocator (n_chunks_));
 
       if (::OpenDDS::DCPS::DCPS_debug_level >= 2)
         {
           ACE_DEBUG((LM_DEBUG,
                      ACE_TEXT("(%P|%t) %CDataWriterImpl::")
                      ACE_TEXT("enable_specific-mb ")
-                     ACE_TEXT("Cached_Allocator_With_Overflow ")
+                     ACE_TEXT("Slab_Allocator ")
                      ACE_TEXT("%x with %d chunks\n"),
                      TraitsType::type_name(),
                      mb_allocator_.get(),
@@ -344,7 +344,7 @@ namespace OpenDDS {
           ACE_DEBUG((LM_DEBUG,
                      ACE_TEXT("(%P|%t) %CDataWriterImpl::")
                      ACE_TEXT("enable_specific-db ")
-                     ACE_TEXT("Cached_Allocator_With_Overflow ")
+                     ACE_TEXT("Slab_Allocator ")
                      ACE_TEXT("%x with %d chunks\n"),
                      TraitsType::type_name(),
                      db_allocator_.get(),
@@ -362,6 +362,12 @@ namespace OpenDDS {
     return data_allocator_.get();
   };
 
+  virtual void allocator_stats(AllocatorStatsList& stats) const
+  {
+    DataWriterImpl::allocator_stats(stats);
+    add_allocator_stats(stats, "data_allocator", data_allocator_.get());
+  }
+
 private:
 
   /**
@@ -402,12 +408,10 @@ private:
           effective_size += padding;
         }
 
-        ACE_NEW_RETURN(tmp_mb, ACE_Message_Block(effective_size,
-                                             ACE_Message_Block::MB_DATA,
-                                             0, //cont
-                                             0, //data
-                                             0, //alloc_strategy
-                                             get_db_lock()), 0);
+        tmp_mb = AtomicDataBlock::make_message_block(effective_size);
+        if (!tmp_mb) {
+          return 0;
+        }
         mb.reset(tmp_mb);
         OpenDDS::DCPS::Serializer serializer(mb.get(), swap, cdr
                                              ? OpenDDS::DCPS::Serializer::ALIGN_CDR
@@ -442,23 +446,14 @@ private:
         }
 
 
-        ACE_NEW_MALLOC_RETURN(tmp_mb,
-                              static_cast<ACE_Message_Block*>(
-                                                              mb_allocator_->malloc(
-                                                                                    sizeof(ACE_Message_Block))),
-                              ACE_Message_Block(
-                                                effective_size,
-                                                ACE_Message_Block::MB_DATA,
-                                                0, //cont
-                                                0, //data
-                                                data_allocator_.get(), //allocator_strategy
-                                                get_db_lock(), //data block locking_strategy
-                                                ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-                                                ACE_Time_Value::zero,
-                                                ACE_Time_Value::max_time,
-                                                db_allocator_.get(),
-                                                mb_allocator_.get()),
-                              0);
+        tmp_mb = AtomicDataBlock::make_message_block(effective_size,
+                                                     0, //cont
+                                                     data_allocator_.get(),
+                                                     db_allocator_.get(),
+                                                     mb_allocator_.get());
+        if (!tmp_mb) {
+          return 0;
+        }
         mb.reset(tmp_mb);
         OpenDDS::DCPS::Serializer serializer(mb.get(), swap, cdr
                                              ? OpenDDS::DCPS::Serializer::ALIGN_CDR
@@ -496,13 +491,37 @@ private:
     const MessageType& instance_data,
     const DDS::Time_t & source_timestamp)
     {
+      handle = DDS::HANDLE_NIL;
+
+      // Writing an instance that is already registered is the common case,
+      // so look it up without the writer's lock and only take that lock
+      // when the instance has to be (re)registered.
+      {
+        ACE_READ_GUARD_RETURN(ACE_RW_Thread_Mutex,
+                              read_guard,
+                              instance_map_lock_,
+                              DDS::RETCODE_ERROR);
+        typename InstanceMap::const_iterator it = key_index_.find(instance_data);
+        if (it != instance_map_.end()) {
+          typename HandleInstanceMap::const_iterator inst =
+            handle_instances_.find(it->second);
+          if (inst != handle_instances_.end() &&
+              !inst->second->unregistered_.value()) {
+            handle = it->second;
+            return DDS::RETCODE_OK;
+          }
+        }
+      }
+
       ACE_GUARD_RETURN(ACE_Recursive_Thread_Mutex,
                        guard,
                        get_lock(),
                        DDS::RETCODE_ERROR);
 
+      // instance_map_ is only modified while holding get_lock(), so it
+      // can be read here without instance_map_lock_.
       handle = DDS::HANDLE_NIL;
-      typename InstanceMap::const_iterator it = instance_map_.find(instance_data);
+      typename InstanceMap::const_iterator it = key_index_.find(instance_data);
 
       bool needs_creation = true;
       bool needs_registration = true;
@@ -514,7 +533,7 @@ private:
           handle = it->second;
           OpenDDS::DCPS::PublicationInstance_rch instance = get_handle_instance(handle);
 
-          if (instance->unregistered_ == false)
+          if (instance->unregistered_.value() == false)
             {
               needs_registration = false;
             }
@@ -541,6 +560,10 @@ private:
 
           if (needs_creation)
             {
+              ACE_WRITE_GUARD_RETURN(ACE_RW_Thread_Mutex,
+                                     write_guard,
+                                     instance_map_lock_,
+                                     DDS::RETCODE_ERROR);
               std::pair<typename InstanceMap::iterator, bool> pair =
                 instance_map_.insert(typename InstanceMap::value_type(instance_data, handle));
 
@@ -555,6 +578,8 @@ private:
                                      TraitsType::type_name(), TraitsType::type_name()),
                                     DDS::RETCODE_ERROR);
                 }
+              key_index_.insert(pair.first);
+              handle_instances_[handle] = get_handle_instance(handle);
             } // end of if (needs_creation)
 
           send_all_to_flush_control(guard);
@@ -565,11 +590,20 @@ private:
     }
 
     InstanceMap  instance_map_;
+    /// Hash lookups into instance_map_, guarded like instance_map_.
+    KeyIndex key_index_;
+    /// The instances of instance_map_ by handle, so that the registration
+    /// of an instance can be checked without get_lock().  Guarded like
+    /// instance_map_.
+    HandleInstanceMap handle_instances_;
+    /// Protects instance_map_ for readers that don't hold get_lock().
+    /// Modifications are made while holding both locks.
+    ACE_RW_Thread_Mutex instance_map_lock_;
     size_t       marshaled_size_;
     size_t       key_marshaled_size_;
     unique_ptr<DataAllocator> data_allocator_;
-    unique_ptr<MessageBlockAllocator> mb_allocator_;
-    unique_ptr<DataBlockAllocator>    db_allocator_;
+    unique_ptr<WriterMessageBlockAllocator> mb_allocator_;
+    unique_ptr<WriterDataBlockAllocator>    db_allocator_;
 
     // A class, normally provided by an unit test, that needs access to
     // private methods/members.
@@ -9,6 +9,7 @@
 #define OPENDDS_DCPS_DEFINITION_H
 
 #include "Cached_Allocator_With_Overflow_T.h"
+#include "AtomicDataBlock.h"
 #include "ace/Message_Block.h"
 #include "ace/Global_Macros.h"
 #include "ace/Null_Mutex.h"
@@ -67,9 +68,9 @@ namespace OpenDDS {
 namespace DCPS {
 
 typedef Cached_Allocator_With_Overflow<ACE_Message_Block, ACE_Thread_Mutex> MessageBlockAllocator;
-typedef Cached_Allocator_With_Overflow<ACE_Data_Block, ACE_Thread_Mutex> DataBlockAllocator;
+typedef Cached_Allocator_With_Overflow<AtomicDataBlock, ACE_Thread_Mutex> DataBlockAllocator;
 struct DataSampleHeader;
-typedef Cached_Allocator_With_Overflow<DataSampleHeader, ACE_Null_Mutex> DataSampleHeaderAllocator;
+typedef Cached_Allocator_With_Overflow<DataSampleHeader, ACE_Thread_Mutex> DataSampleHeaderAllocator;
 
 #define DUP true
 #define NO_DUP false
@@ -0,0 +1,885 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#ifndef OPENDDS_NO_PERSISTENCE_PROFILE
+
+#include "DurabilityLog.h"
+#include "debug.h"
+
+#include "ace/Dirent.h"
+#include "ace/Guard_T.h"
+#include "ace/Log_Msg.h"
+#include "ace/Mem_Map.h"
+#include "ace/OS_NS_fcntl.h"
+#include "ace/OS_NS_stdio.h"
+#include "ace/OS_NS_stdlib.h"
+#include "ace/OS_NS_string.h"
+#include "ace/OS_NS_sys_stat.h"
+#include "ace/OS_NS_sys_time.h"
+#include "ace/OS_NS_unistd.h"
+
+#include <cstring>
+
+/*
+ * Segment file: an 8 byte header followed by records.
+ *   header: "ODDL", version (1 byte), flags (1 byte), 2 unused bytes
+ *   record: body size (4 bytes), checksum of the body (4 bytes), body
+ *   body:   kind (1 byte), stream id (4 bytes), then for the kind:
+ *     STREAM: domain id (4), topic name length (4), topic name,
+ *             type name length (4), type name
+ *     SAMPLE: source timestamp sec (4), nanosec (4), serialized sample
+ *     REMOVE: nothing
+ * Integers are little-endian.
+ */
+
+namespace {
+
+const char MAGIC[] = "ODDL";
+const char VERSION = 1;
+/// The segment replaces all the segments before it.
+const char FLAG_COMPACTED = 1;
+const size_t SEGMENT_HEADER = 8;
+const size_t RECORD_HEADER = 8;
+/// Compaction writes the records it copies in blocks of this size.
+const size_t FLUSH_SIZE = 64 * 1024;
+/// append() waits for the thread of the log to take the pending records
+/// once there are this many bytes of them.
+const size_t MAX_PENDING = 16 * 1024 * 1024;
+
+const char PREFIX[] = "_durability.";
+const size_t PREFIX_LEN = sizeof(PREFIX) - 1;
+const size_t NUMBER_LEN = 8;
+
+enum RecordKind { REC_STREAM = 1, REC_SAMPLE = 2, REC_REMOVE = 3 };
+
+void put_u32(OPENDDS_STRING& out, ACE_UINT32 value)
+{
+  char bytes[4];
+  for (int i = 0; i < 4; ++i) {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+  out.append(bytes, 4);
+}
+
+ACE_UINT32 get_u32(const char* in)
+{
+  const unsigned char* const bytes = reinterpret_cast<const unsigned char*>(in);
+  return ACE_UINT32(bytes[0]) | (ACE_UINT32(bytes[1]) << 8)
+    | (ACE_UINT32(bytes[2]) << 16) | (ACE_UINT32(bytes[3]) << 24);
+}
+
+/// FNV-1a
+ACE_UINT32 checksum(const char* data, size_t length)
+{
+  ACE_UINT32 hash = 2166136261u;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/// Wraps @a body in a record.
+void make_record(const OPENDDS_STRING& body, OPENDDS_STRING& out)
+{
+  out.clear();
+  out.reserve(RECORD_HEADER + body.size());
+  put_u32(out, static_cast<ACE_UINT32>(body.size()));
+  put_u32(out, checksum(body.data(), body.size()));
+  out += body;
+}
+
+OPENDDS_STRING segment_header(bool compacted)
+{
+  OPENDDS_STRING header(MAGIC, 4);
+  header += VERSION;
+  header += compacted ? FLAG_COMPACTED : char(0);
+  header.append(2, '\0');
+  return header;
+}
+
+bool write_all(ACE_HANDLE handle, const char* data, size_t length)
+{
+  return ACE_OS::write_n(handle, data, length) == ssize_t(length);
+}
+
+/// The segments mapped into memory while they're read.
+class Maps {
+public:
+  ~Maps()
+  {
+    for (OPENDDS_MAP(ACE_UINT32, ACE_Mem_Map*)::iterator it = maps_.begin();
+         it != maps_.end(); ++it) {
+      delete it->second;
+    }
+  }
+
+  /// Returns null if the file can't be mapped.
+  ACE_Mem_Map* map(ACE_UINT32 segment, const ACE_CString& path)
+  {
+    ACE_Mem_Map*& m = maps_[segment];
+    if (!m) {
+      m = new ACE_Mem_Map;
+      if (m->map(ACE_TEXT_CHAR_TO_TCHAR(path.c_str()), static_cast<size_t>(-1),
+                 O_RDONLY, ACE_DEFAULT_FILE_PERMS, PROT_READ,
+                 ACE_MAP_PRIVATE) == -1) {
+        delete m;
+        maps_.erase(segment);
+        return 0;
+      }
+    }
+    return m;
+  }
+
+  const char* record(ACE_UINT32 segment, size_t offset)
+  {
+    return static_cast<const char*>(maps_[segment]->addr()) + offset;
+  }
+
+private:
+  OPENDDS_MAP(ACE_UINT32, ACE_Mem_Map*) maps_;
+};
+
+}
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+DurabilityLog::DurabilityLog(const ACE_CString& dir, size_t sync_samples,
+                             const ACE_Time_Value& sync_interval,
+                             size_t segment_size)
+  : dir_(dir)
+  , sync_samples_(sync_samples)
+  , sync_interval_(sync_interval)
+  , segment_size_(segment_size)
+  , open_(false)
+  , stop_(false)
+  , next_id_(1)
+  , live_(0)
+  , total_(0)
+  , current_(0)
+  , pending_size_(0)
+  , sync_requested_(false)
+  , compact_requested_(false)
+  , compacting_(0)
+  , file_segment_(0)
+  , handle_(ACE_INVALID_HANDLE)
+  , dirty_(false)
+  , unsynced_(0)
+  , failed_(false)
+  , pending_cond_(lock_)
+  , taken_cond_(lock_)
+  , writer_(*this)
+{
+}
+
+DurabilityLog::~DurabilityLog()
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    stop_ = true;
+    pending_cond_.signal();
+  }
+  writer_.wait();
+
+  ACE_GUARD(ACE_Thread_Mutex, io_guard, io_lock_);
+  write_pending(true);
+  close_segment();
+}
+
+int
+DurabilityLog::Writer::svc()
+{
+  // Set when the last batch wasn't synced, to sync it after sync_interval_.
+  ACE_Time_Value deadline;
+  for (;;) {
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, log_.lock_, -1);
+      while (!log_.stop_ && log_.pending_.empty()
+             && !log_.compact_requested_) {
+        if (deadline == ACE_Time_Value::zero) {
+          log_.pending_cond_.wait();
+        } else if (log_.pending_cond_.wait(&deadline) == -1) {
+          break;
+        }
+      }
+      if (log_.stop_) {
+        // The destructor writes what's left.
+        return 0;
+      }
+    }
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, io_guard, log_.io_lock_, -1);
+    log_.write_pending(false);
+    log_.drop_segments();
+    bool compact = false;
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, log_.lock_, -1);
+      compact = log_.compact_requested_;
+      log_.compact_requested_ = false;
+    }
+    if (compact) {
+      log_.compact_i();
+    }
+    deadline = log_.dirty_ && log_.sync_interval_ != ACE_Time_Value::zero
+      ? log_.last_sync_ + log_.sync_interval_ : ACE_Time_Value::zero;
+  }
+}
+
+ACE_CString
+DurabilityLog::path(ACE_UINT32 segment, const char* suffix) const
+{
+  char name[PREFIX_LEN + NUMBER_LEN + 8];
+  ACE_OS::snprintf(name, sizeof name, "%s%08u%s", PREFIX,
+                   static_cast<unsigned int>(segment), suffix);
+  ACE_CString p(dir_);
+  if (p.length() && p[p.length() - 1] != '/') {
+    p += '/';
+  }
+  p += name;
+  return p;
+}
+
+bool
+DurabilityLog::open(Loader& loader)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, io_guard, io_lock_, false);
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+
+  ACE_Dirent dirent;
+  if (dirent.open(ACE_TEXT_CHAR_TO_TCHAR(dir_.c_str())) == -1) {
+    return false;
+  }
+
+  OPENDDS_SET(ACE_UINT32) found;
+  for (ACE_DIRENT* ent = dirent.read(); ent; ent = dirent.read()) {
+    const OPENDDS_STRING name = ACE_TEXT_ALWAYS_CHAR(ent->d_name);
+    if (name.size() != PREFIX_LEN + NUMBER_LEN + 4
+        || name.compare(0, PREFIX_LEN, PREFIX) != 0) {
+      continue;
+    }
+    const ACE_UINT32 segment =
+      static_cast<ACE_UINT32>(ACE_OS::atoi(name.c_str() + PREFIX_LEN));
+    const OPENDDS_STRING suffix = name.substr(PREFIX_LEN + NUMBER_LEN);
+    if (suffix == ".log") {
+      found.insert(segment);
+    } else if (suffix == ".tmp") {
+      // an unfinished compaction
+      ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(path(segment, ".tmp").c_str()));
+    }
+  }
+  dirent.close();
+
+  Maps maps;
+  OPENDDS_VECTOR(ACE_UINT32) segments(found.begin(), found.end());
+  // A compacted segment replaces the ones before it, which are left
+  // behind if the process stopped while deleting them.
+  size_t first = 0;
+  for (size_t i = 0; i < segments.size(); ) {
+    const ACE_CString p = path(segments[i]);
+    ACE_stat st;
+    if (i + 1 == segments.size() && ACE_OS::stat(ACE_TEXT_CHAR_TO_TCHAR(p.c_str()), &st) == 0
+        && static_cast<size_t>(st.st_size) < SEGMENT_HEADER) {
+      // The process stopped while it was creating this segment.
+      ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(p.c_str()));
+      segments.pop_back();
+      break;
+    }
+    ACE_Mem_Map* const m = maps.map(segments[i], p);
+    if (!m) {
+      if (DCPS_debug_level > 0) {
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("(%P|%t) DurabilityLog::open ")
+                   ACE_TEXT("couldn't map %C\n"), p.c_str()));
+      }
+      return false;
+    }
+    const char* const base = static_cast<const char*>(m->addr());
+    if (m->size() < SEGMENT_HEADER || std::memcmp(base, MAGIC, 4) != 0
+        || base[4] != VERSION) {
+      if (DCPS_debug_level > 0) {
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("(%P|%t) DurabilityLog::open ")
+                   ACE_TEXT("%C isn't a durability log segment\n"),
+                   p.c_str()));
+      }
+      return false;
+    }
+    if (base[5] & FLAG_COMPACTED) {
+      first = i;
+    }
+    ++i;
+  }
+  for (size_t i = 0; i < first; ++i) {
+    ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(path(segments[i]).c_str()));
+  }
+  segments.erase(segments.begin(), segments.begin() + first);
+
+  for (size_t i = 0; i < segments.size(); ++i) {
+    ACE_Mem_Map* const m = maps.map(segments[i], path(segments[i]));
+    const size_t valid = read_segment(segments[i],
+                                      static_cast<const char*>(m->addr()),
+                                      m->size());
+    if (valid < m->size()) {
+      if (DCPS_debug_level > 0) {
+        ACE_ERROR((LM_WARNING,
+                   ACE_TEXT("(%P|%t) WARNING: DurabilityLog::open ")
+                   ACE_TEXT("ignoring %B bytes of incomplete records in %C\n"),
+                   m->size() - valid, path(segments[i]).c_str()));
+      }
+      if (i + 1 == segments.size()) {
+        // Appending continues after the last complete record.
+        ACE_OS::truncate(ACE_TEXT_CHAR_TO_TCHAR(path(segments[i]).c_str()),
+                         static_cast<ACE_OFF_T>(valid));
+      }
+    }
+  }
+
+  for (Streams::const_iterator it = streams_.begin(); it != streams_.end();
+       ++it) {
+    const Stream& stream = it->second;
+    loader.stream(it->first, stream.domain_id_, stream.topic_name_.c_str(),
+                  stream.type_name_.c_str());
+    // records_[0] is the STREAM record
+    for (size_t r = 1; r < stream.records_.size(); ++r) {
+      const Location& loc = stream.records_[r];
+      const char* const body = maps.record(loc.segment_, loc.offset_)
+        + RECORD_HEADER;
+      DDS::Time_t timestamp;
+      timestamp.sec = static_cast<CORBA::Long>(get_u32(body + 5));
+      timestamp.nanosec = get_u32(body + 9);
+      loader.sample(it->first, timestamp, body + 13,
+                    loc.size_ - RECORD_HEADER - 13);
+    }
+  }
+
+  if (!segments.empty()) {
+    current_ = segments.back();
+    if (segments_[current_].size_ < segment_size_
+        && !open_segment(current_, false)) {
+      return false;
+    }
+  }
+
+  last_sync_ = ACE_OS::gettimeofday();
+  if (writer_.activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1) {
+    if (DCPS_debug_level > 0) {
+      ACE_ERROR((LM_ERROR,
+                 ACE_TEXT("(%P|%t) DurabilityLog::open ")
+                 ACE_TEXT("couldn't start the thread writing the log\n")));
+    }
+    close_segment();
+    return false;
+  }
+
+  open_ = true;
+  OPENDDS_VECTOR(ACE_UINT32) dropped;
+  drop_segments_i(dropped);
+  unlink_segments(dropped);
+  return true;
+}
+
+size_t
+DurabilityLog::read_segment(ACE_UINT32 segment, const char* base,
+                            size_t size)
+{
+  Segment& seg = segments_[segment];
+  seg.live_ = 0;
+
+  size_t offset = SEGMENT_HEADER;
+  while (offset + RECORD_HEADER <= size) {
+    const char* const rec = base + offset;
+    const size_t body_size = get_u32(rec);
+    if (body_size < 5 || body_size > size - offset - RECORD_HEADER
+        || get_u32(rec + 4) != checksum(rec + RECORD_HEADER, body_size)) {
+      break;
+    }
+    const char* const body = rec + RECORD_HEADER;
+    const ACE_UINT32 id = get_u32(body + 1);
+    const Location loc = {segment, offset, RECORD_HEADER + body_size};
+    if (id >= next_id_) {
+      next_id_ = id + 1;
+    }
+
+    switch (body[0]) {
+    case REC_STREAM: {
+      if (body_size < 17) {
+        return offset;
+      }
+      Stream stream;
+      stream.domain_id_ = static_cast<DDS::DomainId_t>(get_u32(body + 5));
+      const size_t topic_len = get_u32(body + 9);
+      if (topic_len > body_size - 17) {
+        return offset;
+      }
+      stream.topic_name_.assign(body + 13, topic_len);
+      const size_t type_len = get_u32(body + 13 + topic_len);
+      if (type_len != body_size - 17 - topic_len) {
+        return offset;
+      }
+      stream.type_name_.assign(body + 17 + topic_len, type_len);
+      stream.records_.push_back(loc);
+      streams_[id] = stream;
+      seg.live_ += loc.size_;
+      live_ += loc.size_;
+      break;
+    }
+    case REC_SAMPLE: {
+      const Streams::iterator it = streams_.find(id);
+      if (body_size >= 13 && it != streams_.end()) {
+        it->second.records_.push_back(loc);
+        seg.live_ += loc.size_;
+        live_ += loc.size_;
+      }
+      break;
+    }
+    case REC_REMOVE: {
+      const Streams::iterator it = streams_.find(id);
+      if (it != streams_.end()) {
+        for (size_t r = 0; r < it->second.records_.size(); ++r) {
+          const Location& l = it->second.records_[r];
+          segments_[l.segment_].live_ -= l.size_;
+          live_ -= l.size_;
+        }
+        streams_.erase(it);
+      }
+      break;
+    }
+    default:
+      return offset;
+    }
+    offset += loc.size_;
+  }
+
+  seg.size_ = offset;
+  total_ += offset;
+  return offset;
+}
+
+void
+DurabilityLog::record_stream(ACE_UINT32 id, const Stream& stream,
+                             OPENDDS_STRING& out) const
+{
+  OPENDDS_STRING body(1, char(REC_STREAM));
+  put_u32(body, id);
+  put_u32(body, static_cast<ACE_UINT32>(stream.domain_id_));
+  put_u32(body, static_cast<ACE_UINT32>(stream.topic_name_.size()));
+  body += stream.topic_name_;
+  put_u32(body, static_cast<ACE_UINT32>(stream.type_name_.size()));
+  body += stream.type_name_;
+  make_record(body, out);
+}
+
+ACE_UINT32
+DurabilityLog::add_stream(DDS::DomainId_t domain_id, const char* topic_name,
+                          const char* type_name)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+  if (!open_) {
+    return 0;
+  }
+  const ACE_UINT32 id = next_id_++;
+  Stream& stream = streams_[id];
+  stream.domain_id_ = domain_id;
+  stream.topic_name_ = topic_name;
+  stream.type_name_ = type_name;
+  OPENDDS_STRING record;
+  record_stream(id, stream, record);
+  buffer(id, record, false);
+  return id;
+}
+
+bool
+DurabilityLog::append(ACE_UINT32 id, const DDS::Time_t& timestamp,
+                      const char* data, size_t length)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+  if (!open_ || streams_.find(id) == streams_.end()) {
+    return false;
+  }
+  OPENDDS_STRING body(1, char(REC_SAMPLE));
+  body.reserve(13 + length);
+  put_u32(body, id);
+  put_u32(body, static_cast<ACE_UINT32>(timestamp.sec));
+  put_u32(body, timestamp.nanosec);
+  body.append(data, length);
+  OPENDDS_STRING record;
+  make_record(body, record);
+
+  while (pending_size_ >= MAX_PENDING && !stop_) {
+    taken_cond_.wait();
+  }
+  buffer(id, record, true);
+  return true;
+}
+
+void
+DurabilityLog::buffer(ACE_UINT32 id, const OPENDDS_STRING& record,
+                      bool sample)
+{
+  if (pending_.empty()) {
+    pending_cond_.signal();
+  }
+
+  if (current_ == 0 || current_ == compacting_
+      || segments_[current_].size_ >= segment_size_) {
+    // The segment is created when the thread writes this chunk.
+    const Chunk chunk = {current_ + 1, true, segment_header(false), 0};
+    pending_.push_back(chunk);
+    current_ = chunk.segment_;
+    Segment& seg = segments_[current_];
+    seg.size_ = chunk.data_.size();
+    seg.live_ = 0;
+    total_ += chunk.data_.size();
+  } else if (pending_.empty() || pending_.back().segment_ != current_) {
+    const Chunk chunk = {current_, false, OPENDDS_STRING(), 0};
+    pending_.push_back(chunk);
+  }
+
+  Segment& seg = segments_[current_];
+  const Location loc = {current_, seg.size_, record.size()};
+  if (id) {
+    streams_[id].records_.push_back(loc);
+    seg.live_ += loc.size_;
+    live_ += loc.size_;
+  }
+  seg.size_ += loc.size_;
+  total_ += loc.size_;
+
+  Chunk& chunk = pending_.back();
+  chunk.data_ += record;
+  if (sample) {
+    ++chunk.samples_;
+  }
+  pending_size_ += record.size();
+}
+
+bool
+DurabilityLog::flush()
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, io_guard, io_lock_, false);
+  const bool ok = write_pending(true) && !failed_;
+  failed_ = false;
+  return ok;
+}
+
+bool
+DurabilityLog::write_pending(bool sync)
+{
+  Chunks chunks;
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+    take_pending(chunks);
+    sync = sync || sync_requested_;
+    sync_requested_ = false;
+  }
+  return write_chunks(chunks, sync);
+}
+
+void
+DurabilityLog::take_pending(Chunks& chunks)
+{
+  chunks.swap(pending_);
+  pending_size_ = 0;
+  taken_cond_.broadcast();
+}
+
+bool
+DurabilityLog::write_chunks(const Chunks& chunks, bool sync)
+{
+  bool ok = true;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    const Chunk& chunk = chunks[i];
+    if ((chunk.segment_ != file_segment_ || handle_ == ACE_INVALID_HANDLE)
+        && !open_segment(chunk.segment_, chunk.start_)) {
+      ok = false;
+      continue;
+    }
+    if (!write_all(handle_, chunk.data_.data(), chunk.data_.size())) {
+      if (DCPS_debug_level > 0) {
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("(%P|%t) DurabilityLog::write_chunks ")
+                   ACE_TEXT("couldn't write %C\n"),
+                   path(chunk.segment_).c_str()));
+      }
+      ok = false;
+      continue;
+    }
+    dirty_ = true;
+    unsynced_ += chunk.samples_;
+  }
+
+  const ACE_Time_Value now = ACE_OS::gettimeofday();
+  if (dirty_ && (sync
+                 || (sync_samples_ == 0 && sync_interval_ == ACE_Time_Value::zero)
+                 || (sync_samples_ && unsynced_ >= sync_samples_)
+                 || (sync_interval_ != ACE_Time_Value::zero
+                     && now - last_sync_ >= sync_interval_))) {
+    if (handle_ == ACE_INVALID_HANDLE || ACE_OS::fsync(handle_) != 0) {
+      ok = false;
+    }
+    dirty_ = false;
+    unsynced_ = 0;
+    last_sync_ = now;
+  } else if (!dirty_) {
+    last_sync_ = now;
+  }
+
+  failed_ = failed_ || !ok;
+  return ok;
+}
+
+bool
+DurabilityLog::open_segment(ACE_UINT32 segment, bool start)
+{
+  if (dirty_ && handle_ != ACE_INVALID_HANDLE) {
+    // The batch is synced as a whole, including this part of it.
+    ACE_OS::fsync(handle_);
+  }
+  close_segment();
+  const ACE_CString p = path(segment);
+  handle_ = ACE_OS::open(ACE_TEXT_CHAR_TO_TCHAR(p.c_str()),
+                         O_WRONLY | O_CREAT | O_APPEND | O_BINARY
+                         | (start ? O_TRUNC : 0),
+                         ACE_DEFAULT_FILE_PERMS);
+  if (handle_ == ACE_INVALID_HANDLE) {
+    if (DCPS_debug_level > 0) {
+      ACE_ERROR((LM_ERROR,
+                 ACE_TEXT("(%P|%t) DurabilityLog::open_segment ")
+                 ACE_TEXT("couldn't open %C\n"), p.c_str()));
+    }
+    return false;
+  }
+  file_segment_ = segment;
+  return true;
+}
+
+void
+DurabilityLog::close_segment()
+{
+  if (handle_ != ACE_INVALID_HANDLE) {
+    ACE_OS::close(handle_);
+    handle_ = ACE_INVALID_HANDLE;
+  }
+}
+
+bool
+DurabilityLog::remove(ACE_UINT32 id)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+  const Streams::iterator it = streams_.find(id);
+  if (!open_ || it == streams_.end()) {
+    return false;
+  }
+  for (size_t r = 0; r < it->second.records_.size(); ++r) {
+    const Location& loc = it->second.records_[r];
+    segments_[loc.segment_].live_ -= loc.size_;
+    live_ -= loc.size_;
+  }
+  streams_.erase(it);
+
+  OPENDDS_STRING body(1, char(REC_REMOVE));
+  put_u32(body, id);
+  OPENDDS_STRING record;
+  make_record(body, record);
+  buffer(0, record, false);
+  // The thread of the log syncs the batch with the REMOVE record, deletes
+  // the segments it made obsolete, and compacts the log if needed.
+  sync_requested_ = true;
+  if (!compacting_ && total_ > segment_size_ && total_ - live_ > live_) {
+    compact_requested_ = true;
+  }
+  pending_cond_.signal();
+  return true;
+}
+
+void
+DurabilityLog::drop_segments()
+{
+  OPENDDS_VECTOR(ACE_UINT32) dropped;
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    drop_segments_i(dropped);
+  }
+  unlink_segments(dropped);
+}
+
+void
+DurabilityLog::drop_segments_i(OPENDDS_VECTOR(ACE_UINT32)& dropped)
+{
+  // Only from the start of the log, a later segment may have the REMOVE
+  // record that makes the records of an earlier one obsolete.
+  while (!segments_.empty() && segments_.begin()->first != current_
+         && segments_.begin()->second.live_ == 0) {
+    dropped.push_back(segments_.begin()->first);
+    total_ -= segments_.begin()->second.size_;
+    segments_.erase(segments_.begin());
+  }
+}
+
+void
+DurabilityLog::unlink_segments(const OPENDDS_VECTOR(ACE_UINT32)& segments)
+{
+  for (size_t i = 0; i < segments.size(); ++i) {
+    if (segments[i] == file_segment_) {
+      close_segment();
+    }
+    ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(path(segments[i]).c_str()));
+  }
+}
+
+bool
+DurabilityLog::compact()
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, io_guard, io_lock_, false);
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+    if (!open_) {
+      return false;
+    }
+  }
+  return compact_i();
+}
+
+bool
+DurabilityLog::compact_i()
+{
+  // Records appended from here on go to segments after target, so the
+  // segments before it don't change and are copied without holding lock_.
+  ACE_UINT32 target = 0, previous = 0;
+  Streams streams;
+  Chunks chunks;
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+    if (current_ == 0 || compacting_) {
+      return true;
+    }
+    take_pending(chunks);
+    previous = current_;
+    target = current_ = compacting_ = current_ + 1;
+    streams = streams_;
+  }
+
+  // The records are copied from the segment files.
+  bool ok = write_chunks(chunks, true);
+
+  const ACE_CString tmp = path(target, ".tmp");
+  const ACE_HANDLE out = ok
+    ? ACE_OS::open(ACE_TEXT_CHAR_TO_TCHAR(tmp.c_str()),
+                   O_WRONLY | O_CREAT | O_TRUNC | O_BINARY,
+                   ACE_DEFAULT_FILE_PERMS)
+    : ACE_INVALID_HANDLE;
+  ok = out != ACE_INVALID_HANDLE;
+
+  Maps maps;
+  Streams compacted;
+  OPENDDS_STRING data = segment_header(true);
+  size_t size = 0;
+  for (Streams::const_iterator it = streams.begin();
+       ok && it != streams.end(); ++it) {
+    Stream& stream = compacted[it->first];
+    stream.domain_id_ = it->second.domain_id_;
+    stream.topic_name_ = it->second.topic_name_;
+    stream.type_name_ = it->second.type_name_;
+
+    OPENDDS_STRING record;
+    record_stream(it->first, stream, record);
+    const Location loc = {target, size + data.size(), record.size()};
+    stream.records_.push_back(loc);
+    data += record;
+
+    for (size_t r = 1; ok && r < it->second.records_.size(); ++r) {
+      const Location& from = it->second.records_[r];
+      if (!maps.map(from.segment_, path(from.segment_))) {
+        ok = false;
+        break;
+      }
+      const Location to = {target, size + data.size(), from.size_};
+      stream.records_.push_back(to);
+      data.append(maps.record(from.segment_, from.offset_), from.size_);
+      if (data.size() >= FLUSH_SIZE) {
+        ok = write_all(out, data.data(), data.size());
+        size += data.size();
+        data.clear();
+      }
+    }
+  }
+  if (out != ACE_INVALID_HANDLE) {
+    ok = ok && write_all(out, data.data(), data.size())
+      && ACE_OS::fsync(out) == 0;
+    size += data.size();
+    ACE_OS::close(out);
+  }
+
+  if (!ok || ACE_OS::rename(ACE_TEXT_CHAR_TO_TCHAR(tmp.c_str()),
+                            ACE_TEXT_CHAR_TO_TCHAR(path(target).c_str())) != 0) {
+    if (DCPS_debug_level > 0) {
+      ACE_ERROR((LM_ERROR,
+                 ACE_TEXT("(%P|%t) DurabilityLog::compact ")
+                 ACE_TEXT("couldn't write %C\n"), tmp.c_str()));
+    }
+    ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(tmp.c_str()));
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+    if (current_ == target) {
+      // Nothing was appended while copying.
+      current_ = previous;
+    }
+    compacting_ = 0;
+    return false;
+  }
+
+  OPENDDS_VECTOR(ACE_UINT32) replaced;
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, false);
+    while (!segments_.empty() && segments_.begin()->first < target) {
+      replaced.push_back(segments_.begin()->first);
+      total_ -= segments_.begin()->second.size_;
+      live_ -= segments_.begin()->second.live_;
+      segments_.erase(segments_.begin());
+    }
+
+    Segment& seg = segments_[target];
+    seg.size_ = size;
+    seg.live_ = 0;
+    for (Streams::iterator it = compacted.begin(); it != compacted.end();
+         ++it) {
+      const Streams::iterator stream = streams_.find(it->first);
+      if (stream == streams_.end()) {
+        continue; // removed while copying, the REMOVE record is after target
+      }
+      OPENDDS_VECTOR(Location)& records = it->second.records_;
+      for (size_t r = 0; r < records.size(); ++r) {
+        seg.live_ += records[r].size_;
+      }
+      // Records appended while copying are in segments after target.
+      const OPENDDS_VECTOR(Location)& old = stream->second.records_;
+      for (size_t r = 0; r < old.size(); ++r) {
+        if (old[r].segment_ > target) {
+          records.push_back(old[r]);
+        }
+      }
+      stream->second.records_.swap(records);
+    }
+    total_ += seg.size_;
+    live_ += seg.live_;
+    compacting_ = 0;
+  }
+
+  unlink_segments(replaced);
+  return true;
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_NO_PERSISTENCE_PROFILE
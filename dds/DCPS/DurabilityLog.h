@@ -0,0 +1,246 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DURABILITY_LOG_H
+#define OPENDDS_DURABILITY_LOG_H
+
+#ifndef OPENDDS_NO_PERSISTENCE_PROFILE
+
+#include "dds/DdsDcpsInfrastructureC.h"
+#include "dds/DCPS/dcps_export.h"
+#include "dds/DCPS/PoolAllocator.h"
+
+#include "ace/Condition_Thread_Mutex.h"
+#include "ace/SString.h"
+#include "ace/Task.h"
+#include "ace/Thread_Mutex.h"
+#include "ace/Time_Value.h"
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+# pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+// Size at which the log starts a new segment.  Can be overridden by the
+// user.
+#ifndef OPENDDS_DURABILITY_LOG_SEGMENT_SIZE
+#define OPENDDS_DURABILITY_LOG_SEGMENT_SIZE (16 * 1024 * 1024)
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class DurabilityLog
+ *
+ * @brief Append-only storage of @c PERSISTENT durable data.
+ *
+ * The samples that DataDurabilityCache keeps for each DataWriter (a
+ * "stream" of the domain, topic and type of that writer) are appended to
+ * segment files named _durability.NNNNNNNN.log in the persistent data
+ * directory, instead of being written to a file each (see
+ * FileSystemStorage).  Removing a stream appends a record saying so.
+ *
+ * An index of the records of each stream is kept in memory.  Segments at
+ * the start of the log that no longer hold records of a stream are
+ * deleted, and when more than half of the log is records of removed
+ * streams, the remaining streams are copied into one new segment that
+ * replaces all the others (compaction).
+ *
+ * On startup the segments are mapped into memory and read in order.  A
+ * record that wasn't written completely, because the process stopped
+ * while writing it, ends the log.
+ *
+ * Records are written by a thread of the log, so append() only copies the
+ * sample.  The thread writes whatever was appended while it was writing
+ * the previous batch, and syncs the segment after the batch that reaches
+ * @a sync_samples samples since the last sync, or @a sync_interval after
+ * the first unsynced write.  If both are 0, each batch is synced.  flush()
+ * writes and syncs everything appended before it was called.
+ *
+ * Thread safe.  see $DDS_ROOT/docs/design/PERSISTENCE.
+ */
+class OpenDDS_Dcps_Export DurabilityLog {
+public:
+  /// Receives the contents of the log when it's opened.
+  class Loader {
+  public:
+    virtual ~Loader() {}
+
+    /// Called for each stream before its samples.
+    virtual void stream(ACE_UINT32 id, DDS::DomainId_t domain_id,
+                        const char* topic_name, const char* type_name) = 0;
+
+    /// Called for each sample of stream @a id, in the order they were
+    /// appended.  @a data is only valid during the call.
+    virtual void sample(ACE_UINT32 id, const DDS::Time_t& timestamp,
+                        const char* data, size_t length) = 0;
+  };
+
+  explicit DurabilityLog(const ACE_CString& dir, size_t sync_samples = 0,
+                         const ACE_Time_Value& sync_interval = ACE_Time_Value::zero,
+                         size_t segment_size = OPENDDS_DURABILITY_LOG_SEGMENT_SIZE);
+
+  ~DurabilityLog();
+
+  /// Reads the log from the directory, passing the streams that weren't
+  /// removed to @a loader, and starts the thread that writes the log.
+  /// Returns false if the log can't be used, in that case the caller
+  /// should fall back on FileSystemStorage.
+  bool open(Loader& loader);
+
+  /// Starts a new stream, returns its id (never 0) or 0 on failure.
+  ACE_UINT32 add_stream(DDS::DomainId_t domain_id, const char* topic_name,
+                        const char* type_name);
+
+  /// Appends a sample to stream @a id.  The sample is written later by the
+  /// thread of the log.
+  bool append(ACE_UINT32 id, const DDS::Time_t& timestamp,
+              const char* data, size_t length);
+
+  /// Writes and syncs the records that weren't written yet.  Returns false
+  /// if writing any record failed since the last call.
+  bool flush();
+
+  /// Removes stream @a id and its samples.  The removal is written and
+  /// synced by the thread of the log, which also compacts the log when
+  /// needed.
+  bool remove(ACE_UINT32 id);
+
+  /// Copies the streams that weren't removed into one new segment and
+  /// deletes the others.  Samples can be appended while the copy is made.
+  bool compact();
+
+private:
+  DurabilityLog(const DurabilityLog&);
+  DurabilityLog& operator=(const DurabilityLog&);
+
+  /// Where a record is: segment number, offset and size in the segment.
+  struct Location {
+    ACE_UINT32 segment_;
+    size_t offset_;
+    size_t size_;
+  };
+
+  /// The index entry of a stream.
+  struct Stream {
+    DDS::DomainId_t domain_id_;
+    OPENDDS_STRING topic_name_;
+    OPENDDS_STRING type_name_;
+    OPENDDS_VECTOR(Location) records_;
+  };
+
+  struct Segment {
+    /// Including the records that weren't written yet.
+    size_t size_;
+    /// Bytes of records of streams that weren't removed.
+    size_t live_;
+  };
+
+  /// Records waiting to be written to a segment.
+  struct Chunk {
+    ACE_UINT32 segment_;
+    /// The segment file is created by writing this chunk.
+    bool start_;
+    OPENDDS_STRING data_;
+    size_t samples_;
+  };
+
+  /// Writes the records appended to the log.
+  class Writer : public ACE_Task_Base {
+  public:
+    explicit Writer(DurabilityLog& log) : log_(log) {}
+    int svc();
+  private:
+    DurabilityLog& log_;
+  };
+
+  typedef OPENDDS_MAP(ACE_UINT32, Stream) Streams;
+  typedef OPENDDS_MAP(ACE_UINT32, Segment) Segments;
+  typedef OPENDDS_VECTOR(Chunk) Chunks;
+
+  ACE_CString path(ACE_UINT32 segment, const char* suffix = ".log") const;
+
+  /// Reads one segment, returns the length of its valid records.
+  size_t read_segment(ACE_UINT32 segment, const char* base, size_t size);
+
+  void record_stream(ACE_UINT32 id, const Stream& stream,
+                     OPENDDS_STRING& out) const;
+  /// Adds a record to the pending records, and to the index for stream
+  /// @a id (0 if the record isn't indexed).
+  void buffer(ACE_UINT32 id, const OPENDDS_STRING& record, bool sample);
+  /// Writes the pending records, with io_lock_ held and lock_ not held.
+  bool write_pending(bool sync);
+  /// Moves the pending records to @a chunks, with lock_ held.
+  void take_pending(Chunks& chunks);
+  /// Writes @a chunks, with io_lock_ held.
+  bool write_chunks(const Chunks& chunks, bool sync);
+  bool open_segment(ACE_UINT32 segment, bool start);
+  void close_segment();
+  /// Compacts the log, with io_lock_ held and lock_ not held.
+  bool compact_i();
+  /// Deletes the segments at the start of the log without live records,
+  /// with io_lock_ held and lock_ not held.
+  void drop_segments();
+  /// Removes those segments from the index, with lock_ held.
+  void drop_segments_i(OPENDDS_VECTOR(ACE_UINT32)& dropped);
+  /// Deletes segment files, with io_lock_ held.
+  void unlink_segments(const OPENDDS_VECTOR(ACE_UINT32)& segments);
+
+  const ACE_CString dir_;
+  const size_t sync_samples_;
+  const ACE_Time_Value sync_interval_;
+  const size_t segment_size_;
+
+  // Protected by lock_.
+  bool open_;
+  bool stop_;
+  ACE_UINT32 next_id_;
+  Streams streams_;
+  Segments segments_;
+  size_t live_;
+  size_t total_;
+  /// The segment records are appended to.
+  ACE_UINT32 current_;
+  Chunks pending_;
+  size_t pending_size_;
+  /// The next batch written is synced.
+  bool sync_requested_;
+  /// The thread of the log compacts it after writing the pending records.
+  bool compact_requested_;
+  /// The segment compact_i() is writing, records are appended to later
+  /// segments until it's done.
+  ACE_UINT32 compacting_;
+
+  // Protected by io_lock_.
+  /// The segment file handle_ is open on.
+  ACE_UINT32 file_segment_;
+  ACE_HANDLE handle_;
+  bool dirty_;
+  size_t unsynced_;
+  ACE_Time_Value last_sync_;
+  bool failed_;
+
+  /// Held while writing to the segment files, taken before lock_.
+  ACE_Thread_Mutex io_lock_;
+  ACE_Thread_Mutex lock_;
+  /// Signaled when records are pending, or the thread should stop.
+  ACE_Condition_Thread_Mutex pending_cond_;
+  /// Signaled when the pending records are taken by the thread.
+  ACE_Condition_Thread_Mutex taken_cond_;
+  Writer writer_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif  /* OPENDDS_NO_PERSISTENCE_PROFILE */
+
+#endif  /* OPENDDS_DURABILITY_LOG_H */
@@ -40,11 +40,13 @@ public:
 
   DurabilityQueue(ACE_Allocator * allocator)
     : ACE_Unbounded_Queue<T> (allocator)
+    , log_id_(0)
   {}
 
   DurabilityQueue(DurabilityQueue<T> const & rhs)
     : ACE_Unbounded_Queue<T> (rhs.allocator_)
     , fs_path_(rhs.fs_path_)
+    , log_id_(rhs.log_id_)
   {
     // Copied from ACE_Unbounded_Queue<>::copy_nodes().
     for (ACE_Node<T> *curr = rhs.head_->next_;
@@ -74,11 +76,15 @@ public:
     std::swap(this->cur_size_, rhs.current_size_);
     std::swap(this->allocator_, rhs.allocator_);
     std::swap(this->fs_path_, rhs.fs_path_);
+    std::swap(this->log_id_, rhs.log_id_);
   }
 
   //filesystem path
   typedef OPENDDS_VECTOR(OPENDDS_STRING) fs_path_t;
   fs_path_t fs_path_;
+
+  /// Stream of the samples in the DurabilityLog, 0 if none.
+  ACE_UINT32 log_id_;
 };
 
 } // namespace DCPS
@@ -16,8 +16,11 @@
 #include "AstNodeWrapper.h"
 #include "Definitions.h"
 #include "dds/DCPS/SafetyProfileStreams.h"
+#include "dds/DCPS/unique_ptr.h"
 
 #include <ace/ACE.h>
+#include <ace/Guard_T.h>
+#include <ace/Thread_Mutex.h>
 
 #include <stdexcept>
 #include <cstring>
@@ -40,36 +43,120 @@ FilterEvaluator::DataForEval::~DataForEval()
 FilterEvaluator::DeserializedForEval::~DeserializedForEval()
 {}
 
-FilterEvaluator::FilterEvaluator(const char* filter, bool allowOrderBy)
-  : extended_grammar_(false)
-  , filter_root_(0)
-  , number_parameters_(0)
-{
-  const char* out = filter + std::strlen(filter);
-  yard::SimpleTextParser parser(filter, out);
-  if (!(allowOrderBy ? parser.Parse<QueryCompleteInput>()
-      : parser.Parse<FilterCompleteInput>())) {
-    reportErrors(parser, filter);
-  }
+/**
+ * The filter compiled into a flat list of instructions that write their
+ * results into numbered registers.  Fields and parameters have their own
+ * registers, filled the first time an instruction reads them.  Fields of
+ * deserialized samples are read through the FieldAccessors of the sample's
+ * MetaStruct, resolved once per MetaStruct instead of by name per sample.
+ * Literals are converted ahead of time to each type they can be compared
+ * with, so comparing a field with a literal doesn't convert on every sample.
+ */
+class FilterEvaluator::Program {
+public:
+  enum OpCode {
+    OP_COMPARE,       // dst = a <arg_> b
+    OP_BETWEEN,       // dst = a BETWEEN b AND c, inverted if arg_ is 1
+    OP_MOD,           // dst = MOD(a, b)
+    OP_NOT,           // dst = NOT a
+    OP_JUMP_IF_FALSE, // if (!a) goto arg_
+    OP_JUMP_IF_TRUE   // if (a) goto arg_
+  };
 
-  bool found_order_by = false;
-  for (AstNode* iter = parser.GetAstRoot()->GetFirstChild(); iter;
-      iter = iter->GetSibling()) {
-    if (iter->TypeMatches<ORDERBY>()) {
-      found_order_by = true;
-    } else if (found_order_by && iter->TypeMatches<FieldName>()) {
-      order_bys_.push_back(toString(iter));
-    } else {
-      filter_root_ = walkAst(iter);
-    }
+  enum Comparison {
+    CMP_EQ, CMP_LT, CMP_GT, CMP_LTEQ, CMP_GTEQ, CMP_NEQ, CMP_LIKE
+  };
+
+  struct Operand {
+    enum Kind { REGISTER, FIELD, PARAMETER, CONSTANT };
+    Operand(Kind kind = REGISTER, size_t index = 0)
+      : kind_(kind), index_(index) {}
+    Kind kind_;
+    size_t index_;
+  };
+
+  struct Instruction {
+    Instruction(OpCode op, size_t dst, const Operand& a,
+                const Operand& b = Operand(), const Operand& c = Operand(),
+                size_t arg = 0)
+      : op_(op), dst_(dst), a_(a), b_(b), c_(c), arg_(arg) {}
+    OpCode op_;
+    size_t dst_;
+    Operand a_, b_, c_;
+    size_t arg_;
+  };
+
+  explicit Program(const EvalNode& root);
+
+  bool run(DataForEval& data) const;
+
+  /// Runs the program for each of a batch of deserialized samples, see
+  /// FilterEvaluator::eval_batch().
+  void run_batch(const void* const* samples, size_t count,
+                 const MetaStruct& meta, const DDS::StringSeq& params,
+                 unsigned char* selected) const;
+
+  // used by the EvalNodes to compile themselves:
+  Operand field(const OPENDDS_STRING& name);
+  Operand parameter(size_t param);
+  Operand constant(const Value& value);
+  size_t new_register() { return temporaries_++; }
+  size_t emit(const Instruction& instruction)
+  {
+    code_.push_back(instruction);
+    return code_.size() - 1;
   }
-}
+  void patch_jump(size_t jump) { code_[jump].arg_ = code_.size(); }
 
-FilterEvaluator::FilterEvaluator(const AstNodeWrapper& yardNode)
-  : extended_grammar_(false)
-  , filter_root_(walkAst(yardNode))
-{
-}
+private:
+  struct Constant {
+    explicit Constant(const Value& value);
+    /// The constant converted to type @a t, or null if not convertible.
+    const Value* as(Value::Type t) const;
+    Value value_;
+    Value converted_[Value::VAL_STRING + 1];
+    bool convertible_[Value::VAL_STRING + 1];
+  };
+
+  class Registers;
+
+  typedef OPENDDS_VECTOR(FieldAccessor) Accessors;
+  const Accessors& accessors(const MetaStruct& meta) const;
+
+  const Value& fetch(const Operand& o, Registers& regs) const;
+  /// Reads all fields of a serialized sample in one pass.
+  void read_fields(Registers& regs) const;
+  bool compare(Comparison cmp, const Operand& a, const Operand& b,
+               Registers& regs) const;
+  bool less(const Operand& a, const Operand& b, Registers& regs) const;
+
+  class Batch;
+
+  /// Runs the program on the columns of the samples in @a batch.  Returns
+  /// false if a field or a value it's compared with has a type the loops
+  /// don't handle, or if the evaluation throws; then the samples have to
+  /// be evaluated one at a time.
+  bool run_columns(Batch& batch, const void* const* samples, size_t count,
+                   unsigned char* selected) const;
+  /// The parameter or literal @a o converted to type @a t like compare()
+  /// converts it for a comparison with a field of that type.
+  bool operand_as(const Operand& o, Value::Type t,
+                  const DDS::StringSeq& params, Value& value) const;
+
+  OPENDDS_VECTOR(Instruction) code_;
+  OPENDDS_VECTOR(OPENDDS_STRING) fields_;
+  OPENDDS_VECTOR(size_t) params_;
+  OPENDDS_VECTOR(Constant) constants_;
+  size_t temporaries_;
+  size_t result_;
+  /// Each comparison is of a field with a parameter or literal, so
+  /// run_columns() can run the program.
+  bool columns_;
+  size_t jumps_;
+
+  mutable ACE_Thread_Mutex lock_;
+  mutable OPENDDS_MAP(const MetaStruct*, Accessors) accessors_;
+};
 
 class FilterEvaluator::EvalNode {
 public:
@@ -97,8 +184,16 @@ public:
     return false;
   }
 
+  virtual bool index_predicate(IndexPredicate&) const
+  {
+    return false;
+  }
+
   virtual Value eval(DataForEval& data) = 0;
 
+  /// Emits the instructions that store this node's value in register @a dst.
+  virtual void compile(Program& program, size_t dst) const = 0;
+
 private:
   static void deleteChild(EvalNode* child)
   {
@@ -112,6 +207,17 @@ protected:
 class FilterEvaluator::Operand : public FilterEvaluator::EvalNode {
 public:
   virtual bool isParameter() const { return false; }
+
+  /// The field read by this operand, or null if it's not a field lookup.
+  virtual const char* fieldName() const { return 0; }
+
+  /// Where the compiled program finds the value of this operand.
+  virtual Program::Operand compileOperand(Program& program) const = 0;
+
+  void compile(Program&, size_t) const
+  {
+    throw std::runtime_error("Operand used as a condition");
+  }
 };
 
 Value
@@ -127,19 +233,132 @@ FilterEvaluator::SerializedForEval::lookup(const char* field) const
   if (iter != cache_.end()) {
     return iter->second;
   }
+  const Value v = read(field);
+  cache_.insert(std::make_pair(OPENDDS_STRING(field), v));
+  return v;
+}
+
+Value
+FilterEvaluator::SerializedForEval::read(const char* field) const
+{
   Message_Block_Ptr mb (serialized_->duplicate());
   Serializer ser(mb.get(), swap_,
                  cdr_ ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
   if (cdr_) {
     ser.skip(4); // CDR encapsulation header
   }
-  const Value v = meta_.getValue(ser, field);
-  cache_.insert(std::make_pair(OPENDDS_STRING(field), v));
-  return v;
+  return meta_.getValue(ser, field);
+}
+
+bool
+FilterEvaluator::SerializedForEval::read(FieldSet& fields) const
+{
+  Message_Block_Ptr mb (serialized_->duplicate());
+  Serializer ser(mb.get(), swap_,
+                 cdr_ ? Serializer::ALIGN_CDR : Serializer::ALIGN_NONE);
+  if (cdr_) {
+    ser.skip(4); // CDR encapsulation header
+  }
+  return meta_.getValues(ser, fields);
+}
+
+bool
+FieldSet::add(const char* name, Value* value)
+{
+  if (count_ == MAX_FIELDS) {
+    return false;
+  }
+  names_[count_] = name;
+  values_[count_] = value;
+  found_flags_[count_] = false;
+  outer_[count_] = -1;
+  ++count_;
+  return true;
+}
+
+int
+FieldSet::find(const char* name) const
+{
+  for (size_t i = 0; i < count_; ++i) {
+    if (std::strcmp(names_[i], name) == 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+FieldSet
+FieldSet::nested(const char* prefix, size_t length) const
+{
+  FieldSet fields;
+  fields.consume_ = true;
+  for (size_t i = 0; i < count_; ++i) {
+    if (std::strncmp(names_[i], prefix, length) == 0) {
+      fields.add(names_[i] + length, values_[i]);
+      fields.outer_[fields.count_ - 1] = static_cast<int>(i);
+    }
+  }
+  return fields;
+}
+
+void
+FieldSet::merge(const FieldSet& nested)
+{
+  for (size_t i = 0; i < nested.count_; ++i) {
+    if (nested.found_flags_[i]) {
+      found_flags_[nested.outer_[i]] = true;
+      ++found_;
+    }
+  }
+}
+
+FilterEvaluator::FilterEvaluator(const char* filter, bool allowOrderBy)
+  : extended_grammar_(false)
+  , filter_root_(0)
+  , program_(0)
+  , number_parameters_(0)
+{
+  const char* out = filter + std::strlen(filter);
+  yard::SimpleTextParser parser(filter, out);
+  if (!(allowOrderBy ? parser.Parse<QueryCompleteInput>()
+      : parser.Parse<FilterCompleteInput>())) {
+    reportErrors(parser, filter);
+  }
+
+  // The tree is deleted if the Program can't be built from it.
+  unique_ptr<EvalNode> root;
+  bool found_order_by = false;
+  for (AstNode* iter = parser.GetAstRoot()->GetFirstChild(); iter;
+      iter = iter->GetSibling()) {
+    if (iter->TypeMatches<ORDERBY>()) {
+      found_order_by = true;
+    } else if (found_order_by && iter->TypeMatches<FieldName>()) {
+      order_bys_.push_back(toString(iter));
+    } else {
+      root.reset(walkAst(iter));
+    }
+  }
+
+  if (root.get()) {
+    program_ = new Program(*root);
+  }
+  filter_root_ = root.release();
+}
+
+FilterEvaluator::FilterEvaluator(const AstNodeWrapper& yardNode)
+  : extended_grammar_(false)
+  , filter_root_(0)
+  , program_(0)
+  , number_parameters_(0)
+{
+  unique_ptr<EvalNode> root(walkAst(yardNode));
+  program_ = new Program(*root);
+  filter_root_ = root.release();
 }
 
 FilterEvaluator::~FilterEvaluator()
 {
+  delete program_;
   delete filter_root_;
 }
 
@@ -161,6 +380,11 @@ bool FilterEvaluator::has_non_key_fields(const MetaStruct& meta) const
   return false;
 }
 
+bool FilterEvaluator::index_predicate(IndexPredicate& predicate) const
+{
+  return filter_root_->index_predicate(predicate);
+}
+
 namespace {
 
   class FieldLookup : public FilterEvaluator::Operand {
@@ -175,11 +399,22 @@ namespace {
       return data.lookup(fieldName_.c_str());
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.field(fieldName_);
+    }
+
     bool has_non_key_fields(const MetaStruct& meta) const
     {
       return !meta.isDcpsKey(fieldName_.c_str());
     }
 
+    const char* fieldName() const
+    {
+      return fieldName_.c_str();
+    }
+
     OPENDDS_STRING fieldName_;
   };
 
@@ -213,6 +448,12 @@ namespace {
       return value_;
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.constant(value_);
+    }
+
     Value value_;
   };
 
@@ -227,6 +468,12 @@ namespace {
       return Value(value_, true);
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.constant(Value(value_, true));
+    }
+
     char value_;
   };
 
@@ -241,6 +488,12 @@ namespace {
       return Value(value_, true);
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.constant(Value(value_, true));
+    }
+
     double value_;
   };
 
@@ -257,6 +510,12 @@ namespace {
       return Value(value_.c_str(), true);
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.constant(Value(value_.c_str(), true));
+    }
+
     OPENDDS_STRING value_;
   };
 
@@ -273,6 +532,12 @@ namespace {
       return Value(data.params_[static_cast<CORBA::ULong>(param_)], true);
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      return program.parameter(param_);
+    }
+
     size_t param() { return param_; }
 
     size_t param_;
@@ -317,6 +582,51 @@ namespace {
       return false; // not reached
     }
 
+    void compile(FilterEvaluator::Program& program, size_t dst) const
+    {
+      typedef FilterEvaluator::Program Program;
+      static const Program::Comparison comparisons[] = {
+        Program::CMP_EQ, Program::CMP_LT, Program::CMP_GT, Program::CMP_LTEQ,
+        Program::CMP_GTEQ, Program::CMP_NEQ, Program::CMP_LIKE
+      };
+      if (oper_type_ == OPER_INVALID) {
+        throw std::runtime_error("Invalid comparison operator");
+      }
+      const Program::Operand left = left_->compileOperand(program);
+      const Program::Operand right = right_->compileOperand(program);
+      program.emit(Program::Instruction(Program::OP_COMPARE, dst, left, right,
+                                        Program::Operand(),
+                                        comparisons[oper_type_]));
+    }
+
+    bool index_predicate(FilterEvaluator::IndexPredicate& predicate) const
+    {
+      typedef FilterEvaluator::IndexPredicate Predicate;
+      // field <op> %n, or %n <op> field with the operator reversed
+      static const Predicate::Kind kinds[] = {
+        Predicate::EQ, Predicate::LT, Predicate::GT, Predicate::LTEQ,
+        Predicate::GTEQ
+      };
+      static const Predicate::Kind reversed[] = {
+        Predicate::EQ, Predicate::GT, Predicate::LT, Predicate::GTEQ,
+        Predicate::LTEQ
+      };
+      if (oper_type_ > OPER_GTEQ) {
+        return false;
+      }
+      const bool reverse = left_->isParameter();
+      const FilterEvaluator::Operand* field = reverse ? right_ : left_;
+      const FilterEvaluator::Operand* param = reverse ? left_ : right_;
+      if (!field->fieldName() || !param->isParameter()) {
+        return false;
+      }
+      predicate.field_ = field->fieldName();
+      predicate.param_ = static_cast<const Parameter*>(param)->param_;
+      predicate.kind_ = reverse ? reversed[oper_type_] : kinds[oper_type_];
+      predicate.exact_ = true;
+      return true;
+    }
+
   private:
     void setOperator(AstNode* node)
     {
@@ -366,6 +676,16 @@ namespace {
       return invert_ ? !btwn : btwn;
     }
 
+    void compile(FilterEvaluator::Program& program, size_t dst) const
+    {
+      typedef FilterEvaluator::Program Program;
+      const Program::Operand field = field_->compileOperand(program);
+      const Program::Operand left = left_->compileOperand(program);
+      const Program::Operand right = right_->compileOperand(program);
+      program.emit(Program::Instruction(Program::OP_BETWEEN, dst, field, left,
+                                        right, invert_ ? 1 : 0));
+    }
+
   private:
     bool invert_;
     FilterEvaluator::Operand* field_;
@@ -406,6 +726,24 @@ namespace {
       return Value(0);
     }
 
+    FilterEvaluator::Program::Operand
+    compileOperand(FilterEvaluator::Program& program) const
+    {
+      typedef FilterEvaluator::Program Program;
+      if (children_.size() != 2) {
+        std::stringstream ss;
+        ss << MOD << " expects 2 arguments, given " << children_.size();
+        throw std::runtime_error(ss.str ());
+      }
+      const Program::Operand left =
+        static_cast<FilterEvaluator::Operand*>(children_[0])->compileOperand(program);
+      const Program::Operand right =
+        static_cast<FilterEvaluator::Operand*>(children_[1])->compileOperand(program);
+      const size_t dst = program.new_register();
+      program.emit(Program::Instruction(Program::OP_MOD, dst, left, right));
+      return Program::Operand(Program::Operand::REGISTER, dst);
+    }
+
   private:
     Operator op_;
   };
@@ -450,6 +788,43 @@ namespace {
       return children_[1]->eval(data);
     }
 
+    void compile(FilterEvaluator::Program& program, size_t dst) const
+    {
+      typedef FilterEvaluator::Program Program;
+      const Program::Operand result(Program::Operand::REGISTER, dst);
+      children_[0]->compile(program, dst);
+      switch (op_) {
+      case LG_NOT:
+        program.emit(Program::Instruction(Program::OP_NOT, dst, result));
+        return;
+      case LG_AND:
+      case LG_OR: {
+        // The right side only runs if the left side doesn't decide the
+        // result, which is then already in dst.
+        const size_t jump = program.emit(
+          Program::Instruction(op_ == LG_AND ? Program::OP_JUMP_IF_FALSE
+                                             : Program::OP_JUMP_IF_TRUE,
+                               dst, result));
+        children_[1]->compile(program, dst);
+        program.patch_jump(jump);
+        return;
+      }
+      }
+    }
+
+    bool index_predicate(FilterEvaluator::IndexPredicate& predicate) const
+    {
+      if (op_ != LG_AND) {
+        return false;
+      }
+      if (children_[0]->index_predicate(predicate)
+          || children_[1]->index_predicate(predicate)) {
+        predicate.exact_ = false;
+        return true;
+      }
+      return false;
+    }
+
   private:
     LogicalOp op_;
   };
@@ -545,6 +920,21 @@ FilterEvaluator::walkOperand(const FilterEvaluator::AstNodeWrapper& node)
 
 bool
 FilterEvaluator::eval_i(DataForEval& data) const
+{
+  return program_->run(data);
+}
+
+void
+FilterEvaluator::eval_batch(const void* const* samples, size_t count,
+                            const MetaStruct& meta,
+                            const DDS::StringSeq& params,
+                            unsigned char* selected) const
+{
+  program_->run_batch(samples, count, meta, params, selected);
+}
+
+bool
+FilterEvaluator::eval_ast_i(DataForEval& data) const
 {
   return filter_root_->eval(data).b_;
 }
@@ -561,6 +951,10 @@ FilterEvaluator::hasFilter() const
   return filter_root_ != 0;
 }
 
+Value::Value()
+  : type_(VAL_BOOL), b_(false), conversion_preferred_(false)
+{}
+
 Value::Value(bool b, bool conversion_preferred)
   : type_(VAL_BOOL), b_(b), conversion_preferred_(conversion_preferred)
 {}
@@ -969,6 +1363,664 @@ Value::conversion(Value& lhs, Value& rhs)
   }
 }
 
+class FilterEvaluator::Program::Registers {
+public:
+  Registers(size_t count, DataForEval& data, const Accessors* accessors)
+    : data_(data)
+    , sample_(data.sample())
+    , accessors_(accessors)
+    , fields_read_(false)
+  {
+    if (count <= LOCAL_REGISTERS) {
+      values_ = local_values_;
+      loaded_ = local_loaded_;
+    } else {
+      heap_values_.resize(count);
+      heap_loaded_.resize(count);
+      values_ = &heap_values_[0];
+      loaded_ = &heap_loaded_[0];
+    }
+    std::fill(loaded_, loaded_ + count, 0);
+  }
+
+  void set(size_t reg, bool b)
+  {
+    Value& v = values_[reg];
+    if (v.type_ == Value::VAL_STRING) {
+      ACE_OS::free((void*)v.s_);
+    }
+    v.type_ = Value::VAL_BOOL;
+    v.b_ = b;
+    v.conversion_preferred_ = false;
+  }
+
+  enum { LOCAL_REGISTERS = 16 };
+
+  DataForEval& data_;
+  const void* const sample_;
+  const Accessors* const accessors_;
+  bool fields_read_;
+  Value* values_;
+  char* loaded_;
+
+private:
+  Value local_values_[LOCAL_REGISTERS];
+  char local_loaded_[LOCAL_REGISTERS];
+  OPENDDS_VECTOR(Value) heap_values_;
+  OPENDDS_VECTOR(char) heap_loaded_;
+};
+
+FilterEvaluator::Program::Constant::Constant(const Value& value)
+  : value_(value)
+{
+  for (int t = 0; t <= Value::VAL_STRING; ++t) {
+    convertible_[t] = false;
+    if (t == value_.type_) {
+      continue;
+    }
+    // Same conversion as Value::conversion() makes when comparing this
+    // constant (conversion preferred) with a value of type t.
+    Value converted(value_);
+    if (converted.convert(static_cast<Value::Type>(t))) {
+      converted_[t] = converted;
+      convertible_[t] = true;
+    }
+  }
+}
+
+const Value*
+FilterEvaluator::Program::Constant::as(Value::Type t) const
+{
+  if (t == value_.type_) {
+    return &value_;
+  }
+  return convertible_[t] ? &converted_[t] : 0;
+}
+
+FilterEvaluator::Program::Program(const EvalNode& root)
+  : temporaries_(0)
+  , result_(0)
+  , columns_(true)
+  , jumps_(0)
+{
+  result_ = new_register();
+  root.compile(*this, result_);
+
+  for (size_t pc = 0; pc < code_.size(); ++pc) {
+    const Instruction& in = code_[pc];
+    const bool a_field = in.a_.kind_ == Operand::FIELD;
+    const bool b_field = in.b_.kind_ == Operand::FIELD;
+    switch (in.op_) {
+    case OP_COMPARE:
+      if (in.arg_ == CMP_LIKE || a_field == b_field
+          || in.a_.kind_ == Operand::REGISTER
+          || in.b_.kind_ == Operand::REGISTER) {
+        columns_ = false;
+      }
+      break;
+    case OP_BETWEEN:
+      if (!a_field || b_field || in.b_.kind_ == Operand::REGISTER
+          || in.c_.kind_ == Operand::FIELD
+          || in.c_.kind_ == Operand::REGISTER) {
+        columns_ = false;
+      }
+      break;
+    case OP_MOD:
+      columns_ = false;
+      break;
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_TRUE:
+      ++jumps_;
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+FilterEvaluator::Program::Operand
+FilterEvaluator::Program::field(const OPENDDS_STRING& name)
+{
+  const OPENDDS_VECTOR(OPENDDS_STRING)::iterator it =
+    std::find(fields_.begin(), fields_.end(), name);
+  if (it != fields_.end()) {
+    return Operand(Operand::FIELD, it - fields_.begin());
+  }
+  fields_.push_back(name);
+  return Operand(Operand::FIELD, fields_.size() - 1);
+}
+
+FilterEvaluator::Program::Operand
+FilterEvaluator::Program::parameter(size_t param)
+{
+  const OPENDDS_VECTOR(size_t)::iterator it =
+    std::find(params_.begin(), params_.end(), param);
+  if (it != params_.end()) {
+    return Operand(Operand::PARAMETER, it - params_.begin());
+  }
+  params_.push_back(param);
+  return Operand(Operand::PARAMETER, params_.size() - 1);
+}
+
+FilterEvaluator::Program::Operand
+FilterEvaluator::Program::constant(const Value& value)
+{
+  constants_.push_back(Constant(value));
+  return Operand(Operand::CONSTANT, constants_.size() - 1);
+}
+
+const FilterEvaluator::Program::Accessors&
+FilterEvaluator::Program::accessors(const MetaStruct& meta) const
+{
+  ACE_Guard<ACE_Thread_Mutex> guard(lock_);
+  OPENDDS_MAP(const MetaStruct*, Accessors)::iterator it = accessors_.find(&meta);
+  if (it == accessors_.end()) {
+    Accessors resolved;
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      resolved.push_back(meta.getFieldAccessor(fields_[i].c_str()));
+    }
+    it = accessors_.insert(std::make_pair(&meta, resolved)).first;
+  }
+  // Entries are never modified or removed once inserted.
+  return it->second;
+}
+
+const Value&
+FilterEvaluator::Program::fetch(const Operand& o, Registers& regs) const
+{
+  switch (o.kind_) {
+  case Operand::CONSTANT:
+    return constants_[o.index_].value_;
+  case Operand::FIELD:
+    if (!regs.loaded_[o.index_]) {
+      const FieldAccessor* const accessor =
+        regs.accessors_ ? &(*regs.accessors_)[o.index_] : 0;
+      if (accessor && accessor->valid()) {
+        regs.values_[o.index_] = accessor->get(regs.sample_);
+      } else {
+        if (!regs.sample_ && !regs.fields_read_) {
+          read_fields(regs);
+        }
+        if (!regs.loaded_[o.index_]) {
+          regs.values_[o.index_] = regs.data_.read(fields_[o.index_].c_str());
+        }
+      }
+      regs.loaded_[o.index_] = 1;
+    }
+    return regs.values_[o.index_];
+  case Operand::PARAMETER: {
+    const size_t reg = fields_.size() + o.index_;
+    if (!regs.loaded_[reg]) {
+      regs.values_[reg] =
+        Value(regs.data_.params_[static_cast<CORBA::ULong>(params_[o.index_])], true);
+      regs.loaded_[reg] = 1;
+    }
+    return regs.values_[reg];
+  }
+  case Operand::REGISTER:
+  default:
+    return regs.values_[fields_.size() + params_.size() + o.index_];
+  }
+}
+
+void
+FilterEvaluator::Program::read_fields(Registers& regs) const
+{
+  // Without this, each field would be found by skipping over all the ones
+  // before it in the serialized sample.
+  regs.fields_read_ = true;
+  FieldSet fields;
+  for (size_t i = 0; i < fields_.size(); ++i) {
+    if (!fields.add(fields_[i].c_str(), &regs.values_[i])) {
+      return;
+    }
+  }
+  if (regs.data_.read(fields)) {
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      if (fields.found(static_cast<int>(i))) {
+        regs.loaded_[i] = 1;
+      }
+    }
+  }
+}
+
+namespace {
+  bool equal_same_type(const Value& lhs, const Value& rhs)
+  {
+    Equals visitor(lhs);
+    return visit(visitor, rhs);
+  }
+
+  bool less_same_type(const Value& lhs, const Value& rhs)
+  {
+    Less visitor(lhs);
+    return visit(visitor, rhs);
+  }
+}
+
+bool
+FilterEvaluator::Program::compare(Comparison cmp, const Operand& a,
+                                  const Operand& b, Registers& regs) const
+{
+  const Value& x = fetch(a, regs);
+  const Value& y = fetch(b, regs);
+  if (cmp == CMP_LIKE) {
+    return x.like(y);
+  }
+
+  const Value* px = &x;
+  const Value* py = &y;
+  if (x.type_ != y.type_) {
+    if (a.kind_ == Operand::CONSTANT && !y.conversion_preferred_) {
+      px = constants_[a.index_].as(y.type_);
+    } else if (b.kind_ == Operand::CONSTANT && !x.conversion_preferred_) {
+      py = constants_[b.index_].as(x.type_);
+    } else {
+      px = py = 0;
+    }
+  }
+
+  if (px && py) {
+    switch (cmp) {
+    case CMP_EQ:
+      return equal_same_type(*px, *py);
+    case CMP_LT:
+      return less_same_type(*px, *py);
+    case CMP_GT:
+      return less_same_type(*py, *px);
+    case CMP_LTEQ:
+      return !less_same_type(*py, *px);
+    case CMP_GTEQ:
+      return !less_same_type(*px, *py);
+    case CMP_NEQ:
+      return !equal_same_type(*px, *py);
+    default:
+      break;
+    }
+  }
+
+  // Types that need a conversion on each evaluation (or that can't be
+  // converted, in which case this throws like the AST evaluator).
+  switch (cmp) {
+  case CMP_EQ:
+    return x == y;
+  case CMP_LT:
+    return x < y;
+  case CMP_GT:
+    return y < x;
+  case CMP_LTEQ:
+    return !(y < x);
+  case CMP_GTEQ:
+    return !(x < y);
+  case CMP_NEQ:
+    return !(x == y);
+  default:
+    break;
+  }
+  return false; // not reached
+}
+
+bool
+FilterEvaluator::Program::run(DataForEval& data) const
+{
+  Registers regs(fields_.size() + params_.size() + temporaries_, data,
+                 data.sample() ? &accessors(data.meta_) : 0);
+  const size_t temps = fields_.size() + params_.size();
+
+  for (size_t pc = 0; pc < code_.size(); ) {
+    const Instruction& in = code_[pc++];
+    switch (in.op_) {
+    case OP_COMPARE:
+      regs.set(temps + in.dst_,
+               compare(static_cast<Comparison>(in.arg_), in.a_, in.b_, regs));
+      break;
+    case OP_BETWEEN: {
+      const bool btwn = !compare(CMP_LT, in.a_, in.b_, regs)
+        && !compare(CMP_LT, in.c_, in.a_, regs);
+      regs.set(temps + in.dst_, in.arg_ ? !btwn : btwn);
+      break;
+    }
+    case OP_MOD:
+      regs.values_[temps + in.dst_] = fetch(in.a_, regs) % fetch(in.b_, regs);
+      break;
+    case OP_NOT:
+      regs.set(temps + in.dst_, !fetch(in.a_, regs).b_);
+      break;
+    case OP_JUMP_IF_FALSE:
+      if (!fetch(in.a_, regs).b_) {
+        pc = in.arg_;
+      }
+      break;
+    case OP_JUMP_IF_TRUE:
+      if (fetch(in.a_, regs).b_) {
+        pc = in.arg_;
+      }
+      break;
+    }
+  }
+
+  const Value& result = regs.values_[temps + result_];
+  assert(result.type_ == Value::VAL_BOOL);
+  return result.b_;
+}
+
+/**
+ * The fields of a run of up to SIZE samples, each copied into an array of
+ * a type that compares like the field's Value type, and an array of
+ * results per register.
+ */
+class FilterEvaluator::Program::Batch {
+public:
+  enum { SIZE = 256 };
+
+  enum Kind { SIGNED, UNSIGNED, FLOATING };
+
+  struct Column {
+    Value::Type type_;
+    Kind kind_;
+    union {
+      ACE_INT64 i_[SIZE];
+      ACE_UINT64 u_[SIZE];
+      double f_[SIZE];
+    };
+
+    /// Returns false if values of type @a t aren't stored in columns.
+    bool type(Value::Type t)
+    {
+      type_ = t;
+      switch (t) {
+      case Value::VAL_BOOL:
+      case Value::VAL_INT:
+      case Value::VAL_I64:
+      case Value::VAL_CHAR:
+        kind_ = SIGNED;
+        return true;
+      case Value::VAL_UINT:
+      case Value::VAL_UI64:
+        kind_ = UNSIGNED;
+        return true;
+      case Value::VAL_FLOAT:
+        kind_ = FLOATING;
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    void set(size_t i, const Value& v) { store(v, i_[i], u_[i], f_[i]); }
+  };
+
+  /// Copies @a v to the one of @a i, @a u or @a f for its kind of type.
+  static void store(const Value& v, ACE_INT64& i, ACE_UINT64& u, double& f)
+  {
+    switch (v.type_) {
+    case Value::VAL_BOOL: i = v.b_; break;
+    case Value::VAL_INT: i = v.i_; break;
+    case Value::VAL_I64: i = v.l_; break;
+    case Value::VAL_CHAR: i = v.c_; break;
+    case Value::VAL_UINT: u = v.u_; break;
+    case Value::VAL_UI64: u = v.m_; break;
+    case Value::VAL_FLOAT: f = v.f_; break;
+    default: break;
+    }
+  }
+
+  Batch(const MetaStruct& meta, const DDS::StringSeq& params,
+        const Accessors& accessors, size_t registers, size_t jumps)
+    : meta_(meta)
+    , params_(params)
+    , accessors_(accessors)
+    , columns_(accessors.size())
+    , results_(registers * SIZE)
+    , saved_(jumps * SIZE)
+    , pending_(jumps)
+  {}
+
+  unsigned char* result(size_t reg) { return &results_[reg * SIZE]; }
+  unsigned char* saved(size_t depth) { return &saved_[depth * SIZE]; }
+
+  const MetaStruct& meta_;
+  const DDS::StringSeq& params_;
+  const Accessors& accessors_;
+  OPENDDS_VECTOR(Column) columns_;
+  OPENDDS_VECTOR(unsigned char) results_;
+  /// Results of the left sides of the ANDs and ORs whose right sides are
+  /// being evaluated, and the jumps that started them.
+  OPENDDS_VECTOR(unsigned char) saved_;
+  OPENDDS_VECTOR(size_t) pending_;
+};
+
+namespace {
+  // Each of these loops over contiguous arrays, with no branches in the
+  // body, so compilers can vectorize them.  The comparisons are written
+  // the same way as in compare().
+
+  template<typename T>
+  void compare_column(FilterEvaluator::Program::Comparison cmp,
+                      const T* x, T k, size_t count, unsigned char* out)
+  {
+    typedef FilterEvaluator::Program Program;
+    switch (cmp) {
+    case Program::CMP_EQ:
+      for (size_t i = 0; i < count; ++i) out[i] = x[i] == k;
+      break;
+    case Program::CMP_LT:
+      for (size_t i = 0; i < count; ++i) out[i] = x[i] < k;
+      break;
+    case Program::CMP_GT:
+      for (size_t i = 0; i < count; ++i) out[i] = k < x[i];
+      break;
+    case Program::CMP_LTEQ:
+      for (size_t i = 0; i < count; ++i) out[i] = !(k < x[i]);
+      break;
+    case Program::CMP_GTEQ:
+      for (size_t i = 0; i < count; ++i) out[i] = !(x[i] < k);
+      break;
+    case Program::CMP_NEQ:
+      for (size_t i = 0; i < count; ++i) out[i] = !(x[i] == k);
+      break;
+    default:
+      break;
+    }
+  }
+
+  template<typename T>
+  void between_column(const T* x, T low, T high, bool invert, size_t count,
+                      unsigned char* out)
+  {
+    const unsigned char inv = invert ? 1 : 0;
+    for (size_t i = 0; i < count; ++i) {
+      const unsigned char btwn = !(x[i] < low) & !(high < x[i]);
+      out[i] = btwn ^ inv;
+    }
+  }
+
+  bool all_equal(const unsigned char* mask, size_t count, unsigned char b)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      if (mask[i] != b) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+bool
+FilterEvaluator::Program::operand_as(const Operand& o, Value::Type t,
+                                     const DDS::StringSeq& params,
+                                     Value& value) const
+{
+  if (o.kind_ == Operand::CONSTANT) {
+    const Value* const converted = constants_[o.index_].as(t);
+    if (!converted) {
+      return false;
+    }
+    value = *converted;
+    return true;
+  }
+  const CORBA::ULong param = static_cast<CORBA::ULong>(params_[o.index_]);
+  if (param >= params.length()) {
+    return false;
+  }
+  value = Value(params[param], true);
+  return value.type_ == t || value.convert(t);
+}
+
+bool
+FilterEvaluator::Program::run_columns(Batch& batch,
+                                      const void* const* samples,
+                                      size_t count,
+                                      unsigned char* selected) const
+{
+  static const Comparison reversed[] = {
+    CMP_EQ, CMP_GT, CMP_LT, CMP_GTEQ, CMP_LTEQ, CMP_NEQ
+  };
+
+  try {
+    for (size_t f = 0; f < fields_.size(); ++f) {
+      Batch::Column& column = batch.columns_[f];
+      const FieldAccessor& accessor = batch.accessors_[f];
+      for (size_t i = 0; i < count; ++i) {
+        const Value v = accessor.valid() ? accessor.get(samples[i])
+          : batch.meta_.getValue(samples[i], fields_[f].c_str());
+        if (i == 0 ? !column.type(v.type_) : v.type_ != column.type_) {
+          return false;
+        }
+        column.set(i, v);
+      }
+    }
+
+    size_t depth = 0;
+    for (size_t pc = 0; ; ) {
+      // The right side of an AND or OR ends where its jump goes to.
+      while (depth && code_[batch.pending_[depth - 1]].arg_ == pc) {
+        --depth;
+        const Instruction& jump = code_[batch.pending_[depth]];
+        unsigned char* const result = batch.result(jump.a_.index_);
+        const unsigned char* const left = batch.saved(depth);
+        if (jump.op_ == OP_JUMP_IF_FALSE) {
+          for (size_t i = 0; i < count; ++i) result[i] &= left[i];
+        } else {
+          for (size_t i = 0; i < count; ++i) result[i] |= left[i];
+        }
+      }
+      if (pc == code_.size()) {
+        break;
+      }
+
+      const Instruction& in = code_[pc++];
+      unsigned char* const dst = batch.result(in.dst_);
+      switch (in.op_) {
+      case OP_COMPARE:
+      case OP_BETWEEN: {
+        const bool field_first = in.a_.kind_ == Operand::FIELD;
+        const Batch::Column& column =
+          batch.columns_[(field_first ? in.a_ : in.b_).index_];
+        Value k;
+        if (!operand_as(field_first ? in.b_ : in.a_, column.type_,
+                        batch.params_, k)) {
+          return false;
+        }
+        ACE_INT64 ki = 0;
+        ACE_UINT64 ku = 0;
+        double kf = 0;
+        Batch::store(k, ki, ku, kf);
+
+        if (in.op_ == OP_BETWEEN) {
+          if (!operand_as(in.c_, column.type_, batch.params_, k)) {
+            return false;
+          }
+          ACE_INT64 hi = 0;
+          ACE_UINT64 hu = 0;
+          double hf = 0;
+          Batch::store(k, hi, hu, hf);
+          const bool invert = in.arg_ != 0;
+          switch (column.kind_) {
+          case Batch::SIGNED:
+            between_column(column.i_, ki, hi, invert, count, dst);
+            break;
+          case Batch::UNSIGNED:
+            between_column(column.u_, ku, hu, invert, count, dst);
+            break;
+          case Batch::FLOATING:
+            between_column(column.f_, kf, hf, invert, count, dst);
+            break;
+          }
+          break;
+        }
+
+        // "k < field" is "field > k"
+        const Comparison cmp = field_first ? static_cast<Comparison>(in.arg_)
+                                           : reversed[in.arg_];
+        switch (column.kind_) {
+        case Batch::SIGNED:
+          compare_column(cmp, column.i_, ki, count, dst);
+          break;
+        case Batch::UNSIGNED:
+          compare_column(cmp, column.u_, ku, count, dst);
+          break;
+        case Batch::FLOATING:
+          compare_column(cmp, column.f_, kf, count, dst);
+          break;
+        }
+        break;
+      }
+      case OP_NOT: {
+        const unsigned char* const a = batch.result(in.a_.index_);
+        for (size_t i = 0; i < count; ++i) dst[i] = !a[i];
+        break;
+      }
+      case OP_JUMP_IF_FALSE:
+      case OP_JUMP_IF_TRUE: {
+        const unsigned char* const a = batch.result(in.a_.index_);
+        // Like run(), skip the right side if the left side decides the
+        // result for every sample.
+        if (all_equal(a, count, in.op_ == OP_JUMP_IF_TRUE)) {
+          pc = in.arg_;
+        } else {
+          std::copy(a, a + count, batch.saved(depth));
+          batch.pending_[depth++] = pc - 1;
+        }
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+  } catch (const std::exception&) {
+    // Evaluating the samples one at a time reports the error.
+    return false;
+  }
+
+  const unsigned char* const result = batch.result(result_);
+  std::copy(result, result + count, selected);
+  return true;
+}
+
+void
+FilterEvaluator::Program::run_batch(const void* const* samples,
+                                    size_t count, const MetaStruct& meta,
+                                    const DDS::StringSeq& params,
+                                    unsigned char* selected) const
+{
+  size_t done = 0;
+  if (columns_ && count > 1) {
+    Batch batch(meta, params, accessors(meta), temporaries_, jumps_);
+    while (done < count) {
+      const size_t n = std::min(count - done, size_t(Batch::SIZE));
+      if (!run_columns(batch, samples + done, n, selected + done)) {
+        break;
+      }
+      done += n;
+    }
+  }
+  for (; done < count; ++done) {
+    DeserializedForEval data(samples[done], meta, params);
+    selected[done] = run(data);
+  }
+}
+
 MetaStruct::~MetaStruct()
 {
 }
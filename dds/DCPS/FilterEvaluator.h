@@ -30,6 +30,7 @@ template<typename T>
 const MetaStruct& getMetaStruct();
 
 struct OpenDDS_Dcps_Export Value {
+  Value();
   Value(bool b, bool conversion_preferred = false);
   Value(int i, bool conversion_preferred = false);
   Value(unsigned int u, bool conversion_preferred = false);
@@ -82,6 +83,72 @@ struct OpenDDS_Dcps_Export Value {
   bool conversion_preferred_;
 };
 
+/**
+ * Reads one field of a deserialized sample.  Found by name once with
+ * MetaStruct::getFieldAccessor(), instead of on every lookup.
+ */
+struct FieldAccessor {
+  typedef Value (*Getter)(const void* stru);
+
+  FieldAccessor() : getter_(0), offset_(0) {}
+
+  bool valid() const { return getter_ != 0; }
+
+  Value get(const void* sample) const
+  {
+    return getter_(static_cast<const char*>(sample) + offset_);
+  }
+
+  /// Reads the field from the (possibly nested) struct containing it.
+  Getter getter_;
+  /// Offset of that struct from the start of the sample.
+  size_t offset_;
+};
+
+/**
+ * Fields to read from a serialized sample in one pass over it, see
+ * MetaStruct::getValues().  Names are relative to the struct being read.
+ */
+struct OpenDDS_Dcps_Export FieldSet {
+  enum { MAX_FIELDS = 16 };
+
+  FieldSet() : count_(0), found_(0), consume_(false) {}
+
+  /// Returns false if there are already MAX_FIELDS fields.
+  bool add(const char* name, Value* value);
+
+  /// Index of the field @a name, or -1 if it's not in the set.
+  int find(const char* name) const;
+
+  void set(int index, const Value& value)
+  {
+    *values_[index] = value;
+    found_flags_[index] = true;
+    ++found_;
+  }
+
+  bool found(int index) const { return found_flags_[index]; }
+
+  /// The fields of the nested struct whose name (with the trailing dot)
+  /// is @a prefix, which must then be read to its end.
+  FieldSet nested(const char* prefix, size_t length) const;
+
+  /// Count the fields that were found in @a nested.
+  void merge(const FieldSet& nested);
+
+  /// All fields are read and the rest of the struct can be left unread.
+  bool done() const { return !consume_ && found_ == count_; }
+
+  const char* names_[MAX_FIELDS];
+  Value* values_[MAX_FIELDS];
+  bool found_flags_[MAX_FIELDS];
+  /// Index in the enclosing set, for nested sets.
+  int outer_[MAX_FIELDS];
+  size_t count_;
+  size_t found_;
+  bool consume_;
+};
+
 class OpenDDS_Dcps_Export FilterEvaluator : public RcObject {
 public:
 
@@ -103,6 +170,25 @@ public:
 
   bool has_non_key_fields(const MetaStruct& meta) const;
 
+  /**
+   * A comparison "field <kind_> %param_" that has to be true for the
+   * filter to match, so readers sharing this filter can be indexed by
+   * their value of the parameter (see FilterIndex).
+   */
+  struct IndexPredicate {
+    enum Kind { EQ, LT, GT, LTEQ, GTEQ };
+
+    OPENDDS_STRING field_;
+    size_t param_;
+    Kind kind_;
+    /// The filter is only this comparison.
+    bool exact_;
+  };
+
+  /// Returns false if the filter has no such comparison at its top level
+  /// (directly or as one of the operands of AND).
+  bool index_predicate(IndexPredicate& predicate) const;
+
   /**
    * Returns true if the unserialized sample matches the filter.
    */
@@ -113,6 +199,17 @@ public:
     return eval_i(data);
   }
 
+  /**
+   * Same as eval() but walks the parsed filter instead of running the
+   * compiled program.  Kept as a reference for tests and benchmarks.
+   */
+  template<typename T>
+  bool eval_ast(const T& sample, const DDS::StringSeq& params) const
+  {
+    DeserializedForEval data(&sample, getMetaStruct<T>(), params);
+    return eval_ast_i(data);
+  }
+
   /**
    * Returns true if the serialized sample matches the filter.
    */
@@ -125,14 +222,48 @@ public:
     return eval_i(data);
   }
 
+  bool eval_ast(ACE_Message_Block* serializedSample, bool swap_bytes,
+                bool cdr_encap, const MetaStruct& meta,
+                const DDS::StringSeq& params) const
+  {
+    SerializedForEval data(serializedSample, meta, params,
+                           swap_bytes, cdr_encap);
+    return eval_ast_i(data);
+  }
+
+  /**
+   * Evaluates the filter for the @a count unserialized samples at
+   * @a samples, all of the type described by @a meta, and sets
+   * selected[i] to 1 if samples[i] matches, 0 if it doesn't.  The fields
+   * of a run of samples are copied into one array per field and each
+   * comparison of a field with a literal or parameter is made for the
+   * whole run in one loop, instead of evaluating the filter per sample.
+   */
+  void eval_batch(const void* const* samples, size_t count,
+                  const MetaStruct& meta, const DDS::StringSeq& params,
+                  unsigned char* selected) const;
+
   class EvalNode;
   class Operand;
 
+  /// The filter compiled into a flat list of instructions.
+  class Program;
+
   struct OpenDDS_Dcps_Export DataForEval {
     DataForEval(const MetaStruct& meta, const DDS::StringSeq& params)
       : meta_(meta), params_(params) {}
     virtual ~DataForEval();
     virtual Value lookup(const char* field) const = 0;
+    /// The sample if it is deserialized, otherwise null.
+    virtual const void* sample() const { return 0; }
+    /// Reads the field without caching it, see Program.
+    virtual Value read(const char* field) const { return lookup(field); }
+    /// Reads @a fields in one pass, returns false if that's not supported.
+    virtual bool read(FieldSet& fields) const
+    {
+      ACE_UNUSED_ARG(fields);
+      return false;
+    }
     const MetaStruct& meta_;
     const DDS::StringSeq& params_;
   private:
@@ -153,6 +284,7 @@ private:
       : DataForEval(meta, params), deserialized_(data) {}
     virtual ~DeserializedForEval();
     Value lookup(const char* field) const;
+    const void* sample() const { return deserialized_; }
     const void* const deserialized_;
   };
 
@@ -161,15 +293,19 @@ private:
                       const DDS::StringSeq& params, bool swap, bool cdr)
       : DataForEval(meta, params), serialized_(data), swap_(swap), cdr_(cdr) {}
     Value lookup(const char* field) const;
+    Value read(const char* field) const;
+    bool read(FieldSet& fields) const;
     ACE_Message_Block* serialized_;
     bool swap_, cdr_;
     mutable OPENDDS_MAP(OPENDDS_STRING, Value) cache_;
   };
 
   bool eval_i(DataForEval& data) const;
+  bool eval_ast_i(DataForEval& data) const;
 
   bool extended_grammar_;
   EvalNode* filter_root_;
+  Program* program_;
   OPENDDS_VECTOR(OPENDDS_STRING) order_bys_;
   /// Number of parameter used in the filter, this should
   /// match the number of values passed when evaluating the filter
@@ -184,6 +320,27 @@ public:
   virtual Value getValue(const void* stru, const char* fieldSpec) const = 0;
   virtual Value getValue(Serializer& ser, const char* fieldSpec) const = 0;
 
+  /// Returns an invalid accessor if the field can't be read directly, in
+  /// that case getValue() has to be used.
+  virtual FieldAccessor getFieldAccessor(const char* fieldSpec) const
+  {
+    ACE_UNUSED_ARG(fieldSpec);
+    return FieldAccessor();
+  }
+
+  /**
+   * Reads the fields in @a fields from the serialized sample in one pass,
+   * reading up to the last of them.  Fields that aren't found are left
+   * unset.  Returns false if this isn't supported, in that case
+   * getValue(Serializer&, ...) has to be used for each field.
+   */
+  virtual bool getValues(Serializer& ser, FieldSet& fields) const
+  {
+    ACE_UNUSED_ARG(ser);
+    ACE_UNUSED_ARG(fields);
+    return false;
+  }
+
   virtual ComparatorBase::Ptr create_qc_comparator(const char* fieldSpec,
     ComparatorBase::Ptr next) const = 0;
 
@@ -0,0 +1,189 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+#include "FilterIndex.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+FilterIndex::Group::Group()
+  : indexed_(false)
+  , accessor_resolved_(false)
+  , current_(false)
+  , key_type_(Value::VAL_BOOL)
+{
+  predicate_.param_ = 0;
+  predicate_.kind_ = FilterEvaluator::IndexPredicate::EQ;
+  predicate_.exact_ = false;
+}
+
+FilterIndex::FilterIndex()
+{
+}
+
+void
+FilterIndex::insert(const RepoId& reader, const RcHandle<FilterEvaluator>& eval,
+                    const DDS::StringSeq& params)
+{
+  remove(reader);
+
+  FilterEvaluator* const key = eval.in();
+  Groups::iterator it = groups_.find(key);
+  if (it == groups_.end()) {
+    it = groups_.insert(std::make_pair(key, Group())).first;
+    it->second.eval_ = eval;
+    it->second.indexed_ = eval->index_predicate(it->second.predicate_);
+  }
+  it->second.readers_[reader] = params;
+  it->second.current_ = false;
+  readers_[reader] = key;
+}
+
+void
+FilterIndex::remove(const RepoId& reader)
+{
+  const ReaderGroups::iterator r = readers_.find(reader);
+  if (r == readers_.end()) {
+    return;
+  }
+
+  const Groups::iterator it = groups_.find(r->second);
+  readers_.erase(r);
+  if (it == groups_.end()) {
+    return;
+  }
+  it->second.readers_.erase(reader);
+  if (it->second.readers_.empty()) {
+    groups_.erase(it);
+  } else {
+    it->second.current_ = false;
+  }
+}
+
+void
+FilterIndex::partition(Group& group, const MetaStruct& meta,
+                       const void* sample, GUIDSeq& excluded,
+                       size_t& begin, size_t& end)
+{
+  begin = end = 0;
+  if (!group.indexed_) {
+    if (!group.current_) {
+      rebuild(group, group.key_type_);
+    }
+    return;
+  }
+
+  const char* const field = group.predicate_.field_.c_str();
+  Value value;
+  try {
+    if (!group.accessor_resolved_) {
+      group.accessor_ = meta.getFieldAccessor(field);
+      group.accessor_resolved_ = true;
+    }
+    value = group.accessor_.valid() ? group.accessor_.get(sample)
+                                    : meta.getValue(sample, field);
+  } catch (const std::exception&) {
+    // Leave reporting the error to the evaluation of the filter.
+    group.indexed_ = false;
+    rebuild(group, group.key_type_);
+    return;
+  }
+
+  if (!group.current_ || value.type_ != group.key_type_) {
+    rebuild(group, value.type_);
+  }
+
+  const Reader* const first = group.sorted_.empty() ? 0 : &group.sorted_[0];
+  const Reader* const last = first + group.sorted_.size();
+  const KeyLess less;
+  // The readers are sorted by the value of the parameter p, find the ones
+  // for which "value <kind_> p" holds.
+  switch (group.predicate_.kind_) {
+  case FilterEvaluator::IndexPredicate::EQ: {
+    const std::pair<const Reader*, const Reader*> range =
+      std::equal_range(first, last, value, less);
+    begin = range.first - first;
+    end = range.second - first;
+    break;
+  }
+  case FilterEvaluator::IndexPredicate::LT:
+    begin = std::upper_bound(first, last, value, less) - first;
+    end = last - first;
+    break;
+  case FilterEvaluator::IndexPredicate::LTEQ:
+    begin = std::lower_bound(first, last, value, less) - first;
+    end = last - first;
+    break;
+  case FilterEvaluator::IndexPredicate::GT:
+    end = std::lower_bound(first, last, value, less) - first;
+    break;
+  case FilterEvaluator::IndexPredicate::GTEQ:
+    end = std::upper_bound(first, last, value, less) - first;
+    break;
+  }
+
+  append(excluded, first, first + begin);
+  append(excluded, first + end, last);
+}
+
+void
+FilterIndex::rebuild(Group& group, Value::Type type)
+{
+  group.sorted_.clear();
+  group.unsorted_.clear();
+
+  const CORBA::ULong param =
+    static_cast<CORBA::ULong>(group.predicate_.param_);
+  for (ParamsMap::const_iterator it = group.readers_.begin();
+       it != group.readers_.end(); ++it) {
+    const DDS::StringSeq& params = it->second;
+    Reader reader;
+    reader.id_ = it->first;
+    reader.params_ = params;
+    if (group.indexed_ && param < params.length()) {
+      // Same conversion as the comparison in the filter makes.
+      reader.key_ = Value(params[param], true);
+      if (reader.key_.convert(type)) {
+        group.sorted_.push_back(reader);
+        continue;
+      }
+    }
+    group.unsorted_.push_back(reader);
+  }
+
+  std::sort(group.sorted_.begin(), group.sorted_.end(), KeyLess());
+  group.key_type_ = type;
+  group.current_ = true;
+}
+
+void
+FilterIndex::append(GUIDSeq& seq, const Reader* begin, const Reader* end)
+{
+  if (begin == end) {
+    return;
+  }
+  CORBA::ULong len = seq.length();
+  seq.length(len + static_cast<CORBA::ULong>(end - begin));
+  for (const Reader* r = begin; r != end; ++r) {
+    seq[len++] = r->id_;
+  }
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_NO_CONTENT_FILTERED_TOPIC
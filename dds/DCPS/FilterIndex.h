@@ -0,0 +1,143 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_FILTERINDEX_H
+#define OPENDDS_DCPS_FILTERINDEX_H
+
+#include "dds/DCPS/Definitions.h"
+
+#ifndef OPENDDS_NO_CONTENT_FILTERED_TOPIC
+
+#include "dds/DCPS/FilterEvaluator.h"
+#include "dds/DCPS/GuidUtils.h"
+#include "dds/DCPS/PoolAllocator.h"
+#include "dds/DCPS/RcHandle_T.h"
+#include "dds/DCPS/Util.h"
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class FilterIndex
+ *
+ * @brief The content filters of the readers associated with a DataWriter,
+ * grouped by filter expression.
+ *
+ * Readers using the same filter expression share a FilterEvaluator.  If
+ * that filter contains a comparison of a field with a parameter (see
+ * FilterEvaluator::IndexPredicate) the readers of the group are kept
+ * sorted by their value of the parameter, so a sample's value of the field
+ * selects the readers that can match with a binary search instead of an
+ * evaluation of the filter per reader.  Only those readers are evaluated,
+ * and not even them if the comparison is the whole filter.
+ *
+ * Not thread safe, DataWriterImpl uses it under its reader_info_lock_.
+ */
+class OpenDDS_Dcps_Export FilterIndex {
+public:
+  FilterIndex();
+
+  void insert(const RepoId& reader, const RcHandle<FilterEvaluator>& eval,
+              const DDS::StringSeq& params);
+
+  void remove(const RepoId& reader);
+
+  bool empty() const { return readers_.empty(); }
+
+  /// Appends the readers whose filter doesn't match @a sample to @a excluded.
+  template<typename T>
+  void filter_out(const T& sample, GUIDSeq& excluded)
+  {
+    for (Groups::iterator it = groups_.begin(); it != groups_.end(); ++it) {
+      Group& group = it->second;
+      size_t begin, end;
+      partition(group, getMetaStruct<T>(), &sample, excluded, begin, end);
+      if (!group.predicate_.exact_) {
+        for (size_t i = begin; i < end; ++i) {
+          const Reader& reader = group.sorted_[i];
+          if (!group.eval_->eval(sample, reader.params_)) {
+            push_back(excluded, reader.id_);
+          }
+        }
+      }
+      for (size_t i = 0; i < group.unsorted_.size(); ++i) {
+        const Reader& reader = group.unsorted_[i];
+        if (!group.eval_->eval(sample, reader.params_)) {
+          push_back(excluded, reader.id_);
+        }
+      }
+    }
+  }
+
+private:
+  struct Reader {
+    RepoId id_;
+    DDS::StringSeq params_;
+    /// The indexed parameter converted to the type of the field.
+    Value key_;
+  };
+
+  struct KeyLess {
+    bool operator()(const Reader& a, const Reader& b) const
+    { return a.key_ < b.key_; }
+    bool operator()(const Reader& a, const Value& b) const
+    { return a.key_ < b; }
+    bool operator()(const Value& a, const Reader& b) const
+    { return a < b.key_; }
+  };
+
+  typedef OPENDDS_MAP_CMP(RepoId, DDS::StringSeq, GUID_tKeyLessThan) ParamsMap;
+
+  struct Group {
+    Group();
+
+    RcHandle<FilterEvaluator> eval_;
+    ParamsMap readers_;
+    bool indexed_;
+    FilterEvaluator::IndexPredicate predicate_;
+    bool accessor_resolved_;
+    FieldAccessor accessor_;
+    /// sorted_ and unsorted_ are up to date for keys of key_type_
+    bool current_;
+    Value::Type key_type_;
+    /// Readers that have a key, in key order
+    OPENDDS_VECTOR(Reader) sorted_;
+    /// Readers that are always evaluated: all of them if the group isn't
+    /// indexed, otherwise the ones whose parameter doesn't convert.
+    OPENDDS_VECTOR(Reader) unsorted_;
+  };
+
+  /// Appends the readers of @a group that can't match @a sample to
+  /// @a excluded, the readers in group.sorted_[begin, end) may match.
+  void partition(Group& group, const MetaStruct& meta, const void* sample,
+                 GUIDSeq& excluded, size_t& begin, size_t& end);
+
+  /// Sort the readers of @a group by their keys of type @a type.
+  void rebuild(Group& group, Value::Type type);
+
+  static void append(GUIDSeq& seq, const Reader* begin, const Reader* end);
+
+  typedef OPENDDS_MAP(FilterEvaluator*, Group) Groups;
+  Groups groups_;
+  typedef OPENDDS_MAP_CMP(RepoId, FilterEvaluator*, GUID_tKeyLessThan) ReaderGroups;
+  ReaderGroups readers_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif // OPENDDS_NO_CONTENT_FILTERED_TOPIC
+
+#endif /* OPENDDS_DCPS_FILTERINDEX_H */
@@ -0,0 +1,99 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_INSTANCEHANDLEINDEX_T_H
+#define OPENDDS_DCPS_INSTANCEHANDLEINDEX_T_H
+
+#include "dds/Versioned_Namespace.h"
+#include "dds/DdsDcpsInfrastructureC.h"
+
+#include "ace/Functor.h"
+#include "ace/Guard_T.h"
+#include "ace/Hash_Map_Manager_T.h"
+#include "ace/Null_Mutex.h"
+#include "ace/Thread_Mutex.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class InstanceHandleIndex
+ *
+ * @brief Hash index from instance handles to @a Value, split into
+ * @a Shards shards of @a Buckets buckets that each have their own lock.
+ *
+ * Instance handles are handed out sequentially, so consecutive instances
+ * land in different shards and threads looking up different instances
+ * rarely contend.  Lookups copy the value out under the shard's lock.
+ */
+template <typename Value, size_t Shards = 16, size_t Buckets = 64>
+class InstanceHandleIndex {
+public:
+  /// Returns false if @a handle is already in the index.
+  bool bind(DDS::InstanceHandle_t handle, const Value& value)
+  {
+    Shard& s = shard(handle);
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, s.lock_, false);
+    return s.map_.bind(handle, value) == 0;
+  }
+
+  bool find(DDS::InstanceHandle_t handle, Value& value) const
+  {
+    const Shard& s = shard(handle);
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, s.lock_, false);
+    return s.map_.find(handle, value) == 0;
+  }
+
+  bool unbind(DDS::InstanceHandle_t handle)
+  {
+    Shard& s = shard(handle);
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, s.lock_, false);
+    return s.map_.unbind(handle) == 0;
+  }
+
+  void clear()
+  {
+    for (size_t i = 0; i < Shards; ++i) {
+      ACE_GUARD(ACE_Thread_Mutex, guard, shards_[i].lock_);
+      shards_[i].map_.unbind_all();
+    }
+  }
+
+private:
+  typedef ACE_Hash_Map_Manager_Ex<DDS::InstanceHandle_t, Value,
+                                  ACE_Hash<DDS::InstanceHandle_t>,
+                                  ACE_Equal_To<DDS::InstanceHandle_t>,
+                                  ACE_Null_Mutex> Map;
+
+  struct Shard {
+    Shard() : map_(Buckets) {}
+
+    mutable ACE_Thread_Mutex lock_;
+    Map map_;
+  };
+
+  Shard& shard(DDS::InstanceHandle_t handle)
+  {
+    return shards_[static_cast<unsigned long>(handle) % Shards];
+  }
+
+  const Shard& shard(DDS::InstanceHandle_t handle) const
+  {
+    return shards_[static_cast<unsigned long>(handle) % Shards];
+  }
+
+  Shard shards_[Shards];
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_INSTANCEHANDLEINDEX_T_H */
@@ -0,0 +1,166 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_KEYHASH_H
+#define OPENDDS_DCPS_KEYHASH_H
+
+#include "dds/Versioned_Namespace.h"
+
+#include "ace/Basic_Types.h"
+#include "ace/CDR_Base.h"
+
+#include <cstring>
+#include <string>
+#ifdef ACE_HAS_CPP11
+#include <array>
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/// Initial value for the hashes computed by the generated
+/// <Type>_OpenDDS_KeyHash structures (FNV-1a offset basis).
+static const ACE_UINT32 key_hash_seed = 2166136261u;
+
+/// Mix @a size bytes at @a data into @a hash (FNV-1a).
+inline void key_hash_bytes(ACE_UINT32& hash, const void* data, size_t size)
+{
+  const unsigned char* const bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+}
+
+/// Detects types that convert to a (narrow or wide) C string, which covers
+/// the string members of every language mapping without naming their types.
+template <typename T, typename Ptr>
+struct KeyHashConvertsTo {
+  static char test(Ptr);
+  static long test(...);
+  static const T& make();
+  enum { value = sizeof(test(make())) == sizeof(char) };
+};
+
+/// Detects class (and union) types, whose storage may include padding.
+template <typename T>
+struct KeyHashIsClass {
+  template <typename U> static char test(int U::*);
+  template <typename U> static long test(...);
+  enum { value = sizeof(test<T>(0)) == sizeof(char) };
+};
+
+/// Arithmetic and enum types, hashed by their bytes.
+template <typename T, bool IsString, bool IsWString, bool IsClass>
+struct KeyHasher {
+  static void hash(ACE_UINT32& hash, const T& value)
+  {
+    key_hash_bytes(hash, &value, sizeof value);
+  }
+};
+
+/// Other class types aren't mixed in.  KeyLessThan still compares them,
+/// and equal keys hash the same without them.
+template <typename T>
+struct KeyHasher<T, false, false, true> {
+  static void hash(ACE_UINT32&, const T&) {}
+};
+
+template <typename T, bool IsClass>
+struct KeyHasher<T, true, false, IsClass> {
+  static void hash(ACE_UINT32& hash, const T& value)
+  {
+    const char* const str = value;
+    if (str) {
+      key_hash_bytes(hash, str, std::strlen(str));
+    }
+  }
+};
+
+template <typename T, bool IsClass>
+struct KeyHasher<T, false, true, IsClass> {
+  static void hash(ACE_UINT32& hash, const T& value)
+  {
+    const ACE_CDR::WChar* const str = value;
+    if (str) {
+      size_t len = 0;
+      while (str[len]) {
+        ++len;
+      }
+      key_hash_bytes(hash, str, len * sizeof(ACE_CDR::WChar));
+    }
+  }
+};
+
+/// Mix the value of one key field into @a hash.  Values that compare
+/// equal with the generated <Type>_OpenDDS_KeyLessThan hash the same.
+template <typename T>
+inline void key_hash(ACE_UINT32& hash, const T& value)
+{
+  KeyHasher<T,
+            KeyHashConvertsTo<T, const char*>::value,
+            KeyHashConvertsTo<T, const ACE_CDR::WChar*>::value,
+            KeyHashIsClass<T>::value>::hash(hash, value);
+}
+
+inline void key_hash(ACE_UINT32& hash, double value)
+{
+  if (value == 0) {
+    value = 0; // -0.0 == 0.0
+  }
+  key_hash_bytes(hash, &value, sizeof value);
+}
+
+inline void key_hash(ACE_UINT32& hash, float value)
+{
+  key_hash(hash, static_cast<double>(value));
+}
+
+inline void key_hash(ACE_UINT32& hash, long double value)
+{
+  // The storage of a long double may include padding bytes.
+  key_hash(hash, static_cast<double>(value));
+}
+
+inline void key_hash(ACE_UINT32& hash, const std::string& value)
+{
+  key_hash_bytes(hash, value.data(), value.size());
+}
+
+#ifdef DDS_HAS_WCHAR
+inline void key_hash(ACE_UINT32& hash, const std::wstring& value)
+{
+  key_hash_bytes(hash, value.data(), value.size() * sizeof(wchar_t));
+}
+#endif
+
+template <typename T, size_t N>
+inline void key_hash(ACE_UINT32& hash, const T (&value)[N])
+{
+  for (size_t i = 0; i < N; ++i) {
+    key_hash(hash, value[i]);
+  }
+}
+
+#ifdef ACE_HAS_CPP11
+/// IDL arrays in the C++11 mapping.
+template <typename T, size_t N>
+inline void key_hash(ACE_UINT32& hash, const std::array<T, N>& value)
+{
+  for (size_t i = 0; i < N; ++i) {
+    key_hash(hash, value[i]);
+  }
+}
+#endif
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_KEYHASH_H */
@@ -0,0 +1,173 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_KEYHASHINDEX_T_H
+#define OPENDDS_DCPS_KEYHASHINDEX_T_H
+
+#include "dds/Versioned_Namespace.h"
+#include "PoolAllocator.h"
+
+#include "ace/Basic_Types.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+ * @class KeyHashIndex
+ *
+ * @brief Hash index over the entries of an ordered map keyed by a DCPS
+ * data type.
+ *
+ * The map keeps owning the keys and stays in use for ordered traversal,
+ * the index stores map iterators in an open addressed table so a lookup
+ * costs one key hash and (usually) one key comparison instead of a
+ * comparison per level of the map's tree.  Until the map holds
+ * @a MinSize entries the index stays empty and find() falls back to the
+ * map's own lookup.
+ *
+ * Hash is the generated <Type>_OpenDDS_KeyHash and Less the generated
+ * <Type>_OpenDDS_KeyLessThan.  The index must be told about every insert
+ * into the map and every erase from it, before the erase.
+ */
+template <typename Map, typename Hash, typename Less, size_t MinSize = 32>
+class KeyHashIndex {
+public:
+  typedef typename Map::key_type key_type;
+  typedef typename Map::iterator iterator;
+
+  explicit KeyHashIndex(Map& map)
+    : map_(map)
+    , size_(0)
+    , mask_(0)
+  {}
+
+  iterator find(const key_type& key) const
+  {
+    if (slots_.empty()) {
+      return map_.find(key);
+    }
+
+    const ACE_UINT32 hash = hash_(key);
+    for (size_t i = hash & mask_; slots_[i].used_; i = (i + 1) & mask_) {
+      if (slots_[i].hash_ == hash && equal(slots_[i].it_->first, key)) {
+        return slots_[i].it_;
+      }
+    }
+    return map_.end();
+  }
+
+  /// @a it was just inserted into the map.
+  void insert(iterator it)
+  {
+    if (slots_.empty()) {
+      if (map_.size() >= MinSize) {
+        rebuild(MinSize * 4);
+      }
+      return;
+    }
+
+    if ((size_ + 1) * 2 > slots_.size()) {
+      rebuild(slots_.size() * 2);
+      return;
+    }
+    place(it, hash_(it->first));
+  }
+
+  /// @a it is about to be erased from the map.
+  void erase(iterator it)
+  {
+    if (slots_.empty()) {
+      return;
+    }
+
+    size_t i = hash_(it->first) & mask_;
+    while (slots_[i].used_ && slots_[i].it_ != it) {
+      i = (i + 1) & mask_;
+    }
+    if (!slots_[i].used_) {
+      return;
+    }
+
+    // Shift back the following entries of the run that could have used
+    // slot i, so that lookups never stop early at a hole.
+    for (size_t j = (i + 1) & mask_; slots_[j].used_; j = (j + 1) & mask_) {
+      const size_t home = slots_[j].hash_ & mask_;
+      const bool stays = (i <= j) ? (i < home && home <= j)
+                                  : (i < home || home <= j);
+      if (!stays) {
+        slots_[i] = slots_[j];
+        i = j;
+      }
+    }
+    slots_[i].used_ = false;
+    --size_;
+  }
+
+  void clear()
+  {
+    slots_.clear();
+    size_ = 0;
+    mask_ = 0;
+  }
+
+private:
+  struct Slot {
+    Slot() : hash_(0), used_(false) {}
+    iterator it_;
+    ACE_UINT32 hash_;
+    bool used_;
+  };
+
+  bool equal(const key_type& a, const key_type& b) const
+  {
+    return !less_(a, b) && !less_(b, a);
+  }
+
+  void place(iterator it, ACE_UINT32 hash)
+  {
+    size_t i = hash & mask_;
+    while (slots_[i].used_) {
+      i = (i + 1) & mask_;
+    }
+    slots_[i].it_ = it;
+    slots_[i].hash_ = hash;
+    slots_[i].used_ = true;
+    ++size_;
+  }
+
+  /// Size the table for at least @a capacity slots (a power of 2) and
+  /// index every entry of the map.
+  void rebuild(size_t capacity)
+  {
+    size_t slots = 1;
+    while (slots < capacity || slots < map_.size() * 2) {
+      slots <<= 1;
+    }
+    slots_.assign(slots, Slot());
+    mask_ = slots - 1;
+    size_ = 0;
+    for (iterator it = map_.begin(); it != map_.end(); ++it) {
+      place(it, hash_(it->first));
+    }
+  }
+
+  Map& map_;
+  Hash hash_;
+  Less less_;
+  OPENDDS_VECTOR(Slot) slots_;
+  size_t size_;
+  size_t mask_;
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_KEYHASHINDEX_T_H */
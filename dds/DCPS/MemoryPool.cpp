@@ -372,6 +372,22 @@ MemoryPool::pool_alloc(size_t size)
   return block;
 }
 
+size_t
+MemoryPool::alloc_size(void* ptr) const
+{
+#if defined(WITH_VALGRIND)
+  VALGRIND_DISABLE_ADDR_ERROR_REPORTING_IN_RANGE(pool_ptr_, pool_size_);
+#endif
+
+  const size_t size = (reinterpret_cast<AllocHeader*>(ptr) - 1)->size();
+
+#if defined(WITH_VALGRIND)
+  VALGRIND_ENABLE_ADDR_ERROR_REPORTING_IN_RANGE(pool_ptr_, pool_size_);
+#endif
+
+  return size;
+}
+
 bool
 MemoryPool::pool_free(void* ptr)
 {
@@ -176,6 +176,10 @@ public:
    */
   bool pool_free(void* ptr);
 
+  /** Size of the buffer of an allocation from this pool, at least the size
+      that was requested */
+  size_t alloc_size(void* ptr) const;
+
   /** Low water mark of maximum available bytes for an allocation */
   size_t lwm_free_bytes() const;
 
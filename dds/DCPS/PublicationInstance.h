@@ -13,6 +13,8 @@
 #include "DataSampleElement.h"
 #include "dds/DCPS/PoolAllocationBase.h"
 #include "ace/Synch_Traits.h"
+#include "ace/Atomic_Op.h"
+#include "ace/Thread_Mutex.h"
 #include "dds/DCPS/RcObject.h"
 #include "dds/DCPS/unique_ptr.h"
 
@@ -64,7 +66,9 @@ struct OpenDDS_Dcps_Export PublicationInstance  : public RcObject {
   InstanceDataSampleList   samples_;
 
   /// The flag to indicate whether the instance is unregistered.
-  bool             unregistered_;
+  /// Set while holding the writer's lock, but read without it when a
+  /// typed writer checks that an instance it writes is still registered.
+  ACE_Atomic_Op<ACE_Thread_Mutex, bool> unregistered_;
 
   /// The instance handle for the registered object
   DDS::InstanceHandle_t instance_handle_;
@@ -19,6 +19,7 @@
 #pragma once
 #endif /* ACE_LACKS_PRAGMA_ONCE */
 
+#include <algorithm>
 #include <vector>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -76,6 +77,43 @@ public:
     return evaluator_.eval(s, query_parameters_);
   }
 
+  /**
+   * Sets selected[i] to 1 if samples[i] matches the query, 0 otherwise,
+   * evaluating the query for all the samples at once (see
+   * FilterEvaluator::eval_batch()).  key_only[i] is 1 if samples[i] only
+   * has key fields.
+   */
+  template<typename Sample>
+  void filter(const void* const* samples, const unsigned char* key_only,
+              size_t count, unsigned char* selected) const
+  {
+    std::fill(selected, selected + count, 0);
+    ACE_GUARD(ACE_Recursive_Thread_Mutex, guard, lock_);
+    const MetaStruct& meta = getMetaStruct<Sample>();
+    if (!evaluator_.has_non_key_fields(meta)) {
+      evaluator_.eval_batch(samples, count, meta, query_parameters_, selected);
+      return;
+    }
+    // As in filter() above, samples with only key fields don't match.
+    OPENDDS_VECTOR(const void*) full;
+    OPENDDS_VECTOR(size_t) positions;
+    for (size_t i = 0; i < count; ++i) {
+      if (!key_only[i]) {
+        full.push_back(samples[i]);
+        positions.push_back(i);
+      }
+    }
+    if (full.empty()) {
+      return;
+    }
+    OPENDDS_VECTOR(unsigned char) matched(full.size());
+    evaluator_.eval_batch(&full[0], full.size(), meta, query_parameters_,
+                          &matched[0]);
+    for (size_t i = 0; i < positions.size(); ++i) {
+      selected[positions[i]] = matched[i];
+    }
+  }
+
 private:
   CORBA::String_var query_expression_;
   DDS::StringSeq query_parameters_;
@@ -691,11 +691,13 @@ Spdp::handle_handshake_message(const DDS::Security::ParticipantStatelessMessage&
       }
       dp.has_last_stateless_msg_ = false;
       dp.auth_state_ = DCPS::AS_AUTHENTICATED;
+      handshake_completed(src_participant, dp);
       match_authenticated(src_participant, dp);
     } else if (vr == DDS::Security::VALIDATION_OK) {
       // Theoretically, this shouldn't happen unless handshakes can involve fewer than 3 messages
       dp.has_last_stateless_msg_ = false;
       dp.auth_state_ = DCPS::AS_AUTHENTICATED;
+      handshake_completed(src_participant, dp);
       match_authenticated(src_participant, dp);
     }
   }
@@ -742,10 +744,12 @@ Spdp::handle_handshake_message(const DDS::Security::ParticipantStatelessMessage&
       }
       dp.has_last_stateless_msg_ = false;
       dp.auth_state_ = DCPS::AS_AUTHENTICATED;
+      handshake_completed(src_participant, dp);
       match_authenticated(src_participant, dp);
     } else if (vr == DDS::Security::VALIDATION_OK) {
       dp.has_last_stateless_msg_ = false;
       dp.auth_state_ = DCPS::AS_AUTHENTICATED;
+      handshake_completed(src_participant, dp);
       match_authenticated(src_participant, dp);
     }
   }
@@ -787,6 +791,7 @@ Spdp::check_auth_states(const ACE_Time_Value& tv) {
     DiscoveredParticipantIter pit = participants_.find(*it);
     if (pit != participants_.end()) {
       ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) DEBUG: Spdp::check_auth_states()      - Removing discovered participant due to authentication timeout: %C\n"), std::string(DCPS::GuidConverter(*it)).c_str()));
+      ++handshake_stats_.timed_out;
       if (participant_sec_attr_.allow_unauthenticated_participants == false) {
         remove_discovered_participant(pit);
       } else {
@@ -933,6 +938,25 @@ Spdp::match_authenticated(const DCPS::RepoId& guid, DiscoveredParticipant& dp)
   return true;
 }
 
+void
+Spdp::handshake_completed(const DCPS::RepoId& guid, const DiscoveredParticipant& dp)
+{
+  const ACE_Time_Value latency = ACE_OS::gettimeofday() - dp.auth_started_time_;
+  ++handshake_stats_.completed;
+  handshake_stats_.total_latency += latency;
+  if (latency > handshake_stats_.max_latency) {
+    handshake_stats_.max_latency = latency;
+  }
+
+  if (DCPS::DCPS_debug_level > 1) {
+    ACE_DEBUG((LM_DEBUG, ACE_TEXT("(%P|%t) Spdp::handshake_completed - ")
+      ACE_TEXT("authenticated %C in %d ms, %B handshakes averaging %d ms\n"),
+      std::string(DCPS::GuidConverter(guid)).c_str(), int(latency.msec()),
+      handshake_stats_.completed,
+      int(handshake_stats_.total_latency.msec() / handshake_stats_.completed)));
+  }
+}
+
 void
 Spdp::attempt_authentication(const DCPS::RepoId& guid, DiscoveredParticipant& dp)
 {
@@ -1871,6 +1895,13 @@ Spdp::lookup_participant_auth_state(const DCPS::RepoId& id) const
   }
   return result;
 }
+
+Spdp::HandshakeStats
+Spdp::handshake_stats() const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, g, lock_, HandshakeStats());
+  return handshake_stats_;
+}
 #endif
 
 }
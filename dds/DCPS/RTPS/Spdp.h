@@ -116,6 +116,19 @@ public:
   DDS::Security::PermissionsHandle lookup_participant_permissions(const DCPS::RepoId& id) const;
 
   DCPS::AuthState lookup_participant_auth_state(const DCPS::RepoId& id) const;
+
+  /// Authentication handshakes with remote participants, timed from the
+  /// first attempt to authenticate until the handshake completes.
+  struct HandshakeStats {
+    HandshakeStats() : completed(0), timed_out(0) {}
+
+    size_t completed;
+    size_t timed_out;
+    ACE_Time_Value total_latency;
+    ACE_Time_Value max_latency;
+  };
+
+  HandshakeStats handshake_stats() const;
 #endif
 
 protected:
@@ -152,6 +165,7 @@ private:
 #ifdef OPENDDS_SECURITY
   bool match_authenticated(const DCPS::RepoId& guid, DiscoveredParticipant& dp);
   void attempt_authentication(const DCPS::RepoId& guid, DiscoveredParticipant& dp);
+  void handshake_completed(const DCPS::RepoId& guid, const DiscoveredParticipant& dp);
 #endif
 
 #ifndef DDS_HAS_MINIMUM_BIT
@@ -215,6 +229,8 @@ private:
   DDS::Security::ParticipantCryptoTokenSeq crypto_tokens_;
 
   DDS::Security::ParticipantSecurityAttributes participant_sec_attr_;
+
+  HandshakeStats handshake_stats_;
 #endif
 };
 
@@ -34,6 +34,7 @@ RakeResults<SampleSeq>::RakeResults(DataReaderImpl* reader,
   , max_samples_(max_samples)
 #ifndef OPENDDS_NO_QUERY_CONDITION
   , cond_(cond)
+  , qci_(0)
 #endif
   , oper_(oper)
   , do_sort_(false)
@@ -42,14 +43,14 @@ RakeResults<SampleSeq>::RakeResults(DataReaderImpl* reader,
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
   if (cond_) {
-    const QueryConditionImpl* qci = dynamic_cast<QueryConditionImpl*>(cond_);
-    if (!qci) {
+    qci_ = dynamic_cast<QueryConditionImpl*>(cond_);
+    if (!qci_) {
       ACE_ERROR((LM_DEBUG, ACE_TEXT("(%P|%t) ERROR: RakeResults(): ")
         ACE_TEXT("failed to obtain QueryConditionImpl\n")));
       return;
     }
-    do_filter_ = qci->hasFilter();
-    std::vector<OPENDDS_STRING> order_bys = qci->getOrderBys();
+    do_filter_ = qci_->hasFilter();
+    std::vector<OPENDDS_STRING> order_bys = qci_->getOrderBys();
     do_sort_ = order_bys.size() > 0;
 
     if (do_sort_) {
@@ -88,36 +89,72 @@ bool RakeResults<SampleSeq>::insert_sample(ReceivedDataElement* sample,
 #ifndef OPENDDS_NO_QUERY_CONDITION
 
   if (do_filter_) {
-    const QueryConditionImpl* qci = dynamic_cast<QueryConditionImpl*>(cond_);
-    typedef typename SampleSeq::value_type VT;
-    const VT* typed_sample = static_cast<VT*>(sample->registered_data_);
-    if (!qci || !typed_sample || !qci->filter(*typed_sample, !sample->valid_data_)) {
+    if (!sample->registered_data_) {
       return false;
     }
+    // The query is evaluated for all the candidates in copy_to_user().
+    RakeData rd = {sample, instance, index_in_instance};
+    candidates_.push_back(rd);
+    return true;
   }
 
 #endif
 
+  RakeData rd = {sample, instance, index_in_instance};
+  return insert_i(rd);
+}
+
+template <class SampleSeq>
+bool RakeResults<SampleSeq>::insert_i(const RakeData& rd)
+{
   if (do_sort_) {
     // N.B. Until a better heuristic is found, non-valid
     // samples are elided when sorting by QueryCondition.
 #ifndef OPENDDS_NO_QUERY_CONDITION
-    if (cond_ && !sample->registered_data_) return false;
+    if (cond_ && !rd.rde_->registered_data_) return false;
 #endif
 
-    RakeData rd = {sample, instance, index_in_instance};
     sorted_.insert(rd);
 
   } else {
     if (unsorted_.size() == max_samples_) return false;
 
-    RakeData rd = {sample, instance, index_in_instance};
     unsorted_.push_back(rd);
   }
 
   return true;
 }
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+template <class SampleSeq>
+void RakeResults<SampleSeq>::filter_candidates()
+{
+  const size_t count = candidates_.size();
+  if (count == 0) {
+    return;
+  }
+
+  OPENDDS_VECTOR(const void*) samples(count);
+  OPENDDS_VECTOR(unsigned char) key_only(count);
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] = candidates_[i].rde_->registered_data_;
+    key_only[i] = !candidates_[i].rde_->valid_data_;
+  }
+
+  OPENDDS_VECTOR(unsigned char) selected(count);
+  qci_->filter<typename SampleSeq::value_type>(&samples[0], &key_only[0],
+                                               count, &selected[0]);
+
+  // In the order they were found, so max_samples applies as it would have.
+  for (size_t i = 0; i < count; ++i) {
+    if (selected[i]) {
+      insert_i(candidates_[i]);
+    }
+  }
+  candidates_.clear();
+}
+#endif
+
 template <class SampleSeq>
 template <class FwdIter>
 bool RakeResults<SampleSeq>::copy_into(FwdIter iter, FwdIter end,
@@ -227,6 +264,10 @@ bool RakeResults<SampleSeq>::copy_into(FwdIter iter, FwdIter end,
 template <class SampleSeq>
 bool RakeResults<SampleSeq>::copy_to_user()
 {
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  filter_candidates();
+#endif
+
   typename SampleSeq::PrivateMemberAccess received_data_p(received_data_);
 
   if (do_sort_) {
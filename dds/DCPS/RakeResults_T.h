@@ -24,6 +24,8 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+class QueryConditionImpl;
+
 enum Operation_t { DDS_OPERATION_READ, DDS_OPERATION_TAKE };
 
 /// Rake is an abbreviation for "read or take".  This class manages the
@@ -44,13 +46,20 @@ public:
 
   /// Returns false if the sample will definitely not be part of the
   /// resulting dataset, however if this returns true it still may be
-  /// excluded (due to sorting and max_samples).
+  /// excluded (due to the query, sorting and max_samples).
   bool insert_sample(ReceivedDataElement* sample, SubscriptionInstance_rch i,
                      size_t index_in_instance);
 
   bool copy_to_user();
 
 private:
+  bool insert_i(const RakeData& rd);
+
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  /// Inserts the candidates_ that match the query.
+  void filter_candidates();
+#endif
+
   template <class FwdIter>
   bool copy_into(FwdIter begin, FwdIter end,
                  typename SampleSeq::PrivateMemberAccess& received_data_p);
@@ -64,6 +73,7 @@ private:
   CORBA::ULong max_samples_;
 #ifndef OPENDDS_NO_QUERY_CONDITION
   DDS::QueryCondition_ptr cond_;
+  const QueryConditionImpl* qci_;
 #endif
   Operation_t oper_;
 
@@ -96,6 +106,11 @@ private:
   // Contains data for all other use cases
   OPENDDS_VECTOR(RakeData) unsorted_;
 
+#ifndef OPENDDS_NO_QUERY_CONDITION
+  // Samples to filter with the query all at once before they're inserted
+  OPENDDS_VECTOR(RakeData) candidates_;
+#endif
+
   // data structures used by copy_into()
   typedef OPENDDS_VECTOR(CORBA::ULong) IndexList;
   struct InstanceData {
@@ -8,6 +8,7 @@
 
 #include "dds/Versioned_Namespace.h"
 #include <cassert>
+#include <utility>
 #include "unique_ptr.h"
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -59,6 +60,52 @@ public:
     this->bump_up();
   }
 
+  // Moving a handle transfers its reference without touching the count.
+#ifdef ACE_HAS_CPP11
+  RcHandle(RcHandle&& b)
+    : ptr_(b._retn())
+  {
+  }
+
+  template <typename U>
+  RcHandle(RcHandle<U>&& b)
+    : ptr_(b._retn())
+  {
+  }
+
+  RcHandle& operator=(RcHandle&& b)
+  {
+    RcHandle tmp(std::move(b));
+    swap(tmp);
+    return *this;
+  }
+
+  template <typename U>
+  RcHandle& operator=(RcHandle<U>&& b)
+  {
+    RcHandle tmp(std::move(b));
+    swap(tmp);
+    return *this;
+  }
+#elif !defined __SUNPRO_CC
+  typedef rv<RcHandle>& rv_reference;
+
+  RcHandle(rv_reference b)
+    : ptr_(b._retn())
+  {
+  }
+
+  RcHandle& operator=(rv_reference b)
+  {
+    RcHandle tmp(b);
+    swap(tmp);
+    return *this;
+  }
+#else
+  // move() copies the handle.
+  typedef const RcHandle& rv_reference;
+#endif
+
   ~RcHandle()
   {
     this->bump_down();
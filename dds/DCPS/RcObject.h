@@ -9,45 +9,66 @@
 #include "dds/Versioned_Namespace.h"
 #include "ace/Atomic_Op.h"
 #include "ace/Synch_Traits.h"
+#include "dds/DCPS/AtomicCounter.h"
 #include "dds/DCPS/PoolAllocationBase.h"
 #include "RcHandle_T.h"
 
+#ifdef OPENDDS_RCOBJECT_STATS
+#include "dds/DCPS/dcps_export.h"
+#endif
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
+#ifdef OPENDDS_RCOBJECT_STATS
+  /// Number of _add_ref() and _remove_ref() calls of all RcObjects, to
+  /// measure the reference counting done by a piece of code.
+  extern OpenDDS_Dcps_Export AtomicCounter rc_object_ops;
+#  define OPENDDS_RCOBJECT_COUNT_OP() rc_object_ops.increment()
+#else
+#  define OPENDDS_RCOBJECT_COUNT_OP()
+#endif
+
   class RcObject;
 
+  /// Holds the reference count of an RcObject, and outlives it while
+  /// there are WeakRcHandles to it, so they can check if it's still there.
   class WeakObject : public PoolAllocationBase
   {
   public:
     WeakObject(RcObject* ptr)
       : ref_count_(1)
+      , object_ref_count_(1)
       , ptr_(ptr)
-      , expired_(false)
     {
     }
 
     void _add_ref() {
-      ++this->ref_count_;
+      this->ref_count_.increment();
     }
 
     void _remove_ref(){
-      const long new_count = --this->ref_count_;
+      const long new_count = this->ref_count_.decrement();
 
       if (new_count == 0) {
         delete this;
       }
     }
 
+    /// Returns the object with its reference count incremented, or null if
+    /// it was deleted.
     RcObject* lock();
-    bool set_expire();
+
   private:
-    ACE_Atomic_Op<ACE_SYNCH_MUTEX, long> ref_count_;
-    ACE_SYNCH_MUTEX mx_;
+    friend class RcObject;
+
+    /// References to this, including the one from the RcObject.
+    AtomicCounter ref_count_;
+    /// References to the RcObject.
+    AtomicCounter object_ref_count_;
     RcObject* const ptr_;
-    bool expired_;
   };
 
   class RcObject : public PoolAllocationBase {
@@ -58,19 +79,21 @@ namespace DCPS {
     }
 
     virtual void _add_ref() {
-      ++this->ref_count_;
+      OPENDDS_RCOBJECT_COUNT_OP();
+      this->weak_object_->object_ref_count_.increment();
     }
 
     virtual void _remove_ref() {
-      const long new_count = --this->ref_count_;
-      if (new_count == 0 && weak_object_->set_expire()) {
+      OPENDDS_RCOBJECT_COUNT_OP();
+      // A WeakRcHandle can't take a reference once the count is 0.
+      if (this->weak_object_->object_ref_count_.decrement() == 0) {
         delete this;
       }
     }
 
     /// This accessor is purely for debugging purposes
     long ref_count() const {
-      return this->ref_count_.value();
+      return this->weak_object_->object_ref_count_.value();
     }
 
     WeakObject*
@@ -82,15 +105,13 @@ namespace DCPS {
   protected:
 
     RcObject()
-      : ref_count_(1)
-      , weak_object_( new WeakObject(this) )
+      : weak_object_( new WeakObject(this) )
     {}
 
 
   private:
 
-    ACE_Atomic_Op<ACE_SYNCH_MUTEX, long> ref_count_;
-    WeakObject*  weak_object_;
+    WeakObject* const weak_object_;
 
     RcObject(const RcObject&);
     RcObject& operator=(const RcObject&);
@@ -100,24 +121,13 @@ namespace DCPS {
   inline RcObject*
   WeakObject::lock()
   {
-    ACE_Guard<ACE_SYNCH_MUTEX> guard(mx_);
-    if (! expired_) {
-      ptr_->_add_ref();
+    if (this->object_ref_count_.increment_if_nonzero()) {
+      OPENDDS_RCOBJECT_COUNT_OP();
       return ptr_;
     }
     return 0;
   }
 
-  inline bool
-  WeakObject::set_expire()
-  {
-    ACE_Guard<ACE_SYNCH_MUTEX> guard(mx_);
-    if (!expired_ && ptr_->ref_count() == 0) {
-      expired_ = true;
-    }
-    return expired_;
-  }
-
   template <typename T>
   class WeakRcHandle
   {
@@ -141,6 +151,19 @@ namespace DCPS {
         weak_object_->_add_ref();
     }
 
+#ifdef ACE_HAS_CPP11
+    WeakRcHandle(WeakRcHandle&& other)
+    : weak_object_(other.weak_object_){
+      other.weak_object_ = 0;
+    }
+
+    WeakRcHandle& operator = (WeakRcHandle&& other) {
+      WeakRcHandle tmp(std::move(other));
+      std::swap(weak_object_, tmp.weak_object_);
+      return *this;
+    }
+#endif
+
     ~WeakRcHandle(){
       if (weak_object_)
         weak_object_->_remove_ref();
@@ -7,6 +7,7 @@
 
 #include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
 #include "ReplayerImpl.h"
+#include "AtomicDataBlock.h"
 #include "FeatureDisabledQosCheck.h"
 #include "DomainParticipantImpl.h"
 #include "PublisherImpl.h"
@@ -1056,22 +1057,15 @@ ReplayerImpl::create_sample_data_message(Message_Block_Ptr   data,
   // header_data.publication_id_ = publication_id_;
   // header_data.publisher_id_ = this->publisher_servant_->publisher_id_;
   size_t max_marshaled_size = header_data.max_marshaled_size();
-  ACE_Message_Block* tmp;
-  ACE_NEW_MALLOC_RETURN(tmp,
-                        static_cast<ACE_Message_Block*>(
-                          mb_allocator_->malloc(sizeof(ACE_Message_Block))),
-                        ACE_Message_Block(max_marshaled_size,
-                                          ACE_Message_Block::MB_DATA,
-                                          data.release(),   //cont
-                                          0,   //data
-                                          header_allocator_.get(),   //alloc_strategy
-                                          0,   //locking_strategy
-                                          ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
-                                          ACE_Time_Value::zero,
-                                          ACE_Time_Value::max_time,
-                                          db_allocator_.get(),
-                                          mb_allocator_.get()),
-                        DDS::RETCODE_ERROR);
+  ACE_Message_Block* const tmp =
+    AtomicDataBlock::make_message_block(max_marshaled_size,
+                                        data.release(),   //cont
+                                        header_allocator_.get(),   //alloc_strategy
+                                        db_allocator_.get(),
+                                        mb_allocator_.get());
+  if (!tmp) {
+    return DDS::RETCODE_ERROR;
+  }
   message.reset(tmp);
   *message << header_data;
   return DDS::RETCODE_OK;
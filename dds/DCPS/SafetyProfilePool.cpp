@@ -8,29 +8,340 @@
 #include "DCPS/DdsDcps_pch.h"  ////Only the _pch include should start with DCPS/
 #include "SafetyProfilePool.h"
 #include "dds/DCPS/debug.h"
+#include <new>
 #include <stdexcept>
 
 #ifdef OPENDDS_SAFETY_PROFILE
 namespace OpenDDS {  namespace DCPS {
 
+namespace {
+
+/// Sizes of the blocks kept in the thread magazines.
+const size_t size_classes[] = {
+  16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+/// Smallest size class that holds @a size bytes, or n if there is none.
+unsigned int alloc_class(size_t size, unsigned int n)
+{
+  for (unsigned int i = 0; i < n; ++i) {
+    if (size <= size_classes[i]) {
+      return i;
+    }
+  }
+  return n;
+}
+
+/// Largest size class a block of @a size bytes can be used for, or n if the
+/// block is too small or large to be kept by a thread.
+unsigned int block_class(size_t size, unsigned int n)
+{
+  if (size < size_classes[0] || size >= 2 * size_classes[n - 1]) {
+    return n;
+  }
+  unsigned int i = n - 1;
+  while (size < size_classes[i]) {
+    --i;
+  }
+  return i;
+}
+
+/// Holds the lock of the MemoryPool, counting the times another thread
+/// had it.
+class PoolGuard {
+public:
+  PoolGuard(ACE_Thread_Mutex& lock, SafetyProfilePool::Stats& stats)
+    : lock_(lock)
+    , locked_(lock.tryacquire() == 0)
+  {
+    if (!locked_) {
+      locked_ = lock.acquire() == 0;
+      if (locked_) {
+        ++stats.contended_;
+      }
+    }
+    if (locked_) {
+      ++stats.locks_;
+    }
+  }
+
+  ~PoolGuard()
+  {
+    if (locked_) {
+      lock_.release();
+    }
+  }
+
+  bool locked() const { return locked_; }
+
+private:
+  ACE_Thread_Mutex& lock_;
+  bool locked_;
+};
+
+}
+
 SafetyProfilePool::SafetyProfilePool()
 : main_pool_(0)
+, magazine_size_(0)
+, lwm_free_bytes_(0)
 {
+  std::memset(&stats_, 0, sizeof stats_);
 }
 
 SafetyProfilePool::~SafetyProfilePool()
 {
+  if (magazine_size_) {
+    ACE_OS::thr_keyfree(cache_key_);
+  }
   // Never delete, because this is always a SAFETY_PROFILE build
   //delete main_pool_;
 }
 
 void
-SafetyProfilePool::configure_pool(size_t size, size_t granularity)
+SafetyProfilePool::configure_pool(size_t size, size_t granularity, size_t magazine_size)
 {
   ACE_GUARD(ACE_Thread_Mutex, lock, lock_);
 
   if (main_pool_ == NULL) {
     main_pool_ = new MemoryPool(size, granularity);
+    lwm_free_bytes_ = main_pool_->lwm_free_bytes();
+    if (magazine_size
+        && ACE_OS::thr_keycreate(&cache_key_,
+                                 &SafetyProfilePool::release_thread_cache) == 0) {
+      magazine_size_ = magazine_size;
+    }
+  }
+}
+
+void*
+SafetyProfilePool::malloc(std::size_t size)
+{
+  if (magazine_size_) {
+    const unsigned int sc = alloc_class(size, SIZE_CLASSES);
+    if (sc < SIZE_CLASSES) {
+      ThreadCache* const cache = thread_cache();
+      void* const block = cache ? cache->heads_[sc] : 0;
+      if (block) {
+        cache->heads_[sc] = *static_cast<void**>(block);
+        --cache->counts_[sc];
+        cache->bytes_ -= main_pool_->alloc_size(block);
+        ++cache->hits_;
+        return block;
+      }
+      return refill(cache, sc);
+    }
+  }
+
+  PoolGuard guard(lock_, stats_);
+  if (!guard.locked()) {
+    return 0;
+  }
+  void* const block = pool_alloc(size);
+  if (!block) {
+    exhausted();
+  }
+  return block;
+}
+
+void
+SafetyProfilePool::free(void* ptr)
+{
+  if (magazine_size_ && ptr && main_pool_->includes(ptr)) {
+    const size_t bytes = main_pool_->alloc_size(ptr);
+    const unsigned int sc = block_class(bytes, SIZE_CLASSES);
+    ThreadCache* cache = sc < SIZE_CLASSES ? thread_cache() : 0;
+    if (sc < SIZE_CLASSES && (!cache || cache->counts_[sc] >= magazine_size_)) {
+      PoolGuard guard(lock_, stats_);
+      if (!guard.locked()) {
+        return;
+      }
+      if (!cache) {
+        cache = make_thread_cache();
+      }
+      if (!cache) {
+        main_pool_->pool_free(ptr);
+        return;
+      }
+      if (cache->counts_[sc] >= magazine_size_) {
+        drain(*cache, sc, (magazine_size_ + 1) / 2);
+      }
+    }
+    if (cache) {
+      *static_cast<void**>(ptr) = cache->heads_[sc];
+      cache->heads_[sc] = ptr;
+      ++cache->counts_[sc];
+      cache->bytes_ += bytes;
+      return;
+    }
+  }
+
+  PoolGuard guard(lock_, stats_);
+  if (guard.locked()) {
+    main_pool_->pool_free(ptr);
+  }
+}
+
+SafetyProfilePool::Stats
+SafetyProfilePool::stats() const
+{
+  Stats stats;
+  std::memset(&stats, 0, sizeof stats);
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, lock, lock_, stats);
+    stats = stats_;
+  }
+  const ThreadCache* const cache = magazine_size_ ? thread_cache() : 0;
+  if (cache) {
+    stats.hits_ += cache->hits_;
+    stats.cached_bytes_ += cache->bytes_ - cache->published_bytes_;
+  }
+  return stats;
+}
+
+SafetyProfilePool::ThreadCache*
+SafetyProfilePool::thread_cache() const
+{
+  void* cache = 0;
+  if (ACE_OS::thr_getspecific(cache_key_, &cache) != 0) {
+    return 0;
+  }
+  return static_cast<ThreadCache*>(cache);
+}
+
+SafetyProfilePool::ThreadCache*
+SafetyProfilePool::make_thread_cache()
+{
+  // Not allocated with new, the Safety Profile doesn't allow delete.
+  void* const mem = pool_alloc(sizeof(ThreadCache));
+  if (!mem) {
+    return 0;
+  }
+  ThreadCache* const cache = new (mem) ThreadCache(this);
+  if (ACE_OS::thr_setspecific(cache_key_, cache) != 0) {
+    main_pool_->pool_free(mem);
+    return 0;
+  }
+  return cache;
+}
+
+void
+SafetyProfilePool::release_thread_cache(void* arg)
+{
+  ThreadCache* const cache = static_cast<ThreadCache*>(arg);
+  SafetyProfilePool* const pool = cache->pool_;
+  PoolGuard guard(pool->lock_, pool->stats_);
+  if (guard.locked()) {
+    pool->drain_all(*cache);
+    pool->publish(*cache);
+    pool->main_pool_->pool_free(cache);
+  }
+}
+
+void*
+SafetyProfilePool::refill(ThreadCache* cache, unsigned int sc)
+{
+  PoolGuard guard(lock_, stats_);
+  if (!guard.locked()) {
+    return 0;
+  }
+  if (!cache) {
+    cache = make_thread_cache();
+  }
+  ++stats_.misses_;
+
+  const size_t size = size_classes[sc];
+  void* block = pool_alloc(size);
+  if (!block && cache) {
+    // The blocks kept by other threads can't be reached from here.
+    drain_all(*cache);
+    publish(*cache);
+    block = pool_alloc(size);
+  }
+  if (!block) {
+    exhausted();
+    return 0;
+  }
+  if (!cache) {
+    return block;
+  }
+
+  for (size_t i = 1; i < (magazine_size_ + 1) / 2; ++i) {
+    void* const extra = pool_alloc(size);
+    if (!extra) {
+      break;
+    }
+    *static_cast<void**>(extra) = cache->heads_[sc];
+    cache->heads_[sc] = extra;
+    ++cache->counts_[sc];
+    cache->bytes_ += main_pool_->alloc_size(extra);
+  }
+  publish(*cache);
+  return block;
+}
+
+void
+SafetyProfilePool::drain(ThreadCache& cache, unsigned int sc, size_t count)
+{
+  ++stats_.returns_;
+
+  for (size_t i = 0; i < count && cache.heads_[sc]; ++i) {
+    void* const block = cache.heads_[sc];
+    cache.heads_[sc] = *static_cast<void**>(block);
+    --cache.counts_[sc];
+    cache.bytes_ -= main_pool_->alloc_size(block);
+    main_pool_->pool_free(block);
+  }
+  publish(cache);
+}
+
+void
+SafetyProfilePool::drain_all(ThreadCache& cache)
+{
+  for (unsigned int sc = 0; sc < SIZE_CLASSES; ++sc) {
+    if (cache.heads_[sc]) {
+      drain(cache, sc, cache.counts_[sc]);
+    }
+  }
+}
+
+void
+SafetyProfilePool::publish(ThreadCache& cache)
+{
+  stats_.hits_ += cache.hits_;
+  cache.hits_ = 0;
+  stats_.cached_bytes_ -= cache.published_bytes_;
+  stats_.cached_bytes_ += cache.bytes_;
+  cache.published_bytes_ = cache.bytes_;
+}
+
+void*
+SafetyProfilePool::pool_alloc(size_t size)
+{
+  void* const block = main_pool_->pool_alloc(size);
+  if (main_pool_->lwm_free_bytes() < lwm_free_bytes_) {
+    lwm_free_bytes_ = main_pool_->lwm_free_bytes();
+    stats_.lwm_cached_bytes_ = stats_.cached_bytes_;
+  }
+  return block;
+}
+
+void
+SafetyProfilePool::exhausted()
+{
+  ++stats_.exhausted_;
+  stats_.exhausted_cached_bytes_ = stats_.cached_bytes_;
+}
+
+SafetyProfilePool::ThreadCache::ThreadCache(SafetyProfilePool* pool)
+: pool_(pool)
+, hits_(0)
+, bytes_(0)
+, published_bytes_(0)
+{
+  for (unsigned int sc = 0; sc < SIZE_CLASSES; ++sc) {
+    heads_[sc] = 0;
+    counts_[sc] = 0;
   }
 }
 
@@ -57,8 +368,21 @@ struct InstanceMaker {
   ~InstanceMaker() {
     if (DCPS_debug_level) {
       if (SafetyProfilePool::instance_->main_pool_) {
-        ACE_DEBUG((LM_INFO, "LWM: main pool: %d bytes\n",
-                   SafetyProfilePool::instance_->main_pool_->lwm_free_bytes()));
+        const SafetyProfilePool::Stats stats =
+          SafetyProfilePool::instance_->stats();
+        ACE_DEBUG((LM_INFO, "LWM: main pool: %d bytes, "
+                   "%B more free in thread magazines\n",
+                   SafetyProfilePool::instance_->main_pool_->lwm_free_bytes(),
+                   stats.lwm_cached_bytes_));
+        if (stats.exhausted_) {
+          ACE_DEBUG((LM_INFO, "main pool: exhausted %B times, "
+                     "%B bytes free in thread magazines the last time\n",
+                     stats.exhausted_, stats.exhausted_cached_bytes_));
+        }
+        ACE_DEBUG((LM_INFO, "main pool: magazine hits %B misses %B "
+                   "returns %B, lock taken %B times, contended %B\n",
+                   stats.hits_, stats.misses_, stats.returns_,
+                   stats.locks_, stats.contended_));
       }
     }
   }
@@ -13,6 +13,7 @@
 
 #ifdef OPENDDS_SAFETY_PROFILE
 #include "ace/Atomic_Op.h"
+#include "ace/OS_NS_Thread.h"
 #include "ace/Singleton.h"
 #include "dcps_export.h"
 #include "MemoryPool.h"
@@ -31,27 +32,52 @@ namespace DCPS {
 /// Saftey Profile disallows std::free() and the delete operators
 /// See PoolAllocator.h for a class that allows STL containers to use an
 /// instance of SafetyProfilePool managed by our Service_Participant singleton.
+///
+/// The MemoryPool is shared by all threads behind one lock.  If the pool is
+/// configured with a magazine size, each thread keeps up to that many free
+/// blocks of each size class (16 to 1024 bytes) and allocates from them
+/// without the lock.  A thread that runs out of blocks of a class takes
+/// half a magazine from the MemoryPool, and a thread with a full magazine
+/// gives half of it back, under one lock each time.  The blocks of a thread,
+/// and the magazines themselves, go back to the MemoryPool when it exits.
 class OpenDDS_Dcps_Export SafetyProfilePool : public ACE_Allocator
 {
   friend class SafetyProfilePoolTest;
 public:
+  /// Counters of the use of the pool, see stats().
+  struct Stats {
+    /// Allocations taken from a thread's magazine.
+    size_t hits_;
+    /// Allocations that refilled a thread's magazine.
+    size_t misses_;
+    /// Half magazines given back to the MemoryPool.
+    size_t returns_;
+    /// Times the MemoryPool's lock was taken.
+    size_t locks_;
+    /// Times the lock was held by another thread.
+    size_t contended_;
+    /// Bytes of the free blocks kept by threads, as of the last time each
+    /// thread took the lock.
+    size_t cached_bytes_;
+    /// cached_bytes_ when the MemoryPool reached its low water mark, the
+    /// threads kept that many more bytes free.
+    size_t lwm_cached_bytes_;
+    /// Allocations that failed because the MemoryPool was exhausted.
+    size_t exhausted_;
+    /// cached_bytes_ when the last of those failed.
+    size_t exhausted_cached_bytes_;
+  };
+
   SafetyProfilePool();
   ~SafetyProfilePool();
 
-  void configure_pool(size_t size, size_t granularity);
+  /// A @a magazine_size of 0 makes every allocation use the MemoryPool.
+  void configure_pool(size_t size, size_t granularity, size_t magazine_size = 0);
   void install();
 
-  void* malloc(std::size_t size)
-  {
-    ACE_GUARD_RETURN(ACE_Thread_Mutex, lock, lock_, 0);
-    return main_pool_->pool_alloc(size);
-  }
+  void* malloc(std::size_t size);
 
-  void free(void* ptr)
-  {
-    ACE_GUARD(ACE_Thread_Mutex, lock, lock_);
-    main_pool_->pool_free(ptr);
-  }
+  void free(void* ptr);
 
   void* calloc(std::size_t bytes, char init = '\0')
   {
@@ -81,12 +107,62 @@ public:
   /// Return a singleton instance of this class.
   static SafetyProfilePool* instance();
 
+  /// Counters since the pool was configured.  Hits of other threads are
+  /// only counted when they next take the lock.
+  Stats stats() const;
+
 private:
   SafetyProfilePool(const SafetyProfilePool&);
   SafetyProfilePool& operator=(const SafetyProfilePool&);
 
+  enum { SIZE_CLASSES = 13 };
+
+  /// The free blocks kept by a thread, linked through their first word.
+  /// Allocated from the MemoryPool.
+  class ThreadCache {
+  public:
+    explicit ThreadCache(SafetyProfilePool* pool);
+
+    SafetyProfilePool* const pool_;
+    void* heads_[SIZE_CLASSES];
+    size_t counts_[SIZE_CLASSES];
+    /// Hits not added to the pool's stats_ yet.
+    size_t hits_;
+    /// Bytes of the blocks in heads_.
+    size_t bytes_;
+    /// Part of bytes_ added to the pool's stats_.
+    size_t published_bytes_;
+  };
+
+  /// The cache of the calling thread, 0 if it doesn't have one yet.
+  ThreadCache* thread_cache() const;
+  /// Creates the cache of the calling thread, with lock_ held.
+  ThreadCache* make_thread_cache();
+  /// Gives the blocks of an exiting thread back, then its cache.
+  static void release_thread_cache(void* cache);
+  /// Allocates a block of size class @a sc, and adds more to @a cache,
+  /// which is created if it's 0.
+  void* refill(ThreadCache* cache, unsigned int sc);
+  /// Gives @a count blocks of size class @a sc back, with lock_ held.
+  void drain(ThreadCache& cache, unsigned int sc, size_t count);
+  /// Gives all blocks of @a cache back, with lock_ held.
+  void drain_all(ThreadCache& cache);
+  /// Adds the counters of @a cache to stats_, with lock_ held.
+  void publish(ThreadCache& cache);
+  /// Allocates from the MemoryPool, with lock_ held.
+  void* pool_alloc(size_t size);
+  /// Counts an allocation that failed, with lock_ held.
+  void exhausted();
+
   MemoryPool* main_pool_;
-  ACE_Thread_Mutex lock_;
+  mutable ACE_Thread_Mutex lock_;
+  size_t magazine_size_;
+  /// Protected by lock_.
+  Stats stats_;
+  /// Low water mark of the MemoryPool the last time it was checked.
+  size_t lwm_free_bytes_;
+  /// Holds the ThreadCache of each thread, valid if magazine_size_ isn't 0.
+  ACE_thread_key_t cache_key_;
   static SafetyProfilePool* instance_;
   friend class InstanceMaker;
 };
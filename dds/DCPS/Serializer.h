@@ -83,6 +83,11 @@ public:
   /// Reset alignment as if a new instance were created
   void reset_alignment();
 
+  /// True if align_r (align_w) to @a al bytes would not skip any padding,
+  /// which is always the case when alignment is disabled.
+  bool is_aligned_r(size_t al) const;
+  bool is_aligned_w(size_t al) const;
+
   /// Examine the state of the stream abstraction.
   bool good_bit() const;
 
@@ -208,6 +208,20 @@ Serializer::alignment() const
   return this->alignment_;
 }
 
+ACE_INLINE bool
+Serializer::is_aligned_r(size_t al) const
+{
+  return this->alignment_ == ALIGN_NONE || this->current_ == 0
+    || (al - ptrdiff_t(this->current_->rd_ptr()) + this->align_rshift_) % al == 0;
+}
+
+ACE_INLINE bool
+Serializer::is_aligned_w(size_t al) const
+{
+  return this->alignment_ == ALIGN_NONE || this->current_ == 0
+    || (al - ptrdiff_t(this->current_->wr_ptr()) + this->align_wshift_) % al == 0;
+}
+
 ACE_INLINE bool
 Serializer::good_bit() const
 {
@@ -137,6 +137,21 @@ static bool got_transport_debug_level = false;
 static bool got_pending_timeout = false;
 #ifndef OPENDDS_NO_PERSISTENCE_PROFILE
 static bool got_persistent_data_dir = false;
+static bool got_persistent_sync_samples = false;
+static bool got_persistent_sync_interval = false;
+
+/// DCPSPersistentSyncSamples and DCPSPersistentSyncInterval can't be
+/// negative, such a value is ignored.
+static bool valid_persistent_sync(const ACE_TCHAR* name, int value)
+{
+  if (value < 0) {
+    ACE_ERROR((LM_WARNING,
+               ACE_TEXT("(%P|%t) WARNING: ignoring negative %s value %d\n"),
+               name, value));
+    return false;
+  }
+  return true;
+}
 #endif
 static bool got_default_discovery = false;
 #ifndef DDS_DEFAULT_DISCOVERY_METHOD
@@ -184,6 +199,7 @@ Service_Participant::Service_Participant()
 #if defined OPENDDS_SAFETY_PROFILE && defined ACE_HAS_ALLOC_HOOKS
     pool_size_(1024*1024*16),
     pool_granularity_(8),
+    pool_magazine_size_(0),
 #endif
     scheduler_(-1),
     priority_min_(0),
@@ -191,6 +207,8 @@ Service_Participant::Service_Participant()
     publisher_content_filter_(true),
 #ifndef OPENDDS_NO_PERSISTENCE_PROFILE
     persistent_data_dir_(DEFAULT_PERSISTENT_DATA_DIR),
+    persistent_sync_samples_(0),
+    persistent_sync_interval_(ACE_Time_Value::zero),
 #endif
     pending_timeout_(ACE_Time_Value::zero),
     bidir_giop_(true),
@@ -276,6 +294,11 @@ Service_Participant::shutdown()
 
   #ifndef OPENDDS_NO_PERSISTENCE_PROFILE
       transient_data_cache_.reset();
+      if (persistent_data_cache_ && !persistent_data_cache_->flush()) {
+        ACE_ERROR((LM_ERROR,
+                   ACE_TEXT("(%P|%t) ERROR: Service_Participant::shutdown: ")
+                   ACE_TEXT("couldn't write all PERSISTENT data\n")));
+      }
       persistent_data_cache_.reset();
   #endif
 
@@ -519,6 +542,22 @@ Service_Participant::parse_args(int &argc, ACE_TCHAR *argv[])
       this->persistent_data_dir_ = ACE_TEXT_ALWAYS_CHAR(currentArg);
       arg_shifter.consume_arg();
       got_persistent_data_dir = true;
+
+    } else if ((currentArg = arg_shifter.get_the_parameter(ACE_TEXT("-DCPSPersistentSyncSamples"))) != 0) {
+      const int samples = ACE_OS::atoi(currentArg);
+      if (valid_persistent_sync(ACE_TEXT("DCPSPersistentSyncSamples"), samples)) {
+        this->persistent_sync_samples_ = samples;
+      }
+      arg_shifter.consume_arg();
+      got_persistent_sync_samples = true;
+
+    } else if ((currentArg = arg_shifter.get_the_parameter(ACE_TEXT("-DCPSPersistentSyncInterval"))) != 0) {
+      const int interval = ACE_OS::atoi(currentArg);
+      if (valid_persistent_sync(ACE_TEXT("DCPSPersistentSyncInterval"), interval)) {
+        this->persistent_sync_interval_.msec(interval);
+      }
+      arg_shifter.consume_arg();
+      got_persistent_sync_interval = true;
 #endif
 
     } else if ((currentArg = arg_shifter.get_the_parameter(ACE_TEXT("-DCPSPendingTimeout"))) != 0) {
@@ -1547,6 +1586,28 @@ Service_Participant::load_common_configuration(ACE_Configuration_Heap& cf,
       GET_CONFIG_TSTRING_VALUE(cf, sect, ACE_TEXT("DCPSPersistentDataDir"), value)
       this->persistent_data_dir_ = ACE_TEXT_ALWAYS_CHAR(value.c_str());
     }
+
+    if (got_persistent_sync_samples) {
+      ACE_DEBUG((LM_NOTICE,
+                 ACE_TEXT("(%P|%t) NOTICE: using DCPSPersistentSyncSamples value from command option (overrides value if it's in config file).\n")));
+    } else {
+      int samples = 0;
+      GET_CONFIG_VALUE(cf, sect, ACE_TEXT("DCPSPersistentSyncSamples"), samples, int)
+      if (valid_persistent_sync(ACE_TEXT("DCPSPersistentSyncSamples"), samples)) {
+        this->persistent_sync_samples_ = samples;
+      }
+    }
+
+    if (got_persistent_sync_interval) {
+      ACE_DEBUG((LM_NOTICE,
+                 ACE_TEXT("(%P|%t) NOTICE: using DCPSPersistentSyncInterval value from command option (overrides value if it's in config file).\n")));
+    } else {
+      int interval = 0;
+      GET_CONFIG_VALUE(cf, sect, ACE_TEXT("DCPSPersistentSyncInterval"), interval, int)
+      if (valid_persistent_sync(ACE_TEXT("DCPSPersistentSyncInterval"), interval)) {
+        this->persistent_sync_interval_.msec(interval);
+      }
+    }
 #endif
 
     if (got_pending_timeout) {
@@ -1641,6 +1702,7 @@ Service_Participant::load_common_configuration(ACE_Configuration_Heap& cf,
 #if defined OPENDDS_SAFETY_PROFILE && defined ACE_HAS_ALLOC_HOOKS
     GET_CONFIG_VALUE(cf, sect, ACE_TEXT("pool_size"), pool_size_, size_t)
     GET_CONFIG_VALUE(cf, sect, ACE_TEXT("pool_granularity"), pool_granularity_, size_t)
+    GET_CONFIG_VALUE(cf, sect, ACE_TEXT("pool_magazine_size"), pool_magazine_size_, size_t)
 #endif
 
     //
@@ -1839,7 +1901,8 @@ void
 Service_Participant::configure_pool()
 {
   if (pool_size_) {
-    SafetyProfilePool::instance()->configure_pool(pool_size_, pool_granularity_);
+    SafetyProfilePool::instance()->configure_pool(pool_size_, pool_granularity_,
+                                                  pool_magazine_size_);
     SafetyProfilePool::instance()->install();
   }
 }
@@ -1879,7 +1942,9 @@ Service_Participant::get_data_durability_cache(
       try {
         if (!this->persistent_data_cache_) {
           this->persistent_data_cache_.reset(new DataDurabilityCache(kind,
-                                                                     this->persistent_data_dir_));
+                                                                     this->persistent_data_dir_,
+                                                                     this->persistent_sync_samples_,
+                                                                     this->persistent_sync_interval_));
         }
 
       } catch (const std::exception& ex) {
@@ -575,6 +575,10 @@ private:
 
   /// Pool granularity from configuration file.
   size_t pool_granularity_;
+
+  /// Free blocks of each size a thread keeps, from configuration file.
+  /// 0, the default, disables the thread magazines.
+  size_t pool_magazine_size_;
 #endif
 
   /// Scheduling policy value used for setting thread priorities.
@@ -600,6 +604,15 @@ private:
   /// The @c PERSISTENT data durability directory.
   ACE_CString persistent_data_dir_;
 
+  /// Number of @c PERSISTENT samples after which the data written is
+  /// synced to storage, 0 to not sync based on the number of samples.
+  size_t persistent_sync_samples_;
+
+  /// Time after which the @c PERSISTENT data written is synced to
+  /// storage, zero to not sync based on time.  If both are 0, each batch
+  /// of samples written is synced.
+  ACE_Time_Value persistent_sync_interval_;
+
 #endif
 
   /// Number of seconds to wait on pending samples to be sent
@@ -0,0 +1,374 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+
+#include "Slab_Allocator.h"
+#include "debug.h"
+
+#include "ace/Guard_T.h"
+#include "ace/Log_Msg.h"
+#include "ace/Malloc_T.h"
+
+#if defined OPENDDS_SLAB_ALLOCATOR_MSVC
+#  include <intrin.h>
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+namespace {
+
+#if defined OPENDDS_SLAB_ALLOCATOR_GCC
+
+inline ACE_UINT64 load(const ACE_UINT64& value)
+{
+  return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+inline bool cas(ACE_UINT64& value, ACE_UINT64& expected, ACE_UINT64 desired)
+{
+  return __atomic_compare_exchange_n(&value, &expected, desired, true,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+inline ACE_UINT32 load(const ACE_UINT32& value)
+{
+  return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+
+inline void store(ACE_UINT32& value, ACE_UINT32 desired)
+{
+  __atomic_store_n(&value, desired, __ATOMIC_RELEASE);
+}
+
+inline long load(const long& value)
+{
+  return __atomic_load_n(&value, __ATOMIC_RELAXED);
+}
+
+inline long add(long& value, long delta)
+{
+  return __atomic_add_fetch(&value, delta, __ATOMIC_RELAXED);
+}
+
+inline bool cas(long& value, long& expected, long desired)
+{
+  return __atomic_compare_exchange_n(&value, &expected, desired, true,
+                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+#elif defined OPENDDS_SLAB_ALLOCATOR_MSVC
+
+inline ACE_UINT64 load(const ACE_UINT64& value)
+{
+  volatile __int64* const p =
+    reinterpret_cast<volatile __int64*>(const_cast<ACE_UINT64*>(&value));
+  return _InterlockedCompareExchange64(p, 0, 0);
+}
+
+inline bool cas(ACE_UINT64& value, ACE_UINT64& expected, ACE_UINT64 desired)
+{
+  const ACE_UINT64 prev = _InterlockedCompareExchange64(
+    reinterpret_cast<volatile __int64*>(&value), desired, expected);
+  if (prev == expected) {
+    return true;
+  }
+  expected = prev;
+  return false;
+}
+
+inline ACE_UINT32 load(const ACE_UINT32& value)
+{
+  return _InterlockedOr(
+    reinterpret_cast<volatile long*>(const_cast<ACE_UINT32*>(&value)), 0);
+}
+
+inline void store(ACE_UINT32& value, ACE_UINT32 desired)
+{
+  _InterlockedExchange(reinterpret_cast<volatile long*>(&value), desired);
+}
+
+inline long load(const long& value)
+{
+  return *const_cast<volatile long*>(&value);
+}
+
+inline long add(long& value, long delta)
+{
+  return _InterlockedExchangeAdd(&value, delta) + delta;
+}
+
+inline bool cas(long& value, long& expected, long desired)
+{
+  const long prev = _InterlockedCompareExchange(&value, desired, expected);
+  if (prev == expected) {
+    return true;
+  }
+  expected = prev;
+  return false;
+}
+
+#else
+
+// Without atomic builtins malloc() and free() hold the allocator's lock.
+
+inline ACE_UINT64 load(const ACE_UINT64& value) { return value; }
+
+inline bool cas(ACE_UINT64& value, ACE_UINT64&, ACE_UINT64 desired)
+{
+  value = desired;
+  return true;
+}
+
+inline ACE_UINT32 load(const ACE_UINT32& value) { return value; }
+
+inline void store(ACE_UINT32& value, ACE_UINT32 desired) { value = desired; }
+
+inline long load(const long& value) { return value; }
+
+inline long add(long& value, long delta) { return value += delta; }
+
+inline bool cas(long& value, long&, long desired)
+{
+  value = desired;
+  return true;
+}
+
+#endif
+
+}
+
+Dynamic_Slab_Allocator::Dynamic_Slab_Allocator(size_t n_chunks, size_t chunk_size)
+  : chunk_size_(ACE_MALLOC_ROUNDUP(chunk_size, ACE_MALLOC_ALIGN))
+  , first_slab_chunks_(n_chunks ? n_chunks : 1)
+  , head_(0)
+  , slab_count_(0)
+  , in_use_(0)
+  , high_water_(0)
+  , overflows_(0)
+{
+  ACE_UINT32 chunk = 0;
+  if (grow(chunk)) {
+    push(chunk, chunk);
+  }
+}
+
+Dynamic_Slab_Allocator::~Dynamic_Slab_Allocator()
+{
+  for (ACE_UINT32 slab = 0; slab < slab_count_; ++slab) {
+    ACE_Allocator::instance()->free(slabs_[slab]);
+  }
+}
+
+void*
+Dynamic_Slab_Allocator::malloc(size_t nbytes)
+{
+  if (nbytes > chunk_size_) {
+    return 0;
+  }
+
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+#endif
+
+  ACE_UINT32 index = pop();
+  if (index || grow(index)) {
+    count_alloc();
+    return chunk(index - 1);
+  }
+
+  void* const ptr = ACE_Allocator::instance()->malloc(chunk_size_);
+  if (ptr) {
+    count_alloc();
+    if (add(overflows_, 1) == 1 && DCPS_debug_level >= 2) {
+      ACE_DEBUG((LM_DEBUG,
+                 "(%P|%t) Dynamic_Slab_Allocator::malloc %@"
+                 " out of slabs, allocating from the heap\n", this));
+    }
+  }
+  return ptr;
+}
+
+void
+Dynamic_Slab_Allocator::free(void* ptr)
+{
+  if (!ptr) {
+    return;
+  }
+
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+#endif
+
+  add(in_use_, -1);
+
+  unsigned char* const p = static_cast<unsigned char*>(ptr);
+  const ACE_UINT32 slabs = load(slab_count_);
+  for (ACE_UINT32 slab = 0; slab < slabs; ++slab) {
+    const size_t first =
+      slab ? first_slab_chunks_ << (slab - 1) : 0;
+    const size_t count = slab ? first : first_slab_chunks_;
+    if (p >= slabs_[slab] && p < slabs_[slab] + count * chunk_size_) {
+      const ACE_UINT32 index =
+        static_cast<ACE_UINT32>(first + (p - slabs_[slab]) / chunk_size_);
+      push(index + 1, index + 1);
+      return;
+    }
+  }
+
+  ACE_Allocator::instance()->free(ptr);
+}
+
+size_t
+Dynamic_Slab_Allocator::slabs() const
+{
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+#endif
+  return load(slab_count_);
+}
+
+size_t
+Dynamic_Slab_Allocator::overflows() const
+{
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+#endif
+  return load(overflows_);
+}
+
+size_t
+Dynamic_Slab_Allocator::high_water() const
+{
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+#endif
+  return load(high_water_);
+}
+
+ACE_UINT32
+Dynamic_Slab_Allocator::pop()
+{
+  ACE_UINT64 head = load(head_);
+  while (const ACE_UINT32 top = static_cast<ACE_UINT32>(head)) {
+    const ACE_UINT64 next = load(*link(top - 1));
+    if (cas(head_, head, ((head >> 32) + 1) << 32 | next)) {
+      return top;
+    }
+  }
+  return 0;
+}
+
+void
+Dynamic_Slab_Allocator::push(ACE_UINT32 first, ACE_UINT32 last)
+{
+  ACE_UINT64 head = load(head_);
+  do {
+    store(*link(last - 1), static_cast<ACE_UINT32>(head));
+  } while (!cas(head_, head, ((head >> 32) + 1) << 32 | first));
+}
+
+bool
+Dynamic_Slab_Allocator::grow(ACE_UINT32& chunk)
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, grow_lock_, false);
+
+  // Another thread may have added a slab or freed chunks meanwhile.
+  chunk = pop();
+  if (chunk) {
+    return true;
+  }
+
+  const ACE_UINT32 slab = slab_count_;
+  if (slab == MAX_SLABS) {
+    return false;
+  }
+  const ACE_UINT64 first =
+    slab ? static_cast<ACE_UINT64>(first_slab_chunks_) << (slab - 1) : 0;
+  const ACE_UINT64 count = slab ? first : first_slab_chunks_;
+  // Indexes + 1 must fit in the lower half of head_.
+  if (first + count > 0xffffffff) {
+    return false;
+  }
+
+  const size_t size = static_cast<size_t>(count * (chunk_size_ + sizeof(ACE_UINT32)));
+  unsigned char* const mem =
+    static_cast<unsigned char*>(ACE_Allocator::instance()->malloc(size));
+  if (!mem) {
+    return false;
+  }
+
+  slabs_[slab] = mem;
+  ACE_UINT32* const links = reinterpret_cast<ACE_UINT32*>(mem + count * chunk_size_);
+  for (ACE_UINT32 i = 1; i + 1 < count; ++i) {
+    links[i] = static_cast<ACE_UINT32>(first + i + 2);
+  }
+  store(slab_count_, slab + 1);
+
+  chunk = static_cast<ACE_UINT32>(first + 1);
+  if (count > 1) {
+    push(chunk + 1, static_cast<ACE_UINT32>(first + count));
+  }
+
+  if (DCPS_debug_level >= 2) {
+    ACE_DEBUG((LM_DEBUG,
+               "(%P|%t) Dynamic_Slab_Allocator::grow %@"
+               " added slab %u with %Q chunks\n",
+               this, slab, count));
+  }
+  return true;
+}
+
+size_t
+Dynamic_Slab_Allocator::slab_of(ACE_UINT32 index, ACE_UINT32& first) const
+{
+  const ACE_UINT64 n = first_slab_chunks_;
+  if (index < n) {
+    first = 0;
+    return 0;
+  }
+  size_t slab = 1;
+  while (index >= n << slab) {
+    ++slab;
+  }
+  first = static_cast<ACE_UINT32>(n << (slab - 1));
+  return slab;
+}
+
+unsigned char*
+Dynamic_Slab_Allocator::chunk(ACE_UINT32 index) const
+{
+  ACE_UINT32 first;
+  const size_t slab = slab_of(index, first);
+  return slabs_[slab] + (index - first) * chunk_size_;
+}
+
+ACE_UINT32*
+Dynamic_Slab_Allocator::link(ACE_UINT32 index) const
+{
+  ACE_UINT32 first;
+  const size_t slab = slab_of(index, first);
+  const size_t count = slab ? first : first_slab_chunks_;
+  return reinterpret_cast<ACE_UINT32*>(slabs_[slab] + count * chunk_size_)
+    + (index - first);
+}
+
+void
+Dynamic_Slab_Allocator::count_alloc()
+{
+  const long in_use = add(in_use_, 1);
+  long high = load(high_water_);
+  while (in_use > high && !cas(high_water_, high, in_use)) {}
+}
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
@@ -0,0 +1,149 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_SLAB_ALLOCATOR_H
+#define OPENDDS_DCPS_SLAB_ALLOCATOR_H
+
+#include "dcps_export.h"
+#include "PoolAllocationBase.h"
+
+#include "ace/Malloc_Allocator.h"
+#include "ace/Thread_Mutex.h"
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+# pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+#if defined __clang__ || (defined __GNUC__ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#  define OPENDDS_SLAB_ALLOCATOR_GCC
+#elif defined _MSC_VER
+#  define OPENDDS_SLAB_ALLOCATOR_MSVC
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+/**
+* @class Dynamic_Slab_Allocator
+*
+* @brief A fixed-size allocator that grows by slabs of chunks when it runs
+*        out, instead of using the heap for each chunk.
+*
+* The first slab has @a n_chunks chunks of @a chunk_size bytes, each
+* following slab has as many chunks as all the slabs before it.  After 32
+* slabs (or if a slab can't be allocated) chunks come from the heap, like
+* Dynamic_Cached_Allocator_With_Overflow.  Slabs are only released when
+* the allocator is destroyed.
+*
+* The free chunks are a stack of chunk indexes updated with compare and
+* swap, with a tag that changes on each update so a thread that was
+* preempted in the middle of an update can't corrupt the stack.  The links
+* of the stack are kept next to the slab rather than in the free chunks.
+* Compilers without atomic builtins use a mutex instead.
+*/
+class OpenDDS_Dcps_Export Dynamic_Slab_Allocator
+  : public ACE_New_Allocator, public PoolAllocationBase {
+public:
+  Dynamic_Slab_Allocator(size_t n_chunks, size_t chunk_size);
+  ~Dynamic_Slab_Allocator();
+
+  /// Returns 0 if @a nbytes is larger than the chunk size.
+  void* malloc(size_t nbytes);
+
+  virtual void* calloc(size_t /* nbytes */,
+                       char /* initial_value */ = '\0') {
+    ACE_NOTSUP_RETURN(0);
+  }
+
+  virtual void* calloc(size_t /* n_elem */,
+                       size_t /* elem_size */,
+                       char /* initial_value */ = '\0') {
+    ACE_NOTSUP_RETURN(0);
+  }
+
+  void free(void* ptr);
+
+  size_t chunk_size() const { return chunk_size_; }
+
+  /// Number of slabs allocated, including the first.
+  size_t slabs() const;
+
+  /// Chunks that came from the heap because no slab could be added.
+  size_t overflows() const;
+
+  /// Most chunks in use at the same time.
+  size_t high_water() const;
+
+private:
+  Dynamic_Slab_Allocator(const Dynamic_Slab_Allocator&);
+  Dynamic_Slab_Allocator& operator=(const Dynamic_Slab_Allocator&);
+
+  enum { MAX_SLABS = 32 };
+
+  /// Takes a chunk off the free stack, returns its index + 1, or 0.
+  ACE_UINT32 pop();
+  /// Puts the chunks from @a first to @a last, linked already, on the free
+  /// stack.  Indexes + 1.
+  void push(ACE_UINT32 first, ACE_UINT32 last);
+  /// Adds a slab, or returns false if there can't be more.  Returns a
+  /// chunk of it, or one freed in the meantime, in @a chunk.
+  bool grow(ACE_UINT32& chunk);
+
+  /// Slab of chunk @a index, and the index of its first chunk.
+  size_t slab_of(ACE_UINT32 index, ACE_UINT32& first) const;
+  unsigned char* chunk(ACE_UINT32 index) const;
+  /// Link of the free stack from chunk @a index, index + 1 of the next.
+  ACE_UINT32* link(ACE_UINT32 index) const;
+
+  void count_alloc();
+
+  const size_t chunk_size_;
+  const size_t first_slab_chunks_;
+
+  /// Index + 1 of the top of the free stack in the lower half, changed
+  /// with each update of the stack in the upper half.
+  ACE_UINT64 head_;
+  /// Slabs allocated so far, read without a lock.
+  ACE_UINT32 slab_count_;
+  unsigned char* slabs_[MAX_SLABS];
+
+  long in_use_;
+  long high_water_;
+  long overflows_;
+
+  /// Serializes adding slabs.
+  ACE_Thread_Mutex grow_lock_;
+#if !defined OPENDDS_SLAB_ALLOCATOR_GCC && !defined OPENDDS_SLAB_ALLOCATOR_MSVC
+  mutable ACE_Thread_Mutex lock_;
+#endif
+};
+
+/**
+* @class Slab_Allocator
+*
+* @brief Dynamic_Slab_Allocator of chunks of sizeof(T).
+*/
+template <class T>
+class Slab_Allocator : public Dynamic_Slab_Allocator {
+public:
+  explicit Slab_Allocator(size_t n_chunks)
+    : Dynamic_Slab_Allocator(n_chunks, sizeof(T))
+  {}
+
+  void* malloc(size_t nbytes = sizeof(T)) {
+    return Dynamic_Slab_Allocator::malloc(nbytes);
+  }
+};
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif /* OPENDDS_DCPS_SLAB_ALLOCATOR_H */
@@ -48,6 +48,9 @@ static const std::string AccessControl_Minor_Version("0");
 
 static const std::string PermissionsCredentialTokenClassId("DDS:Access:PermissionsCredential");
 
+static const size_t VerifiedPermissionsMax = 256;
+static const time_t VerifiedPermissionsLifetimeSec = 600;
+
 
 
 AccessControlBuiltInImpl::AccessControlBuiltInImpl()
@@ -55,6 +58,7 @@ AccessControlBuiltInImpl::AccessControlBuiltInImpl()
   , remote_rp_timer_(*this)
   , handle_mutex_()
   , gen_handle_mutex_()
+  , verified_perms_(VerifiedPermissionsMax, ACE_Time_Value(VerifiedPermissionsLifetimeSec))
   , next_handle_(1)
   , listener_ptr_(NULL)
 {  }
@@ -212,44 +216,57 @@ AccessControlBuiltInImpl::~AccessControlBuiltInImpl()
     return DDS::HANDLE_NIL;
   }
 
+  const LocalAccessCredentialData::shared_ptr& local_access_credential_data = piter->second.local_access_credential_data;
+  const SSL::Certificate& local_ca = local_access_credential_data->get_ca_cert();
+
   // permissions file
   OpenDDS::Security::TokenReader remote_perm_wrapper(remote_credential_token);
-  SSL::SignedDocument remote_perm_doc;
-
-  int err = remote_perm_doc.deserialize(remote_perm_wrapper.get_bin_property_value("c.perm"));
-  if (err)
-  {
-    CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Failed to deserialize c.perm into signed-document");
-    return DDS::HANDLE_NIL;
-  }
+  const DDS::OctetSeq& remote_perm_bytes = remote_perm_wrapper.get_bin_property_value("c.perm");
 
   Permissions::shared_ptr remote_permissions = DCPS::make_rch<Permissions>();
 
-  err = remote_permissions->load(remote_perm_doc);
-  if (err)
-  {
-    CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Invalid permission file");
-    return DDS::HANDLE_NIL;
-  }
+  // Many participants usually share a permissions document, so the rules of
+  // one that was parsed and verified against this CA are reused.
+  std::string verified_key;
+  const bool cacheable = !VerifiedPermissions::make_key(remote_perm_bytes, local_ca.original_bytes(), verified_key);
+  const Permissions::PermissionGrantRules* verified_rules = cacheable ? verified_perms_.find(verified_key) : 0;
 
-  const LocalAccessCredentialData::shared_ptr& local_access_credential_data = piter->second.local_access_credential_data;
+  if (verified_rules) {
+    remote_permissions->data().perm_rules = *verified_rules;
 
-  // Validate the signature of the remote permissions
-  const SSL::Certificate& local_ca = local_access_credential_data->get_ca_cert();
-  std::string ca_subject;
+  } else {
+    SSL::SignedDocument remote_perm_doc;
+
+    int err = remote_perm_doc.deserialize(remote_perm_bytes);
+    if (err)
+    {
+      CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Failed to deserialize c.perm into signed-document");
+      return DDS::HANDLE_NIL;
+    }
 
-  local_ca.subject_name_to_str(ca_subject);
+    err = remote_permissions->load(remote_perm_doc);
+    if (err)
+    {
+      CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Invalid permission file");
+      return DDS::HANDLE_NIL;
+    }
 
-  err = remote_perm_doc.verify_signature(local_ca);
-  if (err) {
-    CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Remote permissions signature not verified");
-    return DDS::HANDLE_NIL;
-  }
+    // Validate the signature of the remote permissions
+    err = remote_perm_doc.verify_signature(local_ca);
+    if (err) {
+      CommonUtilities::set_security_error(ex, -1, 0, "AccessControlBuiltInImpl::validate_remote_permissions: Remote permissions signature not verified");
+      return DDS::HANDLE_NIL;
+    }
 
-  // The remote permissions signature is verified
-  if (OpenDDS::DCPS::DCPS_debug_level > 0) {
-    ACE_DEBUG((LM_DEBUG, ACE_TEXT(
-      "(%P|%t) AccessControlBuiltInImpl::validate_remote_permissions: Remote permissions document verified.\n")));
+    // The remote permissions signature is verified
+    if (OpenDDS::DCPS::DCPS_debug_level > 0) {
+      ACE_DEBUG((LM_DEBUG, ACE_TEXT(
+        "(%P|%t) AccessControlBuiltInImpl::validate_remote_permissions: Remote permissions document verified.\n")));
+    }
+
+    if (cacheable) {
+      verified_perms_.insert(verified_key, remote_permissions->data().perm_rules);
+    }
   }
 
   //Extract and compare the remote subject name for validation
@@ -28,6 +28,7 @@
 #include "AccessControl/Governance.h"
 #include "AccessControl/Permissions.h"
 #include "SSL/SubjectName.h"
+#include "VerificationCache_T.h"
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -280,6 +281,11 @@ private:
   ACE_Thread_Mutex handle_mutex_;
   ACE_Thread_Mutex gen_handle_mutex_;
 
+  /// Rules of remote permissions documents already verified against a
+  /// local CA, guarded by handle_mutex_.
+  typedef VerificationCache<Permissions::PermissionGrantRules> VerifiedPermissions;
+  VerifiedPermissions verified_perms_;
+
   int next_handle_;
 
   DDS::Security::AccessControlListener_ptr listener_ptr_;
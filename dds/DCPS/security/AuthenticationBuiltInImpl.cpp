@@ -42,6 +42,20 @@ static bool validate_topic_data_guid(const DDS::OctetSeq& cpdata,
                                      const std::vector<unsigned char>& subject_name_hash,
                                      DDS::Security::SecurityException& ex);
 
+/// The 'c.kagree_algo' property without its terminating null.
+static std::string kagree_algo_name(const DDS::OctetSeq& kagree_algo)
+{
+  size_t length = kagree_algo.length();
+  if (length == 0) {
+    return std::string();
+  }
+  const char* const name = reinterpret_cast<const char*>(kagree_algo.get_buffer());
+  if (name[length - 1] == '\0') {
+    --length;
+  }
+  return std::string(name, length);
+}
+
 const std::string Auth_Plugin_Name("DDS:Auth:PKI-DH");
 const std::string Auth_Plugin_Major_Version("1");
 const std::string Auth_Plugin_Minor_Version("0");
@@ -53,6 +67,14 @@ const std::string Handshake_Request_Class_Ext("Req");
 const std::string Handshake_Reply_Class_Ext("Reply");
 const std::string Handshake_Final_Class_Ext("Final");
 
+const size_t Verified_Certificates_Max = 1024;
+const time_t Verified_Certificates_Lifetime_Sec = 60;
+
+// The handshake request always uses ECDH, replies use the algorithm of the
+// request.
+const std::string Handshake_Request_Kagree_Algo("ECDH+prime256v1-CEUM");
+const size_t Diffie_Hellman_Keys_Ready = 8;
+
 struct SharedSecret : DCPS::LocalObject<DDS::Security::SharedSecretHandle> {
 
   SharedSecret(DDS::OctetSeq challenge1,
@@ -75,6 +97,8 @@ AuthenticationBuiltInImpl::AuthenticationBuiltInImpl()
 , identity_mutex_()
 , handshake_mutex_()
 , handle_mutex_()
+, verified_certs_(Verified_Certificates_Max, ACE_Time_Value(Verified_Certificates_Lifetime_Sec))
+, dh_pool_(Diffie_Hellman_Keys_Ready)
 , next_handle_(1)
 {
 }
@@ -117,6 +141,9 @@ AuthenticationBuiltInImpl::~AuthenticationBuiltInImpl()
           local_participants_[local_identity_handle] = local_participant;
         }
 
+        // Have key pairs ready for the first handshakes.
+        dh_pool_.prepare(Handshake_Request_Kagree_Algo);
+
         result = DDS::Security::VALIDATION_OK;
 
       } else {
@@ -337,7 +364,7 @@ AuthenticationBuiltInImpl::~AuthenticationBuiltInImpl()
 
   const LocalAuthCredentialData& local_credential_data = *(local_data.credentials);
 
-  SSL::DiffieHellman::unique_ptr diffie_hellman(new SSL::DiffieHellman(new SSL::ECDH_PRIME_256_V1_CEUM));
+  SSL::DiffieHellman::unique_ptr diffie_hellman(dh_pool_.take(Handshake_Request_Kagree_Algo));
 
   OpenDDS::Security::TokenWriter message_out(handshake_message, build_class_id(Handshake_Request_Class_Ext));
 
@@ -658,7 +685,7 @@ static void make_final_signature_sequence(const DDS::OctetSeq& hash_c1,
   if (cid.length() > 0) {
 
     remote_cert->deserialize(cid);
-    if (X509_V_OK != remote_cert->validate(local_credential_data.get_ca_cert()))
+    if (X509_V_OK != validate_remote_certificate(*remote_cert, local_credential_data.get_ca_cert()))
     {
       set_security_error(ex, -1, 0, "Certificate validation failed");
       return Failure;
@@ -686,7 +713,11 @@ static void make_final_signature_sequence(const DDS::OctetSeq& hash_c1,
   cperm = message_in.get_bin_property_value("c.perm");
 
   const DDS::OctetSeq& dh_algo = message_in.get_bin_property_value("c.kagree_algo");
-  diffie_hellman.reset(SSL::DiffieHellman::factory(dh_algo));
+  diffie_hellman.reset(dh_pool_.take(kagree_algo_name(dh_algo)));
+  if (!diffie_hellman) {
+    set_security_error(ex, -1, 0, "Unsupported key agreement algorithm 'c.kagree_algo'");
+    return Failure;
+  }
 
   /* Compute hash_c1 and store for later */
 
@@ -1040,7 +1071,7 @@ DDS::Security::ValidationResult_t AuthenticationBuiltInImpl::process_handshake_r
 
       remote_cert->deserialize(cid);
 
-    if (X509_V_OK != remote_cert->validate(local_credential_data.get_ca_cert()))
+    if (X509_V_OK != validate_remote_certificate(*remote_cert, local_credential_data.get_ca_cert()))
     {
       set_security_error(ex, -1, 0, "Certificate validation failed");
       return Failure;
@@ -1329,6 +1360,39 @@ bool AuthenticationBuiltInImpl::is_handshake_initiator(const OpenDDS::DCPS::GUID
 
 }
 
+int AuthenticationBuiltInImpl::validate_remote_certificate(const SSL::Certificate& cert,
+                                                           const SSL::Certificate& ca)
+{
+  // Participants that rediscover each other, or that share a process, see
+  // the same certificates again, so successful chain checks are reused for
+  // a short while, but never past the expiration of either certificate.
+  std::string key;
+  const bool cacheable = !VerifiedCertificates::make_key(cert.original_bytes(), ca.original_bytes(), key);
+  if (cacheable && verified_certs_.find(key)) {
+    return X509_V_OK;
+  }
+
+  const int result = cert.validate(ca);
+  time_t cert_expires, ca_expires;
+  if (cacheable && result == X509_V_OK
+      && !cert.expiration(cert_expires) && !ca.expiration(ca_expires)) {
+    verified_certs_.insert(key, true, ACE_OS::gettimeofday(),
+                           ACE_Time_Value(std::min(cert_expires, ca_expires)));
+  }
+  return result;
+}
+
+AuthenticationBuiltInImpl::VerificationStats
+AuthenticationBuiltInImpl::certificate_verification_stats()
+{
+  ACE_Guard<ACE_Thread_Mutex> identity_data_guard(identity_mutex_);
+  VerificationStats stats;
+  stats.entries = verified_certs_.size();
+  stats.hits = verified_certs_.hits();
+  stats.misses = verified_certs_.misses();
+  return stats;
+}
+
 bool AuthenticationBuiltInImpl::check_class_versions(const char* remote_class_id)
 {
   if (NULL == remote_class_id) {
@@ -22,6 +22,8 @@
 
 #include "Authentication/LocalAuthCredentialData.h"
 #include "SSL/DiffieHellman.h"
+#include "SSL/DiffieHellmanPool.h"
+#include "VerificationCache_T.h"
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
@@ -144,6 +146,16 @@ public:
     ::DDS::Security::SharedSecretHandle* sharedsecret_handle,
     ::DDS::Security::SecurityException & ex);
 
+  /// Lookups in the cache of remote certificates validated against a
+  /// local CA.
+  struct VerificationStats {
+    size_t entries;
+    size_t hits;
+    size_t misses;
+  };
+
+  VerificationStats certificate_verification_stats();
+
 private:
 
   struct RemoteParticipantData : public DCPS::RcObject {
@@ -228,6 +240,11 @@ private:
 
   bool is_handshake_initiator(const DCPS::GUID_t& local, const DCPS::GUID_t& remote);
 
+  /// Validates @a cert against @a ca unless it was validated recently.
+  /// Must be called with identity_mutex_ held.
+  int validate_remote_certificate(const SSL::Certificate& cert,
+                                  const SSL::Certificate& ca);
+
   bool check_class_versions(const char* remote_class_id);
 
   std::string build_class_id(const std::string& message_ext);
@@ -267,6 +284,14 @@ private:
   ACE_Thread_Mutex handshake_mutex_;
   ACE_Thread_Mutex handle_mutex_;
 
+  /// Remote certificates that were validated against a local CA, guarded
+  /// by identity_mutex_.
+  typedef VerificationCache<bool> VerifiedCertificates;
+  VerifiedCertificates verified_certs_;
+
+  /// Diffie-Hellman key pairs generated ahead of the handshakes.
+  SSL::DiffieHellmanPool dh_pool_;
+
   CORBA::Long next_handle_;
 
 };
@@ -752,13 +752,6 @@ namespace {
           kind[TransformKindIndex] == CRYPTO_TRANSFORMATION_KIND_AES256_GMAC);
   }
 
-  struct CipherContext {
-    EVP_CIPHER_CTX* ctx_;
-    CipherContext() : ctx_(EVP_CIPHER_CTX_new()) {}
-    operator EVP_CIPHER_CTX*() { return ctx_; }
-    ~CipherContext() { EVP_CIPHER_CTX_free(ctx_); }
-  };
-
   bool inc32(unsigned char* a)
   {
     for (int i = 0; i < 4; ++i) {
@@ -771,6 +764,35 @@ namespace {
     return true;
   }
 
+  /// Passes the first @a n bytes of the chain starting at @a plain's rd_ptr
+  /// through EVP_EncryptUpdate.  The ciphertext goes to @a out, or if it's
+  /// null the bytes are only authenticated.
+  bool encrypt_update(EVP_CIPHER_CTX* ctx, const ACE_Message_Block* plain,
+                      size_t n, unsigned char* out)
+  {
+    for (; n; plain = plain->cont()) {
+      if (!plain) {
+        return false;
+      }
+      const size_t len = (std::min)(n, plain->length());
+      int outLen;
+      if (EVP_EncryptUpdate(ctx, out, &outLen,
+                            reinterpret_cast<const unsigned char*>(plain->rd_ptr()),
+                            static_cast<int>(len)) != 1) {
+        return false;
+      }
+      if (out) {
+        // GCM doesn't hold back any of the input
+        if (outLen != static_cast<int>(len)) {
+          return false;
+        }
+        out += outLen;
+      }
+      n -= len;
+    }
+    return true;
+  }
+
   const size_t CRYPTO_CONTENT_ADDED_LENGTH = 4;
   const size_t CRYPTO_HEADER_LENGTH = 20;
 }
@@ -808,14 +830,21 @@ bool CryptoBuiltInImpl::encode_serialized_payload(
   // see register_local_datawriter for the assignment of key indexes in the seq
   const unsigned int key_idx = keyseq.length() >= 2 ? 1 : 0;
   const KeyId_t sKey = std::make_pair(sending_datawriter_crypto, key_idx);
+  ACE_Message_Block plain_mb(to_mb(plain_buffer.get_buffer()),
+                             plain_buffer.length());
+  plain_mb.wr_ptr(plain_buffer.length());
 
   if (encrypts(keyseq[key_idx])) {
-    ok = encrypt(keyseq[key_idx], sessions_[sKey], plain_buffer,
-                 header, footer, out, ex);
+    Session& sess = sessions_[sKey];
+    encauth_setup(keyseq[key_idx], sess, plain_buffer.length(), header);
+    out.length(plain_buffer.length());
+    ok = encrypt(sess, plain_mb, plain_buffer.length(), out.get_buffer(),
+                 footer, ex);
     pOut = &out;
   } else if (authenticates(keyseq[key_idx])) {
-    ok = authtag(keyseq[key_idx], sessions_[sKey], plain_buffer,
-                 header, footer, ex);
+    Session& sess = sessions_[sKey];
+    encauth_setup(keyseq[key_idx], sess, plain_buffer.length(), header);
+    ok = authtag(sess, plain_mb, plain_buffer.length(), footer, ex);
   } else {
     ok = false;
     CommonUtilities::set_security_error(ex, -1, 0,
@@ -851,6 +880,75 @@ bool CryptoBuiltInImpl::encode_serialized_payload(
   return true;
 }
 
+CryptoBuiltInImpl::Session::Session()
+  : counter_(0)
+  , encrypt_ctx_(0)
+  , decrypt_ctx_(0)
+  , encrypt_keyed_(false)
+  , decrypt_keyed_(false)
+{
+}
+
+CryptoBuiltInImpl::Session::Session(const Session& other)
+  : key_(other.key_)
+  , counter_(other.counter_)
+  , encrypt_ctx_(0)
+  , decrypt_ctx_(0)
+  , encrypt_keyed_(false)
+  , decrypt_keyed_(false)
+{
+  std::memcpy(id_, other.id_, sizeof id_);
+  std::memcpy(iv_suffix_, other.iv_suffix_, sizeof iv_suffix_);
+}
+
+CryptoBuiltInImpl::Session&
+CryptoBuiltInImpl::Session::operator=(const Session& other)
+{
+  if (this != &other) {
+    std::memcpy(id_, other.id_, sizeof id_);
+    std::memcpy(iv_suffix_, other.iv_suffix_, sizeof iv_suffix_);
+    key_ = other.key_;
+    counter_ = other.counter_;
+    encrypt_keyed_ = decrypt_keyed_ = false;
+  }
+  return *this;
+}
+
+CryptoBuiltInImpl::Session::~Session()
+{
+  EVP_CIPHER_CTX_free(encrypt_ctx_);
+  EVP_CIPHER_CTX_free(decrypt_ctx_);
+}
+
+EVP_CIPHER_CTX* CryptoBuiltInImpl::Session::cipher(bool encrypt)
+{
+  EVP_CIPHER_CTX*& ctx = encrypt ? encrypt_ctx_ : decrypt_ctx_;
+  bool& keyed = encrypt ? encrypt_keyed_ : decrypt_keyed_;
+
+  if (!ctx) {
+    ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+      return 0;
+    }
+  }
+
+  if (!keyed) {
+    if (key_.length() != KEY_LEN_BYTES) {
+      return 0;
+    }
+    const unsigned char* key = key_.get_buffer();
+    const int ok = encrypt
+      ? EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), 0, key, 0)
+      : EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), 0, key, 0);
+    if (ok != 1) {
+      return 0;
+    }
+    keyed = true;
+  }
+
+  return ctx;
+}
+
 void CryptoBuiltInImpl::Session::create_key(const KeyMaterial& master)
 {
   RAND_bytes(id_, sizeof id_);
@@ -876,11 +974,10 @@ void CryptoBuiltInImpl::Session::inc_iv()
 }
 
 void CryptoBuiltInImpl::encauth_setup(const KeyMaterial& master, Session& sess,
-                                      const DDS::OctetSeq& plain,
-                                      CryptoHeader& header)
+                                      size_t n, CryptoHeader& header)
 {
   const unsigned int blocks =
-    (plain.length() + BLOCK_LEN_BYTES - 1) / BLOCK_LEN_BYTES;
+    static_cast<unsigned int>((n + BLOCK_LEN_BYTES - 1) / BLOCK_LEN_BYTES);
 
   if (!sess.key_.length()) {
     sess.create_key(master);
@@ -902,41 +999,33 @@ void CryptoBuiltInImpl::encauth_setup(const KeyMaterial& master, Session& sess,
               sizeof sess.iv_suffix_);
 }
 
-bool CryptoBuiltInImpl::encrypt(const KeyMaterial& master, Session& sess,
-                                const DDS::OctetSeq& plain,
-                                CryptoHeader& header, CryptoFooter& footer,
-                                DDS::OctetSeq& out, SecurityException& ex)
+bool CryptoBuiltInImpl::encrypt(Session& sess, const ACE_Message_Block& plain,
+                                size_t n, unsigned char* out,
+                                CryptoFooter& footer, SecurityException& ex)
 {
-  encauth_setup(master, sess, plain, header);
   static const int IV_LEN = 12, IV_SUFFIX_IDX = 4;
   unsigned char iv[IV_LEN];
   std::memcpy(iv, &sess.id_, sizeof sess.id_);
   std::memcpy(iv + IV_SUFFIX_IDX, &sess.iv_suffix_, sizeof sess.iv_suffix_);
 
-  CipherContext ctx;
-  const unsigned char* key = sess.key_.get_buffer();
-  if (EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), 0, key, iv) != 1) {
+  EVP_CIPHER_CTX* const ctx = sess.cipher(true);
+  if (!ctx || EVP_EncryptInit_ex(ctx, 0, 0, 0, iv) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptInit_ex");
     return false;
   }
 
-  int len;
-  out.length(plain.length() + BLOCK_LEN_BYTES - 1);
-  unsigned char* const out_buffer = out.get_buffer();
-  if (EVP_EncryptUpdate(ctx, out_buffer, &len,
-                        plain.get_buffer(), plain.length()) != 1) {
+  if (!encrypt_update(ctx, &plain, n, out)) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptUpdate");
     return false;
   }
 
+  unsigned char tail[BLOCK_LEN_BYTES];
   int padLen;
-  if (EVP_EncryptFinal_ex(ctx, out_buffer + len, &padLen) != 1) {
+  if (EVP_EncryptFinal_ex(ctx, tail, &padLen) != 1 || padLen) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptFinal_ex");
     return false;
   }
 
-  out.length(len + padLen);
-
   if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, sizeof footer.common_mac,
                           &footer.common_mac) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_CIPHER_CTX_ctrl");
@@ -946,32 +1035,28 @@ bool CryptoBuiltInImpl::encrypt(const KeyMaterial& master, Session& sess,
   return true;
 }
 
-bool CryptoBuiltInImpl::authtag(const KeyMaterial& master, Session& sess,
-                                const DDS::OctetSeq& plain,
-                                CryptoHeader& header,
-                                CryptoFooter& footer,
+bool CryptoBuiltInImpl::authtag(Session& sess, const ACE_Message_Block& plain,
+                                size_t n, CryptoFooter& footer,
                                 SecurityException& ex)
 {
-  encauth_setup(master, sess, plain, header);
   static const int IV_LEN = 12, IV_SUFFIX_IDX = 4;
   unsigned char iv[IV_LEN];
   std::memcpy(iv, &sess.id_, sizeof sess.id_);
   std::memcpy(iv + IV_SUFFIX_IDX, &sess.iv_suffix_, sizeof sess.iv_suffix_);
 
-  CipherContext ctx;
-  const unsigned char* key = sess.key_.get_buffer();
-  if (EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), 0, key, iv) != 1) {
+  EVP_CIPHER_CTX* const ctx = sess.cipher(true);
+  if (!ctx || EVP_EncryptInit_ex(ctx, 0, 0, 0, iv) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptInit_ex");
     return false;
   }
 
-  int n;
-  if (EVP_EncryptUpdate(ctx, 0, &n, plain.get_buffer(), plain.length()) != 1) {
+  if (!encrypt_update(ctx, &plain, n, 0)) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptUpdate");
     return false;
   }
 
-  if (EVP_EncryptFinal_ex(ctx, 0, &n) != 1) {
+  int len;
+  if (EVP_EncryptFinal_ex(ctx, 0, &len) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_EncryptFinal_ex");
     return false;
   }
@@ -985,68 +1070,82 @@ bool CryptoBuiltInImpl::authtag(const KeyMaterial& master, Session& sess,
   return true;
 }
 
+size_t CryptoBuiltInImpl::max_encoded_submessage_length(size_t plain_length) const
+{
+  size_t size = 0, padding = 0;
+  size += 4; // prefix submessage header
+  using DCPS::gen_find_size;
+  const CryptoHeader header = CryptoHeader();
+  gen_find_size(header, size, padding);
+  size += 8; // body submessage header + seq len
+  size += plain_length + 3; // submessage inside wrapper, aligned to 4
+  size += 4; // postfix submessage header
+  const CryptoFooter footer = CryptoFooter();
+  gen_find_size(footer, size, padding);
+  return size + padding;
+}
+
 bool CryptoBuiltInImpl::encode_submessage(
   DDS::OctetSeq& encoded_rtps_submessage,
   const DDS::OctetSeq& plain_rtps_submessage,
   NativeCryptoHandle sender_handle,
   SecurityException& ex)
 {
+  const unsigned int n = plain_rtps_submessage.length();
+  ACE_Message_Block plain(to_mb(plain_rtps_submessage.get_buffer()), n);
+  plain.wr_ptr(n);
+
+  DDS::OctetSeq encoded(
+    static_cast<CORBA::ULong>(max_encoded_submessage_length(n)));
+  encoded.length(encoded.maximum());
+  ACE_Message_Block out(to_mb(encoded.get_buffer()), encoded.length());
+
+  bool transformed;
+  if (!encode_submessage(out, transformed, plain, n, sender_handle, ex)) {
+    return false;
+  }
+
+  if (transformed) {
+    encoded.length(static_cast<CORBA::ULong>(out.length()));
+    encoded_rtps_submessage.swap(encoded);
+  } else {
+    encoded_rtps_submessage = plain_rtps_submessage;
+  }
+  return true;
+}
+
+bool CryptoBuiltInImpl::encode_submessage(
+  ACE_Message_Block& out,
+  bool& encoded,
+  const ACE_Message_Block& plain,
+  size_t n,
+  NativeCryptoHandle sender_handle,
+  SecurityException& ex)
+{
+  encoded = false;
+
   ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
   if (!keys_.count(sender_handle)) {
-    encoded_rtps_submessage = plain_rtps_submessage;
     return true;
   }
 
   const KeySeq& keyseq = keys_[sender_handle];
   if (!keyseq.length()) {
-    encoded_rtps_submessage = plain_rtps_submessage;
     return true;
   }
 
-  bool ok;
-  CryptoHeader header;
-  CryptoFooter footer;
-  DDS::OctetSeq out;
-  const DDS::OctetSeq* pOut = &plain_rtps_submessage;
   static const unsigned int SUBMSG_KEY_IDX = 0;
-  const KeyId_t sKey = std::make_pair(sender_handle, SUBMSG_KEY_IDX);
-  bool authOnly = false;
-
-  if (encrypts(keyseq[SUBMSG_KEY_IDX])) {
-    ok = encrypt(keyseq[SUBMSG_KEY_IDX], sessions_[sKey], plain_rtps_submessage,
-                 header, footer, out, ex);
-    pOut = &out;
-  } else if (authenticates(keyseq[SUBMSG_KEY_IDX])) {
-    // the original submessage may have octetsToNextHeader = 0 which isn't
-    // legal when appending SEC_POSTFIX, patch in the actual submsg length
-    ACE_Message_Block mb_in(to_mb(pOut->get_buffer()), pOut->length());
-    mb_in.wr_ptr(pOut->length());
-    Serializer ser_in(&mb_in);
-    RTPS::SubmessageHeader smHdr_in;
-    ser_in >> ACE_InputCDR::to_octet(smHdr_in.submessageId);
-    ser_in >> ACE_InputCDR::to_octet(smHdr_in.flags);
-    ser_in.swap_bytes(ACE_CDR_BYTE_ORDER != (smHdr_in.flags & 1));
-    ser_in >> smHdr_in.submessageLength;
-    if (!smHdr_in.submessageLength) {
-      out = *pOut;
-      unsigned int len = pOut->length() - 4;
-      out[2 + !(smHdr_in.flags & 1)] = len & 0xff;
-      out[2 + (smHdr_in.flags & 1)] = (len >> 8) & 0xff;
-      pOut = &out;
-    }
-    ok = authtag(keyseq[SUBMSG_KEY_IDX], sessions_[sKey], *pOut,
-                 header, footer, ex);
-    authOnly = true;
-  } else {
-    ok = false;
+  const KeyMaterial& master = keyseq[SUBMSG_KEY_IDX];
+  const bool authOnly = authenticates(master);
+  if (!authOnly && !encrypts(master)) {
     CommonUtilities::set_security_error(ex, -1, 0,
                                         "Key transform kind unrecognized");
-  }
-
-  if (!ok) {
     return false;
   }
 
+  CryptoHeader header;
+  CryptoFooter footer;
+
   size_t size = 0, padding = 0;
   size += 4; // prefix submessage header
   using DCPS::gen_find_size;
@@ -1057,34 +1156,80 @@ bool CryptoBuiltInImpl::encode_submessage(
     size += 8; // body submessage header + seq len
   }
 
-  size += pOut->length(); // submessage inside wrapper
+  size += n; // submessage inside wrapper
   if ((size + padding) % 4) {
     padding += 4 - ((size + padding) % 4);
   }
 
   size += 4; // postfix submessage header
-  size_t preFooter = size + padding;
+  const size_t preFooter = size + padding;
+  // Only the common MAC is computed.  This plugin doesn't create receiver
+  // specific keys (see make_key()) so receiver_specific_macs stays empty
+  // and the cost of encoding doesn't depend on the number of readers.
   gen_find_size(footer, size, padding);
 
-  encoded_rtps_submessage.length(static_cast<unsigned int>(size + padding));
-  ACE_Message_Block mb(to_mb(encoded_rtps_submessage.get_buffer()),
-                       size + padding);
-  Serializer ser(&mb, Serializer::SWAP_BE, Serializer::ALIGN_CDR);
+  if (out.space() < size + padding) {
+    CommonUtilities::set_security_error(ex, -1, 0,
+                                        "Not enough space for the encoded submessage");
+    return false;
+  }
+
+  Session& sess = sessions_[std::make_pair(sender_handle, SUBMSG_KEY_IDX)];
+  encauth_setup(master, sess, n, header);
+
+  char* const start = out.wr_ptr();
+  Serializer ser(&out, Serializer::SWAP_BE, Serializer::ALIGN_CDR);
   RTPS::SubmessageHeader smHdr = {RTPS::SEC_PREFIX, 0, hdrLen};
   ser << smHdr;
   ser << header;
 
-  if (!authOnly) {
+  bool ok;
+  if (authOnly) {
+    // The submessage is sent as is.  It may have octetsToNextHeader = 0
+    // which isn't legal when appending SEC_POSTFIX, patch in the actual
+    // submsg length.
+    unsigned char* const body = reinterpret_cast<unsigned char*>(out.wr_ptr());
+    size_t copied = 0;
+    for (const ACE_Message_Block* mb = &plain; mb && copied < n; mb = mb->cont()) {
+      const size_t len = (std::min)(n - copied, mb->length());
+      std::memcpy(body + copied, mb->rd_ptr(), len);
+      copied += len;
+    }
+    out.wr_ptr(n);
+
+    if (copied < n) {
+      CommonUtilities::set_security_error(ex, -1, 0,
+                                          "Plain submessage is too short");
+      ok = false;
+    } else {
+      if (n >= RTPS::SMHDR_SZ && !body[2] && !body[3]) {
+        const size_t len = n - RTPS::SMHDR_SZ;
+        const bool le = body[1] & RTPS::FLAG_E;
+        body[2 + !le] = len & 0xff;
+        body[2 + le] = (len >> 8) & 0xff;
+      }
+      ACE_Message_Block sent(reinterpret_cast<const char*>(body), n);
+      sent.wr_ptr(n);
+      ok = authtag(sess, sent, n, footer, ex);
+    }
+  } else {
     smHdr.submessageId = RTPS::SEC_BODY;
-    smHdr.submessageLength = static_cast<ACE_UINT16>(4 + pOut->length());
-    if (pOut->length() % 4) {
-      smHdr.submessageLength += 4 - pOut->length() % 4;
+    smHdr.submessageLength = static_cast<ACE_UINT16>(4 + n);
+    if (n % 4) {
+      smHdr.submessageLength += static_cast<ACE_UINT16>(4 - n % 4);
     }
     ser << smHdr;
-    ser << pOut->length();
+    ser << static_cast<ACE_CDR::ULong>(n);
+    ok = encrypt(sess, plain, n, reinterpret_cast<unsigned char*>(out.wr_ptr()),
+                 footer, ex);
+    out.wr_ptr(n);
+  }
+
+  if (!ok) {
+    out.wr_ptr(start);
+    return false;
   }
 
-  ser.write_octet_array(pOut->get_buffer(), pOut->length());
   ser.align_w(4);
 
   smHdr.submessageId = RTPS::SEC_POSTFIX;
@@ -1092,15 +1237,15 @@ bool CryptoBuiltInImpl::encode_submessage(
   ser << smHdr;
   ser << footer;
 
+  encoded = true;
   return true;
 }
 
-bool CryptoBuiltInImpl::encode_datawriter_submessage(
-  DDS::OctetSeq& encoded_rtps_submessage,
-  const DDS::OctetSeq& plain_rtps_submessage,
+bool CryptoBuiltInImpl::datawriter_submessage_handle(
+  NativeCryptoHandle& encode_handle,
   DatawriterCryptoHandle sending_datawriter_crypto,
   const DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
-  CORBA::Long& receiving_datareader_crypto_list_index,
+  CORBA::Long receiving_datareader_crypto_list_index,
   SecurityException& ex)
 {
   if (DDS::HANDLE_NIL == sending_datawriter_crypto) {
@@ -1129,11 +1274,10 @@ bool CryptoBuiltInImpl::encode_datawriter_submessage(
     }
   }
 
-  NativeCryptoHandle encode_handle = sending_datawriter_crypto;
+  encode_handle = sending_datawriter_crypto;
   ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
   if (!writer_options_[encode_handle].submessage_) {
-    encoded_rtps_submessage = plain_rtps_submessage;
-    receiving_datareader_crypto_list_index = len;
+    encode_handle = DDS::HANDLE_NIL;
     return true;
   }
 
@@ -1145,8 +1289,32 @@ bool CryptoBuiltInImpl::encode_datawriter_submessage(
       }
     }
   }
+  return true;
+}
 
-  guard.release();
+bool CryptoBuiltInImpl::encode_datawriter_submessage(
+  DDS::OctetSeq& encoded_rtps_submessage,
+  const DDS::OctetSeq& plain_rtps_submessage,
+  DatawriterCryptoHandle sending_datawriter_crypto,
+  const DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
+  CORBA::Long& receiving_datareader_crypto_list_index,
+  SecurityException& ex)
+{
+  NativeCryptoHandle encode_handle;
+  if (!datawriter_submessage_handle(encode_handle, sending_datawriter_crypto,
+                                    receiving_datareader_crypto_list,
+                                    receiving_datareader_crypto_list_index,
+                                    ex)) {
+    return false;
+  }
+
+  const CORBA::Long len =
+    static_cast<CORBA::Long>(receiving_datareader_crypto_list.length());
+  if (encode_handle == DDS::HANDLE_NIL) {
+    encoded_rtps_submessage = plain_rtps_submessage;
+    receiving_datareader_crypto_list_index = len;
+    return true;
+  }
 
   const bool ok = encode_submessage(encoded_rtps_submessage,
                                     plain_rtps_submessage, encode_handle, ex);
@@ -1156,9 +1324,31 @@ bool CryptoBuiltInImpl::encode_datawriter_submessage(
   return ok;
 }
 
-bool CryptoBuiltInImpl::encode_datareader_submessage(
-  DDS::OctetSeq& encoded_rtps_submessage,
-  const DDS::OctetSeq& plain_rtps_submessage,
+bool CryptoBuiltInImpl::encode_datawriter_submessage(
+  ACE_Message_Block& out,
+  bool& encoded,
+  const ACE_Message_Block& plain,
+  size_t plain_length,
+  DatawriterCryptoHandle sending_datawriter_crypto,
+  const DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
+  SecurityException& ex)
+{
+  encoded = false;
+  NativeCryptoHandle encode_handle;
+  if (!datawriter_submessage_handle(encode_handle, sending_datawriter_crypto,
+                                    receiving_datareader_crypto_list, 0, ex)) {
+    return false;
+  }
+
+  if (encode_handle == DDS::HANDLE_NIL) {
+    return true;
+  }
+
+  return encode_submessage(out, encoded, plain, plain_length, encode_handle, ex);
+}
+
+bool CryptoBuiltInImpl::datareader_submessage_handle(
+  NativeCryptoHandle& encode_handle,
   DatareaderCryptoHandle sending_datareader_crypto,
   const DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
   SecurityException& ex)
@@ -1176,7 +1366,7 @@ bool CryptoBuiltInImpl::encode_datareader_submessage(
     }
   }
 
-  NativeCryptoHandle encode_handle = sending_datareader_crypto;
+  encode_handle = sending_datareader_crypto;
   if (receiving_datawriter_crypto_list.length() == 1) {
     ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
     if (keys_.count(encode_handle)) {
@@ -1186,11 +1376,46 @@ bool CryptoBuiltInImpl::encode_datareader_submessage(
       }
     }
   }
+  return true;
+}
+
+bool CryptoBuiltInImpl::encode_datareader_submessage(
+  DDS::OctetSeq& encoded_rtps_submessage,
+  const DDS::OctetSeq& plain_rtps_submessage,
+  DatareaderCryptoHandle sending_datareader_crypto,
+  const DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
+  SecurityException& ex)
+{
+  NativeCryptoHandle encode_handle;
+  if (!datareader_submessage_handle(encode_handle, sending_datareader_crypto,
+                                    receiving_datawriter_crypto_list, ex)) {
+    return false;
+  }
 
   return encode_submessage(encoded_rtps_submessage, plain_rtps_submessage,
                            encode_handle, ex);
 }
 
+bool CryptoBuiltInImpl::encode_datareader_submessage(
+  ACE_Message_Block& out,
+  bool& encoded,
+  const ACE_Message_Block& plain,
+  size_t plain_length,
+  DatareaderCryptoHandle sending_datareader_crypto,
+  const DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
+  SecurityException& ex)
+{
+  encoded = false;
+  NativeCryptoHandle encode_handle;
+  if (!datareader_submessage_handle(encode_handle, sending_datareader_crypto,
+                                    receiving_datawriter_crypto_list, ex)) {
+    return false;
+  }
+
+  return encode_submessage(out, encoded, plain, plain_length, encode_handle, ex);
+}
+
+
 bool CryptoBuiltInImpl::encode_rtps_message(
   DDS::OctetSeq& encoded_rtps_message,
   const DDS::OctetSeq& plain_rtps_message,
@@ -1334,7 +1559,7 @@ bool CryptoBuiltInImpl::preprocess_secure_submsg(
   return false;
 }
 
-KeyOctetSeq
+const KeyOctetSeq&
 CryptoBuiltInImpl::Session::get_key(const KeyMaterial& master,
                                     const CryptoHeader& header)
 {
@@ -1349,6 +1574,8 @@ CryptoBuiltInImpl::Session::get_key(const KeyMaterial& master,
 
 void CryptoBuiltInImpl::Session::derive_key(const KeyMaterial& master)
 {
+  encrypt_keyed_ = decrypt_keyed_ = false;
+
   PrivateKey pkey(master.master_sender_key);
   DigestContext ctx;
   const EVP_MD* md = EVP_get_digestbyname("SHA256");
@@ -1393,8 +1620,7 @@ bool CryptoBuiltInImpl::decrypt(const KeyMaterial& master, Session& sess,
                                 SecurityException& ex)
 
 {
-  const KeyOctetSeq sess_key = sess.get_key(master, header);
-  if (!sess_key.length()) {
+  if (!sess.get_key(master, header).length()) {
     CommonUtilities::set_security_error(ex, -1, 0, "no session key");
     return false;
   }
@@ -1409,10 +1635,9 @@ bool CryptoBuiltInImpl::decrypt(const KeyMaterial& master, Session& sess,
     return false;
   }
 
-  CipherContext ctx;
+  EVP_CIPHER_CTX* const ctx = sess.cipher(false);
   // session_id is start of IV contiguous bytes
-  if (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), 0, sess_key.get_buffer(),
-                         header.session_id) != 1) {
+  if (!ctx || EVP_DecryptInit_ex(ctx, 0, 0, 0, header.session_id) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_DecryptInit_ex");
     ACE_ERROR((LM_ERROR, "(%P|%t) CryptoBuiltInImpl::decrypt - ERROR "
                "EVP_DecryptInit_ex %Ld\n", ERR_peek_last_error()));
@@ -1457,8 +1682,7 @@ bool CryptoBuiltInImpl::verify(const KeyMaterial& master, Session& sess,
                                SecurityException& ex)
 
 {
-  const KeyOctetSeq sess_key = sess.get_key(master, header);
-  if (!sess_key.length()) {
+  if (!sess.get_key(master, header).length()) {
     CommonUtilities::set_security_error(ex, -1, 0, "no session key");
     return false;
   }
@@ -1473,10 +1697,9 @@ bool CryptoBuiltInImpl::verify(const KeyMaterial& master, Session& sess,
     return false;
   }
 
-  CipherContext ctx;
+  EVP_CIPHER_CTX* const ctx = sess.cipher(false);
   // session_id is start of IV contiguous bytes
-  if (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), 0, sess_key.get_buffer(),
-                         header.session_id) != 1) {
+  if (!ctx || EVP_DecryptInit_ex(ctx, 0, 0, 0, header.session_id) != 1) {
     CommonUtilities::set_security_error(ex, -1, 0, "EVP_DecryptInit_ex");
     ACE_ERROR((LM_ERROR, "(%P|%t) CryptoBuiltInImpl::verify - ERROR "
                "EVP_DecryptInit_ex %Ld\n", ERR_peek_last_error()));
@@ -11,6 +11,7 @@
 
 #include "dds/DdsSecurityCoreC.h"
 #include "dds/Versioned_Namespace.h"
+#include "dds/DCPS/security/framework/MessageBlockCryptoTransform.h"
 
 #include "tao/LocalObject.h"
 
@@ -23,6 +24,7 @@
 #endif /* ACE_LACKS_PRAGMA_ONCE */
 
 class DDS_TEST;
+struct evp_cipher_ctx_st;
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -34,6 +36,7 @@ class DdsSecurity_Export CryptoBuiltInImpl
   , public virtual DDS::Security::CryptoKeyExchange
   , public virtual DDS::Security::CryptoTransform
   , public virtual CORBA::LocalObject
+  , public MessageBlockCryptoTransform
 {
 public:
   CryptoBuiltInImpl();
@@ -215,6 +218,29 @@ private:
     DDS::Security::DatawriterCryptoHandle sending_datawriter_crypto,
     DDS::Security::SecurityException& ex);
 
+
+  // Message Block Transform
+
+  virtual size_t max_encoded_submessage_length(size_t plain_length) const;
+
+  virtual bool encode_datawriter_submessage(
+    ACE_Message_Block& out,
+    bool& encoded,
+    const ACE_Message_Block& plain,
+    size_t plain_length,
+    DDS::Security::DatawriterCryptoHandle sending_datawriter_crypto,
+    const DDS::Security::DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
+    DDS::Security::SecurityException& ex);
+
+  virtual bool encode_datareader_submessage(
+    ACE_Message_Block& out,
+    bool& encoded,
+    const ACE_Message_Block& plain,
+    size_t plain_length,
+    DDS::Security::DatareaderCryptoHandle sending_datareader_crypto,
+    const DDS::Security::DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
+    DDS::Security::SecurityException& ex);
+
   CryptoBuiltInImpl(const CryptoBuiltInImpl&);
   CryptoBuiltInImpl& operator=(const CryptoBuiltInImpl&);
 
@@ -255,11 +281,28 @@ private:
     KeyOctetSeq key_;
     ACE_UINT64 counter_;
 
-    KeyOctetSeq get_key(const KeyMaterial& master, const CryptoHeader& header);
+    Session();
+    /// Copies don't share the cipher contexts, they start without any.
+    Session(const Session& other);
+    Session& operator=(const Session& other);
+    ~Session();
+
+    const KeyOctetSeq& get_key(const KeyMaterial& master,
+                               const CryptoHeader& header);
     void create_key(const KeyMaterial& master);
     void derive_key(const KeyMaterial& master);
     void next_id(const KeyMaterial& master);
     void inc_iv();
+
+    /// AES-256-GCM context for encrypting (or decrypting) with key_.  The
+    /// key schedule is kept until key_ changes, so each message only sets
+    /// the IV.  Returns null if the context can't be created.
+    evp_cipher_ctx_st* cipher(bool encrypt);
+
+  private:
+    evp_cipher_ctx_st* encrypt_ctx_;
+    evp_cipher_ctx_st* decrypt_ctx_;
+    bool encrypt_keyed_, decrypt_keyed_;
   };
   typedef std::pair<DDS::Security::NativeCryptoHandle, unsigned int> KeyId_t;
   typedef std::map<KeyId_t, Session> SessionTable_t;
@@ -267,23 +310,47 @@ private:
 
   void clear_endpoint_data(DDS::Security::NativeCryptoHandle handle);
 
+  /// Checks the arguments of encode_datawriter_submessage() and finds the
+  /// handle with the keys for the submessage, or HANDLE_NIL if the
+  /// submessage isn't protected.
+  bool datawriter_submessage_handle(
+    DDS::Security::NativeCryptoHandle& encode_handle,
+    DDS::Security::DatawriterCryptoHandle sending_datawriter_crypto,
+    const DDS::Security::DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
+    CORBA::Long receiving_datareader_crypto_list_index,
+    DDS::Security::SecurityException& ex);
+
+  bool datareader_submessage_handle(
+    DDS::Security::NativeCryptoHandle& encode_handle,
+    DDS::Security::DatareaderCryptoHandle sending_datareader_crypto,
+    const DDS::Security::DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
+    DDS::Security::SecurityException& ex);
+
   bool encode_submessage(DDS::OctetSeq& encoded_rtps_submessage,
                          const DDS::OctetSeq& plain_rtps_submessage,
                          DDS::Security::NativeCryptoHandle sender_handle,
                          DDS::Security::SecurityException& ex);
 
-  bool encrypt(const KeyMaterial& master, Session& sess,
-               const DDS::OctetSeq& plain,
-               CryptoHeader& header, CryptoFooter& footer,
-               DDS::OctetSeq& out, DDS::Security::SecurityException& ex);
+  /// Encodes the @a n bytes of the chain starting at @a plain's rd_ptr at
+  /// @a out's wr_ptr, or sets @a encoded to false if @a sender_handle has
+  /// no keys.
+  bool encode_submessage(ACE_Message_Block& out, bool& encoded,
+                         const ACE_Message_Block& plain, size_t n,
+                         DDS::Security::NativeCryptoHandle sender_handle,
+                         DDS::Security::SecurityException& ex);
 
-  bool authtag(const KeyMaterial& master, Session& sess,
-               const DDS::OctetSeq& plain,
-               CryptoHeader& header, CryptoFooter& footer,
+  /// Encrypts the @a n bytes of the chain starting at @a plain's rd_ptr
+  /// into the @a n bytes at @a out.
+  bool encrypt(Session& sess, const ACE_Message_Block& plain, size_t n,
+               unsigned char* out, CryptoFooter& footer,
                DDS::Security::SecurityException& ex);
 
-  void encauth_setup(const KeyMaterial& master, Session& sess,
-                     const DDS::OctetSeq& plain, CryptoHeader& header);
+  bool authtag(Session& sess, const ACE_Message_Block& plain, size_t n,
+               CryptoFooter& footer, DDS::Security::SecurityException& ex);
+
+  /// Prepares @a sess for the next @a n bytes and fills in @a header.
+  void encauth_setup(const KeyMaterial& master, Session& sess, size_t n,
+                     CryptoHeader& header);
 
   bool decode_submessage(DDS::OctetSeq& plain_rtps_submessage,
                          const DDS::OctetSeq& encoded_rtps_submessage,
@@ -9,6 +9,7 @@
 #include "Err.h"
 #include <algorithm>
 #include <cstring>
+#include <ctime>
 #include <fstream>
 #include <iterator>
 #include <cerrno>
@@ -338,6 +339,41 @@ int Certificate::subject_name_digest(std::vector<CORBA::Octet>& dst) const
   return 0;
 }
 
+int Certificate::expiration(time_t& dst) const
+{
+  if (!x_) return 1;
+
+#if OPENSSL_VERSION_NUMBER < 0x10002000L
+  OPENDDS_SSL_LOG_ERR("ASN1_TIME_diff not provided by this OpenSSL library");
+  return 1;
+#else
+  /* Do not free not_after! */
+  const ASN1_TIME* not_after = X509_get_notAfter(x_);
+  if (NULL == not_after) {
+    OPENDDS_SSL_LOG_ERR("X509_get_notAfter failed");
+    return 1;
+  }
+
+  const time_t now = std::time(0);
+  ASN1_TIME* from = ASN1_TIME_set(NULL, now);
+  if (NULL == from) {
+    OPENDDS_SSL_LOG_ERR("ASN1_TIME_set failed");
+    return 1;
+  }
+
+  int days = 0, seconds = 0;
+  const int diff_ok = ASN1_TIME_diff(&days, &seconds, from, not_after);
+  ASN1_TIME_free(from);
+  if (1 != diff_ok) {
+    OPENDDS_SSL_LOG_ERR("ASN1_TIME_diff failed");
+    return 1;
+  }
+
+  dst = now + static_cast<time_t>(days) * 24 * 60 * 60 + seconds;
+  return 0;
+#endif
+}
+
 const char* Certificate::keypair_algo() const
 {
   // This should probably be pulling the information directly from
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <ctime>
 #include <openssl/x509.h>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
@@ -74,6 +75,12 @@ public:
    */
   int subject_name_digest(std::vector<CORBA::Octet>& dst) const;
 
+  /**
+   * Time at which the certificate stops being valid (its notAfter).
+   * @return int 0 on success; 1 on failure.
+   */
+  int expiration(time_t& dst) const;
+
   /**
    * @return int 0 on success; 1 on failure.
    */
@@ -0,0 +1,156 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.OpenDDS.org/license.html
+ */
+
+#include "DiffieHellmanPool.h"
+
+#include "ace/Guard_T.h"
+#include "ace/Log_Msg.h"
+
+#include <cstring>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace Security {
+namespace SSL {
+
+namespace {
+  DiffieHellman* make(const std::string& kagree_algo)
+  {
+    DDS::OctetSeq algo;
+    algo.length(static_cast<CORBA::ULong>(kagree_algo.size()));
+    std::memcpy(algo.get_buffer(), kagree_algo.data(), kagree_algo.size());
+    return DiffieHellman::factory(algo);
+  }
+}
+
+DiffieHellmanPool::DiffieHellmanPool(size_t keys)
+  : max_keys_(keys)
+  , cond_(lock_)
+  , started_(false)
+  , stop_(false)
+  , generator_(*this)
+{
+}
+
+DiffieHellmanPool::~DiffieHellmanPool()
+{
+  {
+    ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+    stop_ = true;
+    cond_.signal();
+  }
+  generator_.wait();
+
+  for (KeyMap::iterator it = keys_.begin(); it != keys_.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      delete it->second[i];
+    }
+  }
+}
+
+void
+DiffieHellmanPool::prepare(const std::string& kagree_algo)
+{
+  if (max_keys_ == 0) {
+    return;
+  }
+  ACE_GUARD(ACE_Thread_Mutex, guard, lock_);
+  want_i(kagree_algo);
+}
+
+DiffieHellman*
+DiffieHellmanPool::take(const std::string& kagree_algo)
+{
+  if (max_keys_ == 0) {
+    return make(kagree_algo);
+  }
+
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+    const KeyMap::iterator it = keys_.find(kagree_algo);
+    if (it != keys_.end() && !it->second.empty()) {
+      DiffieHellman* const dh = it->second.back();
+      it->second.pop_back();
+      cond_.signal();
+      return dh;
+    }
+  }
+
+  DiffieHellman* const dh = make(kagree_algo);
+  if (dh) {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, dh);
+    want_i(kagree_algo);
+  }
+  return dh;
+}
+
+size_t
+DiffieHellmanPool::ready(const std::string& kagree_algo) const
+{
+  ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, lock_, 0);
+  const KeyMap::const_iterator it = keys_.find(kagree_algo);
+  return it == keys_.end() ? 0 : it->second.size();
+}
+
+void
+DiffieHellmanPool::want_i(const std::string& kagree_algo)
+{
+  keys_[kagree_algo];
+  cond_.signal();
+
+  if (!started_) {
+    started_ = true;
+    if (generator_.activate(THR_NEW_LWP | THR_JOINABLE, 1) == -1) {
+      // Key pairs are then generated by the handshakes.
+      ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: DiffieHellmanPool::want_i: ")
+        ACE_TEXT("failed to start the thread generating key pairs\n")));
+    }
+  }
+}
+
+int
+DiffieHellmanPool::Generator::svc()
+{
+  for (;;) {
+    std::string kagree_algo;
+    {
+      ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, pool_.lock_, -1);
+      bool found = false;
+      while (!pool_.stop_ && !found) {
+        for (KeyMap::const_iterator it = pool_.keys_.begin();
+             !found && it != pool_.keys_.end(); ++it) {
+          if (it->second.size() < pool_.max_keys_) {
+            kagree_algo = it->first;
+            found = true;
+          }
+        }
+        if (found) {
+          break;
+        }
+        pool_.cond_.wait();
+      }
+      if (pool_.stop_) {
+        return 0;
+      }
+    }
+
+    DiffieHellman* const dh = make(kagree_algo);
+
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, pool_.lock_, -1);
+    if (dh) {
+      pool_.keys_[kagree_algo].push_back(dh);
+    } else if (pool_.keys_[kagree_algo].empty()) {
+      // Unknown algorithm, stop trying.
+      pool_.keys_.erase(kagree_algo);
+    }
+  }
+}
+
+}  // namespace SSL
+}  // namespace Security
+}  // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
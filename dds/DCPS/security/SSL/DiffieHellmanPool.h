@@ -0,0 +1,94 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.OpenDDS.org/license.html
+ */
+
+#ifndef OPENDDS_SECURITY_SSL_DIFFIE_HELLMAN_POOL_H
+#define OPENDDS_SECURITY_SSL_DIFFIE_HELLMAN_POOL_H
+
+#include "dds/DCPS/security/DdsSecurity_Export.h"
+#include "DiffieHellman.h"
+
+#include "ace/Condition_Thread_Mutex.h"
+#include "ace/Task.h"
+#include "ace/Thread_Mutex.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace Security {
+namespace SSL {
+
+/**
+ * @class DiffieHellmanPool
+ *
+ * @brief Key pairs generated ahead of the handshakes that use them.
+ *
+ * Generating a key pair is the part of the Diffie-Hellman exchange that
+ * doesn't depend on the remote participant, so a thread of the pool keeps
+ * up to @a keys key pairs ready for each algorithm that was asked for, and
+ * the handshake only takes one.  When none is ready the key pair is
+ * generated by the caller, as without the pool.  Each key pair is handed
+ * out once.  Thread safe.
+ */
+class DdsSecurity_Export DiffieHellmanPool {
+public:
+  /// Keeps up to @a keys key pairs ready per algorithm, 0 to generate each
+  /// key pair when it's taken.
+  explicit DiffieHellmanPool(size_t keys);
+
+  ~DiffieHellmanPool();
+
+  /// Starts generating key pairs for @a kagree_algo in the background.
+  void prepare(const std::string& kagree_algo);
+
+  /// Returns a key pair for @a kagree_algo, owned by the caller, or 0 if
+  /// the algorithm is unknown.
+  DiffieHellman* take(const std::string& kagree_algo);
+
+  /// Number of key pairs ready for @a kagree_algo.
+  size_t ready(const std::string& kagree_algo) const;
+
+private:
+  DiffieHellmanPool(const DiffieHellmanPool&);
+  DiffieHellmanPool& operator=(const DiffieHellmanPool&);
+
+  /// Generates the key pairs of the pool.
+  class Generator : public ACE_Task_Base {
+  public:
+    explicit Generator(DiffieHellmanPool& pool) : pool_(pool) {}
+    int svc();
+  private:
+    DiffieHellmanPool& pool_;
+  };
+
+  typedef std::vector<DiffieHellman*> Keys;
+  typedef std::map<std::string, Keys> KeyMap;
+
+  /// Adds @a kagree_algo to the algorithms to generate key pairs for, and
+  /// starts the thread, with lock_ held.
+  void want_i(const std::string& kagree_algo);
+
+  const size_t max_keys_;
+
+  // Protected by lock_.
+  mutable ACE_Thread_Mutex lock_;
+  ACE_Condition_Thread_Mutex cond_;
+  KeyMap keys_;
+  bool started_;
+  bool stop_;
+
+  Generator generator_;
+};
+
+}  // namespace SSL
+}  // namespace Security
+}  // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif
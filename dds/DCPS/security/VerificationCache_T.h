@@ -0,0 +1,139 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.OpenDDS.org/license.html
+ */
+
+#ifndef OPENDDS_SECURITY_VERIFICATION_CACHE_T_H
+#define OPENDDS_SECURITY_VERIFICATION_CACHE_T_H
+
+#include "SSL/Utils.h"
+
+#include "dds/DdsDcpsCoreC.h"
+#include "dds/Versioned_Namespace.h"
+
+#include "ace/OS_NS_sys_time.h"
+#include "ace/Time_Value.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif /* ACE_LACKS_PRAGMA_ONCE */
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace Security {
+
+/**
+* @class VerificationCache
+*
+* @brief Results of signature and certificate checks, keyed by a digest of
+*        the documents that were checked, so that documents shared by many
+*        remote participants are only checked once.
+*
+* Only successful checks are stored.  Entries expire @a lifetime after the
+* check, or earlier if the result itself stops being valid, and the oldest
+* entry is dropped when @a max_entries are stored.  A cache with no entries
+* allowed stores nothing.  The owner serializes access.
+*/
+template <typename T>
+class VerificationCache {
+public:
+  VerificationCache(size_t max_entries, const ACE_Time_Value& lifetime)
+    : max_entries_(max_entries)
+    , lifetime_(lifetime)
+    , hits_(0)
+    , misses_(0)
+  {}
+
+  /// Key for the check of @a document against @a ca.
+  /// @return int 0 on success; 1 on failure.
+  static int make_key(const DDS::OctetSeq& document, const DDS::OctetSeq& ca,
+                      std::string& key)
+  {
+    std::vector<const DDS::OctetSeq*> src;
+    src.push_back(&document);
+    src.push_back(&ca);
+    DDS::OctetSeq digest;
+    if (SSL::hash(src, digest)) {
+      return 1;
+    }
+    key.assign(reinterpret_cast<const char*>(digest.get_buffer()),
+               digest.length());
+    return 0;
+  }
+
+  /// Returns the result stored for @a key, or 0 if there is none or it
+  /// expired.
+  const T* find(const std::string& key,
+                const ACE_Time_Value& now = ACE_OS::gettimeofday())
+  {
+    const typename Map::iterator iter = entries_.find(key);
+    if (iter == entries_.end()) {
+      ++misses_;
+      return 0;
+    }
+    if (now > iter->second.expires) {
+      entries_.erase(iter);
+      ++misses_;
+      return 0;
+    }
+    ++hits_;
+    return &iter->second.value;
+  }
+
+  /// Stores @a value for @a key until @a lifetime after @a now, or until
+  /// @a not_after if that comes first.
+  void insert(const std::string& key, const T& value,
+              const ACE_Time_Value& now = ACE_OS::gettimeofday(),
+              const ACE_Time_Value& not_after = ACE_Time_Value::max_time)
+  {
+    if (max_entries_ == 0) {
+      return;
+    }
+    if (entries_.size() >= max_entries_ && entries_.find(key) == entries_.end()) {
+      typename Map::iterator oldest = entries_.begin();
+      for (typename Map::iterator iter = entries_.begin(); iter != entries_.end(); ++iter) {
+        if (iter->second.verified < oldest->second.verified) {
+          oldest = iter;
+        }
+      }
+      entries_.erase(oldest);
+    }
+    Entry& entry = entries_[key];
+    entry.value = value;
+    entry.verified = now;
+    entry.expires = std::min(now + lifetime_, not_after);
+  }
+
+  size_t size() const { return entries_.size(); }
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+
+private:
+  struct Entry {
+    T value;
+    ACE_Time_Value verified;
+    ACE_Time_Value expires;
+  };
+  typedef std::map<std::string, Entry> Map;
+
+  const size_t max_entries_;
+  const ACE_Time_Value lifetime_;
+  Map entries_;
+  size_t hits_;
+  size_t misses_;
+};
+
+} // namespace Security
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif
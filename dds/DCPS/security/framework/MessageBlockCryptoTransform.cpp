@@ -0,0 +1,27 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "DCPS/DdsDcps_pch.h" //Only the _pch include should start with DCPS/
+#include "MessageBlockCryptoTransform.h"
+
+#ifdef OPENDDS_SECURITY
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace Security {
+
+MessageBlockCryptoTransform::~MessageBlockCryptoTransform()
+{
+}
+
+} // namespace Security
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_DCPS_SECURITY_MESSAGE_BLOCK_CRYPTO_TRANSFORM_H
+#define OPENDDS_DCPS_SECURITY_MESSAGE_BLOCK_CRYPTO_TRANSFORM_H
+
+#include <ace/config.h>
+#if !defined (ACE_LACKS_PRAGMA_ONCE)
+#pragma once
+#endif
+
+#include "dds/DCPS/dcps_export.h"
+
+#ifdef OPENDDS_SECURITY
+#include "dds/DdsSecurityCoreC.h"
+
+#include "ace/Message_Block.h"
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace Security {
+
+/**
+ * @class MessageBlockCryptoTransform
+ *
+ * @brief Optional interface of a CryptoTransform plugin that encodes
+ *        submessages straight out of the message blocks of an RTPS message.
+ *
+ * The transport finds it with a dynamic_cast of the CryptoTransform.  The
+ * plain submessage is read from the message block chain where it is, and
+ * the encoded submessage is written into the block that is sent, instead of
+ * copying both through DDS::OctetSeqs.  Plugins without it are used through
+ * the CryptoTransform operations.
+ */
+class OpenDDS_Dcps_Export MessageBlockCryptoTransform {
+public:
+  virtual ~MessageBlockCryptoTransform();
+
+  /// Most bytes the encoding of a submessage of @a plain_length bytes
+  /// takes.
+  virtual size_t max_encoded_submessage_length(size_t plain_length) const = 0;
+
+  /// Same as CryptoTransform::encode_datawriter_submessage() for the
+  /// @a plain_length bytes of the chain starting at the rd_ptr of @a plain.
+  /// The encoded submessage is written at the wr_ptr of @a out, which must
+  /// have max_encoded_submessage_length() bytes of space.  If the submessage
+  /// is sent as is @a encoded is false and nothing is written.
+  virtual bool encode_datawriter_submessage(
+    ACE_Message_Block& out,
+    bool& encoded,
+    const ACE_Message_Block& plain,
+    size_t plain_length,
+    DDS::Security::DatawriterCryptoHandle sending_datawriter_crypto,
+    const DDS::Security::DatareaderCryptoHandleSeq& receiving_datareader_crypto_list,
+    DDS::Security::SecurityException& ex) = 0;
+
+  /// Same as CryptoTransform::encode_datareader_submessage(), see
+  /// encode_datawriter_submessage().
+  virtual bool encode_datareader_submessage(
+    ACE_Message_Block& out,
+    bool& encoded,
+    const ACE_Message_Block& plain,
+    size_t plain_length,
+    DDS::Security::DatareaderCryptoHandle sending_datareader_crypto,
+    const DDS::Security::DatawriterCryptoHandleSeq& receiving_datawriter_crypto_list,
+    DDS::Security::SecurityException& ex) = 0;
+};
+
+} // namespace Security
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif
+
+#endif
@@ -92,6 +92,7 @@ ReceiveListenerSet::data_received(const ReceivedDataSample& sample,
   OPENDDS_VECTOR(TransportReceiveListener_wrch) handles;
   {
     GuardType guard(this->lock_);
+    handles.reserve(map_.size());
     for (MapType::iterator itr = map_.begin(); itr != map_.end(); ++itr) {
       if (constrain == ReceiveListenerSet::SET_EXCLUDED) {
         if (itr->second && incl_excl.count(itr->first) == 0) {
@@ -851,7 +851,7 @@ TransportClient::send_i(SendStateDataSampleList send_list, ACE_UINT64 transactio
             }
           }
 
-          pub_links = subset;
+          pub_links = move(subset);
         }
 
   #endif // OPENDDS_NO_CONTENT_SUBSCRIPTION_PROFILE
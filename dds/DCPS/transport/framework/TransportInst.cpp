@@ -39,6 +39,8 @@ OpenDDS::DCPS::TransportInst::load(ACE_Configuration_Heap& cf,
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("optimum_packet_size"), this->optimum_packet_size_, ACE_UINT32)
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("thread_per_connection"), this->thread_per_connection_, bool)
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("datalink_release_delay"), this->datalink_release_delay_, int)
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("coalesce_delay_usec"), this->coalesce_delay_usec_, long)
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("coalesce_max_bytes"), this->coalesce_max_bytes_, ACE_UINT32)
 
   // Undocumented - this option is not in the Developer's Guide
   // Controls the number of chunks in the allocators used by the datalink
@@ -98,6 +100,8 @@ OpenDDS::DCPS::TransportInst::dump_to_str() const
   ret += formatNameForDump("thread_per_connection")   + (this->thread_per_connection_ ? "true" : "false") + '\n';
   ret += formatNameForDump("datalink_release_delay")  + to_dds_string(this->datalink_release_delay_) + '\n';
   ret += formatNameForDump("datalink_control_chunks") + to_dds_string(unsigned(this->datalink_control_chunks_)) + '\n';
+  ret += formatNameForDump("coalesce_delay_usec")     + to_dds_string(this->coalesce_delay_usec_) + '\n';
+  ret += formatNameForDump("coalesce_max_bytes")      + to_dds_string(unsigned(this->coalesce_max_bytes_)) + '\n';
   return ret;
 }
 
@@ -96,6 +96,17 @@ public:
   /// samples. The default value is 32.
   size_t datalink_control_chunks_;
 
+  /// Delay in microseconds that a partly filled packet may be held after
+  /// the last send_stop() so that samples from later writes on the same
+  /// DataLink can join it.  The default value is 0, which sends the packet
+  /// right away.  Requires a transport that has a reactor.
+  long coalesce_delay_usec_;
+
+  /// A held packet is sent as soon as it reaches this size (bytes) without
+  /// waiting for the delay.  The default value of 0 uses
+  /// optimum_packet_size_.
+  ACE_UINT32 coalesce_max_bytes_;
+
   /// Does the transport as configured support RELIABLE_RELIABILITY_QOS?
   virtual bool is_reliable() const = 0;
 
@@ -12,6 +12,10 @@
 #include "dds/DCPS/GuidConverter.h"
 #include "dds/DCPS/DisjointSequence.h"
 
+#include "ace/OS_NS_string.h"
+
+#include <algorithm>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
@@ -33,6 +37,26 @@ TransportReassembly::FragRange::FragRange(const SequenceRange& seqRange,
 {
 }
 
+TransportReassembly::FragBuffer::FragBuffer()
+  : rec_ds_(0)
+  , sample_size_(0)
+  , fragment_size_(0)
+  , total_frags_(0)
+  , received_count_(0)
+  , highest_(0)
+  , age_(0)
+{
+}
+
+TransportReassembly::TransportReassembly(size_t max_buffer_bytes)
+  : next_age_(0)
+  , max_buffer_bytes_(max_buffer_bytes)
+  , buffered_bytes_(0)
+  , evictions_(0)
+  , evicted_bytes_(0)
+{
+}
+
 namespace {
   inline void join_err(const char* detail)
   {
@@ -151,7 +175,8 @@ bool
 TransportReassembly::has_frags(const SequenceNumber& seq,
                                const RepoId& pub_id) const
 {
-  return fragments_.count(FragKey(pub_id, seq));
+  const FragKey key(pub_id, seq);
+  return fragments_.count(key) || buffers_.count(key);
 }
 
 CORBA::ULong
@@ -161,7 +186,13 @@ TransportReassembly::get_gaps(const SequenceNumber& seq, const RepoId& pub_id,
 {
   // length is number of (allocated) words in bitmap, max of 8
   // numBits is number of valid bits in the bitmap, <= length * 32, to account for partial words
-  const FragMap::const_iterator iter = fragments_.find(FragKey(pub_id, seq));
+  const FragKey key(pub_id, seq);
+  const BufferMap::const_iterator buffer = buffers_.find(key);
+  if (buffer != buffers_.end() && length) {
+    return get_buffer_gaps(buffer->second, bitmap, length, numBits);
+  }
+
+  const FragMap::const_iterator iter = fragments_.find(key);
   if (iter == fragments_.end() || length == 0) {
     // Nothing missing
     return 0;
@@ -206,6 +237,44 @@ TransportReassembly::get_gaps(const SequenceNumber& seq, const RepoId& pub_id,
   return base;
 }
 
+CORBA::ULong
+TransportReassembly::get_buffer_gaps(const FragBuffer& buffer,
+                                     CORBA::Long bitmap[], CORBA::ULong length,
+                                     CORBA::ULong& numBits)
+{
+  // As with the ranges, the base is the first missing fragment and the
+  // bitmap has the missing fragments up to the highest one received.
+  CORBA::ULong base = 1;
+  while (base <= buffer.total_frags_ && buffer.received_[(base - 1) / 32] == 0xffffffff) {
+    base += 32;
+  }
+  while (base <= buffer.total_frags_ && buffer.has(base)) {
+    ++base;
+  }
+
+  if (base > buffer.highest_) {
+    // No gaps, but we know there is (at least 1) more fragment
+    DisjointSequence::fill_bitmap_range(0, 0, bitmap, length, numBits);
+    return base;
+  }
+
+  const CORBA::ULong limit = std::min(CORBA::ULong(buffer.highest_),
+                                      base + length * 32 - 1);
+  for (CORBA::ULong frag = base; frag <= limit; ++frag) {
+    if (buffer.has(frag)) {
+      continue;
+    }
+    const CORBA::ULong low = frag;
+    while (frag < limit && !buffer.has(frag + 1)) {
+      ++frag;
+    }
+    DisjointSequence::fill_bitmap_range(low - base, frag - base,
+                                        bitmap, length, numBits);
+  }
+
+  return base;
+}
+
 bool
 TransportReassembly::reassemble(const SequenceRange& seqRange,
                                 ReceivedDataSample& data)
@@ -222,6 +291,246 @@ TransportReassembly::reassemble(const SequenceNumber& transportSeq,
                       firstFrag, data);
 }
 
+bool
+TransportReassembly::reassemble(const SequenceRange& fragRange,
+                                ACE_UINT32 sampleSize,
+                                ACE_UINT32 fragmentSize,
+                                ReceivedDataSample& data)
+{
+  const FragKey key(data.header_.publication_id_, data.header_.sequence_);
+
+  BufferMap::iterator iter = buffers_.find(key);
+  const bool created = iter == buffers_.end();
+  if (created) {
+    if (sampleSize > max_buffer_bytes_) {
+      if (Transport_debug_level > 1) {
+        GuidConverter conv(key.publication_);
+        ACE_DEBUG((LM_DEBUG, "(%P|%t) TransportReassembly::reassemble() - "
+          "dropping dseq %q pub %C, %u bytes is over the limit of %B\n",
+          key.data_sample_seq_.getValue(), OPENDDS_STRING(conv).c_str(),
+          sampleSize, max_buffer_bytes_));
+      }
+      return false;
+    }
+    // Samples already being reassembled from ranges keep using ranges.
+    if (sampleSize == 0 || fragmentSize == 0 || fragments_.count(key)) {
+      return reassemble_i(fragRange, fragRange.first == 1, data);
+    }
+    iter = create_buffer(key, sampleSize, fragmentSize);
+    if (iter == buffers_.end()) {
+      return false;
+    }
+  }
+
+  FragBuffer& buffer = iter->second;
+  if (!reassemble_buffer(buffer, fragRange, sampleSize, fragmentSize, data)) {
+    if (created) {
+      // Nothing was copied into it.
+      erase_buffer(iter);
+    }
+    return false;
+  }
+  if (buffer.received_count_ < buffer.total_frags_) {
+    return false;
+  }
+
+  buffer.rec_ds_.header_.message_length_ = buffer.sample_size_;
+  buffer.rec_ds_.header_.more_fragments_ = false;
+  swap(data, buffer.rec_ds_);
+  erase_buffer(iter);
+  VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
+    "completed buffer, returning true\n"));
+  return true;
+}
+
+TransportReassembly::BufferMap::iterator
+TransportReassembly::create_buffer(const FragKey& key, ACE_UINT32 sampleSize,
+                                   ACE_UINT32 fragmentSize)
+{
+  while (buffered_bytes_ + sampleSize > max_buffer_bytes_
+         && evict_oldest(key, sampleSize)) {}
+
+  ACE_Message_Block* mb = 0;
+  ACE_NEW_RETURN(mb, ACE_Message_Block(sampleSize), buffers_.end());
+  if (mb->size() < sampleSize) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: TransportReassembly::create_buffer() - ")
+      ACE_TEXT("could not allocate %u bytes\n"), sampleSize));
+    mb->release();
+    return buffers_.end();
+  }
+  mb->wr_ptr(sampleSize);
+
+  const BufferMap::iterator iter =
+    buffers_.insert(std::make_pair(key, FragBuffer())).first;
+  FragBuffer& buffer = iter->second;
+  buffer.rec_ds_.sample_.reset(mb);
+  buffer.sample_size_ = sampleSize;
+  buffer.fragment_size_ = fragmentSize;
+  buffer.total_frags_ = sampleSize / fragmentSize + (sampleSize % fragmentSize ? 1 : 0);
+  buffer.received_.resize((buffer.total_frags_ + 31) / 32);
+  buffer.age_ = next_age_++;
+  ages_[buffer.age_] = key;
+  buffered_bytes_ += sampleSize;
+  return iter;
+}
+
+void
+TransportReassembly::erase_buffer(BufferMap::iterator iter)
+{
+  buffered_bytes_ -= iter->second.sample_size_;
+  ages_.erase(iter->second.age_);
+  buffers_.erase(iter);
+}
+
+bool
+TransportReassembly::hold_range_bytes(const FragKey& key, size_t bytes)
+{
+  while (buffered_bytes_ + bytes > max_buffer_bytes_ && evict_oldest(key, bytes)) {}
+
+  if (buffered_bytes_ + bytes > max_buffer_bytes_) {
+    const RangeBytesMap::const_iterator held = range_bytes_.find(key);
+    const size_t held_bytes = held == range_bytes_.end() ? 0 : held->second.bytes_;
+    if (held != range_bytes_.end()) {
+      ++evictions_;
+      evicted_bytes_ += held_bytes;
+    }
+    if (Transport_debug_level > 1) {
+      GuidConverter conv(key.publication_);
+      ACE_DEBUG((LM_DEBUG, "(%P|%t) TransportReassembly::hold_range_bytes() - "
+        "dropping dseq %q pub %C, %B bytes is over the limit of %B\n",
+        key.data_sample_seq_.getValue(), OPENDDS_STRING(conv).c_str(),
+        held_bytes + bytes, max_buffer_bytes_));
+    }
+    erase_ranges(key);
+    return false;
+  }
+
+  const RangeBytesMap::iterator iter = range_bytes_.find(key);
+  if (iter == range_bytes_.end()) {
+    RangeBytes& held = range_bytes_[key];
+    held.age_ = next_age_++;
+    ages_[held.age_] = key;
+    held.bytes_ = bytes;
+  } else {
+    iter->second.bytes_ += bytes;
+  }
+  buffered_bytes_ += bytes;
+  return true;
+}
+
+void
+TransportReassembly::erase_ranges(const FragKey& key)
+{
+  fragments_.erase(key);
+  have_first_.erase(key);
+
+  const RangeBytesMap::iterator iter = range_bytes_.find(key);
+  if (iter != range_bytes_.end()) {
+    buffered_bytes_ -= iter->second.bytes_;
+    ages_.erase(iter->second.age_);
+    range_bytes_.erase(iter);
+  }
+}
+
+bool
+TransportReassembly::evict_oldest(const FragKey& keep, size_t bytes)
+{
+  // A reliable writer sends the fragments of the dropped sample again when
+  // they are nacked.
+  for (Ages::iterator it = ages_.begin(); it != ages_.end(); ++it) {
+    if (!(it->second < keep) && !(keep < it->second)) {
+      continue;
+    }
+    const FragKey key = it->second;
+    size_t evicted = 0;
+    const BufferMap::iterator buffer = buffers_.find(key);
+    if (buffer != buffers_.end()) {
+      evicted += buffer->second.sample_size_;
+      erase_buffer(buffer);
+    }
+    const RangeBytesMap::const_iterator held = range_bytes_.find(key);
+    if (held != range_bytes_.end()) {
+      evicted += held->second.bytes_;
+      erase_ranges(key);
+    }
+    ++evictions_;
+    evicted_bytes_ += evicted;
+    if (Transport_debug_level > 1) {
+      GuidConverter conv(key.publication_);
+      ACE_DEBUG((LM_DEBUG, "(%P|%t) TransportReassembly::evict_oldest() - "
+        "evicting dseq %q pub %C (%B bytes) for %B more bytes\n",
+        key.data_sample_seq_.getValue(), OPENDDS_STRING(conv).c_str(),
+        evicted, bytes));
+    }
+    return true;
+  }
+  return false;
+}
+
+bool
+TransportReassembly::reassemble_buffer(FragBuffer& buffer,
+                                       const SequenceRange& fragRange,
+                                       ACE_UINT32 sampleSize,
+                                       ACE_UINT32 fragmentSize,
+                                       ReceivedDataSample& data)
+{
+  if (sampleSize != buffer.sample_size_ || fragmentSize != buffer.fragment_size_
+      || fragRange.first.getValue() < 1 || fragRange.second < fragRange.first
+      || fragRange.second.getValue() > buffer.total_frags_) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: TransportReassembly::reassemble_buffer() - ")
+      ACE_TEXT("fragments %q-%q of %u bytes don't fit the sample of %u bytes in ")
+      ACE_TEXT("fragments of %u bytes\n"), fragRange.first.getValue(),
+      fragRange.second.getValue(), fragmentSize, buffer.sample_size_,
+      buffer.fragment_size_));
+    return false;
+  }
+
+  const ACE_UINT32 first = static_cast<ACE_UINT32>(fragRange.first.getValue()),
+    last = static_cast<ACE_UINT32>(fragRange.second.getValue());
+
+  ACE_UINT32 added = 0;
+  for (ACE_UINT32 frag = first; frag <= last; ++frag) {
+    if (!buffer.has(frag)) {
+      ++added;
+    }
+  }
+  if (!added) {
+    VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble_buffer() "
+      "duplicate fragments, returning false\n"));
+    return false;
+  }
+
+  const size_t offset = size_t(first - 1) * fragmentSize;
+  const size_t size =
+    std::min(size_t(last) * fragmentSize, size_t(buffer.sample_size_)) - offset;
+  if (!data.sample_ || data.sample_->total_length() < size) {
+    ACE_ERROR((LM_ERROR, ACE_TEXT("(%P|%t) ERROR: TransportReassembly::reassemble_buffer() - ")
+      ACE_TEXT("fragments %u-%u have fewer than %B bytes\n"), first, last, size));
+    return false;
+  }
+
+  char* dest = buffer.rec_ds_.sample_->base() + offset;
+  size_t remaining = size;
+  for (const ACE_Message_Block* mb = data.sample_.get(); mb && remaining; mb = mb->cont()) {
+    const size_t n = std::min(mb->length(), remaining);
+    ACE_OS::memcpy(dest, mb->rd_ptr(), n);
+    dest += n;
+    remaining -= n;
+  }
+
+  for (ACE_UINT32 frag = first; frag <= last; ++frag) {
+    buffer.received_[(frag - 1) / 32] |= 1u << ((frag - 1) % 32);
+  }
+  buffer.received_count_ += added;
+  buffer.highest_ = std::max(buffer.highest_, last);
+
+  // Only the first fragment carries the inline QoS, so its header wins.
+  if (first == 1 || buffer.received_count_ == added) {
+    buffer.rec_ds_.header_ = data.header_;
+  }
+  return true;
+}
+
 bool
 TransportReassembly::reassemble_i(const SequenceRange& seqRange,
                                   bool firstFrag,
@@ -237,6 +546,10 @@ TransportReassembly::reassemble_i(const SequenceRange& seqRange,
 
   const FragKey key(data.header_.publication_id_, data.header_.sequence_);
 
+  if (!hold_range_bytes(key, data.sample_ ? data.sample_->total_length() : 0)) {
+    return false;
+  }
+
   if (firstFrag) {
     have_first_.insert(key);
   }
@@ -263,8 +576,7 @@ TransportReassembly::reassemble_i(const SequenceRange& seqRange,
       && iter->second.size() == 1
       && !iter->second.front().rec_ds_.header_.more_fragments_) {
     swap(data, iter->second.front().rec_ds_);
-    fragments_.erase(iter);
-    have_first_.erase(key);
+    erase_ranges(key);
     VDBG((LM_DEBUG, "(%P|%t) DBG:   TransportReassembly::reassemble() "
       "removed frag, returning %C\n", data.sample_ ? "true" : "false"));
     return data.sample_.get(); // could be false if we had data_unavailable()
@@ -332,8 +644,12 @@ TransportReassembly::data_unavailable(const SequenceNumber& dataSampleSeq,
                                       const RepoId& pub_id)
 {
   const FragKey key(pub_id, dataSampleSeq);
-  fragments_.erase(key);
-  have_first_.erase(key);
+  erase_ranges(key);
+
+  const BufferMap::iterator iter = buffers_.find(key);
+  if (iter != buffers_.end()) {
+    erase_buffer(iter);
+  }
 }
 
 }
@@ -21,6 +21,13 @@ namespace DCPS {
 class OpenDDS_Dcps_Export TransportReassembly {
 public:
 
+  enum { DEFAULT_MAX_BUFFER_BYTES = 128 * 1024 * 1024 };
+
+  /// Partially-reassembled samples together hold at most
+  /// @a max_buffer_bytes, whether they are reassembled in buffers or from
+  /// fragment ranges.
+  explicit TransportReassembly(size_t max_buffer_bytes = DEFAULT_MAX_BUFFER_BYTES);
+
   /// Called by TransportReceiveStrategy if the fragmentation header flag
   /// is set.  Returns true/false to indicate if data should be delivered to
   /// the datalink.  The 'data' argument may be modified by this method.
@@ -29,9 +36,19 @@ public:
 
   bool reassemble(const SequenceRange& seqRange, ReceivedDataSample& data);
 
+  /// Called for fragments that carry the size of the whole sample and of
+  /// each fragment (the last one may be shorter), like RTPS DATA_FRAG.
+  /// @a fragRange holds fragment numbers, starting from 1.  The fragments
+  /// are copied into a buffer for the whole sample.  Samples larger than
+  /// the limit on held bytes are dropped.
+  bool reassemble(const SequenceRange& fragRange, ACE_UINT32 sampleSize,
+                  ACE_UINT32 fragmentSize, ReceivedDataSample& data);
+
   /// Called by TransportReceiveStrategy to indicate that we can
   /// stop tracking partially-reassembled messages when we know the
-  /// remaining fragments are not expected to arrive.
+  /// remaining fragments are not expected to arrive.  Samples
+  /// reassembled in buffers don't use transport sequence numbers and are
+  /// not affected.
   void data_unavailable(const SequenceRange& transportSeqDropped);
 
   void data_unavailable(const SequenceNumber& dataSampleSeq,
@@ -48,6 +65,16 @@ public:
                         CORBA::Long bitmap[], CORBA::ULong length,
                         CORBA::ULong& numBits) const;
 
+  /// Bytes held by partially-reassembled samples: the size of their
+  /// buffers, or the bytes received for them as fragment ranges.
+  size_t buffered_bytes() const { return buffered_bytes_; }
+
+  /// Partially-reassembled samples dropped to make room for newer ones,
+  /// or because their fragment ranges grew over the limit, and the bytes
+  /// they held.
+  size_t evictions() const { return evictions_; }
+  size_t evicted_bytes() const { return evicted_bytes_; }
+
 private:
 
   bool reassemble_i(const SequenceRange& seqRange, bool firstFrag,
@@ -93,9 +120,82 @@ private:
 
   OPENDDS_SET(FragKey) have_first_;
 
+  // Bytes received for each sample in fragments_, counted in
+  // buffered_bytes_ until the sample is removed.  Fragments later merged
+  // with unavailable ones stay counted.
+  struct RangeBytes {
+    RangeBytes() : bytes_(0), age_(0) {}
+    size_t bytes_;
+    ACE_UINT64 age_;
+  };
+  typedef OPENDDS_MAP(FragKey, RangeBytes) RangeBytesMap;
+  RangeBytesMap range_bytes_;
+
   static bool insert(OPENDDS_LIST(FragRange)& flist,
                      const SequenceRange& seqRange,
                      ReceivedDataSample& data);
+
+  // A FragBuffer holds a sample whose size was known from the first of its
+  // fragments to arrive.  Each fragment is copied to its place in
+  // rec_ds_.sample_ and marked in the received_ bitmap, so arrival order
+  // doesn't matter and nothing is searched.
+  struct FragBuffer {
+    FragBuffer();
+
+    bool has(ACE_UINT32 frag) const
+    {
+      return received_[(frag - 1) / 32] & (1u << ((frag - 1) % 32));
+    }
+
+    ReceivedDataSample rec_ds_;
+    ACE_UINT32 sample_size_;
+    ACE_UINT32 fragment_size_;
+    ACE_UINT32 total_frags_;
+    ACE_UINT32 received_count_;
+    ACE_UINT32 highest_;
+    ACE_UINT64 age_;
+    OPENDDS_VECTOR(ACE_UINT32) received_;
+  };
+
+  typedef OPENDDS_MAP(FragKey, FragBuffer) BufferMap;
+  BufferMap buffers_;
+
+  // Partially-reassembled samples, in buffers or ranges, by the order
+  // they were first received in, oldest first.
+  typedef OPENDDS_MAP(ACE_UINT64, FragKey) Ages;
+  Ages ages_;
+  ACE_UINT64 next_age_;
+
+  size_t max_buffer_bytes_;
+  size_t buffered_bytes_;
+  size_t evictions_;
+  size_t evicted_bytes_;
+
+  bool reassemble_buffer(FragBuffer& buffer, const SequenceRange& fragRange,
+                         ACE_UINT32 sampleSize, ACE_UINT32 fragmentSize,
+                         ReceivedDataSample& data);
+
+  BufferMap::iterator create_buffer(const FragKey& key,
+                                    ACE_UINT32 sampleSize,
+                                    ACE_UINT32 fragmentSize);
+
+  void erase_buffer(BufferMap::iterator iter);
+
+  /// Counts @a bytes received as fragment ranges for @a key, making room
+  /// if needed.  Returns false, after dropping the sample's fragments, if
+  /// the sample doesn't fit.
+  bool hold_range_bytes(const FragKey& key, size_t bytes);
+
+  void erase_ranges(const FragKey& key);
+
+  /// Drops the oldest partially-reassembled sample other than @a keep to
+  /// make room for @a bytes more.  Returns false if there is none.
+  bool evict_oldest(const FragKey& keep, size_t bytes);
+
+  static CORBA::ULong get_buffer_gaps(const FragBuffer& buffer,
+                                      CORBA::Long bitmap[],
+                                      CORBA::ULong length,
+                                      CORBA::ULong& numBits);
 };
 
 }
@@ -24,8 +24,11 @@
 #include "dds/DCPS/Service_Participant.h"
 #include "EntryExit.h"
 
+#include "ace/Reactor.h"
 #include "ace/Reverse_Lock_T.h"
 
+#include <algorithm>
+
 #if !defined (__ACE_INLINE__)
 #include "TransportSendStrategy.inl"
 #endif /* __ACE_INLINE__ */
@@ -78,7 +81,11 @@ TransportSendStrategy::TransportSendStrategy(
     transport_(transport),
     graceful_disconnecting_(false),
     link_released_(true),
-    send_buffer_(0)
+    send_buffer_(0),
+    coalesce_delay_(0, transport.config().coalesce_delay_usec_),
+    coalesce_timer_armed_(false),
+    coalesce_batches_(0),
+    coalesce_current_(false)
 {
   DBG_ENTRY_LVL("TransportSendStrategy","TransportSendStrategy",6);
 
@@ -98,6 +105,17 @@ TransportSendStrategy::TransportSendStrategy(
   this->max_header_size_ = TransportHeader::max_marshaled_size();
 
   delayed_delivered_notification_queue_.reserve(this->max_samples_);
+
+  if (this->coalesce_delay_ > ACE_Time_Value::zero) {
+    this->coalesce_timer_ = make_rch<CoalesceTimer>(ref(*this));
+
+    // send() already sends the current packet once it grows past the
+    // optimum size, so that is also the limit for holding it.
+    const ACE_UINT32 coalesce_max = transport.config().coalesce_max_bytes_;
+    if (coalesce_max) {
+      this->optimum_size_ = std::min(coalesce_max, this->max_size_);
+    }
+  }
 }
 
 TransportSendStrategy::~TransportSendStrategy()
@@ -791,6 +809,8 @@ TransportSendStrategy::clear(SendMode mode)
     this->start_counter_ = 0;
     this->mode_ = mode;
     this->mode_before_suspend_ = MODE_NOT_SET;
+    this->coalesce_batches_ = 0;
+    this->coalesce_current_ = false;
   }
 
   // We need remove the queued elements outside the lock,
@@ -853,6 +873,31 @@ TransportSendStrategy::stop()
 {
   DBG_ENTRY_LVL("TransportSendStrategy","stop",6);
 
+  if (this->coalesce_timer_) {
+    ACE_Reactor_Timer_Interface* const timer = this->transport_.timer();
+    if (timer) {
+      timer->cancel_timer(this->coalesce_timer_.in());
+    }
+
+    {
+      GuardType guard(this->lock_);
+      // Don't leave a held packet behind.
+      if (this->mode_ == MODE_DIRECT && this->elems_.size() > 0
+          && this->start_counter_ == 0 && !this->link_released_) {
+        this->direct_send(false);
+      }
+
+      VDBG_LVL((LM_DEBUG, "(%P|%t) TransportSendStrategy::stop() - "
+                "coalescing held %Q packets, saved %Q packets, "
+                "%Q sent on deadline\n",
+                this->coalesce_stats_.packets_held_,
+                this->coalesce_stats_.packets_saved_,
+                this->coalesce_stats_.deadline_flushes_), 2);
+    }
+
+    send_delayed_notifications();
+  }
+
   if (this->header_block_ != 0) {
     this->header_block_->release ();
     this->header_block_ = 0;
@@ -1084,6 +1129,7 @@ TransportSendStrategy::send(TransportQueueElement* element, bool relink)
 
         // Add the current element to the collection of packet elements.
         this->elems_.put(element);
+        this->coalesce_current_ = true;
 
         VDBG((LM_DEBUG, "(%P|%t) DBG:   "
               "Before, the header_.length_ == [%d].\n",
@@ -1173,6 +1219,7 @@ void
 TransportSendStrategy::send_stop(RepoId /*repoId*/)
 {
   DBG_ENTRY_LVL("TransportSendStrategy","send_stop",6);
+  bool held = false;
   {
     GuardType guard(this->lock_);
 
@@ -1232,11 +1279,25 @@ TransportSendStrategy::send_stop(RepoId /*repoId*/)
           "We are in MODE_DIRECT in an important send_stop() - "
           "header_.length_ == [%d].\n", header_length));
 
+    if (this->coalesce_current_) {
+      this->coalesce_current_ = false;
+      ++this->coalesce_batches_;
+    }
+
     // Only attempt to send the current packet (directly) if the current
-    // packet actually contains something (it could be empty).
+    // packet actually contains something (it could be empty), and it isn't
+    // being held for coalescing.
     if ((header_length > 0) &&
         //(this->elems_.size ()+this->not_yet_pac_q_->size() > 0))
         (this->elems_.size() > 0)) {
+      held = this->hold_packet();
+    }
+
+    if (held) {
+      VDBG((LM_DEBUG, "(%P|%t) DBG:   "
+            "Holding the current packet for samples from later writes.\n"));
+
+    } else if ((header_length > 0) && (this->elems_.size() > 0)) {
       VDBG((LM_DEBUG, "(%P|%t) DBG:   "
             "There is something in the current packet - attempt to send "
             "it (directly) now.\n"));
@@ -1257,9 +1318,93 @@ TransportSendStrategy::send_stop(RepoId /*repoId*/)
     }
   }
 
+  if (held) {
+    schedule_coalesce_timer();
+  }
+
+  send_delayed_notifications();
+}
+
+bool
+TransportSendStrategy::hold_packet()
+{
+  if (!this->coalesce_timer_ || this->mode_ != MODE_DIRECT
+      || this->max_header_size_ + this->header_.length_ >= this->optimum_size_
+      || this->elems_.size() >= this->max_samples_
+      || !this->transport_.timer()) {
+    return false;
+  }
+
+  ++this->coalesce_stats_.packets_held_;
+  return true;
+}
+
+void
+TransportSendStrategy::schedule_coalesce_timer()
+{
+  {
+    GuardType guard(this->lock_);
+    if (this->coalesce_timer_armed_) {
+      // The packet goes out no later than the pending deadline.
+      return;
+    }
+    this->coalesce_timer_armed_ = true;
+  }
+
+  // Not under lock_, the timer's upcall takes it while the reactor is locked.
+  ACE_Reactor_Timer_Interface* const timer = this->transport_.timer();
+  if (!timer || timer->schedule_timer(this->coalesce_timer_.in(), 0,
+                                      this->coalesce_delay_) == -1) {
+    ACE_ERROR((LM_WARNING,
+               ACE_TEXT("(%P|%t) WARNING: TransportSendStrategy::")
+               ACE_TEXT("schedule_coalesce_timer() - failed to schedule ")
+               ACE_TEXT("timer, sending held packet now.\n")));
+    this->coalesce_timeout();
+  }
+}
+
+void
+TransportSendStrategy::coalesce_timeout()
+{
+  {
+    GuardType guard(this->lock_);
+    this->coalesce_timer_armed_ = false;
+
+    if (this->link_released_ || this->mode_ != MODE_DIRECT
+        || this->coalesce_batches_ == 0 || this->elems_.size() == 0) {
+      // Nothing held, the packet went out with later samples.
+      return;
+    }
+
+    ++this->coalesce_stats_.deadline_flushes_;
+    this->direct_send(false);
+
+    if (this->mode_ == MODE_QUEUE) {
+      this->synch_->work_available();
+    }
+  }
+
   send_delayed_notifications();
 }
 
+int
+TransportSendStrategy::CoalesceTimer::handle_timeout(const ACE_Time_Value&,
+                                                     const void*)
+{
+  RcHandle<TransportSendStrategy> outer = this->outer_.lock();
+  if (outer) {
+    outer->coalesce_timeout();
+  }
+  return 0;
+}
+
+TransportSendStrategy::CoalesceStats
+TransportSendStrategy::coalesce_stats() const
+{
+  GuardType guard(this->lock_);
+  return this->coalesce_stats_;
+}
+
 void
 TransportSendStrategy::remove_all_msgs(RepoId pub_id)
 {
@@ -1418,6 +1563,17 @@ TransportSendStrategy::direct_send(bool relink)
   VDBG((LM_DEBUG, "(%P|%t) DBG:   "
         "Prepare the current packet for a direct send attempt.\n"));
 
+  // Without coalescing each send_stop() whose samples are in this packet,
+  // and the window still open if it has samples here, would have sent a
+  // packet of its own.
+  const size_t batches =
+    this->coalesce_batches_ + (this->coalesce_current_ ? 1 : 0);
+  if (batches > 1) {
+    this->coalesce_stats_.packets_saved_ += batches - 1;
+  }
+  this->coalesce_batches_ = 0;
+  this->coalesce_current_ = false;
+
   // Prepare the packet for sending.
   this->prepare_packet();
 
@@ -11,6 +11,7 @@
 #include "dds/DCPS/dcps_export.h"
 #include "dds/DCPS/Definitions.h"
 #include "dds/DCPS/RcObject.h"
+#include "dds/DCPS/RcEventHandler.h"
 #include "dds/DCPS/PoolAllocator.h"
 #include "ThreadSynchWorker.h"
 #include "TransportDefs.h"
@@ -20,6 +21,7 @@
 #include "TransportRetainedElement.h"
 #include "ThreadSynchStrategy_rch.h"
 #include "ace/Synch_Traits.h"
+#include "ace/Time_Value.h"
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -139,6 +141,24 @@ public:
 
   void deliver_ack_request(TransportQueueElement* element);
 
+  /// Counters for packets held by the coalescing mode (see
+  /// TransportInst::coalesce_delay_usec_).
+  struct CoalesceStats {
+    CoalesceStats()
+      : packets_held_(0), packets_saved_(0), deadline_flushes_(0) {}
+
+    /// Times a send_stop() held the current packet instead of sending it.
+    ACE_UINT64 packets_held_;
+    /// Packets that would have been sent without coalescing, but whose
+    /// samples went out as part of another packet.
+    ACE_UINT64 packets_saved_;
+    /// Held packets sent because the delay expired (the others reached
+    /// coalesce_max_bytes_ or were pushed out by a new sample).
+    ACE_UINT64 deadline_flushes_;
+  };
+
+  CoalesceStats coalesce_stats() const;
+
 protected:
 
   TransportSendStrategy(std::size_t id,
@@ -263,6 +283,22 @@ private:
   /// or max_size_ [user's configured limit]
   size_t space_available() const;
 
+  /// Called from send_stop() with a non-empty current packet.  Returns true
+  /// if the packet should be held for coalescing, in which case the caller
+  /// must call schedule_coalesce_timer() once the lock_ is released.
+  bool hold_packet();
+
+  void schedule_coalesce_timer();
+
+  /// Sends a held packet once its delay has expired.
+  void coalesce_timeout();
+
+  struct CoalesceTimer : RcEventHandler {
+    explicit CoalesceTimer(TransportSendStrategy& outer) : outer_(outer) {}
+    int handle_timeout(const ACE_Time_Value&, const void*);
+    WeakRcHandle<TransportSendStrategy> outer_;
+  };
+
   typedef ACE_SYNCH_MUTEX     LockType;
   typedef ACE_Guard<LockType> GuardType;
 
@@ -378,7 +414,7 @@ private:
 
   /// This lock will protect critical sections of code that play a
   /// role in the sending of data.
-  LockType lock_;
+  mutable LockType lock_;
 
   /// Cached allocator for TransportReplaceElement.
   MessageBlockAllocator replaced_element_mb_allocator_;
@@ -392,6 +428,19 @@ private:
 
   TransportSendBuffer* send_buffer_;
 
+  /// Coalescing mode, off if coalesce_delay_ is zero.
+  ACE_Time_Value coalesce_delay_;
+  RcHandle<CoalesceTimer> coalesce_timer_;
+  /// Set while coalesce_timer_ is scheduled, only coalesce_timeout() clears
+  /// it, so at most one timer is outstanding.
+  bool coalesce_timer_armed_;
+  /// Number of send_stop() events whose samples are in the current packet,
+  /// and whether samples from the send_start()/send_stop() window that is
+  /// still open are in it.  Used to count packets saved.
+  size_t coalesce_batches_;
+  bool coalesce_current_;
+  CoalesceStats coalesce_stats_;
+
   // N.B. The behavior present in TransortSendBuffer should be
   // refactored into the TransportSendStrategy eventually; a good
   // amount of private state is shared between both classes.
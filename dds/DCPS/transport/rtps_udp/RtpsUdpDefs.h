@@ -0,0 +1,41 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef DCPS_RTPSUDPDEFS_H
+#define DCPS_RTPSUDPDEFS_H
+
+#include "ace/config-all.h"
+
+// sendmmsg()/recvmmsg() move several datagrams per system call.  When these
+// aren't available (or the kernel returns ENOSYS) one datagram is sent or
+// received per call.
+#if defined ACE_LINUX && !defined ACE_LACKS_SENDMSG && defined __GLIBC__ \
+  && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14))
+#  define OPENDDS_RTPS_UDP_MMSG
+#  include <sys/socket.h>
+#endif
+
+// UDP generic segmentation offload (UDP_SEGMENT, Linux 4.18) and generic
+// receive offload (UDP_GRO, Linux 5.0).  Older C library headers may lack
+// the constants; whether the running kernel supports them is checked when
+// the socket is set up.
+#ifdef OPENDDS_RTPS_UDP_MMSG
+#  define OPENDDS_RTPS_UDP_GSO
+#  include <netinet/in.h>
+#  include <netinet/udp.h>
+#  ifndef SOL_UDP
+#    define SOL_UDP 17
+#  endif
+#  ifndef UDP_SEGMENT
+#    define UDP_SEGMENT 103
+#  endif
+#  ifndef UDP_GRO
+#    define UDP_GRO 104
+#  endif
+#endif
+
+#endif /* DCPS_RTPSUDPDEFS_H */
@@ -10,6 +10,7 @@
 #include "RtpsUdpTransport.h"
 
 #include "dds/DCPS/transport/framework/TransportDefs.h"
+#include "dds/DCPS/transport/framework/TransportReassembly.h"
 #include "ace/Configuration.h"
 #include "dds/DCPS/RTPS/BaseMessageUtils.h"
 #include "dds/DCPS/transport/framework/NetworkAddress.h"
@@ -35,6 +36,11 @@ RtpsUdpInst::RtpsUdpInst(const OPENDDS_STRING& name)
   , ttl_(1)
   , multicast_group_address_(7401, "239.255.0.2")
   , nak_depth_(32) // default nak_depth in OpenDDS_Multicast
+  , use_batched_io_(false)
+  , receive_batch_size_(8)
+  , use_udp_gso_(false)
+  , udp_segment_size_(1472) // Ethernet MTU less IPv4 and UDP headers
+  , max_reassembly_bytes_(TransportReassembly::DEFAULT_MAX_BUFFER_BYTES)
   , nak_response_delay_(0, 200*1000 /*microseconds*/) // default from RTPS
   , heartbeat_period_(1) // no default in RTPS spec
   , heartbeat_response_delay_(0, 500*1000 /*microseconds*/) // default from RTPS
@@ -86,6 +92,19 @@ RtpsUdpInst::load(ACE_Configuration_Heap& cf,
 
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("nak_depth"), nak_depth_, size_t);
 
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("use_batched_io"), use_batched_io_, bool);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("receive_batch_size"),
+                   receive_batch_size_, size_t);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("use_udp_gso"), use_udp_gso_, bool);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("udp_segment_size"),
+                   udp_segment_size_, size_t);
+
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("max_reassembly_bytes"),
+                   max_reassembly_bytes_, size_t);
+
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("ttl"), ttl_, unsigned char);
 
   GET_CONFIG_TIME_VALUE(cf, sect, ACE_TEXT("nak_response_delay"),
@@ -129,6 +148,11 @@ RtpsUdpInst::dump_to_str() const
       + ':' + to_dds_string(multicast_group_address_.get_port_number()) + '\n';
   ret += formatNameForDump("multicast_interface") + multicast_interface_ + '\n';
   ret += formatNameForDump("nak_depth") + to_dds_string(unsigned(nak_depth_)) + '\n';
+  ret += formatNameForDump("use_batched_io") + (use_batched_io_ ? "true" : "false") + '\n';
+  ret += formatNameForDump("receive_batch_size") + to_dds_string(unsigned(receive_batch_size_)) + '\n';
+  ret += formatNameForDump("use_udp_gso") + (use_udp_gso_ ? "true" : "false") + '\n';
+  ret += formatNameForDump("udp_segment_size") + to_dds_string(unsigned(udp_segment_size_)) + '\n';
+  ret += formatNameForDump("max_reassembly_bytes") + to_dds_string(unsigned(max_reassembly_bytes_)) + '\n';
   ret += formatNameForDump("nak_response_delay") + to_dds_string(nak_response_delay_.msec()) + '\n';
   ret += formatNameForDump("heartbeat_period") + to_dds_string(heartbeat_period_.msec()) + '\n';
   ret += formatNameForDump("heartbeat_response_delay") + to_dds_string(heartbeat_response_delay_.msec()) + '\n';
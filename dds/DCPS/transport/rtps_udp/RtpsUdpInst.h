@@ -36,6 +36,29 @@ public:
   OPENDDS_STRING multicast_interface_;
 
   size_t nak_depth_;
+
+  /// Use sendmmsg() to send a message to all of its destinations with one
+  /// system call and recvmmsg() to read up to receive_batch_size_ datagrams
+  /// (at most 64) per wakeup, into a 64 KiB buffer each, copied out one at
+  /// a time.  Off by default since those buffers are allocated for each
+  /// instance; ignored where these calls are not available.
+  bool use_batched_io_;
+  size_t receive_batch_size_;
+
+  /// Split samples into fragments that fit in udp_segment_size_ bytes and
+  /// send consecutive fragments with one UDP generic segmentation offload
+  /// (UDP_SEGMENT) call, which the kernel or NIC cuts into datagrams of that
+  /// size.  Received datagrams may then be coalesced by the kernel (UDP_GRO)
+  /// and are split again before parsing.  Off by default; ignored where not
+  /// supported.
+  bool use_udp_gso_;
+  size_t udp_segment_size_;
+
+  /// Most bytes held at once by partially-reassembled fragmented samples,
+  /// for each DataLink.  When a new sample doesn't fit, the oldest
+  /// incomplete samples are dropped; samples larger than this are dropped.
+  size_t max_reassembly_bytes_;
+
   ACE_Time_Value nak_response_delay_, heartbeat_period_,
     heartbeat_response_delay_, handshake_timeout_, durable_data_timeout_;
 
@@ -16,16 +16,42 @@
 
 #include "ace/Reactor.h"
 
+#include <algorithm>
+
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
 namespace OpenDDS {
 namespace DCPS {
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+namespace {
+  /// Largest UDP datagram (or coalesced datagram), a batch has room for
+  /// receive_batch_size_ of these.  Datagrams cut short by recvmmsg() can't
+  /// be read again, so this can't be smaller.
+  const size_t MAX_DATAGRAM = 0x10000;
+  /// Most datagrams read by one recvmmsg(), which bounds the memory of a
+  /// batch to MAX_BATCH * MAX_DATAGRAM.
+  const size_t MAX_BATCH = 64;
+#ifdef OPENDDS_RTPS_UDP_GSO
+  const size_t CONTROL_SIZE = CMSG_SPACE(sizeof(int));
+#endif
+}
+#endif
+
 RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const GuidPrefix_t& local_prefix)
   : link_(link)
   , last_received_()
   , recvd_sample_(0)
+  , frags_sample_size_(0)
+  , frags_fragment_size_(0)
+  , reassembly_(link->config().max_reassembly_bytes_)
   , receiver_(local_prefix)
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  , mmsg_unsupported_(false)
+#endif
+#ifdef OPENDDS_RTPS_UDP_GSO
+  , gro_enabled_(false)
+#endif
 #if defined(OPENDDS_SECURITY)
   , secure_sample_(0)
 #endif
@@ -38,15 +64,230 @@ RtpsUdpReceiveStrategy::RtpsUdpReceiveStrategy(RtpsUdpDataLink* link, const Guid
 int
 RtpsUdpReceiveStrategy::handle_input(ACE_HANDLE fd)
 {
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  Batch& b = batch(fd);
+  if (!b.mmsg_.empty() && (b.next_ < b.count_ || !mmsg_unsupported_)) {
+    return handle_input_batch(fd, b);
+  }
+#endif
   return handle_dds_input(fd);
 }
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+RtpsUdpReceiveStrategy::Batch::Batch()
+  : count_(0)
+  , next_(0)
+#ifdef OPENDDS_RTPS_UDP_GSO
+  , offset_(0)
+#endif
+{
+}
+
+void
+RtpsUdpReceiveStrategy::Batch::allocate(size_t size)
+{
+  buffer_.resize(size * MAX_DATAGRAM);
+  iov_.resize(size);
+  addr_.resize(size);
+  mmsg_.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    iov_[i].iov_base = &buffer_[i * MAX_DATAGRAM];
+    iov_[i].iov_len = MAX_DATAGRAM;
+  }
+#ifdef OPENDDS_RTPS_UDP_GSO
+  control_.resize(size * CONTROL_SIZE);
+  segment_.resize(size);
+#endif
+}
+
+void
+RtpsUdpReceiveStrategy::Batch::release()
+{
+  OPENDDS_VECTOR(char)().swap(buffer_);
+  OPENDDS_VECTOR(iovec)().swap(iov_);
+  OPENDDS_VECTOR(sockaddr_storage)().swap(addr_);
+  OPENDDS_VECTOR(mmsghdr)().swap(mmsg_);
+#ifdef OPENDDS_RTPS_UDP_GSO
+  OPENDDS_VECTOR(char)().swap(control_);
+  OPENDDS_VECTOR(size_t)().swap(segment_);
+  offset_ = 0;
+#endif
+  count_ = next_ = 0;
+}
+
+RtpsUdpReceiveStrategy::Batch&
+RtpsUdpReceiveStrategy::batch(ACE_HANDLE fd)
+{
+  return fd == link_->unicast_socket().get_handle()
+    ? unicast_batch_ : multicast_batch_;
+}
+
+int
+RtpsUdpReceiveStrategy::handle_input_batch(ACE_HANDLE fd, Batch& b)
+{
+  // Datagrams left by an earlier call are passed on before reading more.
+  if (b.next_ == b.count_) {
+    b.count_ = b.next_ = 0;
+    const int count = read_batch(fd, b);
+    if (count <= 0) {
+      return count;
+    }
+    b.count_ = count;
+  }
+
+  int result = 0;
+  while (b.next_ < b.count_ && result >= 0) {
+    const size_t next = b.next_;
+#ifdef OPENDDS_RTPS_UDP_GSO
+    const size_t offset = b.offset_;
+#endif
+    result = handle_dds_input(fd);
+    if (b.next_ == next
+#ifdef OPENDDS_RTPS_UDP_GSO
+        && b.offset_ == offset
+#endif
+        ) {
+      break; // the framework didn't call receive_bytes()
+    }
+  }
+  return result;
+}
+
+int
+RtpsUdpReceiveStrategy::read_batch(ACE_HANDLE fd, Batch& b)
+{
+  const size_t batch_size = b.mmsg_.size();
+  for (size_t i = 0; i < batch_size; ++i) {
+    msghdr& hdr = b.mmsg_[i].msg_hdr;
+    std::memset(&hdr, 0, sizeof hdr);
+    hdr.msg_name = &b.addr_[i];
+    hdr.msg_namelen = sizeof(sockaddr_storage);
+    hdr.msg_iov = &b.iov_[i];
+    hdr.msg_iovlen = 1;
+#ifdef OPENDDS_RTPS_UDP_GSO
+    if (gro_enabled_) {
+      hdr.msg_control = &b.control_[i * CONTROL_SIZE];
+      hdr.msg_controllen = CONTROL_SIZE;
+    }
+#endif
+    b.mmsg_[i].msg_len = 0;
+  }
+
+  const int count = ::recvmmsg(fd, &b.mmsg_[0],
+                               static_cast<unsigned int>(batch_size),
+                               MSG_DONTWAIT, 0);
+  if (count <= 0) {
+    if (count < 0 && errno == ENOSYS) {
+      mmsg_unsupported_ = true;
+      VDBG_LVL((LM_DEBUG, "(%P|%t) RtpsUdpReceiveStrategy::read_batch "
+                "recvmmsg is not supported, reading one datagram at a time\n"), 2);
+#ifdef OPENDDS_RTPS_UDP_GSO
+      // The framework's recv() can't split coalesced datagrams.
+      disable_gro();
+#endif
+    } else if (count < 0 && (errno == EWOULDBLOCK || errno == EAGAIN
+                             || errno == EINTR)) {
+      return 0;
+    }
+#ifdef OPENDDS_RTPS_UDP_GSO
+    if (count < 0 && fd == link_->unicast_socket().get_handle()) {
+      // The framework's recv() below can't split a coalesced datagram.
+      const int err = errno;
+      disable_gro();
+      errno = err;
+    }
+#endif
+    // Let the framework's own recv() see and handle the condition.
+    const int result = handle_dds_input(fd);
+    return result < 0 ? result : 0;
+  }
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+  b.offset_ = 0;
+  for (int i = 0; i < count; ++i) {
+    b.segment_[i] = 0;
+    msghdr& hdr = b.mmsg_[i].msg_hdr;
+    if (!gro_enabled_) {
+      continue;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+         cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+        int segment = 0;
+        std::memcpy(&segment, CMSG_DATA(cmsg), sizeof segment);
+        b.segment_[i] = segment > 0 ? segment : 0;
+      }
+    }
+  }
+#endif
+  return count;
+}
+
+ssize_t
+RtpsUdpReceiveStrategy::receive_staged(Batch& b, iovec iov[], int n,
+                                       ACE_INET_Addr& remote_address)
+{
+  const mmsghdr& msg = b.mmsg_[b.next_];
+  const char* src = static_cast<const char*>(msg.msg_hdr.msg_iov->iov_base);
+  size_t length = msg.msg_len;
+#ifdef OPENDDS_RTPS_UDP_GSO
+  // A coalesced datagram is handed over one segment (one RTPS message) at a
+  // time.
+  src += b.offset_;
+  length -= b.offset_;
+  if (b.segment_[b.next_] && b.segment_[b.next_] < length) {
+    length = b.segment_[b.next_];
+  }
+#endif
+  size_t remaining = length;
+  for (int i = 0; remaining && i < n; ++i) {
+    const size_t chunk = std::min(static_cast<size_t>(iov[i].iov_len),
+                                  remaining);
+    std::memcpy(iov[i].iov_base, src, chunk);
+    src += chunk;
+    remaining -= chunk;
+  }
+  remote_address.set(static_cast<const sockaddr_in*>(msg.msg_hdr.msg_name),
+                     static_cast<int>(msg.msg_hdr.msg_namelen));
+#ifdef OPENDDS_RTPS_UDP_GSO
+  b.offset_ += length;
+  if (b.offset_ < msg.msg_len) {
+    return length - remaining;
+  }
+  b.offset_ = 0;
+#endif
+  ++b.next_;
+  return length - remaining;
+}
+#endif
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+void
+RtpsUdpReceiveStrategy::disable_gro()
+{
+  if (gro_enabled_) {
+    int off = 0;
+    link_->unicast_socket().set_option(SOL_UDP, UDP_GRO, &off, sizeof off);
+    gro_enabled_ = false;
+  }
+}
+#endif
+
 ssize_t
 RtpsUdpReceiveStrategy::receive_bytes(iovec iov[],
                                       int n,
                                       ACE_INET_Addr& remote_address,
                                       ACE_HANDLE fd)
 {
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  Batch& b = batch(fd);
+  if (b.next_ < b.count_) {
+    const ssize_t ret = receive_staged(b, iov, n, remote_address);
+    remote_address_ = remote_address;
+    return ret;
+  }
+#endif
+
   const ACE_SOCK_Dgram& socket =
     (fd == link_->unicast_socket().get_handle())
     ? link_->unicast_socket() : link_->multicast_socket();
@@ -478,6 +719,32 @@ RtpsUdpReceiveStrategy::start_i()
   link_->unicast_socket().control(SIO_UDP_CONNRESET, &recv_udp_connreset);
 #endif
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  const RtpsUdpInst& config = link_->config();
+  // The batches are only allocated when recvmmsg() is used.
+  if (config.use_batched_io_ && config.receive_batch_size_ > 1
+      && !mmsg_unsupported_) {
+    const size_t batch_size = std::min(config.receive_batch_size_, MAX_BATCH);
+    unicast_batch_.allocate(batch_size);
+    if (config.use_multicast_) {
+      multicast_batch_.allocate(batch_size);
+    }
+  }
+#endif
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+  // Coalesced datagrams are only split by handle_input_batch().
+  if (config.use_udp_gso_ && !unicast_batch_.mmsg_.empty()) {
+    int on = 1;
+    if (link_->unicast_socket().set_option(SOL_UDP, UDP_GRO, &on, sizeof on) == 0) {
+      gro_enabled_ = true;
+    } else {
+      VDBG_LVL((LM_DEBUG, "(%P|%t) RtpsUdpReceiveStrategy::start_i: "
+                "UDP_GRO is not supported\n"), 2);
+    }
+  }
+#endif
+
   if (reactor->register_handler(link_->unicast_socket().get_handle(), this,
                                 ACE_Event_Handler::READ_MASK) != 0) {
     ACE_ERROR_RETURN((LM_ERROR,
@@ -522,6 +789,11 @@ RtpsUdpReceiveStrategy::stop_i()
     reactor->remove_handler(link_->multicast_socket().get_handle(),
                             ACE_Event_Handler::READ_MASK);
   }
+
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  unicast_batch_.release();
+  multicast_batch_.release();
+#endif
 }
 
 bool
@@ -553,6 +825,8 @@ RtpsUdpReceiveStrategy::check_header(const RtpsSampleHeader& header)
     const RTPS::DataFragSubmessage& rtps = header.submessage_.data_frag_sm();
     frags_.first = rtps.fragmentStartingNum.value;
     frags_.second = frags_.first + (rtps.fragmentsInSubmessage - 1);
+    frags_sample_size_ = rtps.sampleSize;
+    frags_fragment_size_ = rtps.fragmentSize;
   }
 
   return header.valid();
@@ -576,7 +850,8 @@ RtpsUdpReceiveStrategy::reassemble(ReceivedDataSample& data)
 {
   using namespace RTPS;
   receiver_.fill_header(data.header_); // set publication_id_.guidPrefix
-  if (reassembly_.reassemble(frags_, data)) {
+  if (reassembly_.reassemble(frags_, frags_sample_size_, frags_fragment_size_,
+                             data)) {
 
     // Reassembly was successful, replace DataFrag with Data.  This doesn't have
     // to be a fully-formed DataSubmessage, just enough for this class to use
@@ -9,6 +9,7 @@
 #define DCPS_RTPSUDPRECEIVESTRATEGY_H
 
 #include "Rtps_Udp_Export.h"
+#include "RtpsUdpDefs.h"
 #include "RtpsTransportHeader.h"
 #include "RtpsSampleHeader.h"
 
@@ -77,6 +78,46 @@ private:
   virtual int start_i();
   virtual void stop_i();
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  /// Datagrams read from one socket with recvmmsg().
+  struct Batch {
+    Batch();
+    /// Makes room for @a size datagrams.
+    void allocate(size_t size);
+    void release();
+
+    OPENDDS_VECTOR(char) buffer_;
+    OPENDDS_VECTOR(iovec) iov_;
+    OPENDDS_VECTOR(sockaddr_storage) addr_;
+    /// Empty if the socket isn't read with recvmmsg().
+    OPENDDS_VECTOR(mmsghdr) mmsg_;
+    /// Datagrams not yet passed to the framework are mmsg_[next_] up to
+    /// mmsg_[count_ - 1].  They are kept until it takes them.
+    size_t count_, next_;
+#ifdef OPENDDS_RTPS_UDP_GSO
+    /// A coalesced datagram is passed to the framework one segment (of
+    /// segment_[i] bytes) at a time, offset_ is the position of the next
+    /// segment in mmsg_[next_].
+    OPENDDS_VECTOR(char) control_;
+    OPENDDS_VECTOR(size_t) segment_;
+    size_t offset_;
+#endif
+  };
+
+  Batch& batch(ACE_HANDLE fd);
+  /// Hand the datagrams of @a b to the framework, which gets each from
+  /// receive_bytes() without a syscall, reading more with one recvmmsg()
+  /// once they're all taken.
+  int handle_input_batch(ACE_HANDLE fd, Batch& b);
+  /// Returns the number of datagrams read into @a b.
+  int read_batch(ACE_HANDLE fd, Batch& b);
+  ssize_t receive_staged(Batch& b, iovec iov[], int n,
+                         ACE_INET_Addr& remote_address);
+#endif
+#ifdef OPENDDS_RTPS_UDP_GSO
+  void disable_gro();
+#endif
+
   virtual bool check_header(const RtpsTransportHeader& header);
 
   virtual bool check_header(const RtpsSampleHeader& header);
@@ -100,6 +141,7 @@ private:
   RepoIdSet readers_withheld_, readers_selected_;
 
   SequenceRange frags_;
+  ACE_UINT32 frags_sample_size_, frags_fragment_size_;
   TransportReassembly reassembly_;
 
   struct MessageReceiver {
@@ -131,6 +173,17 @@ private:
   MessageReceiver receiver_;
   ACE_INET_Addr remote_address_;
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  /// Allocated by start_i() when batching is enabled.
+  Batch unicast_batch_, multicast_batch_;
+#ifdef OPENDDS_RTPS_UDP_GSO
+  /// Set by start_i() if the unicast socket has UDP_GRO enabled.
+  bool gro_enabled_;
+#endif
+  /// Set if the kernel doesn't implement recvmmsg().
+  bool mmsg_unsupported_;
+#endif
+
 #if defined(OPENDDS_SECURITY)
   RTPS::SecuritySubmessage secure_prefix_;
   OPENDDS_VECTOR(RTPS::Submessage) secure_submessages_;
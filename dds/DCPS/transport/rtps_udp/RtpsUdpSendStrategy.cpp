@@ -21,7 +21,9 @@
 
 #include "dds/DdsDcpsGuidTypeSupportImpl.h"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -40,6 +42,15 @@ RtpsUdpSendStrategy::RtpsUdpSendStrategy(RtpsUdpDataLink* link,
     rtps_header_db_(RTPS::RTPSHDR_SZ, ACE_Message_Block::MB_DATA,
                     rtps_header_data_, 0, 0, ACE_Message_Block::DONT_DELETE, 0),
     rtps_header_mb_(&rtps_header_db_, ACE_Message_Block::DONT_DELETE)
+#ifdef OPENDDS_RTPS_UDP_MMSG
+    , mmsg_unsupported_(false)
+#endif
+#ifdef OPENDDS_RTPS_UDP_GSO
+    , gso_enabled_(false)
+    , gso_length_(0)
+    , gso_segment_(0)
+    , gso_count_(0)
+#endif
 {
   rtps_header_.prefix[0] = 'R';
   rtps_header_.prefix[1] = 'T';
@@ -58,8 +69,68 @@ namespace {
   bool shouldWarn(int code) {
     return code == EPERM || code == EACCES || code == EINTR || code == ENOBUFS || code == ENOMEM;
   }
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+  // Linux limits a UDP_SEGMENT send to 64 segments.
+  const size_t GSO_MAX_SEGMENTS = 64;
+
+  // A DATA_FRAG needs room for at least one RtpsSampleHeader::FRAG_SIZE
+  // fragment plus the RTPS and submessage headers.
+  const size_t MIN_UDP_SEGMENT = 1280;
+
+  bool gso_rejected(int code) {
+    // EIO: the outgoing device can't checksum segments
+    return code == EIO || code == EINVAL || code == ENOSYS;
+  }
+#endif
+}
+
+bool
+RtpsUdpSendStrategy::start_i()
+{
+#ifdef OPENDDS_RTPS_UDP_GSO
+  gso_enabled_ = false;
+  if (link_->config().use_udp_gso_) {
+    // The segment size is given with each send, setting the socket option
+    // here only checks that the kernel knows UDP_SEGMENT.
+    ACE_SOCK_Dgram& socket = link_->unicast_socket();
+    int segment = static_cast<int>(udp_segment_size());
+    if (socket.set_option(SOL_UDP, UDP_SEGMENT, &segment, sizeof segment) == 0) {
+      segment = 0;
+      socket.set_option(SOL_UDP, UDP_SEGMENT, &segment, sizeof segment);
+      gso_enabled_ = true;
+    } else {
+      VDBG_LVL((LM_DEBUG, "(%P|%t) RtpsUdpSendStrategy::start_i - "
+                "UDP_SEGMENT is not supported, sending each fragment "
+                "separately\n"), 2);
+    }
+  }
+#endif
+  return true;
 }
 
+size_t
+RtpsUdpSendStrategy::max_message_size() const
+{
+#ifdef OPENDDS_RTPS_UDP_GSO
+  // Without segmentation offload, smaller packets would only mean more
+  // sends.
+  if (gso_enabled_) {
+    return udp_segment_size();
+  }
+#endif
+  return UDP_MAX_MESSAGE_SIZE;
+}
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+size_t
+RtpsUdpSendStrategy::udp_segment_size() const
+{
+  return std::min(std::max(link_->config().udp_segment_size_, MIN_UDP_SEGMENT),
+                  size_t(UDP_MAX_MESSAGE_SIZE));
+}
+#endif
+
 ssize_t
 RtpsUdpSendStrategy::send_bytes_i(const iovec iov[], int n)
 {
@@ -82,6 +153,16 @@ RtpsUdpSendStrategy::send_bytes_i(const iovec iov[], int n)
 ssize_t
 RtpsUdpSendStrategy::send_bytes_i_helper(const iovec iov[], int n)
 {
+#ifdef OPENDDS_RTPS_UDP_GSO
+  if ((override_single_dest_ || override_dest_) && flush_segments() < 0) {
+    // Resends don't overtake fragments that are still staged.  Those were
+    // already reported as sent, reliable writers will repair them.
+    const ACE_Log_Priority prio = shouldWarn(errno) ? LM_WARNING : LM_ERROR;
+    ACE_ERROR((prio, "(%P|%t) RtpsUdpSendStrategy::send_bytes_i_helper() - "
+      "failed to send staged fragments\n"));
+  }
+#endif
+
   if (override_single_dest_) {
     return send_single_i(iov, n, *override_single_dest_);
   }
@@ -116,6 +197,12 @@ RtpsUdpSendStrategy::send_bytes_i_helper(const iovec iov[], int n)
     return -1;
   }
 
+#ifdef OPENDDS_RTPS_UDP_GSO
+  if (gso_enabled_) {
+    return send_segmented_i(iov, n, addrs);
+  }
+#endif
+
   return send_multi_i(iov, n, addrs);
 }
 
@@ -199,6 +286,18 @@ ssize_t
 RtpsUdpSendStrategy::send_multi_i(const iovec iov[], int n,
                                   const OPENDDS_SET(ACE_INET_Addr)& addrs)
 {
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  if (addrs.size() > 1 && !mmsg_unsupported_ && link_->config().use_batched_io_) {
+    const ssize_t result = send_mmsg_i(iov, n, addrs);
+    if (result >= 0 || errno != ENOSYS) {
+      return result;
+    }
+    mmsg_unsupported_ = true;
+    VDBG_LVL((LM_DEBUG, "(%P|%t) RtpsUdpSendStrategy::send_multi_i() - "
+              "sendmmsg is not supported, sending to each destination\n"), 2);
+  }
+#endif
+
   ssize_t result = -1;
   typedef OPENDDS_SET(ACE_INET_Addr)::const_iterator iter_t;
   for (iter_t iter = addrs.begin(); iter != addrs.end(); ++iter) {
@@ -242,6 +341,188 @@ RtpsUdpSendStrategy::send_single_i(const iovec iov[], int n,
   return result;
 }
 
+#ifdef OPENDDS_RTPS_UDP_MMSG
+ssize_t
+RtpsUdpSendStrategy::send_mmsg_i(const iovec iov[], int n,
+                                 const OPENDDS_SET(ACE_INET_Addr)& addrs,
+                                 bool segmented)
+{
+  ssize_t bytes = 0;
+  for (int i = 0; i < n; ++i) {
+    bytes += iov[i].iov_len;
+  }
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+  if (segmented) {
+    cmsghdr* const cmsg = &gso_control_.cmsg_;
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(ACE_UINT16));
+    const ACE_UINT16 segment = static_cast<ACE_UINT16>(gso_segment_);
+    std::memcpy(CMSG_DATA(cmsg), &segment, sizeof segment);
+  }
+#endif
+
+  // All destinations share the same iovec array.
+  mmsg_.resize(addrs.size());
+  size_t count = 0;
+  typedef OPENDDS_SET(ACE_INET_Addr)::const_iterator iter_t;
+  for (iter_t iter = addrs.begin(); iter != addrs.end(); ++iter, ++count) {
+    msghdr& hdr = mmsg_[count].msg_hdr;
+    std::memset(&hdr, 0, sizeof hdr);
+    hdr.msg_name = iter->get_addr();
+    hdr.msg_namelen = iter->get_size();
+    hdr.msg_iov = const_cast<iovec*>(iov);
+    hdr.msg_iovlen = n;
+#ifdef OPENDDS_RTPS_UDP_GSO
+    if (segmented) {
+      hdr.msg_control = gso_control_.data_;
+      hdr.msg_controllen = CMSG_SPACE(sizeof(ACE_UINT16));
+    }
+#endif
+    mmsg_[count].msg_len = 0;
+  }
+
+  const ACE_HANDLE handle = link_->unicast_socket().get_handle();
+  ssize_t result = -1;
+  iter_t dest = addrs.begin();
+  for (size_t sent = 0; sent < count;) {
+    // The kernel limits each call to UIO_MAXIOV messages and returns the
+    // number actually sent.
+    const int ret = ::sendmmsg(handle, &mmsg_[sent],
+                               static_cast<unsigned int>(count - sent), 0);
+    if (ret < 0) {
+      if (sent == 0 && (errno == ENOSYS
+#ifdef OPENDDS_RTPS_UDP_GSO
+                        || (segmented && gso_rejected(errno))
+#endif
+                        )) {
+        return -1;
+      }
+      // sendmmsg() stops at the first failure and only reports it when
+      // nothing was sent, so this is the error for destination "sent".
+      ACE_TCHAR addr_buff[256] = {};
+      const int err = errno;
+      dest->addr_to_string(addr_buff, 256, 0);
+      errno = err;
+      const ACE_Log_Priority prio = shouldWarn(errno) ? LM_WARNING : LM_ERROR;
+      ACE_ERROR((prio, "(%P|%t) RtpsUdpSendStrategy::send_mmsg_i() - "
+        "destination %s failed %p\n", addr_buff, ACE_TEXT("sendmmsg")));
+      ++sent;
+      ++dest;
+      continue;
+    }
+    result = bytes;
+    sent += ret;
+    std::advance(dest, ret);
+  }
+  return result;
+}
+#endif
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+ssize_t
+RtpsUdpSendStrategy::send_segmented_i(const iovec iov[], int n,
+                                      const OPENDDS_SET(ACE_INET_Addr)& addrs)
+{
+  size_t length = 0;
+  for (int i = 0; i < n; ++i) {
+    length += iov[i].iov_len;
+  }
+
+  const TransportQueueElement* const elem = current_packet_first_element();
+  const bool fragment = gso_enabled_ && elem && elem->is_fragment();
+  const size_t capacity = std::min(GSO_MAX_SEGMENTS * udp_segment_size(),
+                                   size_t(UDP_MAX_MESSAGE_SIZE));
+
+  // The staged fragments were reported as sent, so a failure to send them
+  // is reported for the packet that flushes them.  The framework then
+  // retries or drops that packet as it would after a failed send.
+  if (gso_count_ && (!fragment || length > gso_segment_
+                     || gso_length_ + length > capacity
+                     || addrs != gso_addrs_)
+      && flush_segments() < 0) {
+    return -1;
+  }
+
+  if (!fragment || (header_.last_fragment_ && !gso_count_)) {
+    return send_multi_i(iov, n, addrs);
+  }
+
+  if (!gso_count_) {
+    if (gso_buffer_.size() < capacity) {
+      gso_buffer_.resize(capacity);
+    }
+    gso_segment_ = length;
+    gso_addrs_ = addrs;
+  }
+
+  for (int i = 0; i < n; ++i) {
+    std::memcpy(&gso_buffer_[gso_length_], iov[i].iov_base, iov[i].iov_len);
+    gso_length_ += iov[i].iov_len;
+  }
+  ++gso_count_;
+
+  // Only the last segment of a UDP_SEGMENT send may be short.
+  if ((header_.last_fragment_ || length < gso_segment_
+       || gso_length_ + gso_segment_ > capacity)
+      && flush_segments() < 0) {
+    return -1;
+  }
+
+  return length;
+}
+
+ssize_t
+RtpsUdpSendStrategy::flush_segments()
+{
+  if (!gso_count_) {
+    return 0;
+  }
+
+  iovec iov;
+  iov.iov_base = &gso_buffer_[0];
+  iov.iov_len = gso_length_;
+
+  ssize_t result = -1;
+  bool separately = gso_count_ == 1;
+  if (!separately) {
+    result = send_mmsg_i(&iov, 1, gso_addrs_, true);
+    if (result < 0 && gso_rejected(errno)) {
+      VDBG_LVL((LM_DEBUG, "(%P|%t) RtpsUdpSendStrategy::flush_segments - "
+                "UDP_SEGMENT send failed (%m), sending each fragment "
+                "separately\n"), 2);
+      gso_enabled_ = false;
+      separately = true;
+    }
+  }
+
+  if (separately) {
+    // Fails only if no fragment could be sent to any destination.
+    result = -1;
+    int err = 0;
+    for (size_t offset = 0; offset < gso_length_; offset += gso_segment_) {
+      iov.iov_base = &gso_buffer_[offset];
+      iov.iov_len = std::min(gso_segment_, gso_length_ - offset);
+      if (send_multi_i(&iov, 1, gso_addrs_) >= 0) {
+        result = gso_length_;
+      } else {
+        err = errno;
+      }
+    }
+    if (result < 0) {
+      errno = err;
+    }
+  }
+
+  const int err = errno;
+  gso_length_ = gso_count_ = 0;
+  gso_addrs_.clear();
+  errno = err;
+  return result;
+}
+#endif
+
 void
 RtpsUdpSendStrategy::add_delayed_notification(TransportQueueElement* element)
 {
@@ -367,82 +648,72 @@ namespace {
 }
 
 bool
-RtpsUdpSendStrategy::encode_writer_submessage(const RepoId& receiver,
-                                              OPENDDS_VECTOR(Chunk)& replacements,
-                                              DDS::Security::CryptoTransform* crypto,
-                                              const DDS::OctetSeq& plain,
-                                              DDS::Security::DatawriterCryptoHandle sender_dwch,
-                                              char* submessage_start,
-                                              CORBA::Octet msgId)
+RtpsUdpSendStrategy::encode_submessage(DDS::Security::CryptoTransform* crypto,
+                                       const DDS::OctetSeq& plain,
+                                       Chunk& chunk)
 {
   using namespace DDS::Security;
 
-  DatareaderCryptoHandleSeq readerHandles;
-  if (std::memcmp(&GUID_UNKNOWN, &receiver, sizeof receiver)) {
-    DatareaderCryptoHandle drch = link_->reader_crypto_handle(receiver);
-    if (drch != DDS::HANDLE_NIL) {
+  SecurityException ex = {"", 0, 0};
+  bool ok;
+  if (chunk.writer_) {
+    DatareaderCryptoHandleSeq readerHandles;
+    if (chunk.receiver_ != DDS::HANDLE_NIL) {
       readerHandles.length(1);
-      readerHandles[0] = drch;
+      readerHandles[0] = chunk.receiver_;
+    }
+    CORBA::Long idx = 0;
+    ok = crypto->encode_datawriter_submessage(chunk.encoded_, plain,
+                                              chunk.sender_, readerHandles,
+                                              idx, ex);
+  } else {
+    DatawriterCryptoHandleSeq writerHandles;
+    if (chunk.receiver_ != DDS::HANDLE_NIL) {
+      writerHandles.length(1);
+      writerHandles[0] = chunk.receiver_;
     }
+    ok = crypto->encode_datareader_submessage(chunk.encoded_, plain,
+                                              chunk.sender_, writerHandles, ex);
   }
 
-  CORBA::Long idx = 0;
-  SecurityException ex = {"", 0, 0};
-  replacements.resize(replacements.size() + 1);
-  Chunk& c = replacements.back();
-  if (crypto->encode_datawriter_submessage(c.encoded_, plain, sender_dwch,
-                                           readerHandles, idx, ex)) {
-    if (c.encoded_ != plain) {
-      c.start_ = submessage_start;
-      c.length_ = plain.length();
-    } else {
-      replacements.pop_back();
-    }
-  } else {
-    log_encode_error(msgId, sender_dwch, ex);
-    replacements.pop_back();
-    return false;
+  if (!ok) {
+    log_encode_error(chunk.msgId_, chunk.sender_, ex);
   }
-  return true;
+  return ok;
 }
 
 bool
-RtpsUdpSendStrategy::encode_reader_submessage(const RepoId& receiver,
-                                              OPENDDS_VECTOR(Chunk)& replacements,
-                                              DDS::Security::CryptoTransform* crypto,
-                                              const DDS::OctetSeq& plain,
-                                              DDS::Security::DatareaderCryptoHandle sender_drch,
-                                              char* submessage_start,
-                                              CORBA::Octet msgId)
+RtpsUdpSendStrategy::encode_submessage(Security::MessageBlockCryptoTransform& crypto,
+                                       ACE_Message_Block& out, bool& encoded,
+                                       const ACE_Message_Block& plain,
+                                       const Chunk& chunk)
 {
   using namespace DDS::Security;
 
-  DatawriterCryptoHandleSeq writerHandles;
-  if (std::memcmp(&GUID_UNKNOWN, &receiver, sizeof receiver)) {
-    DatawriterCryptoHandle dwch = link_->writer_crypto_handle(receiver);
-    if (dwch != DDS::HANDLE_NIL) {
+  SecurityException ex = {"", 0, 0};
+  bool ok;
+  if (chunk.writer_) {
+    DatareaderCryptoHandleSeq readerHandles;
+    if (chunk.receiver_ != DDS::HANDLE_NIL) {
+      readerHandles.length(1);
+      readerHandles[0] = chunk.receiver_;
+    }
+    ok = crypto.encode_datawriter_submessage(out, encoded, plain, chunk.length_,
+                                             chunk.sender_, readerHandles, ex);
+  } else {
+    DatawriterCryptoHandleSeq writerHandles;
+    if (chunk.receiver_ != DDS::HANDLE_NIL) {
       writerHandles.length(1);
-      writerHandles[0] = dwch;
+      writerHandles[0] = chunk.receiver_;
     }
+    ok = crypto.encode_datareader_submessage(out, encoded, plain, chunk.length_,
+                                             chunk.sender_, writerHandles, ex);
   }
 
-  SecurityException ex = {"", 0, 0};
-  replacements.resize(replacements.size() + 1);
-  Chunk& c = replacements.back();
-  if (crypto->encode_datareader_submessage(c.encoded_, plain, sender_drch,
-                                           writerHandles, ex)) {
-    if (c.encoded_ != plain) {
-      c.start_ = submessage_start;
-      c.length_ = plain.length();
-    } else {
-      replacements.pop_back();
-    }
-  } else {
-    log_encode_error(msgId, sender_drch, ex);
-    replacements.pop_back();
-    return false;
+  if (!ok) {
+    log_encode_error(chunk.msgId_, chunk.sender_, ex);
   }
-  return true;
+  return ok;
 }
 
 ACE_Message_Block*
@@ -456,6 +727,12 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
     return 0;
   }
 
+  // A plugin that reads and writes message blocks encodes the submessages
+  // while the packet is copied to the output block, without copying them
+  // through OctetSeqs.
+  Security::MessageBlockCryptoTransform* const mb_crypto =
+    dynamic_cast<Security::MessageBlockCryptoTransform*>(crypto.in());
+
   // 'plain' contains a full RTPS Message on its way to the socket(s).
   // Let the crypto plugin examine each submessage and replace it with an
   // encoded version.  First, parse through the message using the 'in'
@@ -506,6 +783,13 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
     int read = 0;
     CORBA::ULong u2 = 0;
 
+    Chunk chunk;
+    chunk.start_ = submessage_start;
+    chunk.length_ = static_cast<unsigned int>(RTPS::SMHDR_SZ +
+      (octetsToNextHeader ? octetsToNextHeader : remaining));
+    chunk.msgId_ = msgId;
+    chunk.receiver_ = DDS::HANDLE_NIL;
+
     switch (msgId) {
     case RTPS::INFO_DST: {
       GuidPrefix_t_forany guidPrefix(receiver.guidPrefix);
@@ -522,6 +806,7 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
         ok = false;
         break;
       }
+      read += 4;
       // fall-through
     case RTPS::HEARTBEAT:
     case RTPS::GAP:
@@ -534,18 +819,29 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
         ok = false;
         break;
       }
-      DatawriterCryptoHandle sender_dwch = link_->writer_crypto_handle(sender);
-      if (sender_dwch == DDS::HANDLE_NIL) {
+      read += 8;
+      chunk.writer_ = true;
+      chunk.sender_ = link_->writer_crypto_handle(sender);
+      if (chunk.sender_ == DDS::HANDLE_NIL) {
         ok = false;
         break;
       }
+      if (std::memcmp(&GUID_UNKNOWN, &receiver, sizeof receiver)) {
+        chunk.receiver_ = link_->reader_crypto_handle(receiver);
+      }
+
+      if (mb_crypto) {
+        replacements.push_back(chunk);
+        break;
+      }
 
       DDS::OctetSeq plain(toSeq(ser, msgId, flags, octetsToNextHeader, u2,
                                 receiver.entityId, sender.entityId, remaining));
       read = octetsToNextHeader;
-      if (!encode_writer_submessage(receiver, replacements, crypto, plain,
-                                    sender_dwch, submessage_start, msgId)) {
+      if (!encode_submessage(crypto, plain, chunk)) {
         ok = false;
+      } else if (chunk.encoded_ != plain) {
+        replacements.push_back(chunk);
       }
       break;
     }
@@ -559,18 +855,29 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
         ok = false;
         break;
       }
-      DatareaderCryptoHandle sender_drch = link_->reader_crypto_handle(sender);
-      if (sender_drch == DDS::HANDLE_NIL) {
+      read += 8;
+      chunk.writer_ = false;
+      chunk.sender_ = link_->reader_crypto_handle(sender);
+      if (chunk.sender_ == DDS::HANDLE_NIL) {
         ok = false;
         break;
       }
+      if (std::memcmp(&GUID_UNKNOWN, &receiver, sizeof receiver)) {
+        chunk.receiver_ = link_->writer_crypto_handle(receiver);
+      }
+
+      if (mb_crypto) {
+        replacements.push_back(chunk);
+        break;
+      }
 
       DDS::OctetSeq plain(toSeq(ser, msgId, flags, octetsToNextHeader, 0,
                                 sender.entityId, receiver.entityId, remaining));
       read = octetsToNextHeader;
-      if (!encode_reader_submessage(receiver, replacements, crypto, plain,
-                                    sender_drch, submessage_start, msgId)) {
+      if (!encode_submessage(crypto, plain, chunk)) {
         ok = false;
+      } else if (chunk.encoded_ != plain) {
+        replacements.push_back(chunk);
       }
       break;
     }
@@ -596,22 +903,26 @@ RtpsUdpSendStrategy::pre_send_packet(const ACE_Message_Block* plain)
 
   //DDS-Security: SRTPS encoding (including if replacements is empty above)
 
-  return replace_chunks(plain, replacements);
+  return replace_chunks(plain, replacements, mb_crypto);
 }
 
 ACE_Message_Block*
 RtpsUdpSendStrategy::replace_chunks(const ACE_Message_Block* plain,
-                                    const OPENDDS_VECTOR(Chunk)& replacements)
+                                    const OPENDDS_VECTOR(Chunk)& replacements,
+                                    Security::MessageBlockCryptoTransform* crypto)
 {
-  unsigned int out_size = static_cast<unsigned int>(plain->total_length());
+  size_t out_size = plain->total_length();
   for (size_t i = 0; i < replacements.size(); ++i) {
-    out_size += replacements[i].encoded_.length();
+    out_size += crypto
+      ? crypto->max_encoded_submessage_length(replacements[i].length_)
+      : replacements[i].encoded_.length();
     out_size -= replacements[i].length_;
   }
 
   Message_Block_Ptr in(plain->duplicate());
   ACE_Message_Block* cur = in.get();
   Message_Block_Ptr out(new ACE_Message_Block(out_size));
+  bool encoded_any = false;
   for (size_t i = 0; i < replacements.size(); ++i) {
     const Chunk& c = replacements[i];
     for (; cur && (c.start_ < cur->rd_ptr() || c.start_ >= cur->wr_ptr());
@@ -626,18 +937,39 @@ RtpsUdpSendStrategy::replace_chunks(const ACE_Message_Block* plain,
     out->copy(cur->rd_ptr(), prefix);
     cur->rd_ptr(prefix);
 
-    out->copy(reinterpret_cast<const char*>(c.encoded_.get_buffer()),
-              c.encoded_.length());
+    // 'cur' now starts with the chunk
+    bool encoded = true;
+    if (!crypto) {
+      out->copy(reinterpret_cast<const char*>(c.encoded_.get_buffer()),
+                c.encoded_.length());
+    } else if (!encode_submessage(*crypto, *out, encoded, *cur, c)) {
+      return 0;
+    }
+    encoded_any |= encoded;
+
     for (size_t n = c.length_; n; cur = cur->cont()) {
+      if (!cur) {
+        return 0;
+      }
       if (cur->length() > n) {
+        if (!encoded) {
+          out->copy(cur->rd_ptr(), n);
+        }
         cur->rd_ptr(n);
         break;
       } else {
+        if (!encoded) {
+          out->copy(cur->rd_ptr(), cur->length());
+        }
         n -= cur->length();
       }
     }
   }
 
+  if (!encoded_any) {
+    return 0;
+  }
+
   for (; cur; cur = cur->cont()) {
     out->copy(cur->rd_ptr(), cur->length());
   }
@@ -649,6 +981,13 @@ RtpsUdpSendStrategy::replace_chunks(const ACE_Message_Block* plain,
 void
 RtpsUdpSendStrategy::stop_i()
 {
+#ifdef OPENDDS_RTPS_UDP_GSO
+  if (flush_segments() < 0) {
+    const ACE_Log_Priority prio = shouldWarn(errno) ? LM_WARNING : LM_ERROR;
+    ACE_ERROR((prio, "(%P|%t) RtpsUdpSendStrategy::stop_i() - "
+      "failed to send staged fragments\n"));
+  }
+#endif
 }
 
 } // namespace DCPS
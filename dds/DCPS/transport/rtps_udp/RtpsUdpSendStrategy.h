@@ -9,9 +9,11 @@
 #define DCPS_RTPSUDPSENDSTRATEGY_H
 
 #include "Rtps_Udp_Export.h"
+#include "RtpsUdpDefs.h"
 
 #if defined(OPENDDS_SECURITY)
 #include "dds/DdsSecurityCoreC.h"
+#include "dds/DCPS/security/framework/MessageBlockCryptoTransform.h"
 #endif
 
 #include "dds/DCPS/transport/framework/TransportSendStrategy.h"
@@ -62,10 +64,9 @@ protected:
   virtual ssize_t send_bytes_i(const iovec iov[], int n);
   ssize_t send_bytes_i_helper(const iovec iov[], int n);
 
-  virtual size_t max_message_size() const
-  {
-    return UDP_MAX_MESSAGE_SIZE;
-  }
+  virtual bool start_i();
+
+  virtual size_t max_message_size() const;
   virtual void add_delayed_notification(TransportQueueElement* element);
   virtual RemoveResult do_remove_sample(const RepoId& pub_id,
     const TransportQueueElement::MatchCriteria& criteria,
@@ -77,32 +78,50 @@ private:
                        const OPENDDS_SET(ACE_INET_Addr)& addrs);
   ssize_t send_single_i(const iovec iov[], int n,
                         const ACE_INET_Addr& addr);
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  ssize_t send_mmsg_i(const iovec iov[], int n,
+                      const OPENDDS_SET(ACE_INET_Addr)& addrs,
+                      bool segmented = false);
+#endif
+#ifdef OPENDDS_RTPS_UDP_GSO
+  /// Stage a packet holding a fragment to be sent along with the following
+  /// fragments of the same sample by flush_segments().
+  ssize_t send_segmented_i(const iovec iov[], int n,
+                           const OPENDDS_SET(ACE_INET_Addr)& addrs);
+  /// Returns -1, with errno set, if none of the staged fragments were sent.
+  ssize_t flush_segments();
+  size_t udp_segment_size() const;
+#endif
 
 #if defined(OPENDDS_SECURITY)
   ACE_Message_Block* pre_send_packet(const ACE_Message_Block* plain);
 
+  /// A submessage of the packet that is protected by the crypto plugin.
   struct Chunk {
     char* start_;
     unsigned int length_;
+    CORBA::Octet msgId_;
+    /// Sent by a DataWriter rather than a DataReader.
+    bool writer_;
+    DDS::Security::NativeCryptoHandle sender_;
+    /// HANDLE_NIL if the submessage isn't for a single remote entity.
+    DDS::Security::NativeCryptoHandle receiver_;
+    /// Only used if the plugin isn't a MessageBlockCryptoTransform.
     DDS::OctetSeq encoded_;
   };
 
-  bool encode_writer_submessage(const RepoId& receiver,
-                                OPENDDS_VECTOR(Chunk)& replacements,
-                                DDS::Security::CryptoTransform* crypto,
-                                const DDS::OctetSeq& plain,
-                                DDS::Security::DatawriterCryptoHandle sender_dwch,
-                                char* submessage_start, CORBA::Octet msgId);
+  bool encode_submessage(DDS::Security::CryptoTransform* crypto,
+                         const DDS::OctetSeq& plain, Chunk& chunk);
 
-  bool encode_reader_submessage(const RepoId& receiver,
-                                OPENDDS_VECTOR(Chunk)& replacements,
-                                DDS::Security::CryptoTransform* crypto,
-                                const DDS::OctetSeq& plain,
-                                DDS::Security::DatareaderCryptoHandle sender_drch,
-                                char* submessage_start, CORBA::Octet msgId);
+  bool encode_submessage(Security::MessageBlockCryptoTransform& crypto,
+                         ACE_Message_Block& out, bool& encoded,
+                         const ACE_Message_Block& plain, const Chunk& chunk);
 
+  /// Returns a copy of @a plain with the chunks encoded, by @a crypto if
+  /// it's not null, or 0 if none of them are.
   ACE_Message_Block* replace_chunks(const ACE_Message_Block* plain,
-                                    const OPENDDS_VECTOR(Chunk)& replacements);
+                                    const OPENDDS_VECTOR(Chunk)& replacements,
+                                    Security::MessageBlockCryptoTransform* crypto);
 #endif
 
   RtpsUdpDataLink* link_;
@@ -113,6 +132,28 @@ private:
   char rtps_header_data_[RTPS::RTPSHDR_SZ];
   ACE_Data_Block rtps_header_db_;
   ACE_Message_Block rtps_header_mb_;
+
+#ifdef OPENDDS_RTPS_UDP_MMSG
+  /// Reused by send_mmsg_i(), one entry per destination.
+  OPENDDS_VECTOR(mmsghdr) mmsg_;
+  /// Set if the kernel doesn't implement sendmmsg().
+  bool mmsg_unsupported_;
+#endif
+
+#ifdef OPENDDS_RTPS_UDP_GSO
+  /// Set by start_i() if use_udp_gso_ is configured and the kernel supports
+  /// UDP_SEGMENT.
+  bool gso_enabled_;
+  /// Fragments in gso_buffer_ are all gso_segment_ bytes long except the
+  /// last one, which may be shorter and ends the staged run.
+  OPENDDS_VECTOR(char) gso_buffer_;
+  size_t gso_length_, gso_segment_, gso_count_;
+  OPENDDS_SET(ACE_INET_Addr) gso_addrs_;
+  union {
+    cmsghdr cmsg_;
+    char data_[CMSG_SPACE(sizeof(ACE_UINT16))];
+  } gso_control_;
+#endif
 };
 
 } // namespace DCPS
@@ -97,7 +97,7 @@ public:
   ShmemAllocator* local_allocator();
   ShmemAllocator* peer_allocator() { return peer_alloc_; }
 
-  void read() { recv_strategy_->read(); }
+  bool read() { return recv_strategy_->read(); }
   void signal_semaphore();
   ShmemTransport& impl() const;
 
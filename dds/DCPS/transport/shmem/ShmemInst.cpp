@@ -25,6 +25,9 @@ ShmemInst::ShmemInst(const std::string& name)
   : TransportInst("shmem", name)
   , pool_size_(16 * 1024 * 1024)
   , datalink_control_size_(4 * 1024)
+  , control_ring_(false)
+  , receive_spin_usec_(0)
+  , receive_cpu_(-1)
   , hostname_(get_fully_qualified_hostname())
 {
   std::ostringstream pool;
@@ -48,6 +51,10 @@ ShmemInst::load(ACE_Configuration_Heap& cf,
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("pool_size"), pool_size_, size_t)
   GET_CONFIG_VALUE(cf, sect, ACE_TEXT("datalink_control_size"),
                    datalink_control_size_, size_t)
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("control_ring"), control_ring_, bool)
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("receive_spin_usec"),
+                   receive_spin_usec_, size_t)
+  GET_CONFIG_VALUE(cf, sect, ACE_TEXT("receive_cpu"), receive_cpu_, int)
   return 0;
 }
 
@@ -58,6 +65,11 @@ ShmemInst::dump_to_str() const
   os << TransportInst::dump_to_str() << std::endl;
   os << formatNameForDump("pool_size") << pool_size_ << "\n"
      << formatNameForDump("datalink_control_size") << datalink_control_size_
+     << "\n"
+     << formatNameForDump("control_ring") << (control_ring_ ? "true" : "false")
+     << "\n"
+     << formatNameForDump("receive_spin_usec") << receive_spin_usec_ << "\n"
+     << formatNameForDump("receive_cpu") << receive_cpu_
      << std::endl;
   return OPENDDS_STRING(os.str());
 }
@@ -35,6 +35,22 @@ public:
   /// Defaults to 4 kilobytes.
   size_t datalink_control_size_;
 
+  /// Organize each data link's control area (of datalink_control_size_ bytes)
+  /// as a single-producer/single-consumer ring.  The reading process is only
+  /// signaled when it is blocked waiting for data.  Not all platforms support
+  /// this, see ShmemRing.h.  Defaults to false.
+  bool control_ring_;
+
+  /// Time (in microseconds) that the receiving thread polls the data links
+  /// for new data before blocking on its semaphore.  Polling avoids the
+  /// scheduler wakeup latency at the cost of a busy CPU.  Defaults to 0,
+  /// which blocks as soon as there is no data.
+  size_t receive_spin_usec_;
+
+  /// CPU that the receiving thread is bound to, or -1 (the default) to let
+  /// the OS schedule it.  Mostly useful with receive_spin_usec_.
+  int receive_cpu_;
+
   bool is_reliable() const { return true; }
 
   virtual size_t populate_locator(OpenDDS::DCPS::TransportLocator& trans_info) const;
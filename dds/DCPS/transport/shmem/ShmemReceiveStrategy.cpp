@@ -7,6 +7,7 @@
 
 #include "ShmemReceiveStrategy.h"
 #include "ShmemDataLink.h"
+#include "ShmemRing.h"
 
 #include "dds/DCPS/transport/framework/TransportHeader.h"
 
@@ -22,17 +23,25 @@ ShmemReceiveStrategy::ShmemReceiveStrategy(ShmemDataLink* link)
   , current_data_(0)
   , partial_recv_remaining_(0)
   , partial_recv_ptr_(0)
+  , recv_done_(false)
+  , ring_(0)
+  , ring_tail_(0)
 {
 }
 
-void
+bool
 ShmemReceiveStrategy::read()
 {
+  if (ring_) {
+    return read_ring();
+  }
+
   if (partial_recv_remaining_) {
     VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::read link %@ "
           "resuming partial recv\n", link_));
+    const size_t partial = partial_recv_remaining_;
     handle_dds_input(ACE_INVALID_HANDLE);
-    return;
+    return partial != partial_recv_remaining_;
   }
 
   if (bound_name_.empty()) {
@@ -42,11 +51,20 @@ ShmemReceiveStrategy::read()
   ShmemAllocator* alloc = link_->peer_allocator();
   void* mem = 0;
   if (-1 == alloc->find(bound_name_.c_str(), mem)) {
+#ifdef OPENDDS_SHMEM_RING
+    const std::string ring_name = "Ring-" + link_->local_address();
+    if (0 == alloc->find(ring_name.c_str(), mem)) {
+      bound_name_ = ring_name;
+      ring_ = reinterpret_cast<ShmemRingHeader*>(mem);
+      ring_tail_ = shmem_load_acquire(ring_->tail_);
+      return read_ring();
+    }
+#endif
     VDBG_LVL((LM_INFO, "(%P|%t) ShmemReceiveStrategy::read link %@ "
               "peer allocator not found, receive_bytes will close link\n",
               link_), 1);
     handle_dds_input(ACE_INVALID_HANDLE); // will return 0 to the TRecvStrateg.
-    return;
+    return false;
   }
 
   if (!current_data_) {
@@ -58,7 +76,7 @@ ShmemReceiveStrategy::read()
     if (!start) {
       start = current_data_;
     } else if (start == current_data_) {
-      return; // none found => don't call handle_dds_input()
+      return false; // none found => don't call handle_dds_input()
     }
     if (current_data_[1].status_ == SHMEM_DATA_END_OF_ALLOC) {
       current_data_ = reinterpret_cast<ShmemData*>(mem) - 1; // incremented by the for loop
@@ -70,7 +88,47 @@ ShmemReceiveStrategy::read()
         link_, current_data_ - reinterpret_cast<ShmemData*>(mem)));
   // If we get this far, current_data_ points to the first SHMEM_DATA_IN_USE.
   // handle_dds_input() will call our receive_bytes() to get the data.
+  recv_done_ = false;
   handle_dds_input(ACE_INVALID_HANDLE);
+  return partial_recv_remaining_ || recv_done_;
+}
+
+bool
+ShmemReceiveStrategy::read_ring()
+{
+  bool received = false;
+#ifdef OPENDDS_SHMEM_RING
+  // Only the writer's first send after this thread parks is signaled, so
+  // drain everything that has been published.
+  while (true) {
+    const ACE_UINT32 tail = ring_tail_;
+    const size_t partial = partial_recv_remaining_;
+    if (!partial && !shmem_load_acquire(ring_->closed_)
+        && tail == shmem_load_acquire(ring_->head_)) {
+      break;
+    }
+    handle_dds_input(ACE_INVALID_HANDLE);
+    if (tail == ring_tail_ && partial == partial_recv_remaining_) {
+      break; // closed, or no progress was made
+    }
+    received = true;
+  }
+#endif
+  return received;
+}
+
+ShmemData*
+ShmemReceiveStrategy::ring_data()
+{
+#ifdef OPENDDS_SHMEM_RING
+  if (shmem_load_acquire(ring_->closed_)
+      || ring_tail_ == shmem_load_acquire(ring_->head_)) {
+    return 0;
+  }
+  return &shmem_ring_slots(ring_)[ring_tail_ & (ring_->capacity_ - 1)].data_;
+#else
+  return 0;
+#endif
 }
 
 ssize_t
@@ -84,9 +142,16 @@ ShmemReceiveStrategy::receive_bytes(iovec iov[],
 
   // check that the writer's shared memory is still available
   ShmemAllocator* alloc = link_->peer_allocator();
-  void* mem;
-  if (-1 == alloc->find(bound_name_.c_str(), mem)
-      || current_data_->status_ != SHMEM_DATA_IN_USE) {
+  if (ring_) {
+    // The ring is looked up once, the writer marks it closed when stopping.
+    current_data_ = ring_data();
+  } else {
+    void* mem;
+    if (-1 == alloc->find(bound_name_.c_str(), mem)) {
+      current_data_ = 0;
+    }
+  }
+  if (!current_data_ || current_data_->status_ != SHMEM_DATA_IN_USE) {
     VDBG_LVL((LM_INFO, "(%P|%t) ShmemReceiveStrategy::receive_bytes closing\n"),
              1);
     gracefully_disconnected_ = true; // do not attempt reconnect via relink()
@@ -159,13 +224,21 @@ ShmemReceiveStrategy::receive_bytes(iovec iov[],
     partial_recv_ptr_ = src_iter;
     VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::receive_bytes "
           "receive was partial\n"));
-    link_->signal_semaphore();
+    if (!ring_) {
+      link_->signal_semaphore();
+    }
 
   } else {
     partial_recv_remaining_ = 0;
     partial_recv_ptr_ = 0;
     VDBG((LM_DEBUG, "(%P|%t) ShmemReceiveStrategy::receive_bytes "
           "receive done\n"));
+    recv_done_ = true;
+#ifdef OPENDDS_SHMEM_RING
+    if (ring_) {
+      shmem_store_release(ring_->tail_, ++ring_tail_);
+    } else
+#endif
     current_data_->status_ = SHMEM_DATA_RECV_DONE;
   }
 
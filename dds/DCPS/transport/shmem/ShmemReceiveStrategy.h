@@ -21,13 +21,15 @@ namespace DCPS {
 
 class ShmemDataLink;
 struct ShmemData;
+struct ShmemRingHeader;
 
 class OpenDDS_Shmem_Export ShmemReceiveStrategy
   : public TransportReceiveStrategy<> {
 public:
   explicit ShmemReceiveStrategy(ShmemDataLink* link);
 
-  void read();
+  /// Returns true if data was received from the peer.
+  bool read();
 
 protected:
   virtual ssize_t receive_bytes(iovec iov[],
@@ -42,11 +44,21 @@ protected:
   virtual void stop_i();
 
 private:
+  bool read_ring();
+  ShmemData* ring_data();
+
   ShmemDataLink* link_;
   std::string bound_name_;
   ShmemData* current_data_;
   size_t partial_recv_remaining_;
   const char* partial_recv_ptr_;
+  /// Set by receive_bytes() before it marks a control block as received,
+  /// after which the writer may reuse the block.
+  bool recv_done_;
+
+  /// Set when the peer's send strategy uses a control ring.
+  ShmemRingHeader* ring_;
+  ACE_UINT32 ring_tail_;
 };
 
 } // namespace DCPS
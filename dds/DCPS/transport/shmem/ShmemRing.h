@@ -0,0 +1,116 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#ifndef OPENDDS_SHMEMRING_H
+#define OPENDDS_SHMEMRING_H
+
+#include "ShmemDataLink.h"
+
+#include "ace/Basic_Types.h"
+
+#if defined __GNUC__ && !defined OPENDDS_SHMEM_UNSUPPORTED
+#  define OPENDDS_SHMEM_RING
+#elif defined OPENDDS_SHMEM_WINDOWS && defined _MSC_VER
+#  define OPENDDS_SHMEM_RING
+#  include <intrin.h>
+#endif
+
+OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
+
+namespace OpenDDS {
+namespace DCPS {
+
+enum { SHMEM_CACHE_LINE = 64 };
+
+/**
+ * The control area of a data link in "control_ring" mode (see ShmemInst) is a
+ * single-producer/single-consumer ring in the writing process's pool.  The
+ * writer (ShmemSendStrategy) owns head_ and the reader (ShmemReceiveStrategy)
+ * owns tail_, so neither side needs the allocator's lock or a scan of the
+ * control blocks.  Slots in [tail_, head_) hold data for the reader, slots
+ * the reader has passed are reclaimed by the writer on its next send.
+ */
+struct ShmemRingHeader {
+  volatile ACE_UINT32 head_;
+  char pad_head_[SHMEM_CACHE_LINE - sizeof(ACE_UINT32)];
+  volatile ACE_UINT32 tail_;
+  char pad_tail_[SHMEM_CACHE_LINE - sizeof(ACE_UINT32)];
+  ACE_UINT32 capacity_; // a power of 2
+  volatile ACE_UINT32 closed_;
+  char pad_[SHMEM_CACHE_LINE - 2 * sizeof(ACE_UINT32)];
+};
+
+struct ShmemRingSlot {
+  ShmemData data_;
+  char pad_[SHMEM_CACHE_LINE - sizeof(ShmemData) % SHMEM_CACHE_LINE];
+};
+
+inline ShmemRingSlot* shmem_ring_slots(ShmemRingHeader* ring)
+{
+  return reinterpret_cast<ShmemRingSlot*>(ring + 1);
+}
+
+/**
+ * The doorbell lives in the reading process's pool next to its semaphore.
+ * The reader sets parked_ before it blocks on the semaphore, and a ring
+ * writer only posts the semaphore if it is the one to clear parked_.
+ */
+struct ShmemDoorbell {
+  volatile ACE_UINT32 parked_;
+  char pad_[SHMEM_CACHE_LINE - sizeof(ACE_UINT32)];
+};
+
+#ifdef OPENDDS_SHMEM_RING
+
+inline ACE_UINT32 shmem_load_acquire(const volatile ACE_UINT32& value)
+{
+#  ifdef __GNUC__
+  return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+#  else
+  // MSVC gives volatile reads acquire semantics.
+  return value;
+#  endif
+}
+
+inline void shmem_store_release(volatile ACE_UINT32& value, ACE_UINT32 v)
+{
+#  ifdef __GNUC__
+  __atomic_store_n(&value, v, __ATOMIC_RELEASE);
+#  else
+  // MSVC gives volatile writes release semantics.
+  value = v;
+#  endif
+}
+
+inline ACE_UINT32 shmem_exchange(volatile ACE_UINT32& value, ACE_UINT32 v)
+{
+#  ifdef __GNUC__
+  return __atomic_exchange_n(&value, v, __ATOMIC_SEQ_CST);
+#  else
+  return _InterlockedExchange(reinterpret_cast<volatile long*>(&value), v);
+#  endif
+}
+
+/// Orders a preceding store before a following load, as required between
+/// publishing ring data (or setting parked_) and checking the other side.
+inline void shmem_full_fence()
+{
+#  ifdef __GNUC__
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#  else
+  MemoryBarrier();
+#  endif
+}
+
+#endif // OPENDDS_SHMEM_RING
+
+} // namespace DCPS
+} // namespace OpenDDS
+
+OPENDDS_END_VERSIONED_NAMESPACE_DECL
+
+#endif  /* OPENDDS_SHMEMRING_H */
@@ -8,6 +8,8 @@
 #include "ShmemSendStrategy.h"
 #include "ShmemDataLink.h"
 #include "ShmemInst.h"
+#include "ShmemTransport.h"
+#include "ShmemRing.h"
 
 #include "dds/DCPS/transport/framework/NullSynchStrategy.h"
 
@@ -26,6 +28,10 @@ ShmemSendStrategy::ShmemSendStrategy(ShmemDataLink* link)
   , link_(link)
   , current_data_(0)
   , datalink_control_size_(link->impl().config().datalink_control_size_)
+  , ring_(0)
+  , ring_head_(0)
+  , ring_reclaimed_(0)
+  , peer_doorbell_(0)
 {
 #ifdef OPENDDS_SHMEM_UNIX
   memset(&peer_semaphore_, 0, sizeof(peer_semaphore_));
@@ -35,6 +41,10 @@ ShmemSendStrategy::ShmemSendStrategy(ShmemDataLink* link)
 bool
 ShmemSendStrategy::start_i()
 {
+  if (link_->impl().config().control_ring_) {
+    return start_ring();
+  }
+
   bound_name_ = "Write-" + link_->peer_address();
   ShmemAllocator* alloc = link_->local_allocator();
 
@@ -52,8 +62,14 @@ ShmemSendStrategy::start_i()
   data[(extra >= sizeof(int)) ? n_elems : (n_elems - 1)].status_ =
     SHMEM_DATA_END_OF_ALLOC;
   alloc->bind(bound_name_.c_str(), mem);
+  return start_peer_semaphore();
+}
 
+bool
+ShmemSendStrategy::start_peer_semaphore()
+{
   ShmemAllocator* peer = link_->peer_allocator();
+  void* mem = 0;
   peer->find("Semaphore", mem);
   ShmemSharedSemaphore* sem = reinterpret_cast<ShmemSharedSemaphore*>(mem);
 #if defined OPENDDS_SHMEM_WINDOWS
@@ -70,9 +86,122 @@ ShmemSendStrategy::start_i()
 #else
   ACE_UNUSED_ARG(sem);
 #endif
+
+  // Peers that don't have a doorbell are signaled for every send.
+  mem = 0;
+  if (peer->find("Doorbell", mem) == 0) {
+    peer_doorbell_ = reinterpret_cast<ShmemDoorbell*>(mem);
+  }
   return true;
 }
 
+bool
+ShmemSendStrategy::start_ring()
+{
+#ifdef OPENDDS_SHMEM_RING
+  bound_name_ = "Ring-" + link_->peer_address();
+  ShmemAllocator* alloc = link_->local_allocator();
+
+  size_t capacity = 1;
+  while (sizeof(ShmemRingHeader) + 2 * capacity * sizeof(ShmemRingSlot)
+         <= datalink_control_size_) {
+    capacity *= 2;
+  }
+  if (sizeof(ShmemRingHeader) + capacity * sizeof(ShmemRingSlot)
+      > datalink_control_size_) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
+              "datalink_control_size %B is too small for a control ring\n",
+              link_, datalink_control_size_), 0);
+    return false;
+  }
+
+  // Over-allocate so the ring can start on a cache line boundary.
+  void* mem = alloc->calloc(datalink_control_size_ + SHMEM_CACHE_LINE);
+  if (mem == 0) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ failed "
+              "to allocate %B bytes for control\n", link_,
+              datalink_control_size_ + SHMEM_CACHE_LINE), 0);
+    return false;
+  }
+  const size_t misalign =
+    reinterpret_cast<size_t>(mem) % SHMEM_CACHE_LINE;
+  char* const aligned = static_cast<char*>(mem)
+    + (misalign ? SHMEM_CACHE_LINE - misalign : 0);
+
+  ring_ = reinterpret_cast<ShmemRingHeader*>(aligned);
+  ring_->capacity_ = static_cast<ACE_UINT32>(capacity);
+  ring_head_ = ring_reclaimed_ = 0;
+  alloc->bind(bound_name_.c_str(), aligned);
+
+  VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
+            "using control ring of %B slots\n", link_, capacity), 2);
+  return start_peer_semaphore();
+#else
+  VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
+            "control_ring is not supported on this platform\n", link_), 0);
+  return false;
+#endif
+}
+
+ssize_t
+ShmemSendStrategy::send_ring(const iovec iov[], char* payload,
+                             size_t payload_size)
+{
+#ifdef OPENDDS_SHMEM_RING
+  ShmemTransport& transport = link_->impl();
+  ShmemRingSlot* const slots = shmem_ring_slots(ring_);
+  const ACE_UINT32 mask = ring_->capacity_ - 1;
+
+  // Everything before the reader's tail has been consumed.
+  const ACE_UINT32 tail = shmem_load_acquire(ring_->tail_);
+  for (; ring_reclaimed_ != tail; ++ring_reclaimed_) {
+    transport.release_payload(slots[ring_reclaimed_ & mask].data_.payload_);
+  }
+
+  if (ring_head_ - tail == ring_->capacity_) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ out of "
+              "space for control\n", link_), 0);
+    transport.release_payload(payload);
+    return -1;
+  }
+
+  ShmemData& data = slots[ring_head_ & mask].data_;
+  std::memcpy(data.transport_header_, iov[0].iov_base,
+              sizeof(data.transport_header_));
+  data.payload_ = payload;
+  data.status_ = SHMEM_DATA_IN_USE;
+  VDBG((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
+        "writing at ring slot #%u payload %@ len %B\n",
+        link_, ring_head_, payload, payload_size));
+  shmem_store_release(ring_->head_, ++ring_head_);
+
+  ring_doorbell();
+  return payload_size + iov[0].iov_len;
+#else
+  ACE_UNUSED_ARG(iov);
+  ACE_UNUSED_ARG(payload);
+  ACE_UNUSED_ARG(payload_size);
+  return -1;
+#endif
+}
+
+void
+ShmemSendStrategy::ring_doorbell()
+{
+#ifdef OPENDDS_SHMEM_RING
+  if (peer_doorbell_) {
+    // Pairs with the fence in ShmemTransport::ReadTask::svc(): either the
+    // reader sees the new head before blocking, or we see it parked.
+    shmem_full_fence();
+    if (!peer_doorbell_->parked_ ||
+        !shmem_exchange(peer_doorbell_->parked_, 0)) {
+      return;
+    }
+  }
+#endif
+  ACE_OS::sema_post(&peer_semaphore_);
+}
+
 ssize_t
 ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
 {
@@ -91,41 +220,34 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
     return -1;
   }
 
-  //FUTURE: use the ShmemTransport object to see if we already have the
-  //        same payload data available in the pool (from other DataLinks),
-  //        and if so, add a refcount to the start of the "from_pool" allocation
-
   size_t pool_alloc_size = 0;
   for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
     pool_alloc_size += iov[i].iov_len;
   }
 
-  ShmemAllocator* alloc = link_->local_allocator();
-  void* from_pool = alloc->malloc(pool_alloc_size);
-  if (from_pool == 0) {
+  // The same payload sent on other DataLinks of this transport shares a
+  // single refcounted allocation in the pool.
+  ShmemTransport& transport = link_->impl();
+  char* const payload = transport.alloc_payload(iov, n, pool_alloc_size);
+  if (payload == 0) {
     VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ failed "
               "to allocate %B bytes for data\n", link_, pool_alloc_size), 0);
     errno = ENOMEM;
     return -1;
   }
 
-  char* payload = reinterpret_cast<char*>(from_pool);
-  char* iter = payload;
-  for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
-    std::memcpy(iter, iov[i].iov_base, iov[i].iov_len);
-    iter += iov[i].iov_len;
+  if (ring_) {
+    return send_ring(iov, payload, pool_alloc_size);
   }
 
+  ShmemAllocator* alloc = link_->local_allocator();
   void* mem = 0;
   alloc->find(bound_name_.c_str(), mem);
 
   for (ShmemData* iter = reinterpret_cast<ShmemData*>(mem);
        iter->status_ != SHMEM_DATA_END_OF_ALLOC; ++iter) {
     if (iter->status_ == SHMEM_DATA_RECV_DONE) {
-      alloc->free(iter->payload_);
-      // This will eventually be refcounted so instead of a free(), the previous
-      // statement would decrement the refcount and check for 0 before free().
-      // See the 'FUTURE' comment above.
+      transport.release_payload(iter->payload_);
       iter->status_ = SHMEM_DATA_FREE;
       VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemSendStrategy for link %@ "
                 "releasing control block #%d\n", link_,
@@ -144,6 +266,7 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
     } else if (start == current_data_) {
       VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ out of "
                 "space for control\n", link_), 0);
+      transport.release_payload(payload);
       return -1;
     }
     if (current_data_[1].status_ == SHMEM_DATA_END_OF_ALLOC) {
@@ -163,6 +286,7 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
   } else {
     VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemSendStrategy for link %@ "
               "failed to find space for control\n", link_), 0);
+    transport.release_payload(payload);
     return -1;
   }
 
@@ -174,6 +298,12 @@ ShmemSendStrategy::send_bytes_i(const iovec iov[], int n)
 void
 ShmemSendStrategy::stop_i()
 {
+#ifdef OPENDDS_SHMEM_RING
+  if (ring_) {
+    shmem_store_release(ring_->closed_, 1);
+    ring_doorbell();
+  }
+#endif
 #ifdef OPENDDS_SHMEM_WINDOWS
   ::CloseHandle(peer_semaphore_);
 #endif
@@ -24,6 +24,8 @@ namespace DCPS {
 class ShmemDataLink;
 class ShmemInst;
 struct ShmemData;
+struct ShmemRingHeader;
+struct ShmemDoorbell;
 typedef RcHandle<ShmemInst> ShmemInst_rch;
 
 class OpenDDS_Shmem_Export ShmemSendStrategy
@@ -38,11 +40,23 @@ protected:
   virtual ssize_t send_bytes_i(const iovec iov[], int n);
 
 private:
+  bool start_ring();
+  bool start_peer_semaphore();
+  ssize_t send_ring(const iovec iov[], char* payload, size_t payload_size);
+  void ring_doorbell();
+
   ShmemDataLink* link_;
   std::string bound_name_;
   ACE_sema_t peer_semaphore_;
   ShmemData* current_data_;
   const size_t datalink_control_size_;
+
+  /// Control ring (ShmemInst::control_ring_), 0 when the control area is
+  /// an array of ShmemData scanned by both sides.
+  ShmemRingHeader* ring_;
+  ACE_UINT32 ring_head_;
+  ACE_UINT32 ring_reclaimed_;
+  ShmemDoorbell* peer_doorbell_;
 };
 
 } // namespace DCPS
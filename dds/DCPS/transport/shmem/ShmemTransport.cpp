@@ -9,11 +9,13 @@
 #include "ShmemInst.h"
 #include "ShmemSendStrategy.h"
 #include "ShmemReceiveStrategy.h"
+#include "ShmemRing.h"
 
 #include "dds/DCPS/AssociationData.h"
 #include "dds/DCPS/transport/framework/NetworkAddress.h"
 #include "dds/DCPS/transport/framework/TransportExceptions.h"
 
+#include "ace/High_Res_Timer.h"
 #include "ace/Log_Msg.h"
 
 #include <sstream>
@@ -159,7 +161,16 @@ ShmemTransport::configure_i(ShmemInst& config)
                      false);
   }
 
-  read_task_.reset(new ReadTask(this, ace_sema));
+  ShmemDoorbell* doorbell = 0;
+#  ifdef OPENDDS_SHMEM_RING
+  mem = alloc_->calloc(sizeof(ShmemDoorbell));
+  if (mem) {
+    doorbell = reinterpret_cast<ShmemDoorbell*>(mem);
+    alloc_->bind("Doorbell", doorbell);
+  }
+#  endif
+
+  read_task_.reset(new ReadTask(this, ace_sema, doorbell));
 
   VDBG_LVL((LM_INFO, "(%P|%t) ShmemTransport %@ configured with address %C\n",
             this, config.poolname().c_str()), 1);
@@ -183,6 +194,18 @@ ShmemTransport::shutdown_i()
 
   read_task_.reset();
 
+  {
+    GuardType payload_guard(payload_lock_);
+    VDBG_LVL((LM_DEBUG, "(%P|%t) ShmemTransport %@ payloads: %B allocated, "
+              "%B shared, %B freed, %B bytes saved\n", this,
+              payload_stats_.allocated_, payload_stats_.shared_,
+              payload_stats_.freed_, payload_stats_.bytes_saved_), 1);
+    // The pool is going away, so any outstanding payloads go with it.
+    payload_index_.clear();
+    payload_refs_.clear();
+    payload_stats_.in_use_ = 0;
+  }
+
   if (alloc_) {
 #ifndef OPENDDS_SHMEM_UNSUPPORTED
     void* mem = 0;
@@ -234,27 +257,98 @@ ShmemTransport::release_datalink(DataLink* link)
   }
 }
 
-ShmemTransport::ReadTask::ReadTask(ShmemTransport* outer, ACE_sema_t semaphore)
+ShmemTransport::ReadTask::ReadTask(ShmemTransport* outer, ACE_sema_t semaphore,
+                                   ShmemDoorbell* doorbell)
   : outer_(outer)
   , semaphore_(semaphore)
+  , doorbell_(doorbell)
   , stopped_(false)
 {
+  const size_t usec = outer->config().receive_spin_usec_;
+  spin_time_.set(static_cast<time_t>(usec / 1000000),
+                 static_cast<suseconds_t>(usec % 1000000));
   activate();
 }
 
 int
 ShmemTransport::ReadTask::svc()
 {
+  bind_cpu(outer_->config().receive_cpu_);
+
   while (true) {
+    if (spin_time_ != ACE_Time_Value::zero) {
+      spin();
+      // Posts for data that spin() has read would only cause empty wakeups.
+      // Anything posted after spin() returned is read below before blocking.
+      while (ACE_OS::sema_trywait(&semaphore_) == 0) {}
+      if (stopped_.value()) {
+        return 0;
+      }
+    }
+    // Without spinning or a control ring every post is a wakeup, so there
+    // is nothing to drain before blocking.
+    bool drain = spin_time_ != ACE_Time_Value::zero;
+#ifdef OPENDDS_SHMEM_RING
+    if (doorbell_) {
+      // Control ring writers only post the semaphore while we are parked, so
+      // park first and then check for anything published before they saw it.
+      shmem_exchange(doorbell_->parked_, 1);
+      drain = true;
+    }
+#endif
+    while (drain && outer_->read_from_links()) {}
     ACE_OS::sema_wait(&semaphore_);
-    if (stopped_) {
+    if (stopped_.value()) {
       return 0;
     }
+#ifdef OPENDDS_SHMEM_RING
+    if (doorbell_) {
+      shmem_store_release(doorbell_->parked_, 0);
+    }
+#endif
     outer_->read_from_links();
   }
   return 1;
 }
 
+void
+ShmemTransport::ReadTask::spin()
+{
+  ACE_Time_Value deadline = ACE_High_Res_Timer::gettimeofday_hr() + spin_time_;
+  while (!stopped_.value()) {
+    if (outer_->read_from_links()) {
+      deadline = ACE_High_Res_Timer::gettimeofday_hr() + spin_time_;
+    } else if (ACE_High_Res_Timer::gettimeofday_hr() >= deadline) {
+      return;
+    }
+  }
+}
+
+void
+ShmemTransport::ReadTask::bind_cpu(int cpu)
+{
+  if (cpu < 0) {
+    return;
+  }
+#ifdef ACE_HAS_CPU_SET_T
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  ACE_hthread_t self;
+  ACE_OS::thr_self(self);
+  if (ACE_OS::thr_setaffinity(self, sizeof cpus, &cpus) != 0) {
+    ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: ")
+               ACE_TEXT("ShmemTransport::ReadTask::bind_cpu: ")
+               ACE_TEXT("could not bind to CPU %d: %p\n"), cpu,
+               ACE_TEXT("thr_setaffinity")));
+  }
+#else
+  ACE_ERROR((LM_WARNING, ACE_TEXT("(%P|%t) WARNING: ")
+             ACE_TEXT("ShmemTransport::ReadTask::bind_cpu: ")
+             ACE_TEXT("receive_cpu is not supported on this platform\n")));
+#endif
+}
+
 void
 ShmemTransport::ReadTask::stop()
 {
@@ -263,22 +357,28 @@ ShmemTransport::ReadTask::stop()
   wait();
 }
 
-void
+bool
 ShmemTransport::read_from_links()
 {
-  std::vector<ShmemDataLink_rch> dl_copies;
+  // read_links_ keeps its capacity so that polling doesn't allocate.
+  read_links_.clear();
   {
     GuardType guard(links_lock_);
     typedef ShmemDataLinkMap::iterator iter_t;
     for (iter_t it = links_.begin(); it != links_.end(); ++it) {
-      dl_copies.push_back(it->second);
+      read_links_.push_back(it->second);
     }
   }
 
+  bool received = false;
   typedef std::vector<ShmemDataLink_rch>::iterator dl_iter_t;
-  for (dl_iter_t dl_it = dl_copies.begin(); dl_it != dl_copies.end(); ++dl_it) {
-    dl_it->in()->read();
+  for (dl_iter_t dl_it = read_links_.begin(); dl_it != read_links_.end(); ++dl_it) {
+    if (dl_it->in()->read()) {
+      received = true;
+    }
   }
+  read_links_.clear();
+  return received;
 }
 
 void
@@ -287,6 +387,95 @@ ShmemTransport::signal_semaphore()
   ACE_OS::sema_post(&read_task_->semaphore_);
 }
 
+char*
+ShmemTransport::alloc_payload(const iovec iov[], int n, size_t size)
+{
+  if (n < 2 || !alloc_) {
+    return 0;
+  }
+
+  const PayloadKey key(iov[1].iov_base, size);
+  GuardType guard(payload_lock_);
+
+  const PayloadIndex::iterator found = payload_index_.find(key);
+  if (found != payload_index_.end()) {
+    // The source address may have been reused for different data since the
+    // pool copy was made, so only share if the contents still match.
+    const char* existing = found->second;
+    bool same = true;
+    for (int i = 1; same && i < n; ++i) {
+      same = std::memcmp(existing, iov[i].iov_base, iov[i].iov_len) == 0;
+      existing += iov[i].iov_len;
+    }
+    if (same) {
+      ++payload_refs_[found->second].refcount_;
+      ++payload_stats_.shared_;
+      payload_stats_.bytes_saved_ += size;
+      VDBG((LM_DEBUG, "(%P|%t) ShmemTransport::alloc_payload "
+            "sharing payload %@ len %B\n", found->second, size));
+      return found->second;
+    }
+    // Stale entry: the old allocation stays alive for its existing references
+    // but is no longer eligible for sharing.
+    payload_refs_[found->second].key_ = PayloadKey();
+    payload_index_.erase(found);
+  }
+
+  char* const payload = static_cast<char*>(alloc_->malloc(size));
+  if (payload == 0) {
+    return 0;
+  }
+
+  char* iter = payload;
+  for (int i = 1 /* skip TransportHeader in [0] */; i < n; ++i) {
+    std::memcpy(iter, iov[i].iov_base, iov[i].iov_len);
+    iter += iov[i].iov_len;
+  }
+
+  PayloadRef& ref = payload_refs_[payload];
+  ref.key_ = key;
+  ref.refcount_ = 1;
+  payload_index_[key] = payload;
+  ++payload_stats_.allocated_;
+  ++payload_stats_.in_use_;
+  return payload;
+}
+
+void
+ShmemTransport::release_payload(char* payload)
+{
+  GuardType guard(payload_lock_);
+  const PayloadRefMap::iterator found = payload_refs_.find(payload);
+  if (found == payload_refs_.end()) {
+    VDBG_LVL((LM_ERROR, "(%P|%t) ERROR: ShmemTransport::release_payload "
+              "payload %@ is not allocated\n", payload), 0);
+    return;
+  }
+
+  if (--found->second.refcount_ > 0) {
+    return;
+  }
+
+  const PayloadIndex::iterator index = payload_index_.find(found->second.key_);
+  if (index != payload_index_.end() && index->second == payload) {
+    payload_index_.erase(index);
+  }
+  payload_refs_.erase(found);
+  ++payload_stats_.freed_;
+  --payload_stats_.in_use_;
+
+  if (alloc_) {
+    alloc_->free(payload);
+  }
+}
+
+ShmemTransport::PayloadStats
+ShmemTransport::payload_stats() const
+{
+  GuardType guard(payload_lock_);
+  return payload_stats_;
+}
+
 std::string
 ShmemTransport::address()
 {
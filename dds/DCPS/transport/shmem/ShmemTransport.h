@@ -16,7 +16,12 @@
 
 #include "dds/DCPS/PoolAllocator.h"
 
+#include "ace/Atomic_Op.h"
+#include "ace/Thread_Mutex.h"
+#include "ace/Time_Value.h"
+
 #include <string>
+#include <vector>
 
 OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 
@@ -24,6 +29,7 @@ namespace OpenDDS {
 namespace DCPS {
 
 class ShmemInst;
+struct ShmemDoorbell;
 
 class OpenDDS_Shmem_Export ShmemTransport : public TransportImpl {
 public:
@@ -34,6 +40,29 @@ public:
   std::string address();
   void signal_semaphore();
 
+  /// Copy the payload (iov[1] through iov[n - 1], iov[0] is the transport
+  /// header) into the pool, or reuse a copy of the identical payload that
+  /// is still in use by another DataLink.  Each successful call adds a
+  /// reference which is removed by release_payload().
+  char* alloc_payload(const iovec iov[], int n, size_t size);
+
+  /// Called when a reader has set SHMEM_DATA_RECV_DONE for a control block
+  /// referencing this payload.  The pool memory is freed with the last
+  /// reference.
+  void release_payload(char* payload);
+
+  /// Counters for the payloads managed by alloc_payload()/release_payload().
+  struct PayloadStats {
+    PayloadStats()
+      : allocated_(0), shared_(0), freed_(0), bytes_saved_(0), in_use_(0) {}
+    size_t allocated_;   ///< new allocations from the pool
+    size_t shared_;      ///< times an existing allocation was reused
+    size_t freed_;       ///< allocations returned to the pool
+    size_t bytes_saved_; ///< pool bytes not copied due to sharing
+    size_t in_use_;      ///< allocations currently referenced
+  };
+  PayloadStats payload_stats() const;
+
   ShmemInst& config() const;
 
 protected:
@@ -68,7 +97,11 @@ private:
 
   std::pair<std::string, std::string> blob_to_key(const TransportBLOB& blob);
 
-  void read_from_links(); // callback from ReadTask
+  /// Callback from ReadTask, returns true if any link received data.
+  bool read_from_links();
+
+  /// Only used by the ReadTask thread in read_from_links().
+  std::vector<ShmemDataLink_rch> read_links_;
 
   typedef ACE_Thread_Mutex        LockType;
   typedef ACE_Guard<LockType>     GuardType;
@@ -82,14 +115,52 @@ private:
 
   unique_ptr<ShmemAllocator> alloc_;
 
+  /// Identifies a payload by the address and total length of the source
+  /// data.  A match is confirmed by comparing the bytes before sharing.
+  struct PayloadKey {
+    PayloadKey(const void* source = 0, size_t size = 0)
+      : source_(source), size_(size) {}
+    bool operator<(const PayloadKey& rhs) const
+    {
+      return source_ < rhs.source_
+        || (source_ == rhs.source_ && size_ < rhs.size_);
+    }
+    const void* source_;
+    size_t size_;
+  };
+
+  struct PayloadRef {
+    PayloadRef(const PayloadKey& key = PayloadKey())
+      : key_(key), refcount_(0) {}
+    PayloadKey key_;
+    size_t refcount_;
+  };
+
+  /// Payloads in the pool that may be shared, and the refcounts of all
+  /// allocated payloads.  Both are protected by payload_lock_.
+  typedef OPENDDS_MAP(PayloadKey, char*) PayloadIndex;
+  PayloadIndex payload_index_;
+  typedef OPENDDS_MAP(char*, PayloadRef) PayloadRefMap;
+  PayloadRefMap payload_refs_;
+  PayloadStats payload_stats_;
+  mutable LockType payload_lock_;
+
   struct ReadTask : ACE_Task_Base {
-    ReadTask(ShmemTransport* outer, ACE_sema_t semaphore);
+    ReadTask(ShmemTransport* outer, ACE_sema_t semaphore,
+             ShmemDoorbell* doorbell);
     int svc();
     void stop();
 
+    /// Poll the links until none has had data for spin_time_.
+    void spin();
+    void bind_cpu(int cpu);
+
+    ACE_Time_Value spin_time_;
+
     ShmemTransport* outer_;
     ACE_sema_t semaphore_;
-    bool stopped_;
+    ShmemDoorbell* doorbell_;
+    ACE_Atomic_Op<ACE_Thread_Mutex, bool> stopped_;
 
   };
   unique_ptr<ReadTask> read_task_;
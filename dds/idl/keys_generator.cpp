@@ -21,6 +21,7 @@ bool keys_generator::gen_struct(AST_Structure*, UTL_ScopedName* name,
     return true;
   }
 
+  be_global->add_include("dds/DCPS/KeyHash.h", BE_GlobalData::STREAM_H);
   be_global->header_ << be_global->versioning_begin() << "\n";
 
   {
@@ -84,7 +85,40 @@ bool keys_generator::gen_struct(AST_Structure*, UTL_ScopedName* name,
     }
     be_global->header_ <<
       "    return false;\n"
-      "  }\n};\n";
+      "  }\n};\n\n";
+
+    be_global->header_ <<
+      "// Hashes the DCPS_DATA_KEY fields, keys that are equal according\n"
+      "// to the KeyLessThan structure above have the same hash.\n"
+      "struct " << be_global->export_macro() << ' ' <<
+      name->last_component()->get_string() << "_OpenDDS_KeyHash {\n";
+    if (info->key_list_.is_empty()) {
+      be_global->header_ <<
+        "  ACE_UINT32 operator()(const " << cxx << "&) const\n"
+        "  {\n"
+        "    return 0;\n"
+        "  }\n};\n";
+    } else {
+      const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+      be_global->header_ <<
+        "  ACE_UINT32 operator()(const " << cxx << "& v) const\n"
+        "  {\n"
+        "    ACE_UINT32 hash = OpenDDS::DCPS::key_hash_seed;\n";
+
+      IDL_GlobalData::DCPS_Data_Type_Info_Iter iter(info->key_list_);
+
+      for (ACE_TString* kp = 0; iter.next(kp) != 0; iter.advance()) {
+        string fname = ACE_TEXT_ALWAYS_CHAR(kp->c_str());
+        if (use_cxx11) {
+          fname += "()";
+        }
+        be_global->header_ <<
+          "    OpenDDS::DCPS::key_hash(hash, v." << fname << ");\n";
+      }
+      be_global->header_ <<
+        "    return hash;\n"
+        "  }\n};\n";
+    }
   } // close namespaces in generated code
   be_global->header_ << be_global->versioning_end() << "\n";
   return true;
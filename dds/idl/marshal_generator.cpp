@@ -986,6 +986,96 @@ namespace {
     return bounded;
   }
 
+  /// Returns true if the classic C++ mapping of 'type' has the same bytes
+  /// as its CDR encoding when the stream is aligned to 'max_align'.  On
+  /// success 'size' is advanced by the CDR size of 'type'.  Only types
+  /// without any padding (internal or trailing) qualify, so the generated
+  /// code can confirm the C++ layout with a single sizeof comparison.
+  bool fixed_layout(AST_Type* type, size_t& size, size_t& max_align)
+  {
+    type = resolveActualType(type);
+    switch (type->node_type()) {
+    case AST_Decl::NT_pre_defined: {
+      AST_PredefinedType* p = AST_PredefinedType::narrow_from_decl(type);
+      size_t width;
+      switch (p->pt()) {
+      case AST_PredefinedType::PT_char:
+      case AST_PredefinedType::PT_octet:
+        width = 1;
+        break;
+      case AST_PredefinedType::PT_short:
+      case AST_PredefinedType::PT_ushort:
+        width = 2;
+        break;
+      case AST_PredefinedType::PT_long:
+      case AST_PredefinedType::PT_ulong:
+      case AST_PredefinedType::PT_float:
+        width = 4;
+        break;
+      case AST_PredefinedType::PT_longlong:
+      case AST_PredefinedType::PT_ulonglong:
+      case AST_PredefinedType::PT_double:
+        width = 8;
+        break;
+      default:
+        // boolean and enums can't take arbitrary bytes, wchar and
+        // long double don't have a fixed native representation.
+        return false;
+      }
+      if (size % width) {
+        return false;
+      }
+      size += width;
+      if (width > max_align) {
+        max_align = width;
+      }
+      return true;
+    }
+    case AST_Decl::NT_struct: {
+      AST_Structure* struct_node = dynamic_cast<AST_Structure*>(type);
+      if (struct_node->nfields() == 0) {
+        return false;
+      }
+      size_t struct_size = 0, struct_align = 1;
+      for (unsigned long i = 0; i < struct_node->nfields(); ++i) {
+        AST_Field** f;
+        struct_node->field(f, i);
+        if (!fixed_layout((*f)->field_type(), struct_size, struct_align)) {
+          return false;
+        }
+      }
+      if (struct_size % struct_align || size % struct_align) {
+        return false;
+      }
+      size += struct_size;
+      if (struct_align > max_align) {
+        max_align = struct_align;
+      }
+      return true;
+    }
+    case AST_Decl::NT_array: {
+      AST_Array* array_node = dynamic_cast<AST_Array*>(type);
+      size_t elem_size = 0, elem_align = 1;
+      if (!fixed_layout(array_node->base_type(), elem_size, elem_align)
+          || elem_size % elem_align || size % elem_align) {
+        return false;
+      }
+      size_t array_size = 1;
+      AST_Expression** dims = array_node->dims();
+      for (unsigned long i = 0; i < array_node->n_dims(); i++) {
+        array_size *= dims[i]->ev()->u.ulval;
+      }
+      size += elem_size * array_size;
+      if (elem_align > max_align) {
+        max_align = elem_align;
+      }
+      return true;
+    }
+    default:
+      return false;
+    }
+  }
+
   void align(size_t alignment, size_t& size, size_t& padding)
   {
     if ((size + padding) % alignment) {
@@ -1583,6 +1673,17 @@ bool marshal_generator::gen_struct(AST_Structure* /* node */,
   }
 
   RtpsFieldCustomizer rtpsCustom(cxx);
+
+  // Structures that are laid out in memory exactly like their CDR encoding
+  // are copied as one block when no byte swapping or padding is needed.
+  size_t fixed_size = 0, fixed_align = 1;
+  bool is_fixed = !use_cxx11 && !fields.empty() && rtpsCustom.preamble_.empty();
+  for (size_t i = 0; is_fixed && i < fields.size(); ++i) {
+    is_fixed = fixed_layout(fields[i]->field_type(), fixed_size, fixed_align)
+      && rtpsCustom.getConditional(fields[i]->local_name()->get_string()).empty();
+  }
+  is_fixed = is_fixed && fixed_size % fixed_align == 0;
+
   {
     Function find_size("gen_find_size", "void");
     find_size.addArg("stru", "const " + cxx + "&");
@@ -1614,6 +1715,14 @@ bool marshal_generator::gen_struct(AST_Structure* /* node */,
     insertion.addArg("strm", "Serializer&");
     insertion.addArg("stru", "const " + cxx + "&");
     insertion.endArgs();
+    if (is_fixed) {
+      be_global->impl_ <<
+        "  if (sizeof(stru) == " << fixed_size << " && !strm.swap_bytes()"
+        " && strm.is_aligned_w(" << fixed_align << ")) {\n"
+        "    return strm.write_octet_array(reinterpret_cast<const ACE_CDR::Octet*>(&stru), "
+        << fixed_size << ");\n"
+        "  }\n";
+    }
     string expr, intro = rtpsCustom.preamble_;
     for (size_t i = 0; i < fields.size(); ++i) {
       if (i) expr += "\n    && ";
@@ -1635,6 +1744,14 @@ bool marshal_generator::gen_struct(AST_Structure* /* node */,
     extraction.addArg("strm", "Serializer&");
     extraction.addArg("stru", cxx + "&");
     extraction.endArgs();
+    if (is_fixed) {
+      be_global->impl_ <<
+        "  if (sizeof(stru) == " << fixed_size << " && !strm.swap_bytes()"
+        " && strm.is_aligned_r(" << fixed_align << ")) {\n"
+        "    return strm.read_octet_array(reinterpret_cast<ACE_CDR::Octet*>(&stru), "
+        << fixed_size << ");\n"
+        "  }\n";
+    }
     string expr, intro;
     for (size_t i = 0; i < fields.size(); ++i) {
       if (i) expr += "\n    && ";
@@ -75,30 +75,38 @@ namespace {
     }
   }
 
+  /// Expression for the Value of the scalar field in the struct "typed".
+  std::string field_value(AST_Field* field, Classification cls)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    const std::string fieldName = field->local_name()->get_string();
+    std::string prefix, suffix;
+    if (cls & CL_ENUM) {
+      AST_Type* enum_type = resolveActualType(field->field_type());
+      prefix = "gen_" +
+        dds_generator::scoped_helper(enum_type->name(), "_")
+        + "_names[";
+      if (use_cxx11) {
+        prefix += "static_cast<int>(";
+      }
+      suffix = use_cxx11 ? "())]" : "]";
+    } else if (use_cxx11) {
+      suffix += "()";
+    }
+    const std::string string_to_ptr = use_cxx11 ? "" : ".in()";
+    return prefix + "typed." + fieldName
+      + (cls & CL_STRING ? string_to_ptr : "") + suffix;
+  }
+
   void gen_field_getValue(AST_Field* field)
   {
     const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
     const Classification cls = classify(field->field_type());
     const std::string fieldName = field->local_name()->get_string();
     if (cls & CL_SCALAR) {
-      std::string prefix, suffix;
-      if (cls & CL_ENUM) {
-        AST_Type* enum_type = resolveActualType(field->field_type());
-        prefix = "gen_" +
-          dds_generator::scoped_helper(enum_type->name(), "_")
-          + "_names[";
-        if (use_cxx11) {
-          prefix += "static_cast<int>(";
-        }
-        suffix = use_cxx11 ? "())]" : "]";
-      } else if (use_cxx11) {
-        suffix += "()";
-      }
-      const std::string string_to_ptr = use_cxx11 ? "" : ".in()";
       be_global->impl_ <<
         "    if (std::strcmp(field, \"" << fieldName << "\") == 0) {\n"
-        "      return " + prefix + "typed." + fieldName
-        + (cls & CL_STRING ? string_to_ptr : "") + suffix + ";\n"
+        "      return " + field_value(field, cls) + ";\n"
         "    }\n";
       be_global->add_include("<cstring>", BE_GlobalData::STREAM_CPP);
     } else if (cls & CL_STRUCTURE) {
@@ -108,6 +116,49 @@ namespace {
     }
   }
 
+  void gen_field_value_getter(AST_Field* field)
+  {
+    const Classification cls = classify(field->field_type());
+    if (cls & CL_SCALAR) {
+      be_global->impl_ <<
+        "  static Value value_" << field->local_name()->get_string()
+        << "(const void* stru)\n"
+        "  {\n"
+        "    const T& typed = *static_cast<const T*>(stru);\n"
+        "    return " << field_value(field, cls) << ";\n"
+        "  }\n\n";
+    }
+  }
+
+  void gen_field_getFieldAccessor(AST_Field* field)
+  {
+    const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    const Classification cls = classify(field->field_type());
+    const std::string fieldName = field->local_name()->get_string();
+    if (cls & CL_SCALAR) {
+      be_global->impl_ <<
+        "    if (std::strcmp(field, \"" << fieldName << "\") == 0) {\n"
+        "      FieldAccessor fa;\n"
+        "      fa.getter_ = &value_" << fieldName << ";\n"
+        "      return fa;\n"
+        "    }\n";
+    } else if (cls & CL_STRUCTURE) {
+      const size_t n = fieldName.size() + 1 /* 1 for the dot */;
+      const std::string member =
+        "sample." + std::string(use_cxx11 ? "_" : "") + fieldName;
+      be_global->impl_ <<
+        "    if (std::strncmp(field, \"" << fieldName << ".\", " << n
+        << ") == 0) {\n"
+        "      FieldAccessor fa = getMetaStruct<"
+        << scoped(field->field_type()->name())
+        << ">().getFieldAccessor(field + " << n << ");\n"
+        "      fa.offset_ += reinterpret_cast<const char*>(&" << member
+        << ") - reinterpret_cast<const char*>(&sample);\n"
+        "      return fa;\n"
+        "    }\n";
+    }
+  }
+
   std::string to_cxx_type(AST_Type* type, int& size)
   {
     const Classification cls = classify(type);
@@ -170,9 +221,62 @@ namespace {
     return scoped(type->name());
   }
 
-  void gen_field_getValueFromSerialized(AST_Field* field)
+  /// Emits the statements skipping over @a field in a serialized sample.
+  void gen_field_skip(AST_Field* field, const std::string& indent)
   {
     const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
+    AST_Type* type = field->field_type();
+    const Classification cls = classify(type);
+    const std::string fieldName = field->local_name()->get_string();
+    int size = 0;
+    const std::string cxx_type = to_cxx_type(type, size);
+    if (cls & CL_STRING) {
+      be_global->impl_ <<
+        indent << "ACE_CDR::ULong len;\n" <<
+        indent << "if (!(ser >> len)) {\n" <<
+        indent << "  throw std::runtime_error(\"String '" << fieldName <<
+        "' length could not be deserialized\");\n" <<
+        indent << "}\n" <<
+        indent << "if (!ser.skip(static_cast<ACE_UINT16>(len))) {\n" <<
+        indent << "  throw std::runtime_error(\"String '" << fieldName <<
+        "' contents could not be skipped\");\n" <<
+        indent << "}\n";
+    } else if ((cls & CL_SCALAR) && (cls & CL_WIDE)) {
+      be_global->impl_ <<
+        indent << "ACE_CDR::Octet len;\n" <<
+        indent << "if (!(ser >> ACE_InputCDR::to_octet(len))) {\n" <<
+        indent << "  throw std::runtime_error(\"WChar '" << fieldName <<
+        "' length could not be deserialized\");\n" <<
+        indent << "}\n" <<
+        indent << "if (!ser.skip(static_cast<ACE_UINT16>(len))) {\n" <<
+        indent << "  throw std::runtime_error(\"WChar '" << fieldName <<
+        "' contents could not be skipped\");\n" <<
+        indent << "}\n";
+    } else if (cls & CL_SCALAR) {
+      be_global->impl_ <<
+        indent << "if (!ser.skip(1, " << size << ")) {\n" <<
+        indent << "  throw std::runtime_error(\"Field '" << fieldName <<
+        "' could not be skipped\");\n" <<
+        indent << "}\n";
+    } else { // struct, array, sequence, union:
+      std::string pre, post;
+      if (!use_cxx11 && (cls & CL_ARRAY)) {
+        post = "_forany";
+      } else if (use_cxx11 && (cls & (CL_ARRAY | CL_SEQUENCE))) {
+        pre = "IDL::DistinctType<";
+        post = ", " + dds_generator::scoped_helper(type->name(), "_") + "_tag>";
+      }
+      be_global->impl_ <<
+        indent << "if (!gen_skip_over(ser, static_cast<" << pre << cxx_type
+        << post << "*>(0))) {\n" <<
+        indent << "  throw std::runtime_error(\"Field '" << fieldName <<
+        "' could not be skipped\");\n" <<
+        indent << "}\n";
+    }
+  }
+
+  void gen_field_getValueFromSerialized(AST_Field* field)
+  {
     AST_Type* type = field->field_type();
     const Classification cls = classify(type);
     const std::string fieldName = field->local_name()->get_string();
@@ -191,56 +295,65 @@ namespace {
         "      }\n"
         "      return val;\n"
         "    } else {\n";
-      if (cls & CL_STRING) {
-        be_global->impl_ <<
-          "      ACE_CDR::ULong len;\n"
-          "      if (!(ser >> len)) {\n"
-          "        throw std::runtime_error(\"String '" << fieldName <<
-          "' length could not be deserialized\");\n"
-          "      }\n"
-          "      if (!ser.skip(static_cast<ACE_UINT16>(len))) {\n"
-          "        throw std::runtime_error(\"String '" << fieldName <<
-          "' contents could not be skipped\");\n"
-          "      }\n";
-      } else if (cls & CL_WIDE) {
-        be_global->impl_ <<
-          "      ACE_CDR::Octet len;\n"
-          "      if (!(ser >> ACE_InputCDR::to_octet(len))) {\n"
-          "        throw std::runtime_error(\"WChar '" << fieldName <<
-          "' length could not be deserialized\");\n"
-          "      }\n"
-          "      if (!ser.skip(static_cast<ACE_UINT16>(len))) {\n"
-          "        throw std::runtime_error(\"WChar '" << fieldName <<
-          "' contents could not be skipped\");\n"
-          "      }\n";
-      } else {
-        be_global->impl_ <<
-          "      if (!ser.skip(1, " << size << ")) {\n"
-          "        throw std::runtime_error(\"Field '" << fieldName <<
-          "' could not be skipped\");\n"
-          "      }\n";
-      }
+      gen_field_skip(field, "      ");
       be_global->impl_ <<
         "    }\n";
     } else if (cls & CL_STRUCTURE) {
       delegateToNested(fieldName, field, "ser", true);
-    } else { // array, sequence, union:
-      std::string pre, post;
-      if (!use_cxx11 && (cls & CL_ARRAY)) {
-        post = "_forany";
-      } else if (use_cxx11 && (cls & (CL_ARRAY | CL_SEQUENCE))) {
-        pre = "IDL::DistinctType<";
-        post = ", " + dds_generator::scoped_helper(type->name(), "_") + "_tag>";
-      }
+    } else {
+      gen_field_skip(field, "    ");
+    }
+  }
+
+  void gen_field_getValues(AST_Field* field)
+  {
+    AST_Type* type = field->field_type();
+    const Classification cls = classify(type);
+    const std::string fieldName = field->local_name()->get_string();
+    int size = 0;
+    const std::string cxx_type = to_cxx_type(type, size);
+    if (cls & CL_SCALAR) {
+      type = resolveActualType(type);
+      const std::string val =
+        (cls & CL_STRING) ? "val.out()" : getWrapper("val", type, WD_INPUT);
+      be_global->impl_ <<
+        "    if ((i = fields.find(\"" << fieldName << "\")) >= 0) {\n"
+        "      " << cxx_type << " val;\n"
+        "      if (!(ser >> " << val << ")) {\n"
+        "        throw std::runtime_error(\"Field '" << fieldName << "' could "
+        "not be deserialized\");\n"
+        "      }\n"
+        "      fields.set(i, val);\n"
+        "      if (fields.done()) {\n"
+        "        return true;\n"
+        "      }\n"
+        "    } else {\n";
+      gen_field_skip(field, "      ");
+      be_global->impl_ <<
+        "    }\n";
+    } else if (cls & CL_STRUCTURE) {
+      const size_t n = fieldName.size() + 1 /* 1 for the dot */;
+      be_global->impl_ <<
+        "    nested = fields.nested(\"" << fieldName << ".\", " << n << ");\n"
+        "    if (nested.count_) {\n"
+        "      if (!getMetaStruct<" << scoped(type->name())
+        << ">().getValues(ser, nested)) {\n"
+        "        return false;\n"
+        "      }\n"
+        "      fields.merge(nested);\n"
+        "      if (fields.done()) {\n"
+        "        return true;\n"
+        "      }\n"
+        "    } else {\n";
+      gen_field_skip(field, "      ");
       be_global->impl_ <<
-        "    if (!gen_skip_over(ser, static_cast<" << pre << cxx_type << post
-        << "*>(0))) {\n"
-        "      throw std::runtime_error(\"Field \" + OPENDDS_STRING(field) + \""
-        " could not be skipped\");\n"
         "    }\n";
+    } else {
+      gen_field_skip(field, "    ");
     }
   }
 
+
   void gen_field_createQC(AST_Field* field)
   {
     const bool use_cxx11 = be_global->language_mapping() == BE_GlobalData::LANGMAP_CXX11;
@@ -446,6 +559,37 @@ bool metaclass_generator::gen_struct(AST_Structure*, UTL_ScopedName* name,
     "    }\n"                  //    and the return value is ignored
     "    throw std::runtime_error(\"Field \" + OPENDDS_STRING(field) + \" not "
     "valid for struct " << clazz << "\");\n"
+    "  }\n\n";
+  be_global->impl_ <<
+    "  bool getValues(Serializer& ser, FieldSet& fields) const\n"
+    "  {\n";
+  bool scalars = false, nested = false;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    const Classification cls = classify(fields[i]->field_type());
+    scalars |= (cls & CL_SCALAR) != 0;
+    nested |= (cls & CL_STRUCTURE) != 0;
+  }
+  if (scalars) {
+    be_global->impl_ << "    int i;\n";
+  }
+  if (nested) {
+    be_global->impl_ << "    FieldSet nested;\n";
+  }
+  std::for_each(fields.begin(), fields.end(), gen_field_getValues);
+  be_global->impl_ <<
+    "    return true;\n"
+    "  }\n\n";
+  std::for_each(fields.begin(), fields.end(), gen_field_value_getter);
+  be_global->impl_ <<
+    "  FieldAccessor getFieldAccessor(const char* field) const\n"
+    "  {\n";
+  if (nested) {
+    // only used for the offsets of nested structs
+    be_global->impl_ << "    T sample;\n";
+  }
+  std::for_each(fields.begin(), fields.end(), gen_field_getFieldAccessor);
+  be_global->impl_ <<
+    "    return FieldAccessor();\n"
     "  }\n\n"
     "  ComparatorBase::Ptr create_qc_comparator(const char* field, "
     "ComparatorBase::Ptr next) const\n"
@@ -139,6 +139,7 @@ bool ts_generator::gen_struct(AST_Structure*, UTL_ScopedName* name,
     "  typedef " << cxxName << "DataWriter DataWriterType;\n"
     "  typedef " << cxxName << "DataReader DataReaderType;\n"
     "  typedef " << cxxName << "_OpenDDS_KeyLessThan LessThanType;\n"
+    "  typedef " << cxxName << "_OpenDDS_KeyHash HashType;\n"
     "\n"
     "  static const char* type_name () { return \"" << cxxName << "\"; }\n"
     "  static bool gen_has_key () { return " << (has_keys ? "false" : "true") << "; }\n"
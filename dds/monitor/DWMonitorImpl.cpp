@@ -16,6 +16,18 @@ OPENDDS_BEGIN_VERSIONED_NAMESPACE_DECL
 namespace OpenDDS {
 namespace DCPS {
 
+namespace {
+
+void add_value(NVPSeq& values, const OPENDDS_STRING& name, size_t value)
+{
+  const CORBA::ULong i = values.length();
+  values.length(i + 1);
+  values[i].name = name.c_str();
+  values[i].value.integer_value(static_cast<CORBA::Long>(value));
+}
+
+}
+
 DWMonitorImpl::DWMonitorImpl(DataWriterImpl* dw,
               OpenDDS::DCPS::DataWriterReportDataWriter_ptr dw_writer)
   : dw_(dw),
@@ -62,6 +74,14 @@ DWMonitorImpl::report() {
       report.associations[length].dr_id = *iter;
       length++;
     }
+    DataWriterImpl::AllocatorStatsList stats;
+    this->dw_->allocator_stats(stats);
+    for (size_t i = 0; i < stats.size(); ++i) {
+      const OPENDDS_STRING name = stats[i].name_;
+      add_value(report.values, name + "_slabs", stats[i].slabs_);
+      add_value(report.values, name + "_overflows", stats[i].overflows_);
+      add_value(report.values, name + "_high_water", stats[i].high_water_);
+    }
     this->dw_writer_->write(report, DDS::HANDLE_NIL);
   }
 }
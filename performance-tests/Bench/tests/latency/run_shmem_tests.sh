@@ -0,0 +1,48 @@
+#!/bin/bash
+#
+# Run the latency tests on a single host with each of the shared memory
+# transport receive modes, then reduce the data and plot the latency
+# histograms of the modes against each other.
+#
+#   shmem       - control area scan, semaphore signaled for every sample
+#   shmem-ring  - control ring, semaphore signaled only when parked
+#   shmem-spin  - control ring, receiver polls before parking
+#
+# Use taskset or receive_cpu in etc/transport-shmem-spin.ini to keep the
+# spinning receivers off the CPUs used by the test processes.
+
+TESTBASE=$( cd "$( dirname ${BASH_SOURCE[0]} )" && pwd )
+PROJECTBASE=$( cd $TESTBASE/../.. && pwd )
+
+REPOHOST=localhost
+REPOPORT=2809
+TEST_DURATION=${TEST_DURATION:-60}
+
+MODES=${MODES:-"shmem shmem-ring shmem-spin"}
+SIZES=${SIZES:-"50 100 250 500 1000 2500 5000 8000 16000 32000"}
+
+DATADIR=$TESTBASE/data
+mkdir -p $DATADIR
+
+$PROJECTBASE/bin/run_test -S -h iiop://$REPOHOST:$REPOPORT & export REPO_PID=$!
+sleep 2
+
+for mode in $MODES; do
+  mkdir -p $TESTBASE/$mode
+  cd $TESTBASE/$mode
+  TRANSPORTCONFIG=$PROJECTBASE/etc/transport-$mode.ini
+
+  for sz in $SIZES; do
+    echo ============ Running $mode $sz
+    $PROJECTBASE/bin/run_test -P -t $TEST_DURATION -h $REPOHOST:$REPOPORT -i $TRANSPORTCONFIG -s $TESTBASE/p2.ini > p2-$sz.log 2>&1 & P2_PID=$!
+    $PROJECTBASE/bin/run_test -P -t $TEST_DURATION -h $REPOHOST:$REPOPORT -i $TRANSPORTCONFIG -s $TESTBASE/p1-$sz.ini > p1-$sz.log 2>&1
+    wait $P2_PID
+    $PROJECTBASE/bin/reduce-latency-data.pl latency-$sz.data > $DATADIR/latency-$mode-$sz.gpd
+  done
+  cd $TESTBASE
+done
+
+kill $REPO_PID
+
+$PROJECTBASE/bin/extract-latency.pl $DATADIR/latency-shmem*.gpd > $DATADIR/latency-shmem.csv
+gnuplot -c $PROJECTBASE/bin/plot-shmem-modes.gpi $DATADIR $DATADIR
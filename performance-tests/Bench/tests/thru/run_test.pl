@@ -52,6 +52,10 @@ uses the multicast implementation with reliability enabled
 
 uses the rtps_udp transport implementation
 
+=item rtps-gso
+
+uses the rtps_udp transport implementation with UDP segmentation offload
+
 =back
 
 =head1 EXAMPLE
@@ -164,6 +168,12 @@ elsif ($transport_type eq 'rtps') {
     mkdir "rtps", 0777 unless -d "rtps";
     chdir "rtps";
 }
+elsif ($transport_type eq 'rtps-gso') {
+   $trans_config_file = "$bench_location/etc/transport-rtps-gso.ini";
+   $sub_config_file = "$bench_location/tests/thru/bidir-remote-rel.ini";
+    mkdir "rtps-gso", 0777 unless -d "rtps-gso";
+    chdir "rtps-gso";
+}
 else {
     print "Unknown transport. Skipping...\n";
     exit 0;
@@ -0,0 +1,324 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/security/CryptoBuiltInImpl.h"
+#include "dds/DCPS/LocalObject.h"
+
+#include "dds/DdsSecurityCoreC.h"
+#include "dds/DdsSecurityParamsC.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/High_Res_Timer.h"
+#include "ace/Log_Msg.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
+
+#include <vector>
+
+using namespace DDS::Security;
+
+namespace {
+
+int iterations = 100000;
+std::vector<int> sizes;
+
+/// The encoded submessage goes in a SEC_BODY holding a 4 byte length
+/// followed by its bytes, and the SEC_BODY's submessageLength is a UINT16.
+const int max_size = 65535 - 4;
+
+void parse_sizes(const ACE_TCHAR* arg)
+{
+  sizes.clear();
+  while (*arg) {
+    sizes.push_back(ACE_OS::atoi(arg));
+    while (*arg && *arg != ACE_TEXT(',')) {
+      ++arg;
+    }
+    if (*arg) {
+      ++arg;
+    }
+  }
+}
+
+void parse_args(int& argc, ACE_TCHAR** argv)
+{
+  ACE_Arg_Shifter shifter(argc, argv);
+
+  while (shifter.is_anything_left()) {
+    const ACE_TCHAR* arg;
+
+    if ((arg = shifter.get_the_parameter(ACE_TEXT("-n")))) {
+      iterations = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-s")))) {
+      parse_sizes(arg);
+      shifter.consume_arg();
+    } else {
+      shifter.ignore_arg();
+    }
+  }
+}
+
+/// Only used by the builtin volatile endpoints, which aren't measured here.
+struct EmptySharedSecret : OpenDDS::DCPS::LocalObject<SharedSecretHandle> {
+  DDS::OctetSeq* challenge1() { return new DDS::OctetSeq; }
+  DDS::OctetSeq* challenge2() { return new DDS::OctetSeq; }
+  DDS::OctetSeq* sharedSecret() { return new DDS::OctetSeq; }
+};
+
+/// One participant's instance of the builtin crypto plugin.
+struct Plugin {
+  Plugin()
+    : factory_(new OpenDDS::Security::CryptoBuiltInImpl)
+    , exchange_(CryptoKeyExchange::_narrow(factory_))
+    , transform_(CryptoTransform::_narrow(factory_))
+  {}
+
+  CryptoKeyFactory_var factory_;
+  CryptoKeyExchange_var exchange_;
+  CryptoTransform_var transform_;
+};
+
+/// A DataWriter in one participant matched with a DataReader in another,
+/// with the writer's keys exchanged.
+struct Endpoints {
+  Endpoints()
+    : secret_(new EmptySharedSecret)
+    , writer_(DDS::HANDLE_NIL)
+    , remote_reader_(DDS::HANDLE_NIL)
+    , reader_(DDS::HANDLE_NIL)
+    , remote_writer_(DDS::HANDLE_NIL)
+  {}
+
+  bool init()
+  {
+    const DDS::PropertySeq props;
+    const ParticipantSecurityAttributes part_attribs =
+      { false, false, false, false, false, 0, props };
+    EndpointSecurityAttributes attribs = EndpointSecurityAttributes();
+    attribs.is_submessage_protected = true;
+    attribs.is_payload_protected = true;
+    attribs.plugin_endpoint_attributes =
+      PLUGIN_ENDPOINT_SECURITY_ATTRIBUTES_FLAG_IS_SUBMESSAGE_ENCRYPTED
+      | PLUGIN_ENDPOINT_SECURITY_ATTRIBUTES_FLAG_IS_PAYLOAD_ENCRYPTED;
+    SecurityException ex;
+
+    CryptoKeyFactory_ptr sf = sender_.factory_.in();
+    CryptoKeyFactory_ptr rf = receiver_.factory_.in();
+    const ParticipantCryptoHandle sp =
+      sf->register_local_participant(1, 1, props, part_attribs, ex);
+    const ParticipantCryptoHandle rp =
+      rf->register_local_participant(2, 2, props, part_attribs, ex);
+    const ParticipantCryptoHandle remote_rp =
+      sf->register_matched_remote_participant(sp, 2, 2, secret_, ex);
+    const ParticipantCryptoHandle remote_sp =
+      rf->register_matched_remote_participant(rp, 1, 1, secret_, ex);
+
+    writer_ = sf->register_local_datawriter(sp, props, attribs, ex);
+    reader_ = rf->register_local_datareader(rp, props, attribs, ex);
+    remote_reader_ =
+      sf->register_matched_remote_datareader(writer_, remote_rp, secret_,
+                                             false, ex);
+    remote_writer_ =
+      rf->register_matched_remote_datawriter(reader_, remote_sp, secret_, ex);
+
+    DatawriterCryptoTokenSeq tokens;
+    if (writer_ == DDS::HANDLE_NIL || reader_ == DDS::HANDLE_NIL
+        || remote_reader_ == DDS::HANDLE_NIL
+        || remote_writer_ == DDS::HANDLE_NIL
+        || !sender_.exchange_->create_local_datawriter_crypto_tokens(
+             tokens, writer_, remote_reader_, ex)
+        || !receiver_.exchange_->set_remote_datawriter_crypto_tokens(
+             reader_, remote_writer_, tokens, ex)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: registering endpoints: %C\n"),
+                        ex.message.in()),
+                       false);
+    }
+    return true;
+  }
+
+  Plugin sender_;
+  Plugin receiver_;
+  SharedSecretHandle_var secret_;
+  DatawriterCryptoHandle writer_;
+  DatareaderCryptoHandle remote_reader_;
+  DatareaderCryptoHandle reader_;
+  DatawriterCryptoHandle remote_writer_;
+};
+
+double per_iteration_ns(ACE_High_Res_Timer& timer)
+{
+  ACE_hrtime_t nsec;
+  timer.elapsed_time(nsec);
+  return static_cast<double>(ACE_UINT64_DBLCAST_ADAPTER(nsec)) / iterations;
+}
+
+double megabytes_per_second(int size, double ns)
+{
+  return ns > 0 ? size * 1e3 / ns : 0.0;
+}
+
+void report(const char* what, int size, double encode_ns, double decode_ns)
+{
+  ACE_DEBUG((LM_INFO,
+             ACE_TEXT("(%P|%t) %C %d bytes: encode %.1f ns (%.1f MB/s) ")
+             ACE_TEXT("decode %.1f ns (%.1f MB/s)\n"),
+             what, size, encode_ns, megabytes_per_second(size, encode_ns),
+             decode_ns, megabytes_per_second(size, decode_ns)));
+}
+
+bool run_payload(const Endpoints& ep, const DDS::OctetSeq& plain)
+{
+  CryptoTransform_ptr sender = ep.sender_.transform_.in();
+  CryptoTransform_ptr receiver = ep.receiver_.transform_.in();
+  DDS::OctetSeq encoded, decoded, inline_qos;
+  SecurityException ex;
+
+  ACE_High_Res_Timer encode_timer;
+  encode_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    if (!sender->encode_serialized_payload(encoded, inline_qos, plain,
+                                           ep.writer_, ex)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: encode_serialized_payload: %C\n"),
+                        ex.message.in()),
+                       false);
+    }
+  }
+  encode_timer.stop();
+
+  ACE_High_Res_Timer decode_timer;
+  decode_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    if (!receiver->decode_serialized_payload(decoded, encoded, inline_qos,
+                                             ep.reader_, ep.remote_writer_,
+                                             ex)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: decode_serialized_payload: %C\n"),
+                        ex.message.in()),
+                       false);
+    }
+  }
+  decode_timer.stop();
+
+  if (!(decoded == plain)) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: payload of %d bytes did not ")
+                      ACE_TEXT("survive a round trip\n"),
+                      static_cast<int>(plain.length())),
+                     false);
+  }
+
+  report("payload", static_cast<int>(plain.length()),
+         per_iteration_ns(encode_timer), per_iteration_ns(decode_timer));
+  return true;
+}
+
+bool run_submessage(const Endpoints& ep, const DDS::OctetSeq& plain)
+{
+  CryptoTransform_ptr sender = ep.sender_.transform_.in();
+  CryptoTransform_ptr receiver = ep.receiver_.transform_.in();
+  DatareaderCryptoHandleSeq readers(1);
+  readers.length(1);
+  readers[0] = ep.remote_reader_;
+  DDS::OctetSeq encoded, decoded;
+  SecurityException ex;
+
+  ACE_High_Res_Timer encode_timer;
+  encode_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    CORBA::Long index = 0;
+    if (!sender->encode_datawriter_submessage(encoded, plain, ep.writer_,
+                                              readers, index, ex)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: encode_datawriter_submessage: %C\n"),
+                        ex.message.in()),
+                       false);
+    }
+  }
+  encode_timer.stop();
+
+  ACE_High_Res_Timer decode_timer;
+  decode_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    if (!receiver->decode_datawriter_submessage(decoded, encoded, ep.reader_,
+                                                ep.remote_writer_, ex)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: decode_datawriter_submessage: %C\n"),
+                        ex.message.in()),
+                       false);
+    }
+  }
+  decode_timer.stop();
+
+  if (!(decoded == plain)) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: submessage of %d bytes did ")
+                      ACE_TEXT("not survive a round trip\n"),
+                      static_cast<int>(plain.length())),
+                     false);
+  }
+
+  report("submessage", static_cast<int>(plain.length()),
+         per_iteration_ns(encode_timer), per_iteration_ns(decode_timer));
+  return true;
+}
+
+/// A DATA submessage header followed by @a size - 4 bytes of a pattern.
+DDS::OctetSeq make_submessage(int size)
+{
+  DDS::OctetSeq seq(size);
+  seq.length(size);
+  for (int i = 0; i < size; ++i) {
+    seq[i] = static_cast<CORBA::Octet>(i * 7);
+  }
+  const int body = size - 4;
+  seq[0] = 0x15; // DATA
+  seq[1] = 1;    // little endian
+  seq[2] = static_cast<CORBA::Octet>(body & 0xff);
+  seq[3] = static_cast<CORBA::Octet>((body >> 8) & 0xff);
+  return seq;
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  const int default_sizes[] = { 64, 256, 1024, 4096, 16384, 60000 };
+  sizes.assign(default_sizes,
+               default_sizes + sizeof(default_sizes) / sizeof(default_sizes[0]));
+  parse_args(argc, argv);
+
+  if (iterations < 1 || sizes.empty()) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: -n must be positive and -s ")
+                      ACE_TEXT("can't be empty\n")),
+                     1);
+  }
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    if (sizes[i] < 4 || sizes[i] > max_size) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: sizes must be between 4 ")
+                        ACE_TEXT("and %d bytes\n"), max_size),
+                       1);
+    }
+  }
+
+  Endpoints ep;
+  if (!ep.init()) {
+    return 1;
+  }
+
+  bool ok = true;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    const DDS::OctetSeq plain = make_submessage(sizes[i]);
+    ok = run_payload(ep, plain) && ok;
+    ok = run_submessage(ep, plain) && ok;
+  }
+  return ok ? 0 : 1;
+}
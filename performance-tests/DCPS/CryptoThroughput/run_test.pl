@@ -0,0 +1,24 @@
+eval '(exit $?0)' && eval 'exec perl -S $0 ${1+"$@"}'
+     & eval 'exec perl -S $0 $argv:q'
+     if 0;
+
+# -*- perl -*-
+
+use Env qw(DDS_ROOT ACE_ROOT);
+use lib "$DDS_ROOT/bin";
+use lib "$ACE_ROOT/bin";
+use PerlDDS::Run_Test;
+use strict;
+
+my $test = new PerlDDS::TestFramework();
+$test->{nobits} = 1;
+$test->enable_console_logging();
+
+$test->process('crypto_throughput', 'crypto_throughput', join(' ', @ARGV));
+$test->start_process('crypto_throughput');
+my $status = $test->finish(600);
+
+if ($status) {
+  print STDERR "ERROR: test failed\n";
+}
+exit $status;
@@ -0,0 +1,151 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "MarshalingTypeSupportImpl.h"
+
+#include "dds/DCPS/Serializer.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/High_Res_Timer.h"
+#include "ace/Message_Block.h"
+#include "ace/OS_NS_stdlib.h"
+#include "ace/OS_NS_string.h"
+
+using OpenDDS::DCPS::Serializer;
+
+namespace {
+
+int iterations = 1000000;
+
+void parse_args(int& argc, ACE_TCHAR** argv)
+{
+  ACE_Arg_Shifter shifter(argc, argv);
+
+  while (shifter.is_anything_left()) {
+    const ACE_TCHAR* arg;
+
+    if ((arg = shifter.get_the_parameter(ACE_TEXT("-n")))) {
+      iterations = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else {
+      shifter.ignore_arg();
+    }
+  }
+}
+
+double per_iteration_ns(ACE_High_Res_Timer& timer)
+{
+  ACE_hrtime_t nsec;
+  timer.elapsed_time(nsec);
+  return static_cast<double>(ACE_UINT64_DBLCAST_ADAPTER(nsec)) / iterations;
+}
+
+template <typename T>
+bool run(const char* name, const T& sample, bool swap)
+{
+  size_t size = 0, padding = 0;
+  OpenDDS::DCPS::gen_find_size(sample, size, padding);
+  ACE_Message_Block mb(size + padding);
+  ACE_Message_Block check(size + padding);
+
+  ACE_High_Res_Timer write_timer;
+  write_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    mb.reset();
+    Serializer ser(&mb, swap, Serializer::ALIGN_INITIALIZE);
+    if (!(ser << sample)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: %C serialization failed\n"),
+                        name),
+                       false);
+    }
+  }
+  write_timer.stop();
+  // The read loop consumes mb, so its length is saved for the checks.
+  const size_t serialized = mb.length();
+
+  T out;
+  ACE_High_Res_Timer read_timer;
+  read_timer.start();
+  for (int i = 0; i < iterations; ++i) {
+    mb.rd_ptr(mb.base());
+    Serializer ser(&mb, swap, Serializer::ALIGN_INITIALIZE);
+    if (!(ser >> out)) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: %C deserialization failed\n"),
+                        name),
+                       false);
+    }
+  }
+  read_timer.stop();
+
+  Serializer ser(&check, swap, Serializer::ALIGN_INITIALIZE);
+  if (!(ser << out) || check.length() != serialized
+      || ACE_OS::memcmp(check.base(), mb.base(), serialized) != 0) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: %C did not survive a round trip\n"),
+                      name),
+                     false);
+  }
+
+  ACE_DEBUG((LM_INFO,
+             ACE_TEXT("(%P|%t) %C %C %B bytes: serialize %.1f ns ")
+             ACE_TEXT("deserialize %.1f ns\n"),
+             name, swap ? "swapped" : "native", serialized,
+             per_iteration_ns(write_timer), per_iteration_ns(read_timer)));
+  return true;
+}
+
+template <typename T>
+bool run(const char* name, const T& sample)
+{
+  const bool native = run(name, sample, false);
+  return run(name, sample, true) && native;
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  parse_args(argc, argv);
+  if (iterations < 1) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: -n must be positive\n")),
+                     1);
+  }
+
+  Marshaling::Point point;
+  point.x = 1.5;
+  point.y = -2.25;
+  point.z = 1e10;
+
+  Marshaling::Samples samples;
+  samples.stamp = 0x0123456789abcdefULL;
+  samples.id = 42;
+  samples.count = 64;
+  for (CORBA::Long i = 0; i < 64; ++i) {
+    samples.values[i] = i * 1000;
+  }
+  samples.origin = point;
+
+  Marshaling::Padded padded;
+  padded.flag = 1;
+  padded.value = 3.75;
+
+  Marshaling::Mixed mixed;
+  mixed.id = 7;
+  mixed.valid = true;
+  mixed.value = 0.125;
+  mixed.name = "marshaling benchmark";
+
+  bool ok = run("Point", point);
+  ok = run("Samples", samples) && ok;
+  ok = run("Padded", padded) && ok;
+  ok = run("Mixed", mixed) && ok;
+
+  return ok ? 0 : 1;
+}
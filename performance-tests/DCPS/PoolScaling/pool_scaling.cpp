@@ -0,0 +1,187 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "dds/DCPS/SafetyProfilePool.h"
+
+#include "ace/Arg_Shifter.h"
+#include "ace/Barrier.h"
+#include "ace/High_Res_Timer.h"
+#include "ace/Log_Msg.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
+#include "ace/Task.h"
+
+#include <vector>
+
+#ifdef OPENDDS_SAFETY_PROFILE
+
+namespace {
+
+int num_threads = 1;
+int ops_per_thread = 1000000;
+int live_per_thread = 64;
+int magazine_size = 32;
+int pool_size = 64 * 1024 * 1024;
+
+void parse_args(int& argc, ACE_TCHAR** argv)
+{
+  ACE_Arg_Shifter shifter(argc, argv);
+
+  while (shifter.is_anything_left()) {
+    const ACE_TCHAR* arg;
+
+    if ((arg = shifter.get_the_parameter(ACE_TEXT("-t")))) {
+      num_threads = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-n")))) {
+      ops_per_thread = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-l")))) {
+      live_per_thread = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-m")))) {
+      magazine_size = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-p")))) {
+      pool_size = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else {
+      shifter.ignore_arg();
+    }
+  }
+}
+
+/// Sizes of the objects allocated on the write and receive paths, roughly:
+/// small handles, queue elements and sample elements.
+const size_t sizes[] = { 24, 48, 64, 96, 160, 200, 320, 560 };
+const size_t num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+/// Each thread replaces random blocks of its own set of live blocks, so
+/// any loss of scaling comes from the pool.
+class AllocTask : public ACE_Task_Base {
+public:
+  explicit AllocTask(OpenDDS::DCPS::SafetyProfilePool& pool)
+    : pool_(pool)
+    , barrier_(num_threads + 1)
+    , done_(num_threads + 1)
+    , next_index_(0)
+    , failures_(0)
+  {}
+
+  /// Wait for all threads to be ready, returns when allocating starts.
+  void start()
+  {
+    barrier_.wait();
+  }
+
+  /// Returns when all threads are done allocating, before they exit.
+  void stop()
+  {
+    done_.wait();
+  }
+
+  long failures() const
+  {
+    return failures_.value();
+  }
+
+  int svc()
+  {
+    unsigned int seed = static_cast<unsigned int>(++next_index_);
+    std::vector<void*> blocks(live_per_thread);
+
+    barrier_.wait();
+
+    for (int i = 0; i < ops_per_thread; ++i) {
+      seed = seed * 1103515245 + 12345;
+      void*& block = blocks[(seed >> 8) % blocks.size()];
+      pool_.free(block);
+      block = pool_.malloc(sizes[(seed >> 20) % num_sizes]);
+      if (!block) {
+        ++failures_;
+      }
+    }
+
+    done_.wait();
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      pool_.free(blocks[i]);
+    }
+    return 0;
+  }
+
+private:
+  OpenDDS::DCPS::SafetyProfilePool& pool_;
+  ACE_Barrier barrier_;
+  ACE_Barrier done_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> next_index_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> failures_;
+};
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  parse_args(argc, argv);
+
+  if (num_threads < 1 || ops_per_thread < 1 || live_per_thread < 1
+      || magazine_size < 0 || pool_size < 1) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: -t, -n, -l and -p must be ")
+                      ACE_TEXT("positive, -m can't be negative\n")),
+                     1);
+  }
+
+  OpenDDS::DCPS::SafetyProfilePool pool;
+  pool.configure_pool(pool_size, 8, magazine_size);
+
+  AllocTask task(pool);
+  task.activate(THR_NEW_LWP | THR_JOINABLE, num_threads);
+
+  task.start();
+  const ACE_Time_Value start = ACE_High_Res_Timer::gettimeofday_hr();
+  task.stop();
+  const ACE_Time_Value elapsed =
+    ACE_High_Res_Timer::gettimeofday_hr() - start;
+  task.wait();
+
+  const double seconds = elapsed.sec() + elapsed.usec() / 1e6;
+  const double ops = double(num_threads) * ops_per_thread;
+  const OpenDDS::DCPS::SafetyProfilePool::Stats stats = pool.stats();
+  const double allocs = double(stats.hits_ + stats.misses_);
+  ACE_DEBUG((LM_INFO,
+             ACE_TEXT("(%P|%t) threads %d magazine %d ops %.0f ")
+             ACE_TEXT("elapsed %.3f s throughput %.0f malloc+free/s\n"),
+             num_threads, magazine_size, ops, seconds,
+             seconds > 0 ? ops / seconds : 0.0));
+  ACE_DEBUG((LM_INFO,
+             ACE_TEXT("(%P|%t) magazine hit rate %.1f%%, lock taken %B times, ")
+             ACE_TEXT("contended %B (%.1f%%)\n"),
+             allocs > 0 ? 100.0 * stats.hits_ / allocs : 0.0,
+             stats.locks_, stats.contended_,
+             stats.locks_ ? 100.0 * stats.contended_ / stats.locks_ : 0.0));
+
+  if (task.failures()) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("(%P|%t) ERROR: %d allocations failed\n"),
+                      static_cast<int>(task.failures())),
+                     1);
+  }
+  return 0;
+}
+
+#else
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  ACE_ERROR_RETURN((LM_ERROR,
+                    ACE_TEXT("(%P|%t) ERROR: pool_scaling needs a Safety ")
+                    ACE_TEXT("Profile build\n")),
+                   1);
+}
+
+#endif
@@ -0,0 +1,45 @@
+eval '(exit $?0)' && eval 'exec perl -S $0 ${1+"$@"}'
+     & eval 'exec perl -S $0 $argv:q'
+     if 0;
+
+# -*- perl -*-
+
+use Env qw(DDS_ROOT ACE_ROOT);
+use lib "$DDS_ROOT/bin";
+use lib "$ACE_ROOT/bin";
+use PerlDDS::Run_Test;
+use strict;
+
+use Getopt::Long qw(:config bundling);
+
+# Runs pool_scaling for each thread count, without and with thread
+# magazines, and reports the aggregate allocation throughput.
+my @threads = (1, 2, 4, 8, 16);
+my @magazines = (0, 32);
+my $ops = 1000000;
+my $live = 64;
+
+GetOptions("threads|t=s"   => sub { @threads = split(/,/, $_[1]); },
+           "magazines|m=s" => sub { @magazines = split(/,/, $_[1]); },
+           "ops|n=i"       => \$ops,
+           "live|l=i"      => \$live)
+  or die "usage: run_test.pl [-t 1,2,4] [-m 0,32] [-n ops] [-l live]\n";
+
+my $status = 0;
+
+foreach my $m (@magazines) {
+  foreach my $t (@threads) {
+    my $test = new PerlDDS::TestFramework();
+    $test->enable_console_logging();
+
+    $test->process("pool_scaling_${m}_$t", 'pool_scaling',
+                   "-t $t -m $m -n $ops -l $live");
+    $test->start_process("pool_scaling_${m}_$t");
+    $status |= $test->finish(600);
+  }
+}
+
+if ($status) {
+  print STDERR "ERROR: test failed\n";
+}
+exit $status;
@@ -0,0 +1,46 @@
+eval '(exit $?0)' && eval 'exec perl -S $0 ${1+"$@"}'
+     & eval 'exec perl -S $0 $argv:q'
+     if 0;
+
+# -*- perl -*-
+
+use Env qw(DDS_ROOT ACE_ROOT);
+use lib "$DDS_ROOT/bin";
+use lib "$ACE_ROOT/bin";
+use PerlDDS::Run_Test;
+use strict;
+
+use Getopt::Long qw(:config bundling);
+
+# Runs writer_scaling once for each thread count and reports the
+# aggregate write throughput of the single DataWriter.
+my @threads = (1, 2, 4, 8, 16);
+my $samples = 100000;
+my $instances = 1;
+my $reader;
+
+GetOptions("threads|t=s"   => sub { @threads = split(/,/, $_[1]); },
+           "samples|s=i"   => \$samples,
+           "instances|i=i" => \$instances,
+           "reader|r"      => \$reader)
+  or die "usage: run_test.pl [-t 1,2,4] [-s samples] [-i instances] [-r]\n";
+
+my $status = 0;
+
+foreach my $t (@threads) {
+  my $test = new PerlDDS::TestFramework();
+  $test->{nobits} = 1;
+  $test->enable_console_logging();
+
+  my $opts = "-DCPSConfigFile rtps.ini -t $t -s $samples -i $instances";
+  $opts .= ' -r' if $reader;
+
+  $test->process("writer_scaling_$t", 'writer_scaling', $opts);
+  $test->start_process("writer_scaling_$t");
+  $status |= $test->finish(600);
+}
+
+if ($status) {
+  print STDERR "ERROR: test failed\n";
+}
+exit $status;
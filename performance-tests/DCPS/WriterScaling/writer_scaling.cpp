@@ -0,0 +1,267 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "WriterScalingTypeSupportImpl.h"
+
+#include "dds/DCPS/Service_Participant.h"
+#include "dds/DCPS/Marked_Default_Qos.h"
+#include "dds/DCPS/RcObject.h"
+#include "dds/DCPS/WaitSet.h"
+
+#include "dds/DCPS/StaticIncludes.h"
+#ifdef ACE_AS_STATIC_LIBS
+# include "dds/DCPS/RTPS/RtpsDiscovery.h"
+# include "dds/DCPS/transport/rtps_udp/RtpsUdp.h"
+#endif
+
+#include "ace/Arg_Shifter.h"
+#include "ace/Atomic_Op.h"
+#include "ace/Barrier.h"
+#include "ace/High_Res_Timer.h"
+#include "ace/OS_NS_stdlib.h"
+#include "ace/Task.h"
+
+#include <vector>
+
+namespace {
+
+int num_threads = 1;
+int samples_per_thread = 100000;
+int instances_per_thread = 1;
+bool with_reader = false;
+
+void parse_args(int& argc, ACE_TCHAR** argv)
+{
+  ACE_Arg_Shifter shifter(argc, argv);
+
+  while (shifter.is_anything_left()) {
+    const ACE_TCHAR* arg;
+
+    if ((arg = shifter.get_the_parameter(ACE_TEXT("-t")))) {
+      num_threads = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-s")))) {
+      samples_per_thread = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if ((arg = shifter.get_the_parameter(ACE_TEXT("-i")))) {
+      instances_per_thread = ACE_OS::atoi(arg);
+      shifter.consume_arg();
+    } else if (shifter.cur_arg_strncasecmp(ACE_TEXT("-r")) == 0) {
+      with_reader = true;
+      shifter.consume_arg();
+    } else {
+      shifter.ignore_arg();
+    }
+  }
+}
+
+/// Each thread writes its own set of instances through the shared
+/// DataWriter, so any loss of scaling comes from the writer itself.
+class WriterTask : public ACE_Task_Base {
+public:
+  explicit WriterTask(WriterScaling::SampleDataWriter_ptr writer)
+    : writer_(WriterScaling::SampleDataWriter::_duplicate(writer))
+    , barrier_(num_threads + 1)
+    , next_index_(0)
+    , failures_(0)
+  {}
+
+  /// Wait for all threads to be ready, returns when writing starts.
+  void start()
+  {
+    barrier_.wait();
+  }
+
+  long failures() const
+  {
+    return failures_.value();
+  }
+
+  int svc()
+  {
+    const CORBA::Long first_id = next_index_++ * instances_per_thread;
+
+    WriterScaling::Sample sample;
+    sample.seq = 0;
+    for (CORBA::ULong i = 0; i < sizeof(sample.data); ++i) {
+      sample.data[i] = static_cast<CORBA::Octet>(i);
+    }
+
+    std::vector<DDS::InstanceHandle_t> handles(instances_per_thread);
+    for (int i = 0; i < instances_per_thread; ++i) {
+      sample.id = first_id + i;
+      handles[i] = writer_->register_instance(sample);
+    }
+
+    barrier_.wait();
+
+    for (int s = 0; s < samples_per_thread; ++s) {
+      const int i = s % instances_per_thread;
+      sample.id = first_id + i;
+      sample.seq = s;
+      if (writer_->write(sample, handles[i]) != DDS::RETCODE_OK) {
+        ++failures_;
+      }
+    }
+
+    return 0;
+  }
+
+private:
+  WriterScaling::SampleDataWriter_var writer_;
+  ACE_Barrier barrier_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> next_index_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> failures_;
+};
+
+bool wait_for_match(DDS::DataWriter_ptr writer)
+{
+  DDS::StatusCondition_var cond = writer->get_statuscondition();
+  cond->set_enabled_statuses(DDS::PUBLICATION_MATCHED_STATUS);
+  DDS::WaitSet_var ws = new DDS::WaitSet;
+  ws->attach_condition(cond);
+
+  const DDS::Duration_t timeout = { 30, 0 };
+  DDS::ConditionSeq conditions;
+  DDS::PublicationMatchedStatus matches = { 0, 0, 0, 0, 0 };
+  do {
+    if (ws->wait(conditions, timeout) != DDS::RETCODE_OK
+        || writer->get_publication_matched_status(matches) != DDS::RETCODE_OK) {
+      ws->detach_condition(cond);
+      return false;
+    }
+  } while (matches.current_count < 1);
+
+  ws->detach_condition(cond);
+  return true;
+}
+
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+  int status = 0;
+
+  try {
+    DDS::DomainParticipantFactory_var dpf =
+      TheParticipantFactoryWithArgs(argc, argv);
+    parse_args(argc, argv);
+
+    if (num_threads < 1 || samples_per_thread < 1 || instances_per_thread < 1) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: -t, -s and -i must be positive\n")),
+                       1);
+    }
+
+    DDS::DomainParticipant_var participant =
+      dpf->create_participant(42,
+                              PARTICIPANT_QOS_DEFAULT,
+                              0,
+                              OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+    if (!participant) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: create_participant failed\n")),
+                       1);
+    }
+
+    WriterScaling::SampleTypeSupport_var ts =
+      new WriterScaling::SampleTypeSupportImpl;
+    if (ts->register_type(participant, "") != DDS::RETCODE_OK) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: register_type failed\n")),
+                       1);
+    }
+
+    CORBA::String_var type_name = ts->get_type_name();
+    DDS::Topic_var topic =
+      participant->create_topic("WriterScaling",
+                                type_name,
+                                TOPIC_QOS_DEFAULT,
+                                0,
+                                OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+    DDS::Publisher_var publisher =
+      participant->create_publisher(PUBLISHER_QOS_DEFAULT,
+                                    0,
+                                    OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+
+    DDS::DataWriter_var writer =
+      publisher->create_datawriter(topic,
+                                   DATAWRITER_QOS_DEFAULT,
+                                   0,
+                                   OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+    WriterScaling::SampleDataWriter_var sample_writer =
+      WriterScaling::SampleDataWriter::_narrow(writer);
+    if (!sample_writer) {
+      ACE_ERROR_RETURN((LM_ERROR,
+                        ACE_TEXT("(%P|%t) ERROR: create_datawriter failed\n")),
+                       1);
+    }
+
+    if (with_reader) {
+      DDS::Subscriber_var subscriber =
+        participant->create_subscriber(SUBSCRIBER_QOS_DEFAULT,
+                                       0,
+                                       OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      DDS::DataReader_var reader =
+        subscriber->create_datareader(topic,
+                                      DATAREADER_QOS_DEFAULT,
+                                      0,
+                                      OpenDDS::DCPS::DEFAULT_STATUS_MASK);
+      if (!reader || !wait_for_match(writer)) {
+        ACE_ERROR_RETURN((LM_ERROR,
+                          ACE_TEXT("(%P|%t) ERROR: reader did not match\n")),
+                         1);
+      }
+    }
+
+    WriterTask task(sample_writer);
+    task.activate(THR_NEW_LWP | THR_JOINABLE, num_threads);
+
+#ifdef OPENDDS_RCOBJECT_STATS
+    const long ops_before = OpenDDS::DCPS::rc_object_ops.value();
+#endif
+    task.start();
+    const ACE_Time_Value start = ACE_High_Res_Timer::gettimeofday_hr();
+    task.wait();
+    const ACE_Time_Value elapsed =
+      ACE_High_Res_Timer::gettimeofday_hr() - start;
+#ifdef OPENDDS_RCOBJECT_STATS
+    const long ops = OpenDDS::DCPS::rc_object_ops.value() - ops_before;
+#endif
+
+    const double seconds = elapsed.sec() + elapsed.usec() / 1e6;
+    const double samples = double(num_threads) * samples_per_thread;
+    ACE_DEBUG((LM_INFO,
+               ACE_TEXT("(%P|%t) threads %d instances %d samples %.0f ")
+               ACE_TEXT("elapsed %.3f s throughput %.0f samples/s\n"),
+               num_threads, num_threads * instances_per_thread,
+               samples, seconds, seconds > 0 ? samples / seconds : 0.0));
+#ifdef OPENDDS_RCOBJECT_STATS
+    ACE_DEBUG((LM_INFO,
+               ACE_TEXT("(%P|%t) reference count operations %d, %.1f per sample\n"),
+               static_cast<int>(ops), ops / samples));
+#endif
+
+    if (task.failures()) {
+      ACE_ERROR((LM_ERROR,
+                 ACE_TEXT("(%P|%t) ERROR: %d writes failed\n"),
+                 static_cast<int>(task.failures())));
+      status = 1;
+    }
+
+    participant->delete_contained_entities();
+    dpf->delete_participant(participant);
+    TheServiceParticipant->shutdown();
+
+  } catch (const CORBA::Exception& e) {
+    e._tao_print_exception("Exception caught in main():");
+    return 1;
+  }
+
+  return status;
+}
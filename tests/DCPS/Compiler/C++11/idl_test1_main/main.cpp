@@ -1,7 +1,9 @@
 #include "../idl_test1_lib/FooDefTypeSupportImpl.h"
+#include "dds/DCPS/KeyHash.h"
 #include "dds/DCPS/Message_Block_Ptr.h"
 #include "ace/ACE.h"
 #include "ace/Log_Msg.h"
+#include <array>
 #include <map>
 
 namespace {
@@ -352,6 +354,33 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
       ACE_ERROR((LM_ERROR, "FooKeyLessThan failed with map - 4\n"));
       failed = true;
     }
+
+    OpenDDS::DCPS::DDSTraits<Xyz::Foo>::HashType foohash;
+    Xyz::Foo foo3 = foo2;
+    foo3.theString() = "five";
+    if (foohash(foo3) != foohash(foo2)) {
+      ACE_ERROR((LM_ERROR, "FooKeyHash differs for equal keys\n"));
+      failed = true;
+    }
+
+    if (foohash(my_foo) == foohash(foo2)) {
+      ACE_ERROR((LM_ERROR, "FooKeyHash same for different keys\n"));
+      failed = true;
+    }
+
+    // Array keys are hashed by their elements, not the bytes of the array
+    const std::array<std::string, 2> strings1 = {{"one", "two"}};
+    std::array<std::string, 2> strings2;
+    strings2[0] = "one";
+    strings2[1] = "two";
+    ACE_UINT32 hash1 = OpenDDS::DCPS::key_hash_seed;
+    ACE_UINT32 hash2 = OpenDDS::DCPS::key_hash_seed;
+    OpenDDS::DCPS::key_hash(hash1, strings1);
+    OpenDDS::DCPS::key_hash(hash2, strings2);
+    if (hash1 != hash2) {
+      ACE_ERROR((LM_ERROR, "key_hash differs for equal arrays of strings\n"));
+      failed = true;
+    }
   } else {
     ACE_DEBUG((LM_DEBUG, "NOTE: _dcps_has_key(foo) returned false\n"));
   }
@@ -0,0 +1,162 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "FixedLayoutTypeSupportImpl.h"
+
+#include "dds/DCPS/Serializer.h"
+
+#include "ace/Log_Msg.h"
+#include "ace/Message_Block.h"
+#include "ace/OS_NS_string.h"
+
+using OpenDDS::DCPS::Serializer;
+
+// Tests that the generated code copying fixed-layout structs as one block
+// writes and reads the same bytes as encoding them field by field, with and
+// without byte swapping, alignment, and at misaligned stream positions and
+// addresses.
+
+namespace {
+
+bool encode_fields(Serializer& ser, const FixedLayout::Outer& o)
+{
+  return ser.write_octet_array(o.tag, 4)
+    && (ser << o.inner.s1)
+    && (ser << o.inner.s2)
+    && (ser << o.inner.l)
+    && ser.write_long_array(o.values, 3)
+    && (ser << o.stamp)
+    && (ser << o.d);
+}
+
+bool decode_fields(Serializer& ser, FixedLayout::Outer& o)
+{
+  return ser.read_octet_array(o.tag, 4)
+    && (ser >> o.inner.s1)
+    && (ser >> o.inner.s2)
+    && (ser >> o.inner.l)
+    && ser.read_long_array(o.values, 3)
+    && (ser >> o.stamp)
+    && (ser >> o.d);
+}
+
+bool same(const FixedLayout::Outer& a, const FixedLayout::Outer& b)
+{
+  return ACE_OS::memcmp(a.tag, b.tag, sizeof a.tag) == 0
+    && a.inner.s1 == b.inner.s1
+    && a.inner.s2 == b.inner.s2
+    && a.inner.l == b.inner.l
+    && ACE_OS::memcmp(a.values, b.values, sizeof a.values) == 0
+    && a.stamp == b.stamp
+    && a.d == b.d;
+}
+
+/// Writes @a lead octets before the struct, so its position in the stream
+/// is @a lead, into a buffer starting @a skew bytes after an aligned address.
+bool check(const FixedLayout::Outer& sample, bool swap,
+           Serializer::Alignment align, size_t lead, size_t skew)
+{
+  const size_t capacity = 128;
+  ACE_Message_Block generated(capacity), fields(capacity);
+  generated.rd_ptr(skew);
+  generated.wr_ptr(skew);
+  fields.rd_ptr(skew);
+  fields.wr_ptr(skew);
+
+  {
+    Serializer gen_ser(&generated, swap, align);
+    Serializer field_ser(&fields, swap, align);
+    for (size_t i = 0; i < lead; ++i) {
+      if (!(gen_ser << ACE_OutputCDR::from_octet(0))
+          || !(field_ser << ACE_OutputCDR::from_octet(0))) {
+        return false;
+      }
+    }
+    if (!(gen_ser << sample) || !encode_fields(field_ser, sample)) {
+      ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: serialization failed\n")),
+                       false);
+    }
+  }
+
+  if (generated.length() != fields.length()
+      || ACE_OS::memcmp(generated.rd_ptr(), fields.rd_ptr(), fields.length()) != 0) {
+    ACE_ERROR_RETURN((LM_ERROR,
+                      ACE_TEXT("ERROR: different bytes: %B generated, %B ")
+                      ACE_TEXT("field by field\n"),
+                      generated.length(), fields.length()),
+                     false);
+  }
+
+  // Read what the other side wrote
+  FixedLayout::Outer from_fields, from_generated;
+  ACE_CDR::Octet octet;
+  Serializer gen_in(&fields, swap, align);
+  Serializer field_in(&generated, swap, align);
+  for (size_t i = 0; i < lead; ++i) {
+    if (!(gen_in >> ACE_InputCDR::to_octet(octet))
+        || !(field_in >> ACE_InputCDR::to_octet(octet))) {
+      return false;
+    }
+  }
+  if (!(gen_in >> from_fields) || !decode_fields(field_in, from_generated)) {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: deserialization failed\n")),
+                     false);
+  }
+  if (!same(sample, from_fields) || !same(sample, from_generated)) {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: values changed\n")), false);
+  }
+  return true;
+}
+
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  FixedLayout::Outer sample;
+  for (CORBA::Octet i = 0; i < 4; ++i) {
+    sample.tag[i] = static_cast<CORBA::Octet>(0xa0 + i);
+  }
+  sample.inner.s1 = -2;
+  sample.inner.s2 = 0xbeef;
+  sample.inner.l = 0x01020304;
+  sample.values[0] = -1;
+  sample.values[1] = 0x7fffffff;
+  sample.values[2] = 42;
+  sample.stamp = 0x0123456789abcdefULL;
+  sample.d = -3.75;
+
+  if (sizeof(FixedLayout::Outer) != 40) {
+    ACE_DEBUG((LM_INFO, ACE_TEXT("Outer isn't laid out like CDR here, ")
+               ACE_TEXT("only the field by field code is tested\n")));
+  }
+
+  const Serializer::Alignment aligns[] = {
+    Serializer::ALIGN_INITIALIZE, Serializer::ALIGN_NONE
+  };
+  const size_t leads[] = {0, 1, 4, 8};
+
+  int failed = 0;
+  for (int swap = 0; swap < 2; ++swap) {
+    for (size_t a = 0; a < sizeof aligns / sizeof aligns[0]; ++a) {
+      for (size_t l = 0; l < sizeof leads / sizeof leads[0]; ++l) {
+        for (size_t skew = 0; skew < 2; ++skew) {
+          if (!check(sample, swap, aligns[a], leads[l], skew)) {
+            ACE_ERROR((LM_ERROR,
+                       ACE_TEXT("ERROR: %C, %C, %B octets before, %B bytes ")
+                       ACE_TEXT("off an aligned address\n"),
+                       swap ? "swapped" : "native",
+                       aligns[a] == Serializer::ALIGN_NONE ? "unaligned" : "aligned",
+                       leads[l], skew));
+            ++failed;
+          }
+        }
+      }
+    }
+  }
+
+  return failed ? 1 : 0;
+}
@@ -324,6 +324,19 @@ int ACE_TMAIN(int argc, ACE_TCHAR *argv[])
       ACE_ERROR((LM_ERROR, "FooKeyLessThan failed with map - 4\n"));
       failed = true;
     }
+
+    OpenDDS::DCPS::DDSTraits<Xyz::Foo>::HashType foohash;
+    Xyz::Foo foo3 = foo2;
+    foo3.theString = "five";
+    if (foohash(foo3) != foohash(foo2)) {
+      ACE_ERROR((LM_ERROR, "FooKeyHash differs for equal keys\n"));
+      failed = true;
+    }
+
+    if (foohash(my_foo) == foohash(foo2)) {
+      ACE_ERROR((LM_ERROR, "FooKeyHash same for different keys\n"));
+      failed = true;
+    }
   } else {
     ACE_DEBUG((LM_DEBUG, "NOTE: _dcps_has_key(foo) returned false\n"));
   }
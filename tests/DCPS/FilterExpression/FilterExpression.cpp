@@ -7,33 +7,96 @@
 #include "dds/DCPS/FilterExpressionGrammar.h"
 #include "dds/DCPS/yard/yard_parser.hpp"
 #include "dds/DCPS/FilterEvaluator.h"
+#include "dds/DCPS/FilterIndex.h"
+#include "dds/DCPS/Serializer.h"
 
+#include "ace/High_Res_Timer.h"
+#include "ace/Message_Block.h"
 #include "ace/OS_main.h"
+#include "ace/OS_NS_stdlib.h"
 #include "ace/OS_NS_string.h"
 
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <cstdio>
 #include <iostream>
 
+using OpenDDS::DCPS::Serializer;
+
+/// Serialize the sample the way SerializedForEval expects it without the
+/// CDR encapsulation header.
+template<typename T>
+ACE_Message_Block* serialize(const T& sample) {
+  size_t size = 0, padding = 0;
+  OpenDDS::DCPS::gen_find_size(sample, size, padding);
+  ACE_Message_Block* mb = new ACE_Message_Block(size + padding);
+  Serializer ser(mb, false, Serializer::ALIGN_NONE);
+  ser << sample;
+  return mb;
+}
+
 template<size_t N, typename T>
 bool doEvalTest(const char* (&input)[N], bool expected, const T& sample,
                 const DDS::StringSeq& params) {
   bool pass = true;
+  ACE_Message_Block* serialized = serialize(sample);
+  const OpenDDS::DCPS::MetaStruct& meta = OpenDDS::DCPS::getMetaStruct<T>();
   for (size_t i = 0; i < N; ++i) {
     try {
       OpenDDS::DCPS::FilterEvaluator fe(input[i], false);
       const bool result = fe.eval(sample, params);
       if (result != expected) pass = false;
+      if (fe.eval_ast(sample, params) != result
+          || fe.eval(serialized, false, false, meta, params) != result
+          || fe.eval_ast(serialized, false, false, meta, params) != result) {
+        std::cout << input[i] << " => evaluators disagree" << std::endl;
+        pass = false;
+      }
       std::cout << input[i] << " => " << result << std::endl;
     } catch (const std::exception& e) {
       if (expected) pass = false;
       std::cout << input[i] << " => exception " << e.what() << std::endl;
     }
   }
+  serialized->release();
   return pass;
 }
 
+int iterations = 0;
+
+template<size_t N, typename T>
+void doEvalBenchmark(const char* (&input)[N], const T& sample,
+                     const DDS::StringSeq& params) {
+  ACE_Message_Block* serialized = serialize(sample);
+  const OpenDDS::DCPS::MetaStruct& meta = OpenDDS::DCPS::getMetaStruct<T>();
+  for (size_t i = 0; i < N; ++i) {
+    OpenDDS::DCPS::FilterEvaluator fe(input[i], false);
+    ACE_hrtime_t elapsed[4];
+    for (int variant = 0; variant < 4; ++variant) {
+      ACE_High_Res_Timer timer;
+      timer.start();
+      for (int j = 0; j < iterations; ++j) {
+        switch (variant) {
+        case 0: fe.eval(sample, params); break;
+        case 1: fe.eval_ast(sample, params); break;
+        case 2: fe.eval(serialized, false, false, meta, params); break;
+        case 3: fe.eval_ast(serialized, false, false, meta, params); break;
+        }
+      }
+      timer.stop();
+      timer.elapsed_time(elapsed[variant]);
+    }
+    std::printf("%s\n  deserialized: program %.1f ns, AST %.1f ns\n"
+                "  serialized: program %.1f ns, AST %.1f ns\n", input[i],
+                double(ACE_UINT64_DBLCAST_ADAPTER(elapsed[0])) / iterations,
+                double(ACE_UINT64_DBLCAST_ADAPTER(elapsed[1])) / iterations,
+                double(ACE_UINT64_DBLCAST_ADAPTER(elapsed[2])) / iterations,
+                double(ACE_UINT64_DBLCAST_ADAPTER(elapsed[3])) / iterations);
+  }
+  serialized->release();
+}
+
 bool testEval() {
 
   try {
@@ -67,6 +130,11 @@ bool testEval() {
     std::cout << std::boolalpha;
     bool ok = doEvalTest(filters_pass, true, sample, params);
     ok &= doEvalTest(filters_fail, false, sample, params);
+
+    if (ok && iterations > 0) {
+      doEvalBenchmark(filters_pass, sample, params);
+      doEvalBenchmark(filters_fail, sample, params);
+    }
     return ok;
 
   } catch (const CORBA::BAD_PARAM&) {
@@ -75,6 +143,146 @@ bool testEval() {
 
 }
 
+bool testEvalBatch() {
+  using namespace OpenDDS::DCPS;
+
+  static const char* filters[] = {"durability_service.history_depth > %0",
+                                  "%0 >= durability_service.max_samples",
+                                  "durability_service.history_depth BETWEEN 2 AND %0",
+                                  "durability_service.history_depth < 3 OR durability_service.max_samples = %0",
+                                  "NOT (durability_service.history_depth <> 4 AND durability_service.max_samples > 1)",
+                                  "name LIKE 'Ad%' AND durability_service.history_depth > %0",
+                                  "MOD(durability_service.history_depth,3) = 0"};
+  static const size_t n_filters = sizeof filters / sizeof filters[0];
+
+  // more than one run of samples, see FilterEvaluator::eval_batch()
+  const size_t count = 600;
+  OPENDDS_VECTOR(TBTD) samples(count);
+  OPENDDS_VECTOR(const void*) pointers(count);
+  for (size_t i = 0; i < count; ++i) {
+    samples[i].name = i % 2 ? "Adam" : "Eve";
+    samples[i].durability_service.history_depth = static_cast<CORBA::Long>(i % 7);
+    samples[i].durability_service.max_samples = static_cast<CORBA::Long>(i % 5);
+    pointers[i] = &samples[i];
+  }
+
+  DDS::StringSeq params;
+  params.length(1);
+  params[0] = "3";
+
+  const MetaStruct& meta = getMetaStruct<TBTD>();
+  bool ok = true;
+  for (size_t f = 0; f < n_filters; ++f) {
+    FilterEvaluator fe(filters[f], false);
+    OPENDDS_VECTOR(unsigned char) selected(count);
+    fe.eval_batch(&pointers[0], count, meta, params, &selected[0]);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (selected[i] != (fe.eval(samples[i], params) ? 1 : 0)) {
+        ++mismatches;
+      }
+    }
+    if (mismatches) {
+      std::cout << filters[f] << " => eval_batch disagrees with eval for "
+                << mismatches << " samples" << std::endl;
+      ok = false;
+    }
+
+    if (iterations > 0) {
+      ACE_High_Res_Timer single, batch;
+      single.start();
+      for (int j = 0; j < iterations; ++j) {
+        for (size_t i = 0; i < count; ++i) {
+          fe.eval(samples[i], params);
+        }
+      }
+      single.stop();
+      batch.start();
+      for (int j = 0; j < iterations; ++j) {
+        fe.eval_batch(&pointers[0], count, meta, params, &selected[0]);
+      }
+      batch.stop();
+      ACE_hrtime_t single_ns, batch_ns;
+      single.elapsed_time(single_ns);
+      batch.elapsed_time(batch_ns);
+      const double samples_evaluated = double(iterations) * count;
+      std::printf("%s\n  per sample %.1f ns, batch %.1f ns\n", filters[f],
+                  double(ACE_UINT64_DBLCAST_ADAPTER(single_ns)) / samples_evaluated,
+                  double(ACE_UINT64_DBLCAST_ADAPTER(batch_ns)) / samples_evaluated);
+    }
+  }
+  return ok;
+}
+
+bool testFilterIndex() {
+  using namespace OpenDDS::DCPS;
+
+  static const char* filters[] = {"durability_service.history_depth = %0",
+                                  "durability_service.history_depth < %0",
+                                  "%0 <= durability_service.history_depth",
+                                  "name LIKE 'Ad%' AND durability_service.max_samples > %0",
+                                  "durability_service.history_depth <> %0"};
+  static const size_t n_filters = sizeof filters / sizeof filters[0];
+  RcHandle<FilterEvaluator> evals[n_filters];
+  for (size_t i = 0; i < n_filters; ++i) {
+    evals[i] = make_rch<FilterEvaluator>(filters[i], false);
+  }
+
+  // 40 readers spread over the filters with parameters 0..7
+  FilterIndex index;
+  GUIDSeq readers;
+  OPENDDS_VECTOR(DDS::StringSeq) params;
+  for (CORBA::Long i = 0; i < 40; ++i) {
+    RepoId id = GUID_UNKNOWN;
+    id.entityId.entityKey[2] = static_cast<CORBA::Octet>(i);
+    push_back(readers, id);
+    DDS::StringSeq p;
+    p.length(1);
+    char buf[16];
+    std::sprintf(buf, "%d", i / 5);
+    p[0] = buf;
+    params.push_back(p);
+    index.insert(id, evals[i % n_filters], p);
+  }
+  // Removed and updated readers leave the index.
+  index.remove(readers[1]);
+  params[2][0] = "5";
+  index.insert(readers[2], evals[2], params[2]);
+
+  bool ok = true;
+  for (CORBA::Long depth = -1; depth <= 9; ++depth) {
+    TBTD sample;
+    sample.name = "Adam";
+    sample.durability_service.history_depth = depth;
+    sample.durability_service.max_samples = depth;
+
+    OPENDDS_VECTOR(RepoId) expected;
+    for (CORBA::ULong i = 0; i < readers.length(); ++i) {
+      if (i == 1) {
+        continue;
+      }
+      if (!evals[i % n_filters]->eval(sample, params[i])) {
+        expected.push_back(readers[i]);
+      }
+    }
+
+    GUIDSeq filtered;
+    index.filter_out(sample, filtered);
+    OPENDDS_VECTOR(RepoId) actual(filtered.get_buffer(),
+                                  filtered.get_buffer() + filtered.length());
+    std::sort(expected.begin(), expected.end(), GUID_tKeyLessThan());
+    std::sort(actual.begin(), actual.end(), GUID_tKeyLessThan());
+    if (expected.size() != actual.size()
+        || !std::equal(expected.begin(), expected.end(), actual.begin())) {
+      std::cout << "FilterIndex with history_depth " << depth << " filtered "
+                << actual.size() << " readers, expected " << expected.size()
+                << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
 // parsing test helpers
 namespace yard_test {
 
@@ -227,12 +435,19 @@ bool testParsing() {
 
 int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
 {
-  if (argc > 1 && ACE_OS::strncmp(argv[1], ACE_TEXT("-d"), 2) == 0) {
-    debug = true;
+  for (int i = 1; i < argc; ++i) {
+    if (ACE_OS::strncmp(argv[i], ACE_TEXT("-d"), 2) == 0) {
+      debug = true;
+    } else if (ACE_OS::strcmp(argv[i], ACE_TEXT("-b")) == 0 && i + 1 < argc) {
+      // time the compiled filters against the AST evaluator, and batches
+      iterations = ACE_OS::atoi(argv[++i]);
+    }
   }
 
   bool ok = testParsing();
   ok &= testEval();
+  ok &= testEvalBatch();
+  ok &= testFilterIndex();
 
   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -112,10 +112,14 @@ elsif ($test->flag('shmem')) {
     $pub_opts .= " -DCPSConfigFile shmem.ini";
     $sub_opts .= " -DCPSConfigFile shmem.ini";
 }
+elsif ($test->flag('shmem_ring')) {
+    $pub_opts .= " -DCPSConfigFile shmem_ring.ini";
+    $sub_opts .= " -DCPSConfigFile shmem_ring.ini";
+}
 elsif ($test->flag('all')) {
     @original_ARGV = grep { $_ ne 'all' } @original_ARGV;
     my @tests = ('', qw/udp multicast default_tcp default_udp default_multicast
-                        nobits stack shmem
+                        nobits stack shmem shmem_ring
                         rtps rtps_disc rtps_unicast rtps_disc_tcp/);
     push(@tests, 'ipv6') if new PerlACE::ConfigList->check_config('IPV6');
     for my $test (@tests) {
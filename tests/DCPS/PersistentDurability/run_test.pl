@@ -17,6 +17,12 @@ $status = 0;
 $pub_opts = "-DCPSConfigFile pub.ini -DCPSPersistentDataDir $DDS_ROOT/tests/DCPS/PersistentDurability/data";
 $sub_opts = "-DCPSConfigFile sub.ini";
 
+if ($ARGV[0] eq 'sync') {
+  # nothing is synced before the first publisher exits, so its samples
+  # reach the second one only through the flush at shutdown
+  $pub_opts .= " -DCPSPersistentSyncSamples 1000 -DCPSPersistentSyncInterval 60000";
+}
+
 my $LONE_PROCESS = 1; #only one publisher process runs at a time
 
 sub rmtree {
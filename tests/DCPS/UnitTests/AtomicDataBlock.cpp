@@ -0,0 +1,130 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+#include "ace/OS_NS_string.h"
+#include "ace/Task.h"
+
+#include "dds/DCPS/AtomicDataBlock.h"
+#include "dds/DCPS/Slab_Allocator.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+AtomicDataBlock* atomic_db(ACE_Message_Block* mb)
+{
+  return dynamic_cast<AtomicDataBlock*>(mb->data_block());
+}
+
+/// Each thread duplicates the shared message block, like the DataLinks a
+/// sample is sent on, and releases its copies.
+class Sharer : public ACE_Task_Base {
+public:
+  explicit Sharer(ACE_Message_Block& mb)
+    : mb_(mb)
+  {}
+
+  int svc()
+  {
+    ACE_Message_Block* copies[8];
+    for (int i = 0; i < 50000; ++i) {
+      for (int c = 0; c < 8; ++c) {
+        copies[c] = mb_.duplicate();
+      }
+      for (int c = 0; c < 8; ++c) {
+        copies[c]->release();
+      }
+    }
+    return 0;
+  }
+
+  ACE_Message_Block& mb_;
+};
+
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    Slab_Allocator<ACE_Message_Block> mb_allocator(4);
+    Slab_Allocator<AtomicDataBlock> db_allocator(4);
+
+    // Duplicates share the data block and the last release frees it
+    {
+      ACE_Message_Block* const cont = AtomicDataBlock::make_message_block(8);
+      TEST_CHECK(cont != 0);
+      ACE_Message_Block* const mb =
+        AtomicDataBlock::make_message_block(16, cont, 0,
+                                            &db_allocator, &mb_allocator);
+      TEST_CHECK(mb != 0);
+      TEST_CHECK(mb->cont() == cont);
+      TEST_CHECK(mb->size() == 16);
+      TEST_CHECK(mb->msg_type() == ACE_Message_Block::MB_DATA);
+      TEST_CHECK(mb->locking_strategy() == 0);
+      TEST_CHECK(atomic_db(mb) != 0);
+      TEST_CHECK(atomic_db(mb)->ref_count() == 1);
+      ACE_OS::memcpy(mb->wr_ptr(), "sample", 7);
+      mb->wr_ptr(7);
+
+      ACE_Message_Block* const dup = mb->duplicate();
+      TEST_CHECK(dup->data_block() == mb->data_block());
+      TEST_CHECK(atomic_db(mb)->ref_count() == 2);
+      TEST_CHECK(atomic_db(cont)->ref_count() == 2);
+      TEST_CHECK(ACE_OS::strcmp(dup->rd_ptr(), "sample") == 0);
+
+      mb->release();
+      TEST_CHECK(atomic_db(dup)->ref_count() == 1);
+      TEST_CHECK(atomic_db(dup->cont())->ref_count() == 1);
+      dup->release();
+
+      // Only what the first message block had is reused.
+      TEST_CHECK(db_allocator.high_water() == 1);
+      TEST_CHECK(mb_allocator.high_water() == 2);
+    }
+
+    // Clones get their own AtomicDataBlock
+    {
+      ACE_Message_Block* const mb =
+        AtomicDataBlock::make_message_block(16, 0, 0,
+                                            &db_allocator, &mb_allocator);
+      ACE_OS::memcpy(mb->wr_ptr(), "sample", 7);
+      mb->wr_ptr(7);
+      ACE_Message_Block* const clone = mb->clone();
+      TEST_CHECK(clone != 0);
+      TEST_CHECK(clone->data_block() != mb->data_block());
+      TEST_CHECK(atomic_db(clone) != 0);
+      TEST_CHECK(atomic_db(clone)->ref_count() == 1);
+      TEST_CHECK(ACE_OS::strcmp(clone->rd_ptr(), "sample") == 0);
+      clone->release();
+      mb->release();
+    }
+
+    // Threads sharing a message block leave its count where it was
+    {
+      ACE_Message_Block* const mb =
+        AtomicDataBlock::make_message_block(16, 0, 0,
+                                            &db_allocator, &mb_allocator);
+      Sharer sharer(*mb);
+      TEST_CHECK(sharer.activate(THR_NEW_LWP | THR_JOINABLE, 4) == 0);
+      sharer.wait();
+      TEST_CHECK(atomic_db(mb)->ref_count() == 1);
+      mb->release();
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
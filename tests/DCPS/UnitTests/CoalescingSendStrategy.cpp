@@ -0,0 +1,289 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+#include "ace/OS_NS_string.h"
+#include "ace/OS_NS_sys_time.h"
+#include "ace/OS_NS_unistd.h"
+#include "ace/Atomic_Op.h"
+#include "ace/Guard_T.h"
+#include "ace/Thread_Mutex.h"
+
+#include "dds/DCPS/transport/framework/NullSynchStrategy.h"
+#include "dds/DCPS/transport/framework/TransportHeader.h"
+#include "dds/DCPS/transport/framework/TransportImpl.h"
+#include "dds/DCPS/transport/framework/TransportInst.h"
+#include "dds/DCPS/transport/framework/TransportQueueElement.h"
+#include "dds/DCPS/transport/framework/TransportSendStrategy.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+
+using namespace OpenDDS::DCPS;
+
+// Tests the coalescing mode of TransportSendStrategy (coalesce_delay_usec
+// and coalesce_max_bytes) with a strategy that records the datagrams it
+// would send.
+
+namespace {
+
+const size_t SAMPLE = 100;
+
+class TestInst : public TransportInst {
+public:
+  explicit TestInst(const char* name) : TransportInst("coalescing_test", name) {}
+  bool is_reliable() const { return true; }
+  size_t populate_locator(TransportLocator&) const { return 0; }
+  TransportImpl_rch new_impl() { return TransportImpl_rch(); }
+};
+
+class TestTransport : public TransportImpl {
+public:
+  explicit TestTransport(TransportInst& inst) : TransportImpl(inst) {}
+  void close() { shutdown(); }
+  OPENDDS_STRING transport_type() const { return "coalescing_test"; }
+
+protected:
+  bool connection_info_i(TransportLocator&) const { return false; }
+  AcceptConnectResult connect_datalink(const RemoteTransport&,
+                                       const ConnectionAttribs&,
+                                       const TransportClient_rch&)
+  {
+    return AcceptConnectResult();
+  }
+  AcceptConnectResult accept_datalink(const RemoteTransport&,
+                                      const ConnectionAttribs&,
+                                      const TransportClient_rch&)
+  {
+    return AcceptConnectResult();
+  }
+  void stop_accepting_or_connecting(const TransportClient_wrch&, const RepoId&) {}
+  void shutdown_i() {}
+
+private:
+  void release_datalink(DataLink*) {}
+};
+
+/// Records the size of each datagram instead of sending it.
+class RecordingStrategy : public TransportSendStrategy {
+public:
+  explicit RecordingStrategy(TransportImpl& transport)
+    : TransportSendStrategy(0, transport, 0, 0, make_rch<NullSynchStrategy>())
+  {}
+
+  void stop_i() {}
+
+  size_t datagrams() const
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, sizes_lock_, 0);
+    return sizes_.size();
+  }
+
+  size_t datagram_size(size_t i) const
+  {
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, sizes_lock_, 0);
+    return i < sizes_.size() ? sizes_[i] : 0;
+  }
+
+  /// Waits up to @a timeout for @a count datagrams.
+  bool wait_for(size_t count, const ACE_Time_Value& timeout) const
+  {
+    const ACE_Time_Value deadline = ACE_OS::gettimeofday() + timeout;
+    while (datagrams() < count && ACE_OS::gettimeofday() < deadline) {
+      ACE_OS::sleep(ACE_Time_Value(0, 10000));
+    }
+    return datagrams() >= count;
+  }
+
+protected:
+  ssize_t send_bytes(const iovec iov[], int n, int& bp)
+  {
+    bp = 0;
+    return send_bytes_i(iov, n);
+  }
+
+  ssize_t send_bytes_i(const iovec iov[], int n)
+  {
+    size_t size = 0;
+    for (int i = 0; i < n; ++i) {
+      size += iov[i].iov_len;
+    }
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, sizes_lock_, -1);
+    sizes_.push_back(size);
+    return static_cast<ssize_t>(size);
+  }
+
+private:
+  mutable ACE_Thread_Mutex sizes_lock_;
+  OPENDDS_VECTOR(size_t) sizes_;
+};
+
+class TestElement : public TransportQueueElement {
+public:
+  explicit TestElement(size_t size)
+    : TransportQueueElement(1)
+    , delivered_(false)
+    , msg_(size)
+  {
+    ACE_OS::memset(msg_.wr_ptr(), 0x5a, size);
+    msg_.wr_ptr(size);
+  }
+
+  RepoId publication_id() const { return GUID_UNKNOWN; }
+  const ACE_Message_Block* msg() const { return &msg_; }
+  const ACE_Message_Block* msg_payload() const { return &msg_; }
+  bool owned_by_transport() { return false; }
+
+  /// Set by the thread that sent the element.
+  ACE_Atomic_Op<ACE_Thread_Mutex, bool> delivered_;
+
+protected:
+  void release_element(bool dropped_by_transport)
+  {
+    delivered_ = !dropped_by_transport;
+  }
+
+private:
+  ACE_Message_Block msg_;
+};
+
+/// A started strategy of a transport with the coalescing options.
+struct Link {
+  Link(long delay_usec, ACE_UINT32 max_bytes)
+    : inst_(make_rch<TestInst>("coalescing"))
+  {
+    inst_->coalesce_delay_usec_ = delay_usec;
+    inst_->coalesce_max_bytes_ = max_bytes;
+    transport_ = make_rch<TestTransport>(ref(*inst_));
+    transport_->create_reactor_task();
+    strategy_ = make_rch<RecordingStrategy>(ref(*transport_));
+    TEST_CHECK(strategy_->start() == 0);
+    strategy_->link_released(false);
+  }
+
+  ~Link()
+  {
+    strategy_->stop();
+    transport_->close();
+  }
+
+  /// Sends @a element as one write.
+  void write(TestElement& element)
+  {
+    strategy_->send_start();
+    strategy_->send(&element);
+    strategy_->send_stop(GUID_UNKNOWN);
+  }
+
+  RcHandle<TestInst> inst_;
+  RcHandle<TestTransport> transport_;
+  RcHandle<RecordingStrategy> strategy_;
+};
+
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    const size_t header = TransportHeader::max_marshaled_size();
+
+    // Without a delay each write is sent right away
+    {
+      Link link(0, 0);
+      TestElement a(SAMPLE), b(SAMPLE);
+      link.write(a);
+      link.write(b);
+      TEST_CHECK(link.strategy_->datagrams() == 2);
+      TEST_CHECK(link.strategy_->datagram_size(0) == header + SAMPLE);
+      TEST_CHECK(a.delivered_.value() && b.delivered_.value());
+      const TransportSendStrategy::CoalesceStats stats =
+        link.strategy_->coalesce_stats();
+      TEST_CHECK(stats.packets_held_ == 0);
+      TEST_CHECK(stats.packets_saved_ == 0);
+      TEST_CHECK(stats.deadline_flushes_ == 0);
+    }
+
+    // Small writes are merged and sent when the delay expires
+    {
+      const ACE_Time_Value delay(0, 300000);
+      Link link(static_cast<long>(delay.usec()), 0);
+      TestElement a(SAMPLE), b(SAMPLE);
+      const ACE_Time_Value start = ACE_OS::gettimeofday();
+      link.write(a);
+      link.write(b);
+      TEST_CHECK(link.strategy_->datagrams() == 0);
+      TEST_CHECK(!a.delivered_.value() && !b.delivered_.value());
+
+      TEST_CHECK(link.strategy_->wait_for(1, delay + ACE_Time_Value(5)));
+      const ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+      ACE_DEBUG((LM_INFO, ACE_TEXT("held packet sent after %dms\n"),
+                 int(elapsed.msec())));
+      TEST_CHECK(elapsed < delay + ACE_Time_Value(2));
+      TEST_CHECK(link.strategy_->datagrams() == 1);
+      TEST_CHECK(link.strategy_->datagram_size(0) == header + 2 * SAMPLE);
+      // The timer's thread reports them after sending
+      for (int i = 0; i < 500 && !(a.delivered_.value() && b.delivered_.value()); ++i) {
+        ACE_OS::sleep(ACE_Time_Value(0, 10000));
+      }
+      TEST_CHECK(a.delivered_.value() && b.delivered_.value());
+
+      const TransportSendStrategy::CoalesceStats stats =
+        link.strategy_->coalesce_stats();
+      TEST_CHECK(stats.packets_held_ == 2);
+      TEST_CHECK(stats.packets_saved_ == 1);
+      TEST_CHECK(stats.deadline_flushes_ == 1);
+    }
+
+    // Reaching coalesce_max_bytes sends the packet without waiting
+    {
+      const ACE_Time_Value delay(0, 300000);
+      Link link(static_cast<long>(delay.usec()),
+                static_cast<ACE_UINT32>(header + 2 * SAMPLE + SAMPLE / 2));
+      TestElement a(SAMPLE), b(SAMPLE), c(SAMPLE);
+      link.write(a);
+      link.write(b);
+      TEST_CHECK(link.strategy_->datagrams() == 0);
+      link.write(c);
+      TEST_CHECK(link.strategy_->datagrams() == 1);
+      TEST_CHECK(link.strategy_->datagram_size(0) == header + 3 * SAMPLE);
+      TEST_CHECK(a.delivered_.value() && b.delivered_.value() && c.delivered_.value());
+
+      // The deadline finds nothing to send
+      ACE_OS::sleep(delay + ACE_Time_Value(0, 200000));
+      TEST_CHECK(link.strategy_->datagrams() == 1);
+
+      const TransportSendStrategy::CoalesceStats stats =
+        link.strategy_->coalesce_stats();
+      TEST_CHECK(stats.packets_held_ == 2);
+      TEST_CHECK(stats.packets_saved_ == 2);
+      TEST_CHECK(stats.deadline_flushes_ == 0);
+    }
+
+    // Stopping sends a held packet
+    {
+      TestElement a(SAMPLE);
+      RcHandle<RecordingStrategy> strategy;
+      {
+        Link link(60 * 1000 * 1000, 0);
+        strategy = link.strategy_;
+        link.write(a);
+        TEST_CHECK(strategy->datagrams() == 0);
+      }
+      TEST_CHECK(strategy->datagrams() == 1);
+      TEST_CHECK(a.delivered_.value());
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
@@ -0,0 +1,379 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+#include "ace/Dirent.h"
+#include "ace/OS_NS_fcntl.h"
+#include "ace/OS_NS_sys_stat.h"
+#include "ace/OS_NS_unistd.h"
+
+#include "dds/DCPS/DurabilityLog.h"
+
+#include "../common/TestSupport.h"
+
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+const char DIR[] = "DurabilityLog_test";
+
+/// Records what the log passes to it when it's opened.
+class Loader : public DurabilityLog::Loader {
+public:
+  struct Stream {
+    DDS::DomainId_t domain_id;
+    std::string topic_name;
+    std::string type_name;
+    std::vector<std::string> samples;
+    std::vector<DDS::Time_t> timestamps;
+  };
+
+  void stream(ACE_UINT32 id, DDS::DomainId_t domain_id,
+              const char* topic_name, const char* type_name)
+  {
+    Stream& s = streams[id];
+    s.domain_id = domain_id;
+    s.topic_name = topic_name;
+    s.type_name = type_name;
+  }
+
+  void sample(ACE_UINT32 id, const DDS::Time_t& timestamp,
+              const char* data, size_t length)
+  {
+    streams[id].samples.push_back(std::string(data, length));
+    streams[id].timestamps.push_back(timestamp);
+  }
+
+  std::map<ACE_UINT32, Stream> streams;
+};
+
+std::string path(const char* name)
+{
+  return std::string(DIR) + '/' + name;
+}
+
+/// Names of the segment files of the log.
+std::vector<std::string> segments()
+{
+  std::vector<std::string> names;
+  ACE_Dirent dirent;
+  if (dirent.open(ACE_TEXT(DIR)) == -1) {
+    return names;
+  }
+  for (ACE_DIRENT* ent = dirent.read(); ent; ent = dirent.read()) {
+    const std::string name = ACE_TEXT_ALWAYS_CHAR(ent->d_name);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+size_t file_size(const std::string& name)
+{
+  ACE_stat st;
+  if (ACE_OS::stat(ACE_TEXT_CHAR_TO_TCHAR(name.c_str()), &st) != 0) {
+    return 0;
+  }
+  return static_cast<size_t>(st.st_size);
+}
+
+bool append_file(const std::string& name, const char* data, size_t length)
+{
+  const ACE_HANDLE handle =
+    ACE_OS::open(ACE_TEXT_CHAR_TO_TCHAR(name.c_str()),
+                 O_WRONLY | O_CREAT | O_APPEND | O_BINARY,
+                 ACE_DEFAULT_FILE_PERMS);
+  if (handle == ACE_INVALID_HANDLE) {
+    return false;
+  }
+  const bool ok = ACE_OS::write_n(handle, data, length) == ssize_t(length);
+  ACE_OS::close(handle);
+  return ok;
+}
+
+void clean_up()
+{
+  ACE_Dirent dirent;
+  if (dirent.open(ACE_TEXT(DIR)) == -1) {
+    return;
+  }
+  std::vector<std::string> names;
+  for (ACE_DIRENT* ent = dirent.read(); ent; ent = dirent.read()) {
+    const std::string name = ACE_TEXT_ALWAYS_CHAR(ent->d_name);
+    if (name != "." && name != "..") {
+      names.push_back(name);
+    }
+  }
+  dirent.close();
+  for (size_t i = 0; i < names.size(); ++i) {
+    ACE_OS::unlink(ACE_TEXT_CHAR_TO_TCHAR(path(names[i].c_str()).c_str()));
+  }
+  ACE_OS::rmdir(ACE_TEXT(DIR));
+}
+
+DDS::Time_t timestamp(int i)
+{
+  DDS::Time_t t;
+  t.sec = 1000 + i;
+  t.nanosec = i;
+  return t;
+}
+
+std::string sample(int stream, int i)
+{
+  // long enough that a few samples fill a small segment
+  return std::string(40, char('a' + stream)) + char('0' + i % 10);
+}
+
+/// Size of a segment with a stream and its samples.
+size_t segment_size(const char* topic_name, const char* type_name,
+                    size_t samples)
+{
+  const size_t stream = 8 + 17 + std::strlen(topic_name) + std::strlen(type_name);
+  return 8 + stream + samples * (8 + 13 + sample(0, 0).size());
+}
+
+/// Waits for the thread of the log to write a segment of @a size bytes.
+bool written(const std::string& segment, size_t size)
+{
+  for (int i = 0; i < 100 && file_size(segment) != size; ++i) {
+    ACE_OS::sleep(ACE_Time_Value(0, 50000));
+  }
+  return file_size(segment) == size;
+}
+
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    clean_up();
+    TEST_ASSERT(ACE_OS::mkdir(ACE_TEXT(DIR)) == 0);
+
+    // Reopening the log after a restart
+    {
+      {
+        DurabilityLog log(DIR);
+        Loader loader;
+        TEST_CHECK(log.open(loader));
+        TEST_CHECK(loader.streams.empty());
+
+        const ACE_UINT32 id = log.add_stream(7, "Topic", "Type");
+        TEST_CHECK(id != 0);
+        for (int i = 0; i < 3; ++i) {
+          const std::string s = sample(0, i);
+          TEST_CHECK(log.append(id, timestamp(i), s.data(), s.size()));
+        }
+        TEST_CHECK(!log.append(id + 1, timestamp(0), "x", 1));
+      }
+
+      DurabilityLog log(DIR);
+      Loader loader;
+      TEST_CHECK(log.open(loader));
+      TEST_CHECK(loader.streams.size() == 1);
+      const Loader::Stream& s = loader.streams.begin()->second;
+      TEST_CHECK(s.domain_id == 7);
+      TEST_CHECK(s.topic_name == "Topic");
+      TEST_CHECK(s.type_name == "Type");
+      TEST_CHECK(s.samples.size() == 3);
+      for (size_t i = 0; i < s.samples.size(); ++i) {
+        TEST_CHECK(s.samples[i] == sample(0, int(i)));
+        TEST_CHECK(s.timestamps[i].sec == timestamp(int(i)).sec);
+        TEST_CHECK(s.timestamps[i].nanosec == timestamp(int(i)).nanosec);
+      }
+
+      // New streams don't reuse the ids in the log
+      TEST_CHECK(log.add_stream(7, "Other", "Type") > loader.streams.begin()->first);
+    }
+
+    // A record that wasn't written completely ends the log
+    {
+      std::vector<std::string> names = segments();
+      TEST_ASSERT(names.size() == 1);
+      const std::string segment = path(names[0].c_str());
+      const size_t size = file_size(segment);
+      // A record header claiming a longer body than follows it
+      const char torn[] = "\x40\0\0\0\x12\x34\x56\x78\x02\x01";
+      TEST_CHECK(append_file(segment, torn, sizeof torn - 1));
+      TEST_CHECK(file_size(segment) == size + sizeof torn - 1);
+
+      ACE_UINT32 id = 0;
+      {
+        DurabilityLog log(DIR);
+        Loader loader;
+        TEST_CHECK(log.open(loader));
+        TEST_CHECK(file_size(segment) == size);
+        TEST_CHECK(loader.streams.size() == 2);
+        id = loader.streams.begin()->first;
+        TEST_CHECK(loader.streams[id].samples.size() == 3);
+
+        // Appending continues after the last complete record
+        const std::string s = sample(0, 3);
+        TEST_CHECK(log.append(id, timestamp(3), s.data(), s.size()));
+        TEST_CHECK(log.flush());
+      }
+
+      DurabilityLog log(DIR);
+      Loader loader;
+      TEST_CHECK(log.open(loader));
+      TEST_CHECK(loader.streams[id].samples.size() == 4);
+      TEST_CHECK(loader.streams[id].samples.back() == sample(0, 3));
+    }
+
+    clean_up();
+    TEST_ASSERT(ACE_OS::mkdir(ACE_TEXT(DIR)) == 0);
+
+    // Compaction
+    {
+      ACE_UINT32 kept = 0;
+      {
+        DurabilityLog log(DIR, 0, ACE_Time_Value::zero, 512);
+        Loader loader;
+        TEST_CHECK(log.open(loader));
+        const ACE_UINT32 removed = log.add_stream(0, "Removed", "Type");
+        kept = log.add_stream(0, "Kept", "Type");
+        for (int i = 0; i < 20; ++i) {
+          const std::string r = sample(1, i), k = sample(2, i);
+          TEST_CHECK(log.append(removed, timestamp(i), r.data(), r.size()));
+          if (i < 5) {
+            TEST_CHECK(log.append(kept, timestamp(i), k.data(), k.size()));
+          }
+        }
+        TEST_CHECK(log.flush());
+        TEST_CHECK(segments().size() > 1);
+
+        // Most of the log is now records of a removed stream, which makes
+        // the thread of the log compact it into one segment.
+        TEST_CHECK(log.remove(removed));
+        TEST_CHECK(!log.remove(removed));
+        TEST_CHECK(!log.append(removed, timestamp(0), "x", 1));
+        for (int i = 0; i < 100 && segments().size() != 1; ++i) {
+          ACE_OS::sleep(ACE_Time_Value(0, 100000));
+        }
+        TEST_CHECK(segments().size() == 1);
+
+        // Samples appended after compacting go to the compacted segment
+        // while it has room, and are kept by the next compaction.
+        const std::string k = sample(2, 5);
+        TEST_CHECK(log.append(kept, timestamp(5), k.data(), k.size()));
+        TEST_CHECK(log.flush());
+        TEST_CHECK(segments().size() == 1);
+        TEST_CHECK(log.compact());
+        TEST_CHECK(segments().size() == 1);
+      }
+
+      const std::vector<std::string> names = segments();
+      TEST_CHECK(names.size() == 1);
+      if (names.size() == 1) {
+        const ACE_HANDLE handle = ACE_OS::open(
+          ACE_TEXT_CHAR_TO_TCHAR(path(names[0].c_str()).c_str()), O_RDONLY | O_BINARY);
+        char header[8] = {0};
+        TEST_CHECK(handle != ACE_INVALID_HANDLE);
+        TEST_CHECK(ACE_OS::read_n(handle, header, sizeof header) == ssize_t(sizeof header));
+        ACE_OS::close(handle);
+        TEST_CHECK(std::string(header, 4) == "ODDL");
+        TEST_CHECK(header[5] == 1); // compacted
+      }
+
+      DurabilityLog log(DIR, 0, ACE_Time_Value::zero, 512);
+      Loader loader;
+      TEST_CHECK(log.open(loader));
+      TEST_CHECK(loader.streams.size() == 1);
+      const Loader::Stream& s = loader.streams[kept];
+      TEST_CHECK(s.topic_name == "Kept");
+      TEST_CHECK(s.samples.size() == 6);
+      for (size_t i = 0; i < s.samples.size(); ++i) {
+        TEST_CHECK(s.samples[i] == sample(2, int(i)));
+      }
+    }
+
+    clean_up();
+
+    // Writing and syncing, whatever the sync settings the thread of the log
+    // writes each batch, flush() and the destructor write what's left.
+    {
+      const size_t sync_samples[] = {0, 3, 0, 1000};
+      const ACE_Time_Value sync_interval[] = {
+        ACE_Time_Value::zero, ACE_Time_Value::zero,
+        ACE_Time_Value(0, 200000), ACE_Time_Value(60)
+      };
+      for (size_t c = 0; c < sizeof sync_samples / sizeof sync_samples[0]; ++c) {
+        clean_up();
+        TEST_ASSERT(ACE_OS::mkdir(ACE_TEXT(DIR)) == 0);
+        const std::string segment = path("_durability.00000001.log");
+        {
+          DurabilityLog log(DIR, sync_samples[c], sync_interval[c]);
+          Loader loader;
+          TEST_CHECK(log.open(loader));
+          const ACE_UINT32 id = log.add_stream(1, "Sync", "Type");
+          for (int i = 0; i < 2; ++i) {
+            const std::string s = sample(0, i);
+            TEST_CHECK(log.append(id, timestamp(i), s.data(), s.size()));
+          }
+          TEST_CHECK(written(segment, segment_size("Sync", "Type", 2)));
+
+          for (int i = 2; i < 5; ++i) {
+            const std::string s = sample(0, i);
+            TEST_CHECK(log.append(id, timestamp(i), s.data(), s.size()));
+          }
+          TEST_CHECK(log.flush());
+          TEST_CHECK(file_size(segment) == segment_size("Sync", "Type", 5));
+
+          // Left for the destructor, as at shutdown
+          const std::string s = sample(0, 5);
+          TEST_CHECK(log.append(id, timestamp(5), s.data(), s.size()));
+        }
+        TEST_CHECK(file_size(segment) == segment_size("Sync", "Type", 6));
+
+        DurabilityLog log(DIR);
+        Loader loader;
+        TEST_CHECK(log.open(loader));
+        TEST_CHECK(loader.streams.size() == 1);
+        TEST_CHECK(loader.streams.begin()->second.samples.size() == 6);
+      }
+    }
+
+    clean_up();
+
+    // DataDurabilityCache falls back on FileSystemStorage when the log
+    // can't be opened
+    {
+      {
+        DurabilityLog log(DIR);
+        Loader loader;
+        TEST_CHECK(!log.open(loader));
+        TEST_CHECK(log.add_stream(0, "Topic", "Type") == 0);
+        TEST_CHECK(!log.compact());
+      }
+
+      TEST_ASSERT(ACE_OS::mkdir(ACE_TEXT(DIR)) == 0);
+      const char junk[] = "not a durability log segment";
+      TEST_CHECK(append_file(path("_durability.00000001.log"), junk, sizeof junk - 1));
+      DurabilityLog log(DIR);
+      Loader loader;
+      TEST_CHECK(!log.open(loader));
+      TEST_CHECK(log.add_stream(0, "Topic", "Type") == 0);
+      TEST_CHECK(!log.append(1, timestamp(0), "x", 1));
+    }
+
+    clean_up();
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
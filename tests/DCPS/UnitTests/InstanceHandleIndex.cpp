@@ -0,0 +1,69 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+
+#include "dds/DCPS/InstanceHandleIndex_T.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+
+using namespace OpenDDS::DCPS;
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    // Lookup of bound and missing handles
+    {
+      InstanceHandleIndex<int, 4, 2> index;
+      int value = 0;
+      TEST_CHECK(!index.find(1, value));
+
+      for (DDS::InstanceHandle_t h = 1; h <= 100; ++h) {
+        TEST_CHECK(index.bind(h, h * 10));
+      }
+
+      for (DDS::InstanceHandle_t h = 1; h <= 100; ++h) {
+        TEST_CHECK(index.find(h, value));
+        TEST_CHECK(value == h * 10);
+      }
+      TEST_CHECK(!index.find(101, value));
+
+      // Binding a handle twice keeps the first value
+      TEST_CHECK(!index.bind(7, 0));
+      TEST_CHECK(index.find(7, value));
+      TEST_CHECK(value == 70);
+    }
+
+    // Unbind and clear
+    {
+      InstanceHandleIndex<int> index;
+      int value = 0;
+      TEST_CHECK(index.bind(3, 30));
+      TEST_CHECK(index.bind(19, 190));
+      TEST_CHECK(index.unbind(3));
+      TEST_CHECK(!index.unbind(3));
+      TEST_CHECK(!index.find(3, value));
+      TEST_CHECK(index.find(19, value));
+      TEST_CHECK(value == 190);
+
+      index.clear();
+      TEST_CHECK(!index.find(19, value));
+      TEST_CHECK(index.bind(19, 191));
+      TEST_CHECK(index.find(19, value));
+      TEST_CHECK(value == 191);
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
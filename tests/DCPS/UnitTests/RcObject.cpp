@@ -0,0 +1,135 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+#include "ace/Task.h"
+
+#include "dds/DCPS/RcObject.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+class Counted : public RcObject {
+public:
+  explicit Counted(int value) : value_(value) {}
+  int value_;
+};
+
+typedef RcHandle<Counted> Counted_rch;
+typedef WeakRcHandle<Counted> Counted_wrch;
+
+/// Locks a weak handle while the main thread drops the last strong one.
+class Locker : public ACE_Task_Base {
+public:
+  explicit Locker(const Counted_wrch& weak) : weak_(weak) {}
+
+  int svc()
+  {
+    for (int i = 0; i < 100000; ++i) {
+      Counted_rch strong = weak_.lock();
+      if (strong && strong->value_ != 42) {
+        bad_.increment();
+      }
+    }
+    return 0;
+  }
+
+  Counted_wrch weak_;
+  AtomicCounter bad_;
+};
+
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    // Moving a handle doesn't change the count
+    {
+      Counted_rch a = make_rch<Counted>(1);
+      TEST_CHECK(a->ref_count() == 1);
+      Counted_rch b(move(a));
+      TEST_CHECK(!a);
+      TEST_CHECK(b->ref_count() == 1);
+      Counted_rch c;
+      c = move(b);
+      TEST_CHECK(!b);
+      TEST_CHECK(c->ref_count() == 1);
+      Counted_rch d = c;
+      TEST_CHECK(c->ref_count() == 2);
+    }
+
+#ifdef OPENDDS_RCOBJECT_STATS
+    // Reference count operations of passing a handle on, as
+    // TransportClient::send_i does with the filtered links of a sample
+    {
+      Counted_rch target;
+      long copy_ops = 0;
+      {
+        Counted_rch source = make_rch<Counted>(3);
+        const long before = rc_object_ops.value();
+        target = source;
+        source.reset();
+        copy_ops = rc_object_ops.value() - before;
+      }
+      target.reset();
+
+      long move_ops = 0;
+      {
+        Counted_rch source = make_rch<Counted>(3);
+        const long before = rc_object_ops.value();
+        target = move(source);
+        source.reset();
+        move_ops = rc_object_ops.value() - before;
+      }
+      target.reset();
+
+      ACE_DEBUG((LM_INFO, ACE_TEXT("rc_object_ops to pass a handle on: ")
+                 ACE_TEXT("%d copying, %d moving\n"), int(copy_ops), int(move_ops)));
+      TEST_CHECK(copy_ops == 2);
+      TEST_CHECK(move_ops == 0);
+    }
+#endif
+
+    // A weak handle can't be locked once the object is gone
+    {
+      Counted_rch strong = make_rch<Counted>(2);
+      Counted_wrch weak(strong);
+      TEST_CHECK(strong->ref_count() == 1);
+      {
+        Counted_rch locked = weak.lock();
+        TEST_CHECK(locked == strong);
+        TEST_CHECK(strong->ref_count() == 2);
+      }
+      TEST_CHECK(strong->ref_count() == 1);
+      strong.reset();
+      TEST_CHECK(!weak.lock());
+    }
+
+    // Weak handles locked by other threads while the object goes away
+    for (int round = 0; round < 10; ++round) {
+      Counted_rch strong = make_rch<Counted>(42);
+      Locker locker(strong);
+      TEST_CHECK(locker.activate(THR_NEW_LWP | THR_JOINABLE, 4) == 0);
+      strong.reset();
+      locker.wait();
+      TEST_CHECK(locker.bad_.value() == 0);
+      TEST_CHECK(!locker.weak_.lock());
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/OS_main.h"
+#include "ace/OS_NS_string.h"
+
+#include "dds/DCPS/transport/framework/TransportRegistry.h"
+#include "dds/DCPS/transport/shmem/Shmem.h"
+#include "dds/DCPS/transport/shmem/ShmemInst.h"
+#include "dds/DCPS/transport/shmem/ShmemTransport.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+
+using namespace OpenDDS::DCPS;
+
+// Tests that one sample sent on two DataLinks of a shmem transport is
+// copied into the pool once, and that the copy is freed only after both
+// links have released it.
+
+namespace {
+
+const size_t PART = 64;
+
+class TestTransport : public ShmemTransport {
+public:
+  explicit TestTransport(ShmemInst& inst) : ShmemTransport(inst) {}
+  void close() { shutdown(); }
+};
+
+/// The iovecs ShmemSendStrategy gets for a sample: the transport header
+/// followed by the sample in two parts.
+struct Sample {
+  explicit Sample(char fill)
+  {
+    ACE_OS::memset(header_, 0, sizeof header_);
+    ACE_OS::memset(data_, fill, sizeof data_);
+    iov_[0].iov_base = header_;
+    iov_[0].iov_len = sizeof header_;
+    iov_[1].iov_base = data_;
+    iov_[1].iov_len = PART;
+    iov_[2].iov_base = data_ + PART;
+    iov_[2].iov_len = PART;
+  }
+
+  /// What each link's send strategy does to put the sample in the pool.
+  char* send(ShmemTransport& transport) const
+  {
+    return transport.alloc_payload(iov_, 3, sizeof data_);
+  }
+
+  char header_[32]; ///< not part of the payload, its contents don't matter
+  char data_[2 * PART];
+  iovec iov_[3];
+};
+
+}
+
+int
+ACE_TMAIN(int, ACE_TCHAR*[])
+{
+#ifdef OPENDDS_SHMEM_UNSUPPORTED
+  ACE_DEBUG((LM_INFO, ACE_TEXT("No shared memory support, nothing to test\n")));
+#else
+  try
+  {
+    TransportInst_rch inst =
+      TheTransportRegistry->create_inst("shmem_payloads", "shmem");
+    ShmemInst& config = static_cast<ShmemInst&>(*inst);
+    config.pool_size_ = 1024 * 1024;
+    RcHandle<TestTransport> transport = make_rch<TestTransport>(ref(config));
+
+    // One sample sent on two links shares a copy
+    {
+      Sample sample('a');
+      char* const first = sample.send(*transport);
+      char* const second = sample.send(*transport);
+      TEST_CHECK(first != 0);
+      TEST_CHECK(first == second);
+      TEST_CHECK(ACE_OS::memcmp(first, sample.data_, sizeof sample.data_) == 0);
+
+      ShmemTransport::PayloadStats stats = transport->payload_stats();
+      TEST_CHECK(stats.allocated_ == 1);
+      TEST_CHECK(stats.shared_ == 1);
+      TEST_CHECK(stats.bytes_saved_ == sizeof sample.data_);
+      TEST_CHECK(stats.in_use_ == 1);
+
+      // The first link's reader is done, the copy is still in use
+      transport->release_payload(first);
+      stats = transport->payload_stats();
+      TEST_CHECK(stats.freed_ == 0);
+      TEST_CHECK(stats.in_use_ == 1);
+
+      // The second link's reader is done, the copy goes back to the pool
+      transport->release_payload(second);
+      stats = transport->payload_stats();
+      TEST_CHECK(stats.freed_ == 1);
+      TEST_CHECK(stats.in_use_ == 0);
+
+      // Sending it again needs a new copy
+      char* const again = sample.send(*transport);
+      TEST_CHECK(again != 0);
+      stats = transport->payload_stats();
+      TEST_CHECK(stats.allocated_ == 2);
+      TEST_CHECK(stats.shared_ == 1);
+      transport->release_payload(again);
+    }
+
+    // Different bytes at the same address aren't shared
+    {
+      Sample sample('b');
+      char* const first = sample.send(*transport);
+      ACE_OS::memset(sample.data_ + PART, 'c', PART);
+      char* const second = sample.send(*transport);
+      TEST_CHECK(first != 0 && second != 0);
+      TEST_CHECK(first != second);
+      TEST_CHECK(ACE_OS::memcmp(first, "bbbb", 4) == 0);
+      TEST_CHECK(ACE_OS::memcmp(second + PART, "cccc", 4) == 0);
+
+      ShmemTransport::PayloadStats stats = transport->payload_stats();
+      TEST_CHECK(stats.allocated_ == 4);
+      TEST_CHECK(stats.shared_ == 1);
+      TEST_CHECK(stats.in_use_ == 2);
+
+      transport->release_payload(first);
+      transport->release_payload(second);
+      stats = transport->payload_stats();
+      TEST_CHECK(stats.freed_ == 4);
+      TEST_CHECK(stats.in_use_ == 0);
+    }
+
+    transport->close();
+    TheTransportRegistry->release();
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+#endif
+  return 0;
+}
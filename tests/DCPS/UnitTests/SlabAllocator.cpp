@@ -0,0 +1,136 @@
+/*
+ *
+ *
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "ace/Atomic_Op.h"
+#include "ace/OS_main.h"
+#include "ace/OS_NS_string.h"
+#include "ace/Task.h"
+
+#include "dds/DCPS/Slab_Allocator.h"
+
+#include "../common/TestSupport.h"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace OpenDDS::DCPS;
+
+namespace {
+
+struct Chunk {
+  unsigned char data_[40];
+};
+
+/// Each thread fills its chunks with its own byte, any chunk handed to two
+/// threads at once shows up as a corrupted fill.
+class Churner : public ACE_Task_Base {
+public:
+  explicit Churner(Dynamic_Slab_Allocator& allocator)
+    : allocator_(allocator)
+    , next_id_(0)
+    , errors_(0)
+  {}
+
+  int svc()
+  {
+    const unsigned char id = static_cast<unsigned char>(++next_id_);
+    std::vector<unsigned char*> chunks;
+    unsigned int seed = id;
+    for (int i = 0; i < 100000; ++i) {
+      seed = seed * 1103515245 + 12345;
+      if (chunks.size() < 64 && (seed >> 16) % 2) {
+        unsigned char* const chunk =
+          static_cast<unsigned char*>(allocator_.malloc(64));
+        if (!chunk) {
+          ++errors_;
+          continue;
+        }
+        ACE_OS::memset(chunk, id, 64);
+        chunks.push_back(chunk);
+      } else if (!chunks.empty()) {
+        unsigned char* const chunk = chunks.back();
+        chunks.pop_back();
+        for (int b = 0; b < 64; ++b) {
+          if (chunk[b] != id) {
+            ++errors_;
+            break;
+          }
+        }
+        allocator_.free(chunk);
+      }
+    }
+    for (size_t c = 0; c < chunks.size(); ++c) {
+      allocator_.free(chunks[c]);
+    }
+    return 0;
+  }
+
+  Dynamic_Slab_Allocator& allocator_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> next_id_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> errors_;
+};
+
+}
+
+int ACE_TMAIN(int, ACE_TCHAR*[])
+{
+  try
+  {
+    // Grows by slabs instead of going to the heap
+    {
+      Slab_Allocator<Chunk> allocator(4);
+      TEST_CHECK(allocator.slabs() == 1);
+      std::vector<void*> chunks;
+      for (int i = 0; i < 100; ++i) {
+        void* const chunk = allocator.malloc();
+        TEST_CHECK(chunk != 0);
+        ACE_OS::memset(chunk, i, sizeof(Chunk));
+        chunks.push_back(chunk);
+      }
+      // 4 + 4 + 8 + 16 + 32 + 64 chunks
+      TEST_CHECK(allocator.slabs() == 6);
+      TEST_CHECK(allocator.overflows() == 0);
+      TEST_CHECK(allocator.high_water() == 100);
+
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        const unsigned char* const chunk =
+          static_cast<const unsigned char*>(chunks[i]);
+        TEST_CHECK(chunk[0] == i && chunk[sizeof(Chunk) - 1] == i);
+        allocator.free(chunks[i]);
+      }
+
+      // Freed chunks are reused
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        chunks[i] = allocator.malloc();
+      }
+      TEST_CHECK(allocator.slabs() == 6);
+      TEST_CHECK(allocator.high_water() == 100);
+      for (size_t i = 0; i < chunks.size(); ++i) {
+        allocator.free(chunks[i]);
+      }
+
+      TEST_CHECK(allocator.malloc(sizeof(Chunk) + 1) == 0);
+    }
+
+    // Threads never get the same chunk
+    {
+      Dynamic_Slab_Allocator allocator(16, 64);
+      Churner churner(allocator);
+      TEST_CHECK(churner.activate(THR_NEW_LWP | THR_JOINABLE, 4) == 0);
+      churner.wait();
+      TEST_CHECK(churner.errors_ == 0);
+      TEST_CHECK(allocator.overflows() == 0);
+      TEST_CHECK(allocator.high_water() <= 4 * 64);
+    }
+  }
+  catch (std::runtime_error& err)
+  {
+    ACE_ERROR_RETURN((LM_ERROR, ACE_TEXT("ERROR: main() - %C\n"),
+      err.what()), -1);
+  }
+  return 0;
+}
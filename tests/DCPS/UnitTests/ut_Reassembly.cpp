@@ -6,6 +6,7 @@
 #include "dds/DCPS/transport/framework/TransportReassembly.h"
 #include "dds/DCPS/RepoIdGenerator.h"
 
+#include <algorithm>
 #include <string.h>
 
 using namespace OpenDDS::DCPS;
@@ -33,6 +34,47 @@ namespace {
     ReceivedDataSample sample;
   };
 
+  // Fragments first_frag to first_frag + frags - 1 of a sample of sample_size
+  // bytes whose byte i is i % 251, for the sized reassemble()
+  class SizedFrag {
+  public:
+    SizedFrag(const RepoId& pub_id, const SequenceNumber& msg_seq,
+              CORBA::ULong first_frag, CORBA::ULong frags,
+              CORBA::ULong frag_size, CORBA::ULong sample_size)
+    : sample(0),
+      range(first_frag, first_frag + frags - 1)
+    {
+      const CORBA::ULong offset = (first_frag - 1) * frag_size;
+      const CORBA::ULong end = std::min(offset + frags * frag_size, sample_size);
+      sample.header_.publication_id_ = pub_id;
+      sample.header_.sequence_ = msg_seq;
+      sample.header_.more_fragments_ = end < sample_size;
+      sample.sample_.reset(new ACE_Message_Block(end - offset));
+      for (CORBA::ULong i = offset; i < end; ++i) {
+        *sample.sample_->wr_ptr() = static_cast<char>(i % 251);
+        sample.sample_->wr_ptr(1);
+      }
+    }
+    ReceivedDataSample sample;
+    SequenceRange range;
+  };
+
+  bool has_pattern(const ReceivedDataSample& rds, CORBA::ULong size)
+  {
+    if (!rds.sample_ || rds.sample_->total_length() != size) {
+      return false;
+    }
+    CORBA::ULong i = 0;
+    for (const ACE_Message_Block* mb = rds.sample_.get(); mb; mb = mb->cont()) {
+      for (size_t j = 0; j < mb->length(); ++j, ++i) {
+        if (mb->rd_ptr()[j] != static_cast<char>(i % 251)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
   enum Constants {
     BM_LENGTH = 8
   };
@@ -280,12 +322,147 @@ void test_fill_ltor()
   TEST_ASSERT(!gaps.check_gap(8));    // No gap
 }
 
+void test_buffer_out_of_order()
+{
+  TransportReassembly tr;
+  SequenceNumber msg_seq(3);
+  RepoId pub_id = create_pub_id();
+
+  SizedFrag third(pub_id, msg_seq, 3, 1, 4, 10);
+  TEST_ASSERT(!tr.reassemble(third.range, 10, 4, third.sample));
+  TEST_ASSERT(tr.has_frags(msg_seq, pub_id));
+  TEST_ASSERT(10 == tr.buffered_bytes());
+
+  SizedFrag first(pub_id, msg_seq, 1, 1, 4, 10);
+  TEST_ASSERT(!tr.reassemble(first.range, 10, 4, first.sample));
+  SizedFrag duplicate(pub_id, msg_seq, 1, 1, 4, 10);
+  TEST_ASSERT(!tr.reassemble(duplicate.range, 10, 4, duplicate.sample));
+
+  SizedFrag second(pub_id, msg_seq, 2, 1, 4, 10);
+  TEST_ASSERT(tr.reassemble(second.range, 10, 4, second.sample));
+  TEST_ASSERT(has_pattern(second.sample, 10));
+  TEST_ASSERT(10 == second.sample.header_.message_length_);
+  TEST_ASSERT(!second.sample.header_.more_fragments_);
+  TEST_ASSERT(!tr.has_frags(msg_seq, pub_id));
+  TEST_ASSERT(0 == tr.buffered_bytes());
+}
+
+void test_buffer_gaps()
+{
+  TransportReassembly tr;
+  Gaps gaps;
+  SequenceNumber msg_seq(5);
+  RepoId pub_id = create_pub_id();
+
+  SizedFrag first_two(pub_id, msg_seq, 1, 2, 4, 40);
+  TEST_ASSERT(!tr.reassemble(first_two.range, 40, 4, first_two.sample));
+  TEST_ASSERT(3 == gaps.get(tr, msg_seq, pub_id));
+  TEST_ASSERT(1 == gaps.result_bits); // Only the next one
+  TEST_ASSERT(gaps.check_gap(3));
+
+  SizedFrag fifth(pub_id, msg_seq, 5, 1, 4, 40);
+  TEST_ASSERT(!tr.reassemble(fifth.range, 40, 4, fifth.sample));
+  SizedFrag eighth(pub_id, msg_seq, 8, 1, 4, 40);
+  TEST_ASSERT(!tr.reassemble(eighth.range, 40, 4, eighth.sample));
+  TEST_ASSERT(3 == gaps.get(tr, msg_seq, pub_id));
+  TEST_ASSERT(5 == gaps.result_bits); // 3-7
+  TEST_ASSERT(gaps.check_gap(3));
+  TEST_ASSERT(gaps.check_gap(4));
+  TEST_ASSERT(!gaps.check_gap(5));
+  TEST_ASSERT(gaps.check_gap(6));
+  TEST_ASSERT(gaps.check_gap(7));
+
+  tr.data_unavailable(msg_seq, pub_id);
+  TEST_ASSERT(!tr.has_frags(msg_seq, pub_id));
+  TEST_ASSERT(0 == tr.buffered_bytes());
+}
+
+void test_buffer_eviction()
+{
+  TransportReassembly tr(16);
+  RepoId pub_id = create_pub_id();
+
+  SizedFrag a(pub_id, SequenceNumber(1), 1, 1, 4, 10);
+  TEST_ASSERT(!tr.reassemble(a.range, 10, 4, a.sample));
+  SizedFrag b(pub_id, SequenceNumber(2), 1, 1, 4, 10);
+  TEST_ASSERT(!tr.reassemble(b.range, 10, 4, b.sample));
+  TEST_ASSERT(!tr.has_frags(SequenceNumber(1), pub_id));
+  TEST_ASSERT(tr.has_frags(SequenceNumber(2), pub_id));
+  TEST_ASSERT(1 == tr.evictions());
+  TEST_ASSERT(10 == tr.evicted_bytes());
+  TEST_ASSERT(10 == tr.buffered_bytes());
+
+  // Too large for the limit
+  SizedFrag c(pub_id, SequenceNumber(3), 1, 1, 4, 20);
+  TEST_ASSERT(!tr.reassemble(c.range, 20, 4, c.sample));
+  TEST_ASSERT(!tr.has_frags(SequenceNumber(3), pub_id));
+  TEST_ASSERT(10 == tr.buffered_bytes());
+  TEST_ASSERT(1 == tr.evictions());
+
+  // Doesn't fit the buffer, which isn't kept
+  SizedFrag d(pub_id, SequenceNumber(4), 1, 1, 4, 6);
+  TEST_ASSERT(!tr.reassemble(d.range, 6, 8, d.sample));
+  TEST_ASSERT(!tr.has_frags(SequenceNumber(4), pub_id));
+  TEST_ASSERT(10 == tr.buffered_bytes());
+  TEST_ASSERT(tr.has_frags(SequenceNumber(2), pub_id));
+}
+
+void test_range_limit()
+{
+  TransportReassembly tr(16);
+  RepoId pub_id = create_pub_id();
+
+  // Without the fragment size, the fragments are merged as ranges
+  SizedFrag a1(pub_id, SequenceNumber(1), 1, 1, 4, 12);
+  TEST_ASSERT(!tr.reassemble(a1.range, 0, 0, a1.sample));
+  TEST_ASSERT(4 == tr.buffered_bytes());
+
+  // A buffer evicts the ranges
+  SizedFrag b(pub_id, SequenceNumber(2), 1, 1, 4, 14);
+  TEST_ASSERT(!tr.reassemble(b.range, 14, 4, b.sample));
+  TEST_ASSERT(!tr.has_frags(SequenceNumber(1), pub_id));
+  TEST_ASSERT(14 == tr.buffered_bytes());
+  TEST_ASSERT(1 == tr.evictions());
+  TEST_ASSERT(4 == tr.evicted_bytes());
+
+  // Ranges evict the buffer
+  SizedFrag c1(pub_id, SequenceNumber(3), 1, 1, 4, 12);
+  TEST_ASSERT(!tr.reassemble(c1.range, 0, 0, c1.sample));
+  TEST_ASSERT(!tr.has_frags(SequenceNumber(2), pub_id));
+  TEST_ASSERT(4 == tr.buffered_bytes());
+  TEST_ASSERT(2 == tr.evictions());
+  TEST_ASSERT(18 == tr.evicted_bytes());
+
+  SizedFrag c3(pub_id, SequenceNumber(3), 3, 1, 4, 12);
+  TEST_ASSERT(!tr.reassemble(c3.range, 0, 0, c3.sample));
+  TEST_ASSERT(8 == tr.buffered_bytes());
+  SizedFrag c2(pub_id, SequenceNumber(3), 2, 1, 4, 12);
+  TEST_ASSERT(tr.reassemble(c2.range, 0, 0, c2.sample));
+  TEST_ASSERT(has_pattern(c2.sample, 12));
+  TEST_ASSERT(0 == tr.buffered_bytes());
+
+  // Ranges growing over the limit are dropped
+  TransportReassembly small(6);
+  SizedFrag d1(pub_id, SequenceNumber(4), 1, 1, 4, 12);
+  TEST_ASSERT(!small.reassemble(d1.range, 0, 0, d1.sample));
+  SizedFrag d2(pub_id, SequenceNumber(4), 2, 1, 4, 12);
+  TEST_ASSERT(!small.reassemble(d2.range, 0, 0, d2.sample));
+  TEST_ASSERT(!small.has_frags(SequenceNumber(4), pub_id));
+  TEST_ASSERT(0 == small.buffered_bytes());
+  TEST_ASSERT(1 == small.evictions());
+  TEST_ASSERT(4 == small.evicted_bytes());
+}
+
 int
 ACE_TMAIN(int, ACE_TCHAR*[])
 {
   try
   {
     test_empty();
+    test_buffer_out_of_order();
+    test_buffer_gaps();
+    test_buffer_eviction();
+    test_range_limit();
     /*
       test_insert_has_frag();
       test_first_insert_has_no_gaps();
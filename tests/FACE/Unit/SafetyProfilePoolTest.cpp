@@ -1,6 +1,7 @@
 #include "dds/DCPS/SafetyProfilePool.h"
 #include "ace/OS_main.h"
 #include "ace/Log_Msg.h"
+#include "ace/Task.h"
 
 #include "test_check.h"
 
@@ -42,10 +43,161 @@ void test_mallocs() {
   TEST_CHECK(p4 > p5);
 }
 
+// A freed block should be reused by the next malloc of its size
+void test_magazine_reuse() {
+  SafetyProfilePool pool;
+  pool.configure_pool(64 * 1024, sizeof(void*), 8);
+  void* p1;
+  void* p2;
+  TEST_CHECK(p1 = pool.malloc(24));
+  pool.free(p1);
+  TEST_CHECK(p2 = pool.malloc(20));
+  TEST_CHECK(p1 == p2);
+  pool.free(p2);
+
+  const SafetyProfilePool::Stats stats = pool.stats();
+  TEST_CHECK(stats.misses_ == 1);
+  TEST_CHECK(stats.hits_ == 1);
+  TEST_CHECK(stats.returns_ == 0);
+}
+
+// Magazines should be refilled and returned half a magazine at a time
+void test_magazine_batches() {
+  SafetyProfilePool pool;
+  pool.configure_pool(64 * 1024, sizeof(void*), 8);
+  void* p[16];
+  for (int i = 0; i < 16; ++i) {
+    TEST_CHECK(p[i] = pool.malloc(100));
+  }
+  SafetyProfilePool::Stats stats = pool.stats();
+  TEST_CHECK(stats.misses_ == 4);
+  TEST_CHECK(stats.hits_ == 12);
+  TEST_CHECK(stats.locks_ == 4);
+
+  for (int i = 0; i < 16; ++i) {
+    pool.free(p[i]);
+  }
+  stats = pool.stats();
+  TEST_CHECK(stats.returns_ == 2);
+  TEST_CHECK(stats.locks_ == 6);
+}
+
+// Without magazines each malloc and free should take the lock
+void test_no_magazines() {
+  SafetyProfilePool pool;
+  pool.configure_pool(1024, sizeof(void*));
+  void* p1;
+  TEST_CHECK(p1 = pool.malloc(24));
+  pool.free(p1);
+  const SafetyProfilePool::Stats stats = pool.stats();
+  TEST_CHECK(stats.locks_ == 2);
+  TEST_CHECK(stats.hits_ == 0);
+  TEST_CHECK(stats.misses_ == 0);
+}
+
+// When the pool is exhausted, the magazines of the thread should be given
+// back to satisfy an allocation of another size
+void test_magazine_exhausted() {
+  SafetyProfilePool pool;
+  pool.configure_pool(1024, sizeof(void*), 64);
+  void* p1;
+  void* p2;
+  TEST_CHECK(p1 = pool.malloc(16));
+  pool.free(p1);
+  TEST_CHECK(p2 = pool.malloc(512));
+  pool.free(p2);
+}
+
+// The free bytes kept by magazines should be reported, as of the pool's
+// low water mark and its exhaustion too
+void test_magazine_accounting() {
+  SafetyProfilePool pool;
+  pool.configure_pool(8 * 1024, sizeof(void*), 8);
+  void* p1;
+  void* p2;
+  TEST_CHECK(p1 = pool.malloc(64));
+  SafetyProfilePool::Stats stats = pool.stats();
+  const size_t cached = stats.cached_bytes_;
+  TEST_CHECK(cached >= 3 * 64);
+
+  TEST_CHECK(p2 = pool.malloc(2000));
+  TEST_CHECK(!pool.malloc(16 * 1024));
+  stats = pool.stats();
+  TEST_CHECK(stats.lwm_cached_bytes_ == cached);
+  TEST_CHECK(stats.exhausted_ == 1);
+  TEST_CHECK(stats.exhausted_cached_bytes_ == cached);
+
+  pool.free(p1);
+  pool.free(p2);
+  stats = pool.stats();
+  TEST_CHECK(stats.cached_bytes_ > cached);
+}
+
+class PoolUser : public ACE_Task_Base {
+public:
+  explicit PoolUser(SafetyProfilePool& pool)
+    : pool_(pool)
+    , errors_(0)
+  {}
+
+  int svc()
+  {
+    void* blocks[32] = {0};
+    unsigned int seed = 1;
+    for (int i = 0; i < 20000; ++i) {
+      seed = seed * 1103515245 + 12345;
+      const size_t slot = (seed >> 8) % 32;
+      unsigned char* const old = static_cast<unsigned char*>(blocks[slot]);
+      if (old) {
+        if (old[0] != slot || old[1] != (slot ^ 0xff)) {
+          ++errors_;
+        }
+        pool_.free(old);
+      }
+      unsigned char* const block =
+        static_cast<unsigned char*>(pool_.malloc(16 + (seed >> 16) % 1200));
+      if (block) {
+        block[0] = static_cast<unsigned char>(slot);
+        block[1] = static_cast<unsigned char>(slot ^ 0xff);
+      }
+      blocks[slot] = block;
+    }
+    for (size_t slot = 0; slot < 32; ++slot) {
+      pool_.free(blocks[slot]);
+    }
+    return 0;
+  }
+
+  SafetyProfilePool& pool_;
+  ACE_Atomic_Op<ACE_Thread_Mutex, long> errors_;
+};
+
+// Threads should not get each other's blocks, and their magazines should
+// go back to the pool when they exit
+void test_magazine_threads() {
+  SafetyProfilePool pool;
+  pool.configure_pool(1024 * 1024, sizeof(void*), 16);
+  PoolUser user(pool);
+  TEST_CHECK(user.activate(THR_NEW_LWP | THR_JOINABLE, 4) == 0);
+  user.wait();
+  TEST_CHECK(user.errors_ == 0);
+
+  const SafetyProfilePool::Stats stats = pool.stats();
+  TEST_CHECK(stats.hits_ > stats.misses_);
+  TEST_CHECK(stats.cached_bytes_ == 0);
+  TEST_CHECK(pool.malloc(1000 * 1000));
+}
+
 int ACE_TMAIN(int, ACE_TCHAR* [] )
 {
   test_malloc();
   test_mallocs();
+  test_magazine_reuse();
+  test_magazine_batches();
+  test_no_magazines();
+  test_magazine_exhausted();
+  test_magazine_accounting();
+  test_magazine_threads();
 
   printf("%d assertions failed, %d passed\n", failed, assertions - failed);
   return failed;
@@ -411,6 +411,49 @@ TEST_F(AccessControlTest, validate_remote_permissions_Success)
   std::cout << ex.message << std::endl;
 }
 
+TEST_F(AccessControlTest, validate_remote_permissions_Repeated)
+{
+  ::DDS::Security::PermissionsToken remote_perm_token;
+  ::DDS::Security::AuthenticatedPeerCredentialToken remote_apc_token;
+  ::DDS::Security::SecurityException ex;
+
+  remote_perm_token.class_id = Expected_Permissions_Token_Class_Id;
+  remote_perm_token.properties.length(1);
+  remote_perm_token.properties[0].name = "dds.perm.ca.sn";
+  remote_perm_token.properties[0].value = remote_subject_name;
+
+  std::string id(get_file_contents(mock_1_cert_file));
+  std::string pf(get_file_contents(perm_mock_1_join_p7s_file));
+
+  remote_apc_token.class_id = Expected_Permissions_Cred_Token_Class_Id;
+  remote_apc_token.binary_properties.length(2);
+  remote_apc_token.binary_properties[0].name = "c.id";
+  remote_apc_token.binary_properties[0].value.length(id.size());
+  memcpy(remote_apc_token.binary_properties[0].value.get_buffer(), id.c_str(), id.size());
+  remote_apc_token.binary_properties[0].propagate = true;
+
+  remote_apc_token.binary_properties[1].name = "c.perm";
+  remote_apc_token.binary_properties[1].value.length(pf.size());
+  memcpy(remote_apc_token.binary_properties[1].value.get_buffer(), pf.c_str(), pf.size());
+  remote_apc_token.binary_properties[1].propagate = true;
+
+  get_inst().validate_local_permissions(auth_plugin_.get(), 1, 1, domain_participant_qos, ex);
+
+  // The second remote participant gets the rules verified for the first
+  ::DDS::Security::PermissionsHandle first_handle = get_inst().validate_remote_permissions(
+    auth_plugin_.get(), 1, 2, remote_perm_token, remote_apc_token, ex);
+  ::DDS::Security::PermissionsHandle second_handle = get_inst().validate_remote_permissions(
+    auth_plugin_.get(), 1, 3, remote_perm_token, remote_apc_token, ex);
+  EXPECT_FALSE(DDS::HANDLE_NIL == first_handle);
+  EXPECT_FALSE(DDS::HANDLE_NIL == second_handle);
+  EXPECT_NE(first_handle, second_handle);
+
+  // A document that no longer matches its signature is checked again
+  remote_apc_token.binary_properties[1].value[pf.size() / 2] ^= 0xff;
+  EXPECT_EQ(DDS::HANDLE_NIL, get_inst().validate_remote_permissions(
+    auth_plugin_.get(), 1, 4, remote_perm_token, remote_apc_token, ex));
+}
+
 TEST_F(AccessControlTest, check_create_participant_InvalidInput)
 {
   ::DDS::DomainParticipantQos qos;
@@ -643,6 +643,118 @@ TEST_F(AuthenticationTest, BeginHandshakeRequest_BeginHandshakeReply_ProcessHand
   ASSERT_EQ(r, DDS::Security::VALIDATION_OK);
 }
 
+TEST_F(AuthenticationTest, ValidateRemoteCertificate_SuccessCached_FailureNotCached)
+{
+  AuthenticationBuiltInImpl auth;
+  SecurityException ex;
+
+  ValidationResult_t r = auth.validate_local_identity(mp2.id_handle, mp2.guid_adjusted, mp2.domain_id, mp2.qos, mp2.guid, mp2.ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_OK, r);
+  ASSERT_EQ(true, auth.get_identity_token(mp2.id_token, mp2.id_handle, mp2.ex));
+
+  r = auth.validate_local_identity(mp1.id_handle, mp1.guid_adjusted, mp1.domain_id, mp1.qos, mp1.guid, mp1.ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_OK, r);
+  ASSERT_EQ(true, auth.get_identity_token(mp1.id_token, mp1.id_handle, mp1.ex));
+
+  IdentityHandle mp1_remote_mp2;
+  r = auth.validate_remote_identity(mp1_remote_mp2,
+                                    mp1.auth_request_message_token,
+                                    mp2.auth_request_message_token,
+                                    mp1.id_handle,
+                                    mp2.id_token,
+                                    mp2.guid_adjusted,
+                                    ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_PENDING_HANDSHAKE_REQUEST, r);
+
+  DDS::Security::HandshakeMessageToken request_token;
+  r = auth.begin_handshake_request(mp1.handshake_handle,
+                                   request_token,
+                                   mp1.id_handle,
+                                   mp1_remote_mp2,
+                                   mp1.mock_participant_builtin_topic_data,
+                                   ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_PENDING_HANDSHAKE_MESSAGE, r);
+
+  IdentityHandle mp2_remote_mp1;
+  r = auth.validate_remote_identity(mp2_remote_mp1,
+                                    mp2.auth_request_message_token,
+                                    mp1.auth_request_message_token,
+                                    mp2.id_handle,
+                                    mp1.id_token,
+                                    mp1.guid_adjusted,
+                                    ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_PENDING_HANDSHAKE_MESSAGE, r);
+
+  // The replier validates the certificate of the initiator
+  DDS::Security::HandshakeMessageToken reply_token(request_token);
+  r = auth.begin_handshake_reply(mp2.handshake_handle,
+                                 reply_token,
+                                 mp2_remote_mp1,
+                                 mp2.id_handle,
+                                 mp2.mock_participant_builtin_topic_data,
+                                 ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_PENDING_HANDSHAKE_MESSAGE, r);
+
+  AuthenticationBuiltInImpl::VerificationStats stats = auth.certificate_verification_stats();
+  ASSERT_EQ(1u, stats.entries);
+  ASSERT_EQ(0u, stats.hits);
+  ASSERT_EQ(1u, stats.misses);
+
+  // And the initiator the certificate of the replier
+  DDS::Security::HandshakeMessageToken final_token;
+  r = auth.process_handshake(final_token,
+                             reply_token,
+                             mp1.handshake_handle,
+                             ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_OK_FINAL_MESSAGE, r);
+
+  stats = auth.certificate_verification_stats();
+  ASSERT_EQ(2u, stats.entries);
+  ASSERT_EQ(2u, stats.misses);
+
+  // A certificate that isn't signed by the CA fails each time
+  DDS::Security::HandshakeMessageToken bad_request_token(request_token);
+  const Certificate not_signed("file:certs/identity/not_signed.pem");
+  for (CORBA::ULong i = 0; i < bad_request_token.binary_properties.length(); ++i) {
+    if (std::strcmp(bad_request_token.binary_properties[i].name, "c.id") == 0) {
+      bad_request_token.binary_properties[i].value = not_signed.original_bytes();
+    }
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    DDS::Security::HandshakeMessageToken bad_reply_token(bad_request_token);
+    HandshakeHandle handshake_handle = DDS::HANDLE_NIL;
+    r = auth.begin_handshake_reply(handshake_handle,
+                                   bad_reply_token,
+                                   mp2_remote_mp1,
+                                   mp2.id_handle,
+                                   mp2.mock_participant_builtin_topic_data,
+                                   ex);
+    ASSERT_EQ(DDS::Security::VALIDATION_FAILED, r);
+
+    stats = auth.certificate_verification_stats();
+    ASSERT_EQ(2u, stats.entries);
+    ASSERT_EQ(0u, stats.hits);
+    ASSERT_EQ(3u + i, stats.misses);
+  }
+
+  // The certificate of the initiator is still cached
+  DDS::Security::HandshakeMessageToken second_reply_token(request_token);
+  HandshakeHandle second_handshake_handle = DDS::HANDLE_NIL;
+  r = auth.begin_handshake_reply(second_handshake_handle,
+                                 second_reply_token,
+                                 mp2_remote_mp1,
+                                 mp2.id_handle,
+                                 mp2.mock_participant_builtin_topic_data,
+                                 ex);
+  ASSERT_EQ(DDS::Security::VALIDATION_PENDING_HANDSHAKE_MESSAGE, r);
+
+  stats = auth.certificate_verification_stats();
+  ASSERT_EQ(2u, stats.entries);
+  ASSERT_EQ(1u, stats.hits);
+  ASSERT_EQ(4u, stats.misses);
+}
+
 TEST_F(AuthenticationTest, SeparateAuthImpls_BeginHandshakeRequest_BeginHandshakeReply_ProcessHandshake_Success)
 {
   // The goal here is not only to test having two separate Auth impl objects, but to make sure the info available to each side is cleanly separated
@@ -0,0 +1,94 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.opendds.org/license.html
+ */
+
+#include "gtest/gtest.h"
+#include "dds/DCPS/security/VerificationCache_T.h"
+
+#include <cstring>
+
+using namespace OpenDDS::Security;
+
+namespace {
+  DDS::OctetSeq octets(const char* s)
+  {
+    DDS::OctetSeq seq;
+    seq.length(static_cast<CORBA::ULong>(std::strlen(s)));
+    std::memcpy(seq.get_buffer(), s, seq.length());
+    return seq;
+  }
+
+  const ACE_Time_Value start(1000);
+}
+
+TEST(VerificationCacheTest, MakeKey_DependsOnDocumentAndCa)
+{
+  std::string k1, k2, k3, k4;
+  ASSERT_EQ(0, VerificationCache<bool>::make_key(octets("document"), octets("ca"), k1));
+  ASSERT_EQ(0, VerificationCache<bool>::make_key(octets("document"), octets("ca"), k2));
+  ASSERT_EQ(0, VerificationCache<bool>::make_key(octets("other"), octets("ca"), k3));
+  ASSERT_EQ(0, VerificationCache<bool>::make_key(octets("document"), octets("other ca"), k4));
+  ASSERT_EQ(32u, k1.size());
+  ASSERT_EQ(k1, k2);
+  ASSERT_NE(k1, k3);
+  ASSERT_NE(k1, k4);
+}
+
+TEST(VerificationCacheTest, Find_Expired_Removed)
+{
+  VerificationCache<int> cache(4, ACE_Time_Value(60));
+  cache.insert("a", 1, start);
+
+  const int* value = cache.find("a", start + ACE_Time_Value(60));
+  ASSERT_TRUE(value != 0);
+  ASSERT_EQ(1, *value);
+  ASSERT_EQ(1u, cache.hits());
+
+  ASSERT_TRUE(cache.find("a", start + ACE_Time_Value(61)) == 0);
+  ASSERT_EQ(0u, cache.size());
+  ASSERT_EQ(1u, cache.misses());
+
+  ASSERT_TRUE(cache.find("b", start) == 0);
+  ASSERT_EQ(2u, cache.misses());
+}
+
+TEST(VerificationCacheTest, Insert_Full_EvictsOldest)
+{
+  VerificationCache<int> cache(2, ACE_Time_Value(60));
+  cache.insert("b", 1, start + ACE_Time_Value(1));
+  cache.insert("a", 2, start + ACE_Time_Value(2));
+
+  // Replacing an entry doesn't evict another one
+  cache.insert("b", 3, start + ACE_Time_Value(3));
+  ASSERT_EQ(2u, cache.size());
+
+  cache.insert("c", 4, start + ACE_Time_Value(4));
+  ASSERT_EQ(2u, cache.size());
+  ASSERT_TRUE(cache.find("a", start + ACE_Time_Value(4)) == 0);
+  ASSERT_EQ(3, *cache.find("b", start + ACE_Time_Value(4)));
+  ASSERT_EQ(4, *cache.find("c", start + ACE_Time_Value(4)));
+}
+
+TEST(VerificationCacheTest, NoEntries_NothingStored)
+{
+  VerificationCache<int> cache(0, ACE_Time_Value(60));
+  cache.insert("a", 1, start);
+  ASSERT_EQ(0u, cache.size());
+  ASSERT_TRUE(cache.find("a", start) == 0);
+}
+
+TEST(VerificationCacheTest, Find_NotAfter_ExpiresFirst)
+{
+  VerificationCache<int> cache(4, ACE_Time_Value(60));
+  cache.insert("a", 1, start, start + ACE_Time_Value(10));
+  cache.insert("b", 2, start, start + ACE_Time_Value(600));
+
+  ASSERT_EQ(1, *cache.find("a", start + ACE_Time_Value(10)));
+  ASSERT_TRUE(cache.find("a", start + ACE_Time_Value(11)) == 0);
+
+  // The lifetime still applies to results valid for longer
+  ASSERT_EQ(2, *cache.find("b", start + ACE_Time_Value(60)));
+  ASSERT_TRUE(cache.find("b", start + ACE_Time_Value(61)) == 0);
+  ASSERT_EQ(0u, cache.size());
+}
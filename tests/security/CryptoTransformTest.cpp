@@ -1,7 +1,11 @@
 #include "dds/DCPS/security/CryptoBuiltInImpl.h"
+#include "dds/DCPS/LocalObject.h"
+#include "dds/DCPS/Message_Block_Ptr.h"
 #include "dds/DdsDcpsInfrastructureC.h"
 #include "gtest/gtest.h"
 
+#include <cstring>
+
 
 using namespace OpenDDS::Security;
 using namespace testing;
@@ -55,6 +59,11 @@ public:
     return test_class_;
   }
 
+  MessageBlockCryptoTransform& get_mb_inst()
+  {
+    return test_class_;
+  }
+
   DDS::OctetSeq& get_buffer()
   {
     return test_buffer_;
@@ -261,6 +270,54 @@ TEST_F(CryptoTransformTest, encode_datareader_submessage_GoodBuffer)
   EXPECT_EQ(get_buffer(), output);
 }
 
+TEST_F(CryptoTransformTest, encode_datawriter_submessage_MessageBlock)
+{
+  DDS::Security::SecurityException ex;
+  DDS::Security::DatawriterCryptoHandle handle = 1;
+
+  init_readers(3);
+  init_buffer(48, 7);
+
+  ACE_Message_Block plain(reinterpret_cast<const char*>(get_buffer().get_buffer()),
+                          get_buffer().length());
+  plain.wr_ptr(get_buffer().length());
+  ACE_Message_Block output(get_mb_inst().max_encoded_submessage_length(plain.length()));
+
+  bool encoded = true;
+  EXPECT_TRUE(get_mb_inst().encode_datawriter_submessage(
+    output, encoded, plain, plain.length(), handle, get_readers(), ex));
+  EXPECT_FALSE(encoded);
+  EXPECT_EQ(0U, output.length());
+
+  EXPECT_FALSE(get_mb_inst().encode_datawriter_submessage(
+    output, encoded, plain, plain.length(), DDS::HANDLE_NIL, get_readers(), ex));
+  EXPECT_FALSE(encoded);
+}
+
+TEST_F(CryptoTransformTest, encode_datareader_submessage_MessageBlock)
+{
+  DDS::Security::SecurityException ex;
+  DDS::Security::DatareaderCryptoHandle handle = 1;
+
+  init_writers(5);
+  init_buffer(256, 127);
+
+  ACE_Message_Block plain(reinterpret_cast<const char*>(get_buffer().get_buffer()),
+                          get_buffer().length());
+  plain.wr_ptr(get_buffer().length());
+  ACE_Message_Block output(get_mb_inst().max_encoded_submessage_length(plain.length()));
+
+  bool encoded = true;
+  EXPECT_TRUE(get_mb_inst().encode_datareader_submessage(
+    output, encoded, plain, plain.length(), handle, get_writers(), ex));
+  EXPECT_FALSE(encoded);
+  EXPECT_EQ(0U, output.length());
+
+  EXPECT_FALSE(get_mb_inst().encode_datareader_submessage(
+    output, encoded, plain, plain.length(), DDS::HANDLE_NIL, get_writers(), ex));
+  EXPECT_FALSE(encoded);
+}
+
 TEST_F(CryptoTransformTest, encode_rtps_message_NullSendingHandle)
 {
   DDS::OctetSeq output;
@@ -512,6 +569,216 @@ TEST_F(CryptoTransformTest, decode_serialized_payload_Success)
   EXPECT_EQ(get_buffer(), output);
 }
 
+struct FakeSharedSecret
+  : OpenDDS::DCPS::LocalObject<DDS::Security::SharedSecretHandle> {
+
+  DDS::OctetSeq* challenge1() { return new DDS::OctetSeq; }
+  DDS::OctetSeq* challenge2() { return new DDS::OctetSeq; }
+  DDS::OctetSeq* sharedSecret() { return new DDS::OctetSeq; }
+};
+
+// Submessages encoded from a chain of message blocks by the
+// MessageBlockCryptoTransform operations, decoded by the CryptoTransform
+// ones.  One plugin instance plays both participants: the local writer and
+// reader send, the matched remote writer and reader that were given their
+// keys receive.
+class MessageBlockRoundTripTest : public Test
+{
+public:
+  MessageBlockRoundTripTest()
+    : secret_(new FakeSharedSecret)
+    , local_writer_(DDS::HANDLE_NIL)
+    , local_reader_(DDS::HANDLE_NIL)
+    , remote_writer_(DDS::HANDLE_NIL)
+    , remote_reader_(DDS::HANDLE_NIL)
+  {
+  }
+
+  void init(bool encrypt)
+  {
+    DDS::PropertySeq props;
+    DDS::Security::ParticipantSecurityAttributes part_attributes =
+      {
+        false, false, false, false, false,
+        0, props
+      };
+    DDS::Security::EndpointSecurityAttributes attributes =
+      {
+        {false, false, false, false},
+        true, false, false,
+        encrypt ? DDS::Security::PLUGIN_ENDPOINT_SECURITY_ATTRIBUTES_FLAG_IS_SUBMESSAGE_ENCRYPTED : 0,
+        props
+      };
+    DDS::Security::SecurityException ex;
+    DDS::Security::CryptoKeyFactory& factory = test_class_;
+    DDS::Security::CryptoKeyExchange& exchange = test_class_;
+
+    const DDS::Security::ParticipantCryptoHandle local =
+      factory.register_local_participant(1, 2, props, part_attributes, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, local);
+    const DDS::Security::ParticipantCryptoHandle remote =
+      factory.register_matched_remote_participant(local, 5, 6, secret_, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, remote);
+
+    local_writer_ = factory.register_local_datawriter(local, props, attributes, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, local_writer_);
+    local_reader_ = factory.register_local_datareader(local, props, attributes, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, local_reader_);
+    remote_reader_ = factory.register_matched_remote_datareader(
+      local_writer_, remote, secret_, false, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, remote_reader_);
+    remote_writer_ = factory.register_matched_remote_datawriter(
+      local_reader_, remote, secret_, ex);
+    ASSERT_NE(DDS::HANDLE_NIL, remote_writer_);
+
+    DDS::Security::DatawriterCryptoTokenSeq writer_tokens;
+    ASSERT_TRUE(exchange.create_local_datawriter_crypto_tokens(
+      writer_tokens, local_writer_, remote_reader_, ex));
+    ASSERT_TRUE(exchange.set_remote_datawriter_crypto_tokens(
+      local_reader_, remote_writer_, writer_tokens, ex));
+    DDS::Security::DatareaderCryptoTokenSeq reader_tokens;
+    ASSERT_TRUE(exchange.create_local_datareader_crypto_tokens(
+      reader_tokens, local_reader_, remote_writer_, ex));
+    ASSERT_TRUE(exchange.set_remote_datareader_crypto_tokens(
+      local_writer_, remote_reader_, reader_tokens, ex));
+
+    readers_.length(1);
+    readers_[0] = remote_reader_;
+    writers_.length(1);
+    writers_[0] = remote_writer_;
+  }
+
+  // A little endian DATA submessage of length bytes, split into blocks
+  // whose boundaries don't line up with the cipher's blocks.
+  void init_plain(CORBA::ULong length)
+  {
+    plain_.length(length);
+    for (CORBA::ULong i = 0; i < length; ++i) {
+      plain_[i] = static_cast<CORBA::Octet>(i * 7 + 3);
+    }
+    plain_[0] = 0x15;
+    plain_[1] = 1;
+    plain_[2] = static_cast<CORBA::Octet>((length - 4) & 0xff);
+    plain_[3] = static_cast<CORBA::Octet>((length - 4) >> 8);
+
+    const char* const data = reinterpret_cast<const char*>(plain_.get_buffer());
+    const size_t splits[] = {0, 5, 42, 43, length};
+    ACE_Message_Block* prev = 0;
+    for (size_t i = 0; i + 1 < sizeof splits / sizeof splits[0]; ++i) {
+      ACE_Message_Block* const mb =
+        new ACE_Message_Block(data + splits[i], splits[i + 1] - splits[i]);
+      mb->wr_ptr(mb->size());
+      if (prev) {
+        prev->cont(mb);
+      } else {
+        chain_.reset(mb);
+      }
+      prev = mb;
+    }
+  }
+
+  static DDS::OctetSeq to_seq(const ACE_Message_Block& mb)
+  {
+    DDS::OctetSeq seq(static_cast<CORBA::ULong>(mb.length()));
+    seq.length(seq.maximum());
+    std::memcpy(seq.get_buffer(), mb.rd_ptr(), mb.length());
+    return seq;
+  }
+
+  void writer_round_trip()
+  {
+    DDS::Security::SecurityException ex;
+    MessageBlockCryptoTransform& mb_transform = test_class_;
+    ACE_Message_Block out(mb_transform.max_encoded_submessage_length(plain_.length()));
+    bool encoded = false;
+    ASSERT_TRUE(mb_transform.encode_datawriter_submessage(
+      out, encoded, *chain_, plain_.length(), local_writer_, readers_, ex));
+    ASSERT_TRUE(encoded);
+
+    DDS::Security::CryptoTransform& transform = test_class_;
+    DDS::OctetSeq decoded;
+    EXPECT_TRUE(transform.decode_datawriter_submessage(
+      decoded, to_seq(out), local_reader_, remote_writer_, ex));
+    EXPECT_EQ(plain_, decoded);
+
+    DDS::OctetSeq seq_encoded;
+    CORBA::Long index = 0;
+    ASSERT_TRUE(transform.encode_datawriter_submessage(
+      seq_encoded, plain_, local_writer_, readers_, index, ex));
+    EXPECT_EQ(seq_encoded.length(), out.length());
+    DDS::OctetSeq seq_decoded;
+    EXPECT_TRUE(transform.decode_datawriter_submessage(
+      seq_decoded, seq_encoded, local_reader_, remote_writer_, ex));
+    EXPECT_EQ(decoded, seq_decoded);
+  }
+
+  void reader_round_trip()
+  {
+    DDS::Security::SecurityException ex;
+    MessageBlockCryptoTransform& mb_transform = test_class_;
+    ACE_Message_Block out(mb_transform.max_encoded_submessage_length(plain_.length()));
+    bool encoded = false;
+    ASSERT_TRUE(mb_transform.encode_datareader_submessage(
+      out, encoded, *chain_, plain_.length(), local_reader_, writers_, ex));
+    ASSERT_TRUE(encoded);
+
+    DDS::Security::CryptoTransform& transform = test_class_;
+    DDS::OctetSeq decoded;
+    EXPECT_TRUE(transform.decode_datareader_submessage(
+      decoded, to_seq(out), local_writer_, remote_reader_, ex));
+    EXPECT_EQ(plain_, decoded);
+
+    DDS::OctetSeq seq_encoded;
+    ASSERT_TRUE(transform.encode_datareader_submessage(
+      seq_encoded, plain_, local_reader_, writers_, ex));
+    EXPECT_EQ(seq_encoded.length(), out.length());
+    DDS::OctetSeq seq_decoded;
+    EXPECT_TRUE(transform.decode_datareader_submessage(
+      seq_decoded, seq_encoded, local_writer_, remote_reader_, ex));
+    EXPECT_EQ(decoded, seq_decoded);
+  }
+
+private:
+  CryptoBuiltInImpl test_class_;
+  DDS::Security::SharedSecretHandle_var secret_;
+  DDS::Security::DatawriterCryptoHandle local_writer_;
+  DDS::Security::DatareaderCryptoHandle local_reader_;
+  DDS::Security::DatawriterCryptoHandle remote_writer_;
+  DDS::Security::DatareaderCryptoHandle remote_reader_;
+  DDS::Security::DatareaderCryptoHandleSeq readers_;
+  DDS::Security::DatawriterCryptoHandleSeq writers_;
+  DDS::OctetSeq plain_;
+  OpenDDS::DCPS::Message_Block_Ptr chain_;
+};
+
+TEST_F(MessageBlockRoundTripTest, datawriter_submessage_Chain_GCM)
+{
+  ASSERT_NO_FATAL_FAILURE(init(true));
+  init_plain(150);
+  writer_round_trip();
+}
+
+TEST_F(MessageBlockRoundTripTest, datawriter_submessage_Chain_GMAC)
+{
+  ASSERT_NO_FATAL_FAILURE(init(false));
+  init_plain(150);
+  writer_round_trip();
+}
+
+TEST_F(MessageBlockRoundTripTest, datareader_submessage_Chain_GCM)
+{
+  ASSERT_NO_FATAL_FAILURE(init(true));
+  init_plain(93);
+  reader_round_trip();
+}
+
+TEST_F(MessageBlockRoundTripTest, datareader_submessage_Chain_GMAC)
+{
+  ASSERT_NO_FATAL_FAILURE(init(false));
+  init_plain(93);
+  reader_round_trip();
+}
+
 
 int main(int argc, char** argv)
 {
@@ -179,3 +179,19 @@ TEST_F(CertificateTest, CopyConstruct_ECDSA_SHA256)
   Certificate c(signed_ec_);
   ASSERT_EQ(c, signed_ec_);
 }
+
+TEST_F(CertificateTest, Expiration_Success)
+{
+  time_t expires = 0;
+  ASSERT_EQ(0, signed_.expiration(expires));
+  ASSERT_EQ(1844223196, expires); // Jun 10 04:13:16 2028 GMT
+  ASSERT_EQ(0, ca_.expiration(expires));
+  ASSERT_EQ(1844223063, expires); // Jun 10 04:11:03 2028 GMT
+}
+
+TEST_F(CertificateTest, Expiration_NotLoaded_Failure)
+{
+  Certificate c;
+  time_t expires = 0;
+  ASSERT_EQ(1, c.expiration(expires));
+}
@@ -0,0 +1,90 @@
+/*
+ * Distributed under the OpenDDS License.
+ * See: http://www.OpenDDS.org/license.html
+ */
+
+#include "gtest/gtest.h"
+#include "dds/DCPS/security/SSL/DiffieHellmanPool.h"
+
+#include "ace/OS_NS_unistd.h"
+
+#include <cstring>
+
+using namespace OpenDDS::Security::SSL;
+
+namespace {
+  const std::string ECDH("ECDH+prime256v1-CEUM");
+  const std::string MODP("DH+MODP-2048-256");
+
+  bool wait_ready(const DiffieHellmanPool& pool, const std::string& algo, size_t keys)
+  {
+    for (int i = 0; i < 300 && pool.ready(algo) != keys; ++i) {
+      ACE_OS::sleep(ACE_Time_Value(0, 100000));
+    }
+    return pool.ready(algo) == keys;
+  }
+}
+
+TEST(DiffieHellmanPoolTest, Prepare_GeneratesKeys)
+{
+  DiffieHellmanPool pool(3);
+  ASSERT_EQ(0u, pool.ready(ECDH));
+
+  pool.prepare(ECDH);
+  ASSERT_TRUE(wait_ready(pool, ECDH, 3));
+  ASSERT_EQ(0u, pool.ready(MODP));
+}
+
+TEST(DiffieHellmanPoolTest, Take_RefillsAndKeysAgree)
+{
+  DiffieHellmanPool pool(2);
+  pool.prepare(ECDH);
+  ASSERT_TRUE(wait_ready(pool, ECDH, 2));
+
+  DiffieHellman::unique_ptr dh1(pool.take(ECDH));
+  DiffieHellman::unique_ptr dh2(pool.take(ECDH));
+  ASSERT_TRUE(dh1.get() && dh2.get());
+  ASSERT_STREQ(ECDH.c_str(), dh1->kagree_algo());
+
+  // Each key pair is handed out once
+  DDS::OctetSeq pub1, pub2;
+  ASSERT_EQ(0, dh1->pub_key(pub1));
+  ASSERT_EQ(0, dh2->pub_key(pub2));
+  ASSERT_EQ(pub1.length(), pub2.length());
+  ASSERT_NE(0, std::memcmp(pub1.get_buffer(), pub2.get_buffer(), pub1.length()));
+
+  ASSERT_EQ(0, dh1->gen_shared_secret(pub2));
+  ASSERT_EQ(0, dh2->gen_shared_secret(pub1));
+  ASSERT_TRUE(dh1->cmp_shared_secret(*dh2));
+
+  ASSERT_TRUE(wait_ready(pool, ECDH, 2));
+}
+
+TEST(DiffieHellmanPoolTest, Take_NotReady_GeneratesAndPrepares)
+{
+  DiffieHellmanPool pool(1);
+
+  DiffieHellman::unique_ptr dh(pool.take(MODP));
+  ASSERT_TRUE(dh.get());
+  ASSERT_STREQ(MODP.c_str(), dh->kagree_algo());
+  ASSERT_TRUE(wait_ready(pool, MODP, 1));
+}
+
+TEST(DiffieHellmanPoolTest, Take_UnknownAlgorithm_Fails)
+{
+  DiffieHellmanPool pool(1);
+  DiffieHellman::unique_ptr dh(pool.take("DH+Unknown"));
+  ASSERT_FALSE(dh.get());
+  ASSERT_EQ(0u, pool.ready("DH+Unknown"));
+}
+
+TEST(DiffieHellmanPoolTest, NoKeys_NothingGenerated)
+{
+  DiffieHellmanPool pool(0);
+  pool.prepare(ECDH);
+
+  DiffieHellman::unique_ptr dh(pool.take(ECDH));
+  ASSERT_TRUE(dh.get());
+  ACE_OS::sleep(ACE_Time_Value(0, 100000));
+  ASSERT_EQ(0u, pool.ready(ECDH));
+}